@@ -1943,6 +1943,10 @@ const
 	gds_truncate_monitor                 = 335545267;
 	isc_truncate_context                 = 335545268;
 	gds_truncate_context                 = 335545268;
+	isc_ext_line_too_long                = 335545269;
+	gds_ext_line_too_long                = 335545269;
+	isc_ext_format_not_ext               = 335545270;
+	gds_ext_format_not_ext               = 335545270;
 	isc_gfix_db_name                     = 335740929;
 	gds_gfix_db_name                     = 335740929;
 	isc_gfix_invalid_sw                  = 335740930;
@@ -2901,6 +2905,12 @@ const
 	gds_nbackup_deco_parse               = 337117259;
 	isc_nbackup_lostrec_guid_db          = 337117261;
 	gds_nbackup_lostrec_guid_db          = 337117261;
+	isc_nbackup_zip_not_loaded           = 337117266;
+	gds_nbackup_zip_not_loaded           = 337117266;
+	isc_nbackup_zip_not_supported        = 337117267;
+	gds_nbackup_zip_not_supported        = 337117267;
+	isc_nbackup_zip_call_err             = 337117268;
+	gds_nbackup_zip_call_err             = 337117268;
 	isc_trace_conflict_acts              = 337182750;
 	gds_trace_conflict_acts              = 337182750;
 	isc_trace_act_notfound               = 337182751;
@@ -53,6 +53,8 @@ void ZLib::symbols()
 	FB_ZSYMB(inflate)
 	FB_ZSYMB(deflateEnd)
 	FB_ZSYMB(inflateEnd)
+	FB_ZSYMB(deflateReset)
+	FB_ZSYMB(inflateReset)
 #undef FB_ZSYMB
 }
 
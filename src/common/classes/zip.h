@@ -45,6 +45,8 @@ namespace Firebird {
 		int ZEXPORT (*inflate)(z_stream* strm, int flush);
 		void ZEXPORT (*deflateEnd)(z_stream* strm);
 		void ZEXPORT (*inflateEnd)(z_stream* strm);
+		int ZEXPORT (*deflateReset)(z_stream* strm);
+		int ZEXPORT (*inflateReset)(z_stream* strm);
 
 		operator bool() { return z.hasData(); }
 		bool operator!() { return !z.hasData(); }
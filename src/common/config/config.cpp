@@ -139,6 +139,9 @@ const char*	GCPolicyCooperative	= "cooperative";
 const char*	GCPolicyBackground	= "background";
 const char*	GCPolicyCombined	= "combined";
 
+const char*	CacheReplacementLRU	= "lru";
+const char*	CacheReplacement2Q	= "2q";
+
 
 const Config::ConfigEntry Config::entries[MAX_CONFIG_KEY] =
 {
@@ -230,7 +233,18 @@ const Config::ConfigEntry Config::entries[MAX_CONFIG_KEY] =
 	{TYPE_INTEGER,		"TipCacheBlockSize",		(ConfigValue) 4194304}, // bytes
 	{TYPE_BOOLEAN,		"ReadConsistency",			(ConfigValue) true},
 	{TYPE_BOOLEAN,		"ClearGTTAtRetaining",		(ConfigValue) false},
-	{TYPE_STRING,		"DataTypeCompatibility",	(ConfigValue) NULL}
+	{TYPE_STRING,		"DataTypeCompatibility",	(ConfigValue) NULL},
+	{TYPE_INTEGER,		"ReadAheadPages",			(ConfigValue) 32},		// pages
+	{TYPE_INTEGER,		"ReadAheadThreads",			(ConfigValue) 2},
+	{TYPE_INTEGER,		"IoQueueDepth",				(ConfigValue) 32},
+	{TYPE_INTEGER,		"DbCachePartitions",		(ConfigValue) 8},
+	{TYPE_STRING,		"DbCacheReplacement",		(ConfigValue) "lru"},	// page replacement policy
+	{TYPE_INTEGER,		"MaxParallelWorkers",		(ConfigValue) 0},
+	{TYPE_INTEGER,		"ParallelWorkers",			(ConfigValue) 1},
+	{TYPE_INTEGER,		"LockHashPartitions",		(ConfigValue) 8},
+	{TYPE_INTEGER,		"LargeBlobPages",			(ConfigValue) 0},		// pages
+	{TYPE_INTEGER,		"BlobCompressionThreshold",	(ConfigValue) 0},		// bytes
+	{TYPE_BOOLEAN,		"ClientAdaptiveFetch",		(ConfigValue) false}
 };
 
 /******************************************************************************
@@ -951,3 +965,103 @@ const char* Config::getDataTypeCompatibility() const
 {
 	return get<const char*>(KEY_DATA_TYPE_COMPATIBILITY);
 }
+
+ULONG Config::getReadAheadPages() const
+{
+	const SINT64 rc = get<SINT64>(KEY_READ_AHEAD_PAGES);
+	if (rc <= 0)
+		return 0;
+
+	return MIN(rc, 1024);
+}
+
+int Config::getReadAheadThreads() const
+{
+	const int rc = get<int>(KEY_READ_AHEAD_THREADS);
+	if (rc < 0)
+		return 0;
+
+	return MIN(rc, 16);
+}
+
+int Config::getIoQueueDepth() const
+{
+	const int rc = get<int>(KEY_IO_QUEUE_DEPTH);
+	if (rc < 0)
+		return 0;
+
+	return MIN(rc, 1024);
+}
+
+const char* Config::getDbCacheReplacement() const
+{
+	const char* rc = get<const char*>(KEY_DB_CACHE_REPLACEMENT);
+
+	if (rc && fb_utils::stricmp(rc, CacheReplacementLRU) != 0 &&
+		fb_utils::stricmp(rc, CacheReplacement2Q) != 0)
+	{
+		// user-provided value is invalid - fail to default
+		rc = NULL;
+	}
+
+	return rc ? rc : CacheReplacementLRU;
+}
+
+ULONG Config::getDbCachePartitions() const
+{
+	const SINT64 rc = get<SINT64>(KEY_DB_CACHE_PARTITIONS);
+	if (rc <= 1)
+		return 1;
+
+	return MIN(rc, 64);
+}
+
+unsigned Config::getMaxParallelWorkers()
+{
+	const SINT64 rc = (SINT64) getDefaultConfig()->values[KEY_MAX_PARALLEL_WORKERS];
+	if (rc <= 0)
+		return 0;
+
+	return MIN(rc, 64);
+}
+
+unsigned Config::getParallelWorkers() const
+{
+	const SINT64 rc = get<SINT64>(KEY_PARALLEL_WORKERS);
+	if (rc <= 1)
+		return 1;
+
+	return MIN(rc, 64);
+}
+
+ULONG Config::getLockHashPartitions() const
+{
+	const SINT64 rc = get<SINT64>(KEY_LOCK_HASH_PARTITIONS);
+	if (rc <= 1)
+		return 1;
+
+	return MIN(rc, 64);
+}
+
+ULONG Config::getLargeBlobPages() const
+{
+	const SINT64 rc = get<SINT64>(KEY_LARGE_BLOB_PAGES);
+	if (rc <= 0)
+		return 0;
+
+	return MIN(rc, MAX_ULONG);
+}
+
+ULONG Config::getBlobCompressionThreshold() const
+{
+	const SINT64 rc = get<SINT64>(KEY_BLOB_COMPRESSION_THRESHOLD);
+	if (rc <= 0)
+		return 0;
+
+	return MIN(rc, MAX_ULONG);
+}
+
+bool Config::getClientAdaptiveFetch() const
+{
+	return get<bool>(KEY_CLIENT_ADAPTIVE_FETCH);
+}
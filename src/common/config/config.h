@@ -69,6 +69,9 @@ extern const char*	GCPolicyCooperative;
 extern const char*	GCPolicyBackground;
 extern const char*	GCPolicyCombined;
 
+extern const char*	CacheReplacementLRU;
+extern const char*	CacheReplacement2Q;
+
 const int WIRE_CRYPT_DISABLED = 0;
 const int WIRE_CRYPT_ENABLED = 1;
 const int WIRE_CRYPT_REQUIRED = 2;
@@ -156,6 +159,17 @@ public:
 		KEY_READ_CONSISTENCY,
 		KEY_CLEAR_GTT_RETAINING,
 		KEY_DATA_TYPE_COMPATIBILITY,
+		KEY_READ_AHEAD_PAGES,
+		KEY_READ_AHEAD_THREADS,
+		KEY_IO_QUEUE_DEPTH,
+		KEY_DB_CACHE_PARTITIONS,
+		KEY_DB_CACHE_REPLACEMENT,
+		KEY_MAX_PARALLEL_WORKERS,
+		KEY_PARALLEL_WORKERS,
+		KEY_LOCK_HASH_PARTITIONS,
+		KEY_LARGE_BLOB_PAGES,
+		KEY_BLOB_COMPRESSION_THRESHOLD,
+		KEY_CLIENT_ADAPTIVE_FETCH,
 		MAX_CONFIG_KEY		// keep it last
 	};
 
@@ -393,6 +407,39 @@ public:
 	bool getClearGTTAtRetaining() const;
 
 	const char* getDataTypeCompatibility() const;
+
+	// Number of data pages read ahead by a sequential scan, zero disables read-ahead
+	ULONG getReadAheadPages() const;
+
+	// Number of cache reader threads per database in SuperServer
+	int getReadAheadThreads() const;
+
+	// Number of page I/O requests submitted at once by batched page I/O, zero disables it
+	int getIoQueueDepth() const;
+
+	// Number of partitions of shared page cache
+	ULONG getDbCachePartitions() const;
+
+	// Page replacement policy of page cache
+	const char* getDbCacheReplacement() const;
+
+	// Number of threads in process-wide pool of parallel workers, zero disables the pool
+	static unsigned getMaxParallelWorkers();
+
+	// Number of parts single operation (sort, for example) is split into
+	unsigned getParallelWorkers() const;
+
+	// Number of partitions of the lock table, 1 makes all operations use the lock table mutex
+	ULONG getLockHashPartitions() const;
+
+	// Number of data pages of blob which is read bypassing page cache, zero means cache size
+	ULONG getLargeBlobPages() const;
+
+	// Minimal length of blob which is stored compressed, zero disables compression
+	ULONG getBlobCompressionThreshold() const;
+
+	// Client adapts number of rows fetched at once and fetches in advance to round trip time
+	bool getClientAdaptiveFetch() const;
 };
 
 // Implementation of interface to access master configuration file
@@ -129,6 +129,7 @@ static const TOK tokens[] =
 	{TOK_COMMITTED, "COMMITTED", true},
 	{TOK_COMMON, "COMMON", true},
 	{TOK_COMPARE_DECFLOAT, "COMPARE_DECFLOAT", true},
+	{TOK_COMPRESSION, "COMPRESSION", true},
 	{TOK_COMPUTED, "COMPUTED", true},
 	{TOK_CONDITIONAL, "CONDITIONAL", true},
 	{TOK_CONNECT, "CONNECT", false},
@@ -179,6 +180,7 @@ static const TOK tokens[] =
 	{TOK_DEFINER, "DEFINER", true},
 	{TOK_DELETE, "DELETE", false},
 	{TOK_DELETING, "DELETING", false},
+	{TOK_DELIMITED, "DELIMITED", true},
 	{TOK_DENSE_RANK, "DENSE_RANK", true},
 	{TOK_DESC, "DESC", true},	// Alias of DESCENDING
 	{TOK_DESC, "DESCENDING", true},
@@ -222,6 +224,7 @@ static const TOK tokens[] =
 	{TOK_FOLLOWING, "FOLLOWING", true},
 	{TOK_FOR, "FOR", false},
 	{TOK_FOREIGN, "FOREIGN", false},
+	{TOK_FORMAT, "FORMAT", true},
 	{TOK_FREE_IT, "FREE_IT", true},
 	{TOK_FROM, "FROM", false},
 	{TOK_FULL, "FULL", false},
@@ -81,6 +81,9 @@ namespace os_utils
 
 	bool isIPv6supported();
 
+	// number of processors available, at least one
+	unsigned getProcessorCount();
+
 	// force descriptor to have O_CLOEXEC set
 	int open(const char* pathname, int flags, mode_t mode = DEFAULT_OPEN_MODE);
 	void setCloseOnExec(int fd);	// posix only
@@ -335,6 +335,17 @@ bool isIPv6supported()
 #endif
 }
 
+// number of online processors, one if unknown
+unsigned getProcessorCount()
+{
+#ifdef _SC_NPROCESSORS_ONLN
+	const long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return count > 0 ? (unsigned) count : 1;
+#else
+	return 1;
+#endif
+}
+
 // setting flag is not absolutely required, therefore ignore errors here
 void setCloseOnExec(int fd)
 {
@@ -305,6 +305,13 @@ bool isIPv6supported()
 	return false;
 }
 
+unsigned getProcessorCount()
+{
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwNumberOfProcessors;
+}
+
 int open(const char* pathname, int flags, mode_t mode)
 {
 	return ::_open(pathname, flags, mode);
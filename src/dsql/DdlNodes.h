@@ -1311,7 +1311,9 @@ public:
 			TYPE_DROP_COLUMN,
 			TYPE_DROP_CONSTRAINT,
 			TYPE_ALTER_SQL_SECURITY,
-			TYPE_ALTER_PUBLICATION
+			TYPE_ALTER_PUBLICATION,
+			TYPE_ALTER_COMPRESSION,
+			TYPE_ALTER_FORMAT
 		};
 
 		explicit Clause(MemoryPool& p, Type aType)
@@ -1553,6 +1555,8 @@ public:
 	Firebird::Array<NestConst<Clause> > clauses;
 	Nullable<bool> ssDefiner;
 	Nullable<bool> replicationState;
+	Nullable<bool> extendedCompression;
+	Nullable<bool> extDelimited;
 };
 
 
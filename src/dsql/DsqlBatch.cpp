@@ -28,6 +28,8 @@
 #include "../jrd/jrd.h"
 #include "../jrd/status.h"
 #include "../jrd/exe_proto.h"
+#include "../jrd/BulkInsert.h"
+#include "../jrd/Savepoint.h"
 #include "../dsql/dsql.h"
 #include "../dsql/errd_proto.h"
 #include "../common/classes/ClumpletReader.h"
@@ -660,97 +662,140 @@ private:
 	const dsql_msg* message = m_request->getStatement()->getSendMsg();
 	bool startRequest = true;
 
+	// Big batch of inserts stores records in bulk. Keys of the records stored by a message
+	// are accepted before the next message is sent, or rejected if sending failed.
+	// If the batch fails with an error not related to a single message (bad blob id,
+	// short message), keys of the records stored so far are inserted before the error
+	// is raised, so these records stay as they do when records are not stored in bulk.
+	// Should anything go wrong with the bulk insertion itself, savepoint undoes all
+	// the records it stored.
+
+	const bool bulkMode = m_request->getStatement()->getType() == DsqlCompiledStatement::TYPE_INSERT &&
+		m_messages.getSize() / m_alignedMessage >= BULK_LIMIT;
+
+	BulkInsert bulk(*tdbb->getDefaultPool(), transaction);
+	AutoSetRestore<BulkInsert*> bulkInsert(&req->req_bulk_insert, bulkMode ? &bulk : NULL);
+	AutoPtr<AutoSavePoint> bulkSavepoint(bulkMode ? FB_NEW_POOL(*tdbb->getDefaultPool())
+		AutoSavePoint(tdbb, transaction) : NULL);
+
 	// process messages
 	ULONG remains;
 	UCHAR* data;
-	while ((remains = m_messages.get(&data)) > 0)
+	try
 	{
-		if (remains < m_messageSize)
-		{
-			ERRD_post(Arg::Gds(isc_sqlerr) << Arg::Num(-104) <<
-				Arg::Gds(isc_batch_blob_buf) <<
-				Arg::Gds(isc_batch_small_data) << "messages");
-		}
-
-		while (remains >= m_messageSize)
+		while ((remains = m_messages.get(&data)) > 0)
 		{
-			if (startRequest)
-			{
-				EXE_unwind(tdbb, req);
-				EXE_start(tdbb, req, transaction);
-				startRequest = false;
-			}
-
-			// skip alignment data
-			UCHAR* alignedData = FB_ALIGN(data, m_alignment);
-			if (alignedData != data)
+			if (remains < m_messageSize)
 			{
-				remains -= (alignedData - data);
-				data = alignedData;
-				continue;
+				ERRD_post(Arg::Gds(isc_sqlerr) << Arg::Num(-104) <<
+					Arg::Gds(isc_batch_blob_buf) <<
+					Arg::Gds(isc_batch_small_data) << "messages");
 			}
 
-			// translate blob IDs
-			fb_assert(intptr_t(data) % m_alignment == 0);
-			for (unsigned i = 0; i < m_blobMeta.getCount(); ++i)
+			while (remains >= m_messageSize)
 			{
-				const SSHORT* nullFlag = reinterpret_cast<const SSHORT*>(&data[m_blobMeta[i].nullOffset]);
-				if (*nullFlag)
-					continue;
+				if (startRequest)
+				{
+					EXE_unwind(tdbb, req);
+					EXE_start(tdbb, req, transaction);
+					startRequest = false;
+				}
 
-				ISC_QUAD* id = reinterpret_cast<ISC_QUAD*>(&data[m_blobMeta[i].offset]);
-				if (id->gds_quad_high == 0 && id->gds_quad_low == 0)
+				// skip alignment data
+				UCHAR* alignedData = FB_ALIGN(data, m_alignment);
+				if (alignedData != data)
+				{
+					remains -= (alignedData - data);
+					data = alignedData;
 					continue;
+				}
 
-				ISC_QUAD newId;
-				if (!m_blobMap.get(*id, newId))
+				// translate blob IDs
+				fb_assert(intptr_t(data) % m_alignment == 0);
+				for (unsigned i = 0; i < m_blobMeta.getCount(); ++i)
 				{
-					ERRD_post(Arg::Gds(isc_sqlerr) << Arg::Num(-104) <<
-						Arg::Gds(isc_batch_blob_id) << Arg::Quad(id));
-				}
+					const SSHORT* nullFlag = reinterpret_cast<const SSHORT*>(&data[m_blobMeta[i].nullOffset]);
+					if (*nullFlag)
+						continue;
 
-				m_blobMap.remove(*id);
-				*id = newId;
-			}
+					ISC_QUAD* id = reinterpret_cast<ISC_QUAD*>(&data[m_blobMeta[i].offset]);
+					if (id->gds_quad_high == 0 && id->gds_quad_low == 0)
+						continue;
 
-			// map message to internal engine format
-			m_request->mapInOut(tdbb, false, message, m_meta, NULL, data);
-			data += m_messageSize;
-			remains -= m_messageSize;
+					ISC_QUAD newId;
+					if (!m_blobMap.get(*id, newId))
+					{
+						ERRD_post(Arg::Gds(isc_sqlerr) << Arg::Num(-104) <<
+							Arg::Gds(isc_batch_blob_id) << Arg::Quad(id));
+					}
 
-			UCHAR* msgBuffer = m_request->req_msg_buffers[message->msg_buffer_number];
-			try
-			{
-				// runsend data to request and collect stats
-				ULONG before = req->req_records_inserted + req->req_records_updated +
-					req->req_records_deleted;
-				EXE_send(tdbb, req, message->msg_number, message->msg_length, msgBuffer);
-				ULONG after = req->req_records_inserted + req->req_records_updated +
-					req->req_records_deleted;
-				completionState->regUpdate(after - before);
-			}
-			catch (const Exception& ex)
-			{
-				FbLocalStatus status;
-				ex.stuffException(&status);
-				tdbb->tdbb_status_vector->init();
+					m_blobMap.remove(*id);
+					*id = newId;
+				}
 
-				JTransliterate trLit(tdbb);
-				completionState->regError(&status, &trLit);
+				// map message to internal engine format
+				m_request->mapInOut(tdbb, false, message, m_meta, NULL, data);
+				data += m_messageSize;
+				remains -= m_messageSize;
 
-				if (!(m_flags & (1 << IBatch::TAG_MULTIERROR)))
+				if (bulkMode)
+					bulk.accept(tdbb);
+
+				UCHAR* msgBuffer = m_request->req_msg_buffers[message->msg_buffer_number];
+				try
 				{
-					cancel(tdbb);
-					remains = 0;
-					break;
+					// runsend data to request and collect stats
+					ULONG before = req->req_records_inserted + req->req_records_updated +
+						req->req_records_deleted;
+					EXE_send(tdbb, req, message->msg_number, message->msg_length, msgBuffer);
+					ULONG after = req->req_records_inserted + req->req_records_updated +
+						req->req_records_deleted;
+					completionState->regUpdate(after - before);
 				}
+				catch (const Exception& ex)
+				{
+					if (bulkMode)
+						bulk.reject();
+
+					FbLocalStatus status;
+					ex.stuffException(&status);
+					tdbb->tdbb_status_vector->init();
+
+					JTransliterate trLit(tdbb);
+					completionState->regError(&status, &trLit);
+
+					if (!(m_flags & (1 << IBatch::TAG_MULTIERROR)))
+					{
+						cancel(tdbb);
+						remains = 0;
+						break;
+					}
 
-				startRequest = true;
+					startRequest = true;
+				}
 			}
+
+			UCHAR* alignedData = FB_ALIGN(data, m_alignment);
+			m_messages.remained(remains, alignedData - data);
+		}
+	}
+	catch (const Exception&)
+	{
+		if (bulkMode)
+		{
+			bulk.accept(tdbb);
+			bulk.flush(tdbb);
+			bulkSavepoint->release();
 		}
 
-		UCHAR* alignedData = FB_ALIGN(data, m_alignment);
-		m_messages.remained(remains, alignedData - data);
+		throw;
+	}
+
+	if (bulkMode)
+	{
+		bulk.accept(tdbb);
+		bulk.flush(tdbb);
+		bulkSavepoint->release();
 	}
 
 	DEB_BATCH(fprintf(stderr, "Sent %d messages\n", completionState->getSize(tdbb->tdbb_status_vector)));
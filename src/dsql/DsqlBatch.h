@@ -58,6 +58,7 @@ public:
 	static const ULONG BUFFER_LIMIT = 16 * 1024 * 1024;
 	static const ULONG HARD_BUFFER_LIMIT = 256 * 1024 * 1024;
 	static const ULONG DETAILED_LIMIT = 64;
+	static const ULONG BULK_LIMIT = 1000;		// messages to insert in bulk
 	static const ULONG SIZEOF_BLOB_HEAD = sizeof(ISC_QUAD) + 2 * sizeof(ULONG);
 	static const unsigned BLOB_STREAM_ALIGN = 4;
 
@@ -36,6 +36,7 @@
 #include "../jrd/Optimizer.h"
 #include "../jrd/RecordSourceNodes.h"
 #include "../jrd/VirtualTable.h"
+#include "../jrd/BulkInsert.h"
 #include "../jrd/extds/ExtDS.h"
 #include "../jrd/recsrc/RecordSource.h"
 #include "../jrd/recsrc/Cursor.h"
@@ -7484,8 +7485,26 @@ const StmtNode* StoreNode::store(thread_db* tdbb, jrd_req* request, WhichTrigger
 					VirtualTable::store(tdbb, rpb);
 				else if (!relation->rel_view_rse)
 				{
-					VIO_store(tdbb, rpb, transaction);
-					IDX_store(tdbb, rpb, transaction);
+					// Batch inserts into a table in bulk unless something else could
+					// read it meanwhile: triggers, subqueries or the source of INSERT
+					// ... SELECT (they make more than one stream)
+
+					BulkInsert* bulk = request->req_bulk_insert;
+
+					if (bulk && (request->req_rpb.getCount() != 1 ||
+						relation->rel_pre_store || relation->rel_post_store || !bulk->attach(relation)))
+					{
+						bulk = NULL;
+					}
+
+					{	// scope
+						AutoSetRestore<USHORT> streamFlags(&rpb->rpb_stream_flags,
+							bulk ? (rpb->rpb_stream_flags | RPB_s_bulk) : rpb->rpb_stream_flags);
+
+						VIO_store(tdbb, rpb, transaction);
+					}
+
+					IDX_store(tdbb, rpb, transaction, bulk);
 					REPL_store(tdbb, rpb, transaction);
 				}
 
@@ -597,6 +597,7 @@ using namespace Firebird;
 %token <metaNamePtr> BINARY
 %token <metaNamePtr> BIND
 %token <metaNamePtr> COMPARE_DECFLOAT
+%token <metaNamePtr> COMPRESSION
 %token <metaNamePtr> CONSISTENCY
 %token <metaNamePtr> COUNTER
 %token <metaNamePtr> CTR_BIG_ENDIAN
@@ -605,6 +606,7 @@ using namespace Firebird;
 %token <metaNamePtr> CUME_DIST
 %token <metaNamePtr> DECFLOAT
 %token <metaNamePtr> DEFINER
+%token <metaNamePtr> DELIMITED
 %token <metaNamePtr> DISABLE
 %token <metaNamePtr> ENABLE
 %token <metaNamePtr> EXCESS
@@ -612,6 +614,7 @@ using namespace Firebird;
 %token <metaNamePtr> EXTENDED
 %token <metaNamePtr> FIRST_DAY
 %token <metaNamePtr> FOLLOWING
+%token <metaNamePtr> FORMAT
 %token <metaNamePtr> HEX_DECODE
 %token <metaNamePtr> HEX_ENCODE
 %token <metaNamePtr> IDLE
@@ -2196,6 +2199,10 @@ table_attribute($relationNode)
 		{ setClause($relationNode->ssDefiner, "SQL SECURITY", $1); }
 	| publication_state
 		{ setClause($relationNode->replicationState, "PUBLICATION", $1); }
+	| compression_mode
+		{ setClause($relationNode->extendedCompression, "COMPRESSION", $1); }
+	| external_format
+		{ setClause($relationNode->extDelimited, "FORMAT", $1); }
 	;
 
 %type <boolVal> sql_security_clause
@@ -2216,6 +2223,18 @@ publication_state
 	| DISABLE PUBLICATION		{ $$ = false; }
 	;
 
+%type <boolVal> compression_mode
+compression_mode
+	: COMPRESSION EXTENDED		{ $$ = true; }
+	| COMPRESSION DEFAULT		{ $$ = false; }
+	;
+
+%type <boolVal> external_format
+external_format
+	: FORMAT DELIMITED			{ $$ = true; }
+	| FORMAT DEFAULT			{ $$ = false; }
+	;
+
 %type <createRelationNode> gtt_table_clause
 gtt_table_clause
 	: simple_table_name
@@ -4177,6 +4196,20 @@ alter_op($relationNode)
 				newNode<RelationNode::Clause>(RelationNode::Clause::TYPE_ALTER_PUBLICATION);
 			$relationNode->clauses.add(clause);
 		}
+	| SET compression_mode
+		{
+			setClause($relationNode->extendedCompression, "COMPRESSION", $2);
+			RelationNode::Clause* clause =
+				newNode<RelationNode::Clause>(RelationNode::Clause::TYPE_ALTER_COMPRESSION);
+			$relationNode->clauses.add(clause);
+		}
+	| SET external_format
+		{
+			setClause($relationNode->extDelimited, "FORMAT", $2);
+			RelationNode::Clause* clause =
+				newNode<RelationNode::Clause>(RelationNode::Clause::TYPE_ALTER_FORMAT);
+			$relationNode->clauses.add(clause);
+		}
 	;
 
 %type <metaNamePtr> alter_column_name
@@ -8937,6 +8970,7 @@ non_reserved_word
 	| CLEAR
 	| COUNTER
 	| COMPARE_DECFLOAT
+	| COMPRESSION
 	| CONNECTIONS
 	| CONSISTENCY
 	| CRC32
@@ -8945,6 +8979,7 @@ non_reserved_word
 	| CTR_LITTLE_ENDIAN
 	| CUME_DIST
 	| DEFINER
+	| DELIMITED
 	| DISABLE
 	| ENABLE
 	| EXCESS
@@ -8952,6 +8987,7 @@ non_reserved_word
 	| EXTENDED
 	| FIRST_DAY
 	| FOLLOWING
+	| FORMAT
 	| HEX_DECODE
 	| HEX_ENCODE
 	| IDLE
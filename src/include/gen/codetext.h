@@ -970,6 +970,8 @@ static const struct {
 	{"truncate_warn", 335545266},
 	{"truncate_monitor", 335545267},
 	{"truncate_context", 335545268},
+	{"ext_line_too_long", 335545269},
+	{"ext_format_not_ext", 335545270},
 	{"gfix_db_name", 335740929},
 	{"gfix_invalid_sw", 335740930},
 	{"gfix_incmp_sw", 335740932},
@@ -1449,6 +1451,9 @@ static const struct {
 	{"nbackup_user_stop", 337117257},
 	{"nbackup_deco_parse", 337117259},
 	{"nbackup_lostrec_guid_db", 337117261},
+	{"nbackup_zip_not_loaded", 337117266},
+	{"nbackup_zip_not_supported", 337117267},
+	{"nbackup_zip_call_err", 337117268},
 	{"trace_conflict_acts", 337182750},
 	{"trace_act_notfound", 337182751},
 	{"trace_switch_once", 337182752},
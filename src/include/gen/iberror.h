@@ -1004,6 +1004,8 @@ const ISC_STATUS isc_suspend_without_returns          = 335545265L;
 const ISC_STATUS isc_truncate_warn                    = 335545266L;
 const ISC_STATUS isc_truncate_monitor                 = 335545267L;
 const ISC_STATUS isc_truncate_context                 = 335545268L;
+const ISC_STATUS isc_ext_line_too_long                = 335545269L;
+const ISC_STATUS isc_ext_format_not_ext               = 335545270L;
 const ISC_STATUS isc_gfix_db_name                     = 335740929L;
 const ISC_STATUS isc_gfix_invalid_sw                  = 335740930L;
 const ISC_STATUS isc_gfix_incmp_sw                    = 335740932L;
@@ -1483,6 +1485,9 @@ const ISC_STATUS isc_nbackup_switchd_parameter        = 337117255L;
 const ISC_STATUS isc_nbackup_user_stop                = 337117257L;
 const ISC_STATUS isc_nbackup_deco_parse               = 337117259L;
 const ISC_STATUS isc_nbackup_lostrec_guid_db          = 337117261L;
+const ISC_STATUS isc_nbackup_zip_not_loaded           = 337117266L;
+const ISC_STATUS isc_nbackup_zip_not_supported        = 337117267L;
+const ISC_STATUS isc_nbackup_zip_call_err             = 337117268L;
 const ISC_STATUS isc_trace_conflict_acts              = 337182750L;
 const ISC_STATUS isc_trace_act_notfound               = 337182751L;
 const ISC_STATUS isc_trace_switch_once                = 337182752L;
@@ -1494,7 +1499,7 @@ const ISC_STATUS isc_trace_switch_user_only           = 337182757L;
 const ISC_STATUS isc_trace_switch_param_miss          = 337182758L;
 const ISC_STATUS isc_trace_param_act_notcompat        = 337182759L;
 const ISC_STATUS isc_trace_mandatory_switch_miss      = 337182760L;
-const ISC_STATUS isc_err_max                          = 1438;
+const ISC_STATUS isc_err_max                          = 1443;
 
 #else /* c definitions */
 
@@ -2468,6 +2473,8 @@ const ISC_STATUS isc_err_max                          = 1438;
 #define isc_truncate_warn                    335545266L
 #define isc_truncate_monitor                 335545267L
 #define isc_truncate_context                 335545268L
+#define isc_ext_line_too_long                335545269L
+#define isc_ext_format_not_ext               335545270L
 #define isc_gfix_db_name                     335740929L
 #define isc_gfix_invalid_sw                  335740930L
 #define isc_gfix_incmp_sw                    335740932L
@@ -2947,6 +2954,9 @@ const ISC_STATUS isc_err_max                          = 1438;
 #define isc_nbackup_user_stop                337117257L
 #define isc_nbackup_deco_parse               337117259L
 #define isc_nbackup_lostrec_guid_db          337117261L
+#define isc_nbackup_zip_not_loaded           337117266L
+#define isc_nbackup_zip_not_supported        337117267L
+#define isc_nbackup_zip_call_err             337117268L
 #define isc_trace_conflict_acts              337182750L
 #define isc_trace_act_notfound               337182751L
 #define isc_trace_switch_once                337182752L
@@ -2958,7 +2968,7 @@ const ISC_STATUS isc_err_max                          = 1438;
 #define isc_trace_switch_param_miss          337182758L
 #define isc_trace_param_act_notcompat        337182759L
 #define isc_trace_mandatory_switch_miss      337182760L
-#define isc_err_max                          1438
+#define isc_err_max                          1443
 
 #endif
 
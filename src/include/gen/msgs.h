@@ -973,6 +973,8 @@ Data source : @4"},		/* eds_statement */
 	{335545266, "String truncated warning due to the following reason"},		/* truncate_warn */
 	{335545267, "Monitoring data does not fit into the field"},		/* truncate_monitor */
 	{335545268, "Engine data does not fit into return value of system function"},		/* truncate_context */
+	{335545269, "Line of external file @1 is longer than @2 bytes"},		/* ext_line_too_long */
+	{335545270, "FORMAT clause is allowed for EXTERNAL FILE tables only, table @1"},		/* ext_format_not_ext */
 	{335740929, "data base file name (@1) already given"},		/* gfix_db_name */
 	{335740930, "invalid switch @1"},		/* gfix_invalid_sw */
 	{335740932, "incompatible switch combination"},		/* gfix_incmp_sw */
@@ -1452,6 +1454,9 @@ Data source : @4"},		/* eds_statement */
 	{337117257, "Terminated due to user request"},		/* nbackup_user_stop */
 	{337117259, "Too complex decompress command (> @1 arguments)"},		/* nbackup_deco_parse */
 	{337117261, "Cannot find record for database \"@1\" backup GUID @2 in the backup history"},		/* nbackup_lostrec_guid_db */
+	{337117266, "Compression support library not loaded"},		/* nbackup_zip_not_loaded */
+	{337117267, "Compression is not supported by this build"},		/* nbackup_zip_not_supported */
+	{337117268, "Compression library call @1() failed with error @2"},		/* nbackup_zip_call_err */
 	{337182750, "conflicting actions \"@1\" and \"@2\" found"},		/* trace_conflict_acts */
 	{337182751, "action switch not found"},		/* trace_act_notfound */
 	{337182752, "switch \"@1\" must be set only once"},		/* trace_switch_once */
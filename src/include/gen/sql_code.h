@@ -969,6 +969,8 @@ static const struct {
 	{335545266,  304}, /* 946 truncate_warn */
 	{335545267,  304}, /* 947 truncate_monitor */
 	{335545268,  304}, /* 948 truncate_context */
+	{335545269, -902}, /* 949 ext_line_too_long */
+	{335545270, -607}, /* 950 ext_format_not_ext */
 	{335740929, -901}, /*   1 gfix_db_name */
 	{335740930, -901}, /*   2 gfix_invalid_sw */
 	{335740932, -901}, /*   4 gfix_incmp_sw */
@@ -1448,6 +1450,9 @@ static const struct {
 	{337117257, -901}, /*  73 nbackup_user_stop */
 	{337117259, -901}, /*  75 nbackup_deco_parse */
 	{337117261, -901}, /*  77 nbackup_lostrec_guid_db */
+	{337117266, -901}, /*  82 nbackup_zip_not_loaded */
+	{337117267, -901}, /*  83 nbackup_zip_not_supported */
+	{337117268, -901}, /*  84 nbackup_zip_call_err */
 	{337182750, -901}, /*  30 trace_conflict_acts */
 	{337182751, -901}, /*  31 trace_act_notfound */
 	{337182752, -901}, /*  32 trace_switch_once */
@@ -969,6 +969,8 @@ static const struct {
 	{335545266, "01004"}, // 946 truncate_warn
 	{335545267, "01004"}, // 947 truncate_monitor
 	{335545268, "01004"}, // 948 truncate_context
+	{335545269, "HY000"}, // 949 ext_line_too_long
+	{335545270, "42000"}, // 950 ext_format_not_ext
 	{335740929, "00000"}, //   1 gfix_db_name
 	{335740930, "00000"}, //   2 gfix_invalid_sw
 	{335740932, "00000"}, //   4 gfix_incmp_sw
@@ -1448,6 +1450,9 @@ static const struct {
 	{337117257, "08006"}, //  73 nbackup_user_stop
 	{337117259, "54023"}, //  75 nbackup_deco_parse
 	{337117261, "00000"}, //  77 nbackup_lostrec_guid_db
+	{337117266, "00000"}, //  82 nbackup_zip_not_loaded
+	{337117267, "0A000"}, //  83 nbackup_zip_not_supported
+	{337117268, "00000"}, //  84 nbackup_zip_call_err
 	{337182750, "00000"}, //  30 trace_conflict_acts
 	{337182751, "00000"}, //  31 trace_act_notfound
 	{337182752, "00000"}, //  32 trace_switch_once
@@ -93,6 +93,7 @@ namespace Jrd
 	class JrdStatement;
 	class Validation;
 	class Applier;
+	class PrefetchMisses;
 
 
 struct DSqlCacheItem
@@ -191,6 +192,34 @@ private:
 };
 
 
+// Direct-mapped cache of recently seen transactions known to be committed
+// (with their commit numbers) or dead. Such states never change, so TipCache
+// looks here before going to shared memory. Attachment is used by a single
+// thread at a time, so no synchronization is needed.
+
+class TransactionStates
+{
+public:
+	TransactionStates()
+	{
+		memset(m_entries, 0, sizeof(m_entries));
+	}
+
+private:
+	static const ULONG CACHE_SIZE = 256;	// must be power of 2
+
+	struct Entry
+	{
+		TraNumber number;
+		CommitNumber state;		// CN_ACTIVE means unused entry
+	};
+
+	Entry m_entries[CACHE_SIZE];
+
+	friend class TipCache;
+};
+
+
 //
 // RefCounted part of Attachment object, placed into permanent pool
 //
@@ -412,6 +441,7 @@ public:
 	jrd_tra*	att_dbkey_trans;			// transaction to control db-key scope
 	TraNumber	att_oldest_snapshot;		// GTT's record versions older than this can be garbage-collected
 	ActiveSnapshots att_active_snapshots;	// List of currently active snapshots for GC purposes
+	TransactionStates att_tra_states;		// Final states of recently seen transactions
 
 private:
 	jrd_tra*	att_sys_transaction;		// system transaction
@@ -431,6 +461,7 @@ public:
 	SecurityClassList*	att_security_classes;	// security classes
 	RuntimeStatistics	att_stats;
 	RuntimeStatistics	att_base_stats;
+	Firebird::RefPtr<PrefetchMisses>	att_prefetch_misses;	// read-ahead misses not yet in att_stats
 	ULONG		att_flags;					// Flags describing the state of the attachment
 	SSHORT		att_client_charset;			// user's charset specified in dpb
 	SSHORT		att_charset;				// current (client or external) attachment charset
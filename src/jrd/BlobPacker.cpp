@@ -0,0 +1,417 @@
+/*
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird Project.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#include "firebird.h"
+#include "../jrd/BlobPacker.h"
+#include "../jrd/jrd.h"
+#include "../jrd/blb.h"
+#include "../common/classes/init.h"
+#include "../jrd/err_proto.h"
+
+using namespace Firebird;
+using namespace Jrd;
+using namespace BlobPack;
+
+namespace
+{
+#ifdef HAVE_ZLIB_H
+	InitInstance<ZLib> zlib;
+#endif
+
+	void damaged()
+	{
+		ERR_post(Arg::Gds(isc_random) << Arg::Str("Compressed blob is damaged"));
+	}
+}
+
+
+bool BlobPack::isAvailable()
+{
+#ifdef HAVE_ZLIB_H
+	return zlib();
+#else
+	return false;
+#endif
+}
+
+
+BlobPacker::BlobPacker(MemoryPool& pool, blb* output)
+	: m_output(output),
+	  m_segmented(output->isSegmented()),
+	  m_abandoned(false),
+	  m_image(pool),
+	  m_packed(pool),
+	  m_ends(pool),
+	  m_stored(0),
+	  m_length(0),
+	  m_count(0),
+	  m_maxSegment(0)
+{
+#ifdef HAVE_ZLIB_H
+	m_deflating = false;
+
+	memset(&m_stream, 0, sizeof(m_stream));
+	m_stream.zalloc = ZLib::allocFunc;
+	m_stream.zfree = ZLib::freeFunc;
+
+	// Storing of blobs should stay cheap, so prefer speed
+
+	if (zlib().deflateInit(&m_stream, Z_BEST_SPEED) != Z_OK)
+		BadAlloc::raise();
+
+	m_deflating = true;
+#else
+	fb_assert(false);
+#endif
+
+	// Compressed data is stored as a stream blob, segments are kept in the image
+
+	m_output->blb_flags |= BLB_stream;
+}
+
+
+BlobPacker::~BlobPacker()
+{
+#ifdef HAVE_ZLIB_H
+	if (m_deflating)
+		zlib().deflateEnd(&m_stream);
+#endif
+}
+
+
+bool BlobPacker::put(thread_db* tdbb, const UCHAR* data, USHORT length)
+{
+	if (m_abandoned)
+	{
+		m_output->BLB_put_segment(tdbb, data, length);
+		return false;
+	}
+
+	m_count++;
+	m_length += length;
+
+	if (length > m_maxSegment)
+		m_maxSegment = length;
+
+	if (m_segmented)
+		m_image.add(reinterpret_cast<const UCHAR*>(&length), sizeof(length));
+
+	m_image.add(data, length);
+
+	while (m_image.getCount() >= FRAME_SIZE)
+	{
+		if (!putFrame(tdbb, FRAME_SIZE))
+		{
+			abandon(tdbb);
+			return false;
+		}
+
+		m_image.removeCount(0, FRAME_SIZE);
+	}
+
+	return true;
+}
+
+
+bool BlobPacker::finish(thread_db* tdbb)
+{
+	if (m_abandoned)
+		return false;
+
+	if (m_image.hasData())
+	{
+		if (!putFrame(tdbb, m_image.getCount()))
+		{
+			abandon(tdbb);
+			return false;
+		}
+
+		m_image.clear();
+	}
+
+	// Write frames table and footer
+
+	const UCHAR* table = reinterpret_cast<const UCHAR*>(m_ends.begin());
+	ULONG tableLength = m_ends.getCount() * sizeof(ULONG);
+
+	while (tableLength)
+	{
+		const USHORT n = (USHORT) MIN(tableLength, FRAME_SIZE);
+		m_output->BLB_put_segment(tdbb, table, n);
+		table += n;
+		tableLength -= n;
+	}
+
+	Footer footer;
+	footer.length = m_length;
+	footer.count = m_count;
+	footer.frameSize = FRAME_SIZE;
+	footer.frames = m_ends.getCount();
+	footer.maxSegment = m_maxSegment;
+	footer.flags = m_segmented ? 0 : FLAG_STREAM;
+	footer.version = VERSION_1;
+
+	m_output->BLB_put_segment(tdbb, &footer, sizeof(footer));
+	m_output->blb_flags |= BLB_compressed;
+
+	const ULONG imageLength = m_segmented ? m_length + m_count * sizeof(USHORT) : m_length;
+
+	tdbb->bumpStats(RuntimeStatistics::BLOB_PACKED_BYTES, imageLength);
+	tdbb->bumpStats(RuntimeStatistics::BLOB_PACKED_SIZE, m_output->blb_length);
+
+	return true;
+}
+
+
+bool BlobPacker::putFrame(thread_db* tdbb, ULONG length)
+{
+	// Deflate frame at the start of image. If the first frame does not become
+	// shorter then the data is assumed to be not compressible at all.
+
+	const UCHAR* data = m_image.begin();
+	ULONG packed = 0;
+
+#ifdef HAVE_ZLIB_H
+	UCHAR* const buffer = m_packed.getBuffer(length);
+
+	zlib().deflateReset(&m_stream);
+	m_stream.next_in = const_cast<UCHAR*>(data);
+	m_stream.avail_in = length;
+	m_stream.next_out = buffer;
+	m_stream.avail_out = length - 1;
+
+	if (zlib().deflate(&m_stream, Z_FINISH) == Z_STREAM_END)
+	{
+		packed = m_stream.total_out;
+		data = buffer;
+	}
+#endif
+
+	if (!packed)
+	{
+		if (m_ends.isEmpty())
+			return false;
+
+		packed = length;
+	}
+
+	m_output->BLB_put_segment(tdbb, data, (USHORT) packed);
+
+	m_stored += packed;
+	m_ends.add(m_stored);
+
+	return true;
+}
+
+
+void BlobPacker::abandon(thread_db* tdbb)
+{
+	// Nothing is written into output blob yet and image consists of whole
+	// segments, store them as is
+
+	fb_assert(m_ends.isEmpty());
+
+	m_abandoned = true;
+
+	if (m_segmented)
+		m_output->blb_flags &= ~BLB_stream;
+
+	const UCHAR* p = m_image.begin();
+	const UCHAR* const end = m_image.end();
+
+	while (p < end)
+	{
+		USHORT length = (USHORT) MIN(end - p, FRAME_SIZE);
+
+		if (m_segmented)
+		{
+			memcpy(&length, p, sizeof(length));
+			p += sizeof(length);
+		}
+
+		m_output->BLB_put_segment(tdbb, p, length);
+		p += length;
+	}
+
+	m_image.free();
+}
+
+
+BlobUnpacker::BlobUnpacker(MemoryPool& pool, blb* stored)
+	: m_stored(stored),
+	  m_ends(pool),
+	  m_frame(pool),
+	  m_packed(pool),
+	  m_frameSize(0),
+	  m_frameNumber(MAX_ULONG),
+	  m_frameLength(0),
+	  m_imageLength(0),
+	  m_position(0)
+{
+#ifdef HAVE_ZLIB_H
+	m_inflating = false;
+#endif
+}
+
+
+BlobUnpacker::~BlobUnpacker()
+{
+#ifdef HAVE_ZLIB_H
+	if (m_inflating)
+		zlib().inflateEnd(&m_stream);
+#endif
+}
+
+
+void BlobUnpacker::open(thread_db* tdbb, Footer& footer)
+{
+#ifdef HAVE_ZLIB_H
+	if (!zlib())
+	{
+		(Arg::Gds(isc_random) << "Compression support library not loaded" <<
+		 Arg::StatusVector(zlib().status)).raise();
+	}
+
+	memset(&m_stream, 0, sizeof(m_stream));
+	m_stream.zalloc = ZLib::allocFunc;
+	m_stream.zfree = ZLib::freeFunc;
+
+	if (zlib().inflateInit(&m_stream) != Z_OK)
+		BadAlloc::raise();
+
+	m_inflating = true;
+#else
+	(Arg::Gds(isc_random) << "No inflate support").raise();
+#endif
+
+	const ULONG storedLength = m_stored->blb_length;
+
+	if (storedLength < sizeof(Footer))
+		damaged();
+
+	readStored(tdbb, storedLength - sizeof(Footer), reinterpret_cast<UCHAR*>(&footer), sizeof(Footer));
+
+	if (footer.version != VERSION_1 || !footer.frameSize || footer.frameSize > FRAME_SIZE)
+		damaged();
+
+	m_frameSize = footer.frameSize;
+	m_imageLength = footer.length;
+
+	if (!(footer.flags & FLAG_STREAM))
+		m_imageLength += footer.count * sizeof(USHORT);
+
+	// Read table of frame ends preceding the footer
+
+	const ULONG tableLength = footer.frames * sizeof(ULONG);
+
+	if (footer.frames != (m_imageLength + m_frameSize - 1) / m_frameSize ||
+		tableLength > storedLength - sizeof(Footer))
+	{
+		damaged();
+	}
+
+	const ULONG tableOffset = storedLength - sizeof(Footer) - tableLength;
+	ULONG* const table = m_ends.getBuffer(footer.frames);
+	readStored(tdbb, tableOffset, reinterpret_cast<UCHAR*>(table), tableLength);
+
+	if (footer.frames && m_ends.back() != tableOffset)
+		damaged();
+
+	m_frame.getBuffer(m_frameSize);
+	m_position = 0;
+}
+
+
+ULONG BlobUnpacker::read(thread_db* tdbb, void* buffer, ULONG length)
+{
+	UCHAR* p = static_cast<UCHAR*>(buffer);
+
+	while (length && m_position < m_imageLength)
+	{
+		const ULONG frame = m_position / m_frameSize;
+
+		if (frame != m_frameNumber)
+			loadFrame(tdbb, frame);
+
+		const ULONG offset = m_position - frame * m_frameSize;
+		const ULONG n = MIN(length, m_frameLength - offset);
+
+		memcpy(p, m_frame.begin() + offset, n);
+		p += n;
+		length -= n;
+		m_position += n;
+	}
+
+	return p - static_cast<UCHAR*>(buffer);
+}
+
+
+void BlobUnpacker::readStored(thread_db* tdbb, ULONG offset, UCHAR* buffer, ULONG length)
+{
+	m_stored->BLB_lseek(0, offset);
+
+	while (length)
+	{
+		const USHORT n = m_stored->BLB_get_segment(tdbb, buffer, (USHORT) MIN(length, FRAME_SIZE));
+
+		if (!n)
+			damaged();
+
+		buffer += n;
+		length -= n;
+	}
+}
+
+
+void BlobUnpacker::loadFrame(thread_db* tdbb, ULONG frame)
+{
+	const ULONG start = frame ? m_ends[frame - 1] : 0;
+	const ULONG end = m_ends[frame];
+
+	m_frameNumber = MAX_ULONG;
+	m_frameLength = MIN(m_frameSize, m_imageLength - frame * m_frameSize);
+
+	if (end < start || end - start > m_frameLength)
+		damaged();
+
+	const ULONG packed = end - start;
+
+	// Frame which did not become shorter is stored as is
+
+	if (packed == m_frameLength)
+	{
+		readStored(tdbb, start, m_frame.begin(), packed);
+		m_frameNumber = frame;
+		return;
+	}
+
+	readStored(tdbb, start, m_packed.getBuffer(packed), packed);
+
+#ifdef HAVE_ZLIB_H
+	zlib().inflateReset(&m_stream);
+	m_stream.next_in = m_packed.begin();
+	m_stream.avail_in = packed;
+	m_stream.next_out = m_frame.begin();
+	m_stream.avail_out = m_frameLength;
+
+	if (zlib().inflate(&m_stream, Z_FINISH) != Z_STREAM_END || m_stream.total_out != m_frameLength)
+		damaged();
+#endif
+
+	m_frameNumber = frame;
+}
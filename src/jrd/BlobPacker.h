@@ -0,0 +1,146 @@
+/*
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird Project.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#ifndef JRD_BLOB_PACKER_H
+#define JRD_BLOB_PACKER_H
+
+#include "../common/classes/alloc.h"
+#include "../common/classes/array.h"
+#include "../common/classes/zip.h"
+
+namespace Jrd {
+
+class blb;
+class thread_db;
+
+// Compressed blob is stored as a stream blob containing independently deflated
+// frames of FRAME_SIZE bytes of blob image, followed by the table of frame ends
+// and the footer. Blob image is the blob data as it's stored uncompressed, i.e.
+// every segment of segmented blob is prefixed by its length. A frame which does
+// not become shorter is stored as is. Independent frames let the compressed
+// stream blob be read from any position.
+
+namespace BlobPack
+{
+	const ULONG FRAME_SIZE = 32768;
+
+	const UCHAR VERSION_1 = 1;		// zlib deflate
+
+	const UCHAR FLAG_STREAM = 1;	// blob is a stream blob
+
+	struct Footer
+	{
+		ULONG length;			// Total length of data sans segments
+		ULONG count;			// Number of segments
+		ULONG frameSize;		// Image bytes per frame
+		ULONG frames;			// Number of frames
+		USHORT maxSegment;		// Longest segment
+		UCHAR flags;
+		UCHAR version;
+	};
+
+	static_assert(sizeof(Footer) == 20, "struct Footer size mismatch");
+
+	bool isAvailable();
+}
+
+// Writes blob data into a stream blob in compressed form
+
+class BlobPacker
+{
+public:
+	BlobPacker(MemoryPool& pool, blb* output);
+	~BlobPacker();
+
+	// Returns false if data turned out to be not compressible, since
+	// then the data put so far and all the next data is stored as is
+	bool put(thread_db* tdbb, const UCHAR* data, USHORT length);
+
+	// Returns true if blob is stored compressed
+	bool finish(thread_db* tdbb);
+
+private:
+	bool putFrame(thread_db* tdbb, ULONG length);
+	void abandon(thread_db* tdbb);
+
+	blb* const m_output;
+	const bool m_segmented;
+	bool m_abandoned;
+	Firebird::Array<UCHAR> m_image;		// image not yet put into frames
+	Firebird::Array<UCHAR> m_packed;
+	Firebird::Array<ULONG> m_ends;		// end offsets of frames in stored data
+	ULONG m_stored;
+	ULONG m_length;
+	ULONG m_count;
+	USHORT m_maxSegment;
+#ifdef HAVE_ZLIB_H
+	z_stream m_stream;
+	bool m_deflating;
+#endif
+};
+
+// Reads image of compressed blob from the stream blob it's stored in
+
+class BlobUnpacker
+{
+public:
+	BlobUnpacker(MemoryPool& pool, blb* stored);
+	~BlobUnpacker();
+
+	// Read frames table, return blob attributes stored in the footer
+	void open(thread_db* tdbb, BlobPack::Footer& footer);
+
+	ULONG read(thread_db* tdbb, void* buffer, ULONG length);
+
+	void seek(ULONG position)
+	{
+		m_position = position;
+	}
+
+	bool isEof() const
+	{
+		return m_position >= m_imageLength;
+	}
+
+	blb* getStored() const
+	{
+		return m_stored;
+	}
+
+private:
+	void readStored(thread_db* tdbb, ULONG offset, UCHAR* buffer, ULONG length);
+	void loadFrame(thread_db* tdbb, ULONG frame);
+
+	blb* const m_stored;
+	Firebird::Array<ULONG> m_ends;
+	Firebird::Array<UCHAR> m_frame;
+	Firebird::Array<UCHAR> m_packed;
+	ULONG m_frameSize;
+	ULONG m_frameNumber;		// frame in m_frame, if any
+	ULONG m_frameLength;
+	ULONG m_imageLength;
+	ULONG m_position;
+#ifdef HAVE_ZLIB_H
+	z_stream m_stream;
+	bool m_inflating;
+#endif
+};
+
+} // namespace Jrd
+
+#endif // JRD_BLOB_PACKER_H
@@ -0,0 +1,255 @@
+/*
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird Project.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#include "firebird.h"
+#include "../jrd/BulkInsert.h"
+#include "../jrd/jrd.h"
+#include "../jrd/ods.h"
+#include "../jrd/btr.h"
+#include "../jrd/sort.h"
+#include "../jrd/tra.h"
+#include "../jrd/btr_proto.h"
+#include "../jrd/cch_proto.h"
+
+using namespace Firebird;
+using namespace Jrd;
+using namespace Ods;
+
+namespace
+{
+	// Key of a record not yet accepted, key data follows it in m_pending
+
+	struct PendingKey
+	{
+		SINT64 number;
+		USHORT sort;			// position in m_sorts
+		USHORT length;
+		USHORT nulls;
+		UCHAR flags;
+	};
+
+	// Tail of sort record, key data padded to IndexSort::keyLength precede it
+
+#pragma pack(1)
+	struct BulkSortRecord
+	{
+		SINT64 number;			// sorted after the key, as b-tree orders duplicates
+		USHORT length;
+		USHORT nulls;
+		UCHAR flags;
+	};
+#pragma pack()
+}
+
+
+BulkInsert::BulkInsert(MemoryPool& pool, jrd_tra* transaction)
+	: m_pool(pool),
+	  m_transaction(transaction),
+	  m_relation(NULL),
+	  m_sorts(pool),
+	  m_pending(pool)
+{
+}
+
+
+BulkInsert::~BulkInsert()
+{
+	for (IndexSort* s = m_sorts.begin(); s < m_sorts.end(); s++)
+		delete s->sort;
+}
+
+
+bool BulkInsert::isDeferred(const index_desc* idx)
+{
+	// Insertion into such an index can't fail
+
+	return !(idx->idx_flags & (idx_unique | idx_primary | idx_foreign));
+}
+
+
+bool BulkInsert::attach(jrd_rel* relation)
+{
+	if (!m_relation)
+		m_relation = relation;
+
+	return m_relation == relation;
+}
+
+
+BulkInsert::IndexSort* BulkInsert::getSort(thread_db* tdbb, index_desc* idx)
+{
+	for (IndexSort* s = m_sorts.begin(); s < m_sorts.end(); s++)
+	{
+		if (s->id == idx->idx_id)
+			return s;
+	}
+
+	const USHORT keyLength = ROUNDUP(BTR_key_length(tdbb, m_relation, idx), sizeof(SINT64));
+
+	sort_key_def keyDesc[2];
+	// Key sort description
+	keyDesc[0].setSkdLength(SKD_bytes, keyLength);
+	keyDesc[0].skd_flags = SKD_ascending;
+	keyDesc[0].setSkdOffset();
+	keyDesc[0].skd_vary_offset = 0;
+	// RecordNumber sort description
+	keyDesc[1].setSkdLength(SKD_int64, sizeof(SINT64));
+	keyDesc[1].skd_flags = SKD_ascending;
+	keyDesc[1].setSkdOffset(keyDesc);
+	keyDesc[1].skd_vary_offset = 0;
+
+	IndexSort s;
+	s.id = idx->idx_id;
+	s.keyLength = keyLength;
+	s.pad = (idx->idx_flags & idx_descending) ? -1 : 0;
+	s.sort = FB_NEW_POOL(m_transaction->tra_sorts.getPool())
+		Sort(tdbb->getDatabase(), &m_transaction->tra_sorts, keyLength + sizeof(BulkSortRecord),
+			 2, 1, keyDesc, NULL, NULL);
+
+	return &m_sorts[m_sorts.add(s)];
+}
+
+
+bool BulkInsert::putKey(thread_db* tdbb, index_desc* idx, const temporary_key* key, RecordNumber number)
+{
+	fb_assert(m_relation && isDeferred(idx));
+
+	const IndexSort* const s = getSort(tdbb, idx);
+
+	if (key->key_length > s->keyLength)
+		return false;
+
+	PendingKey pending;
+	pending.number = number.getValue();
+	pending.sort = (USHORT) (s - m_sorts.begin());
+	pending.length = key->key_length;
+	pending.nulls = key->key_nulls;
+	pending.flags = key->key_flags;
+
+	m_pending.add(reinterpret_cast<const UCHAR*>(&pending), sizeof(pending));
+	m_pending.add(key->key_data, key->key_length);
+
+	return true;
+}
+
+
+void BulkInsert::accept(thread_db* tdbb)
+{
+	const UCHAR* data = m_pending.begin();
+	const UCHAR* const end = m_pending.end();
+
+	while (data < end)
+	{
+		PendingKey pending;
+		memcpy(&pending, data, sizeof(pending));
+		data += sizeof(pending);
+
+		const IndexSort& s = m_sorts[pending.sort];
+
+		UCHAR* p;
+		s.sort->put(tdbb, reinterpret_cast<ULONG**>(&p));
+
+		memcpy(p, data, pending.length);
+		memset(p + pending.length, s.pad, s.keyLength - pending.length);
+		data += pending.length;
+
+		BulkSortRecord* const record = reinterpret_cast<BulkSortRecord*>(p + s.keyLength);
+		record->number = pending.number;
+		record->length = pending.length;
+		record->nulls = pending.nulls;
+		record->flags = pending.flags;
+	}
+
+	m_pending.clear();
+}
+
+
+void BulkInsert::reject()
+{
+	m_pending.clear();
+}
+
+
+void BulkInsert::flush(thread_db* tdbb)
+{
+	// Keys come in the b-tree order, so the pages to insert into are mostly
+	// the ones just used and stay in the cache
+
+	fb_assert(m_pending.isEmpty());
+
+	if (!m_relation)
+		return;
+
+	RelationPages* const relPages = m_relation->getPages(tdbb);
+
+	temporary_key key;
+	index_desc idx;
+
+	index_insertion insertion;
+	insertion.iib_relation = m_relation;
+	insertion.iib_key = &key;
+	insertion.iib_descriptor = &idx;
+	insertion.iib_transaction = m_transaction;
+	insertion.iib_btr_level = 0;
+
+	for (IndexSort* s = m_sorts.begin(); s < m_sorts.end(); s++)
+	{
+		s->sort->sort(tdbb);
+
+		for (;;)
+		{
+			UCHAR* p;
+			s->sort->get(tdbb, reinterpret_cast<ULONG**>(&p));
+
+			if (!p)
+				break;
+
+			const BulkSortRecord* const record = reinterpret_cast<const BulkSortRecord*>(p + s->keyLength);
+
+			key.key_length = record->length;
+			key.key_nulls = record->nulls;
+			key.key_flags = record->flags;
+			memcpy(key.key_data, p, record->length);
+
+			// Pick up the current description as IDX_store does, the index
+			// root changes when the b-tree grows a level
+
+			WIN window(relPages->rel_pg_space_id, relPages->rel_index_root);
+			index_root_page* const root = (index_root_page*) CCH_FETCH(tdbb, &window, LCK_read, pag_root);
+
+			if (!BTR_description(tdbb, m_relation, root, &idx, s->id))
+			{
+				// Index was dropped meanwhile
+				CCH_RELEASE(tdbb, &window);
+				break;
+			}
+
+			insertion.iib_number.setValue(record->number);
+			insertion.iib_duplicates = NULL;
+			BTR_insert(tdbb, &window, &insertion);
+
+			if (--tdbb->tdbb_quantum < 0)
+				JRD_reschedule(tdbb, 0, true);
+		}
+
+		delete s->sort;
+		s->sort = NULL;
+	}
+
+	m_sorts.clear();
+}
@@ -0,0 +1,85 @@
+/*
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird Project.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#ifndef JRD_BULK_INSERT_H
+#define JRD_BULK_INSERT_H
+
+#include "../common/classes/alloc.h"
+#include "../common/classes/array.h"
+#include "../jrd/RecordNumber.h"
+
+namespace Jrd {
+
+class jrd_rel;
+class jrd_tra;
+class thread_db;
+class Sort;
+struct index_desc;
+struct temporary_key;
+
+// Bulk insertion of records into a table, used by batches of INSERT statements.
+// Records are appended to new data pages (see RPB_s_bulk) and the keys of
+// indices which can't raise an error (neither unique nor foreign ones) are
+// collected and sorted, to be inserted into their b-trees in key order when
+// the batch is over. Keys of a record are held pending until the statement
+// storing it succeeds, so the keys of records undone never reach the b-trees.
+
+class BulkInsert
+{
+public:
+	BulkInsert(MemoryPool& pool, jrd_tra* transaction);
+	~BulkInsert();
+
+	// Returns true if records of relation may be stored in bulk. The first
+	// relation asked about becomes the bulk one.
+	bool attach(jrd_rel* relation);
+
+	// Returns false if key must be inserted into the index at once
+	bool putKey(thread_db* tdbb, index_desc* idx, const temporary_key* key, RecordNumber number);
+
+	// Keys put since the last call belong to the stored records or are discarded
+	void accept(thread_db* tdbb);
+	void reject();
+
+	// Insert the sorted keys into the b-trees
+	void flush(thread_db* tdbb);
+
+	// Index which maintenance may be deferred
+	static bool isDeferred(const index_desc* idx);
+
+private:
+	struct IndexSort
+	{
+		USHORT id;
+		USHORT keyLength;		// length of key part of sort record
+		UCHAR pad;
+		Sort* sort;
+	};
+
+	IndexSort* getSort(thread_db* tdbb, index_desc* idx);
+
+	MemoryPool& m_pool;
+	jrd_tra* const m_transaction;
+	jrd_rel* m_relation;
+	Firebird::HalfStaticArray<IndexSort, 8> m_sorts;
+	Firebird::HalfStaticArray<UCHAR, 1024> m_pending;	// keys of records not yet accepted
+};
+
+} // namespace Jrd
+
+#endif // JRD_BULK_INSERT_H
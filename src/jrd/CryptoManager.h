@@ -296,6 +296,13 @@ public:
 	bool read(thread_db* tdbb, FbStatusVector* sv, Ods::pag* page, IOCallback* io);
 	bool write(thread_db* tdbb, FbStatusVector* sv, Ods::pag* page, IOCallback* io);
 
+	// Page is going to be written as is, without encryption
+	bool isPlainWrite(const Ods::pag* page) const
+	{
+		return page->pag_type <= pag_max &&
+			(!Ods::pag_crypt_page[page->pag_type] || (!crypt && !slowIO));
+	}
+
 	void cryptThread();
 
 	bool checkValidation(Firebird::IDbCryptPlugin* crypt);
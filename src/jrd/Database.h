@@ -455,11 +455,6 @@ public:
 	USHORT dbb_max_records;				// max record per data page
 	USHORT dbb_max_idx;					// max number of indexes on a root page
 
-#ifdef SUPERSERVER_V2
-	USHORT dbb_prefetch_sequence;		// sequence to pace frequency of prefetch requests
-	USHORT dbb_prefetch_pages;			// prefetch pages per request
-#endif
-
 	Firebird::PathName dbb_filename;	// filename string
 	Firebird::PathName dbb_database_name;	// database visible name (file name or alias)
 #ifdef HAVE_ID_BY_NAME
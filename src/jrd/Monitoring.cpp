@@ -1248,6 +1248,15 @@ void Monitoring::putStatistics(SnapshotData::DumpRecord& record, const RuntimeSt
 	record.storeInteger(f_mon_io_page_writes, statistics.getValue(RuntimeStatistics::PAGE_WRITES));
 	record.storeInteger(f_mon_io_page_fetches, statistics.getValue(RuntimeStatistics::PAGE_FETCHES));
 	record.storeInteger(f_mon_io_page_marks, statistics.getValue(RuntimeStatistics::PAGE_MARKS));
+	record.storeInteger(f_mon_io_page_prefetches, statistics.getValue(RuntimeStatistics::PAGE_PREFETCHES));
+	record.storeInteger(f_mon_io_prefetch_hits, statistics.getValue(RuntimeStatistics::PAGE_PREFETCH_HITS));
+	record.storeInteger(f_mon_io_prefetch_misses, statistics.getValue(RuntimeStatistics::PAGE_PREFETCH_MISSES));
+	record.storeInteger(f_mon_io_page_evictions, statistics.getValue(RuntimeStatistics::PAGE_EVICTIONS));
+	record.storeInteger(f_mon_io_page_promotions, statistics.getValue(RuntimeStatistics::PAGE_PROMOTIONS));
+	record.storeInteger(f_mon_io_blob_page_reads, statistics.getValue(RuntimeStatistics::BLOB_PAGE_READS));
+	record.storeInteger(f_mon_io_blob_bytes_read, statistics.getValue(RuntimeStatistics::BLOB_BYTES_READ));
+	record.storeInteger(f_mon_io_blob_packed_bytes, statistics.getValue(RuntimeStatistics::BLOB_PACKED_BYTES));
+	record.storeInteger(f_mon_io_blob_packed_size, statistics.getValue(RuntimeStatistics::BLOB_PACKED_SIZE));
 	record.write();
 
 	// logical I/O statistics (global)
@@ -1269,6 +1278,8 @@ void Monitoring::putStatistics(SnapshotData::DumpRecord& record, const RuntimeSt
 	record.storeInteger(f_mon_rec_frg_reads, statistics.getValue(RuntimeStatistics::RECORD_FRAGMENT_READS));
 	record.storeInteger(f_mon_rec_rpt_reads, statistics.getValue(RuntimeStatistics::RECORD_RPT_READS));
 	record.storeInteger(f_mon_rec_imgc, statistics.getValue(RuntimeStatistics::RECORD_IMGC));
+	record.storeInteger(f_mon_rec_state_hits, statistics.getValue(RuntimeStatistics::TRA_STATE_HITS));
+	record.storeInteger(f_mon_rec_state_misses, statistics.getValue(RuntimeStatistics::TRA_STATE_MISSES));
 	record.write();
 
 	// logical I/O statistics (table wise)
@@ -1596,6 +1596,24 @@ RecordSource* AggregateSourceNode::generate(thread_db* tdbb, OptimizerBlk* opt,
 	CompilerScratch* const csb = opt->opt_csb;
 	rse->rse_sorted = group;
 
+	// Group the records using a hash table instead of sorting them if there are
+	// few enough groups to be kept in memory. Don't do that if the user-specified
+	// plan or the first rows optimization may rely on the records being sorted.
+
+	bool hashed = false;
+
+	if (group && !rse->rse_plan && !(rse->flags & RseNode::FLAG_OPT_FIRST_ROWS) &&
+		HashAggregateStream::isSupported(tdbb, csb, &group->expressions, map))
+	{
+		const double groups = OPT_estimate_groups(tdbb, csb, group);
+
+		if (groups > 0 && HashAggregateStream::fitsMemory(tdbb, csb, stream, map, groups))
+		{
+			rse->rse_sorted = NULL;
+			hashed = true;
+		}
+	}
+
 	// AB: Try to distribute items from the HAVING CLAUSE to the WHERE CLAUSE.
 	// Zip thru stack of booleans looking for fields that belong to shellStream.
 	// Those fields are mappings. Mappings that hold a plain field may be used
@@ -1609,7 +1627,7 @@ RecordSource* AggregateSourceNode::generate(thread_db* tdbb, OptimizerBlk* opt,
 	NestConst<ValueExprNode>* ptr;
 	AggNode* aggNode = NULL;
 
-	if (map->sourceList.getCount() == 1 && (ptr = map->sourceList.begin()) &&
+	if (!hashed && map->sourceList.getCount() == 1 && (ptr = map->sourceList.begin()) &&
 		(aggNode = nodeAs<AggNode>(*ptr)) &&
 		(aggNode->aggInfo.blr == blr_agg_min || aggNode->aggInfo.blr == blr_agg_max))
 	{
@@ -1633,8 +1651,18 @@ RecordSource* AggregateSourceNode::generate(thread_db* tdbb, OptimizerBlk* opt,
 
 	// allocate and optimize the record source block
 
-	AggregatedStream* const rsb = FB_NEW_POOL(*tdbb->getDefaultPool()) AggregatedStream(tdbb, csb,
-		stream, (group ? &group->expressions : NULL), map, nextRsb);
+	RecordSource* rsb;
+
+	if (hashed)
+	{
+		rsb = FB_NEW_POOL(*tdbb->getDefaultPool()) HashAggregateStream(tdbb, csb,
+			stream, &group->expressions, map, nextRsb);
+	}
+	else
+	{
+		rsb = FB_NEW_POOL(*tdbb->getDefaultPool()) AggregatedStream(tdbb, csb,
+			stream, (group ? &group->expressions : NULL), map, nextRsb);
+	}
 
 	if (rse->rse_aggregate)
 	{
@@ -67,6 +67,17 @@ public:
 		RECORD_RPT_READS,
 		RECORD_IMGC,
 		RECORD_LAST_ITEM = RECORD_IMGC,
+		PAGE_PREFETCHES,
+		PAGE_PREFETCH_HITS,
+		PAGE_PREFETCH_MISSES,
+		PAGE_EVICTIONS,
+		PAGE_PROMOTIONS,
+		TRA_STATE_HITS,
+		TRA_STATE_MISSES,
+		BLOB_PAGE_READS,
+		BLOB_BYTES_READ,
+		BLOB_PACKED_BYTES,
+		BLOB_PACKED_SIZE,
 		TOTAL_ITEMS		// last
 	};
 
@@ -241,9 +252,10 @@ public:
 		if (baseStats.allChgNumber != newStats.allChgNumber)
 		{
 			const size_t FIRST_ITEM = relStatsOnly ? REL_BASE_OFFSET : 0;
+			const size_t LAST_ITEM = relStatsOnly ? REL_BASE_OFFSET + REL_TOTAL_ITEMS : TOTAL_ITEMS;
 
 			allChgNumber++;
-			for (size_t i = FIRST_ITEM; i < TOTAL_ITEMS; ++i)
+			for (size_t i = FIRST_ITEM; i < LAST_ITEM; ++i)
 				values[i] += newStats.values[i] - baseStats.values[i];
 
 			if (baseStats.relChgNumber != newStats.relChgNumber)
@@ -0,0 +1,276 @@
+/*
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird Project.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#include "firebird.h"
+#include "../jrd/WorkerPool.h"
+#include "../common/classes/init.h"
+#include "../common/config/config.h"
+#include "../common/gdsassert.h"
+#include "../common/isc_proto.h"
+
+using namespace Firebird;
+using namespace Jrd;
+
+namespace
+{
+	GlobalPtr<WorkerPool, InstanceControl::PRIORITY_DELETE_FIRST> globalPool;
+}
+
+
+WorkerPool& WorkerPool::workerPool()
+{
+	return globalPool;
+}
+
+
+WorkerPool::WorkerPool(MemoryPool& pool)
+	: m_jobs(pool), m_threads(pool), m_started(false), m_shutdown(false)
+{
+}
+
+
+WorkerPool::~WorkerPool()
+{
+	{	// scope
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+		m_shutdown = true;
+	}
+
+	for (FB_SIZE_T i = 0; i < m_threads.getCount(); i++)
+		m_wakeup.release();
+
+	for (FB_SIZE_T i = 0; i < m_threads.getCount(); i++)
+		Thread::waitForCompletion(m_threads[i]);
+}
+
+
+unsigned WorkerPool::getParallelism(unsigned requested)
+{
+	const unsigned workers = Config::getMaxParallelWorkers();
+
+	if (requested <= 1 || !workers)
+		return 1;
+
+	return MIN(requested, workers + 1);
+}
+
+
+void WorkerPool::run(Task* const* tasks, unsigned count)
+{
+	Job job;
+	job.tasks = tasks;
+	job.count = count;
+	job.next = 0;
+	job.done = 0;
+
+	WorkerPool& pool = workerPool();
+	pool.submit(&job, false);
+	pool.complete(&job);
+
+	job.status.check();
+}
+
+
+void WorkerPool::Background::start(Task* task)
+{
+	fb_assert(!m_active);
+
+	m_task = task;
+	m_job.tasks = &m_task;
+	m_job.count = 1;
+	m_job.next = 0;
+	m_job.done = 0;
+	m_job.status->init();
+
+	workerPool().submit(&m_job, true);
+	m_active = true;
+}
+
+
+void WorkerPool::Background::wait()
+{
+	if (!m_active)
+		return;
+
+	m_active = false;
+	workerPool().complete(&m_job);
+
+	m_job.status.check();
+}
+
+
+void WorkerPool::start()
+{
+	// Caller holds m_mutex
+
+	m_started = true;
+
+	const unsigned workers = Config::getMaxParallelWorkers();
+
+	for (unsigned i = 0; i < workers; i++)
+	{
+		Thread::Handle handle;
+
+		try
+		{
+			Thread::start(workerThread, this, THREAD_medium, &handle);
+		}
+		catch (const Exception& ex)
+		{
+			// Work with the threads we have, caller does the rest anyway
+			iscLogException("Cannot start parallel worker thread", ex);
+			break;
+		}
+
+		m_threads.add(handle);
+	}
+}
+
+
+void WorkerPool::submit(Job* job, bool background)
+{
+	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+	if (!m_started)
+		start();
+
+	// Caller executes one of the tasks itself, unless it's busy with something else
+
+	const unsigned helpers = background ? job->count : job->count - 1;
+
+	if (helpers && m_threads.hasData())
+	{
+		m_jobs.add(job);
+
+		const unsigned wakeup = MIN(helpers, m_threads.getCount());
+		for (unsigned i = 0; i < wakeup; i++)
+			m_wakeup.release();
+	}
+}
+
+
+void WorkerPool::complete(Job* job)
+{
+	// Help the workers, then wait for the tasks they took
+
+	while (executeNext(job))
+		;
+
+	while (true)
+	{
+		{	// scope
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+			if (job->done == job->count)
+				break;
+		}
+
+		job->finished.enter();
+	}
+}
+
+
+bool WorkerPool::executeNext(Job* job)
+{
+	Task* task = NULL;
+
+	{	// scope
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+		// Worker takes the oldest job, it can't go away before the task
+		// taken below is reported as done
+
+		if (!job)
+		{
+			if (m_jobs.isEmpty())
+				return false;
+
+			job = m_jobs[0];
+		}
+
+		if (job->next == job->count)
+			return false;
+
+		task = job->tasks[job->next++];
+
+		if (job->next == job->count)
+		{
+			FB_SIZE_T pos;
+			if (m_jobs.find(job, pos))
+				m_jobs.remove(pos);
+		}
+	}
+
+	FbLocalStatus status;
+
+	try
+	{
+		task->execute();
+	}
+	catch (const Exception& ex)
+	{
+		ex.stuffException(&status);
+	}
+
+	// The job may be gone as soon as the last task is reported as done and
+	// the mutex is released, don't touch it after that
+
+	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+	if (!status.isSuccess() && job->status.isSuccess())
+		status.copyTo(&job->status);
+
+	if (++job->done == job->count)
+		job->finished.release();
+
+	return true;
+}
+
+
+void WorkerPool::worker()
+{
+	while (true)
+	{
+		m_wakeup.enter();
+
+		{	// scope
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+			if (m_shutdown)
+				return;
+		}
+
+		while (executeNext(NULL))
+			;
+	}
+}
+
+
+THREAD_ENTRY_DECLARE WorkerPool::workerThread(THREAD_ENTRY_PARAM arg)
+{
+	try
+	{
+		static_cast<WorkerPool*>(arg)->worker();
+	}
+	catch (const Exception& ex)
+	{
+		iscLogException("Parallel worker thread", ex);
+	}
+
+	return 0;
+}
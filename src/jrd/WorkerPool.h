@@ -0,0 +1,125 @@
+/*
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird Project.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#ifndef JRD_WORKER_POOL_H
+#define JRD_WORKER_POOL_H
+
+#include "../common/classes/alloc.h"
+#include "../common/classes/array.h"
+#include "../common/classes/locks.h"
+#include "../common/classes/semaphore.h"
+#include "../common/status.h"
+#include "../common/ThreadStart.h"
+
+namespace Jrd {
+
+// Process-wide pool of threads running CPU bound parts of engine requests
+// (sorting of memory buffers, for example) in parallel, or reading external
+// files ahead in background. Tasks are executed outside of engine context,
+// i.e. without thread_db, so they must not touch attachment, transaction or
+// database state and must not do page I/O.
+
+class WorkerPool
+{
+public:
+	class Task
+	{
+	public:
+		virtual ~Task() {}
+		virtual void execute() = 0;
+	};
+
+private:
+	// Set of tasks passed to run()
+	struct Job
+	{
+		Task* const* tasks;
+		unsigned count;
+		unsigned next;				// first task not yet taken
+		unsigned done;				// number of finished tasks
+		Firebird::Semaphore finished;
+		Firebird::FbLocalStatus status;
+	};
+
+public:
+	// Single task executed by the pool while the caller does something else.
+	// If the pool has no threads, the task is executed by wait().
+	class Background
+	{
+	public:
+		Background()
+			: m_task(NULL), m_active(false)
+		{
+		}
+
+		~Background()
+		{
+			if (m_active)
+				workerPool().complete(&m_job);
+		}
+
+		void start(Task* task);
+
+		// Return when the task is done, re-throw its error if any
+		void wait();
+
+		bool isActive() const
+		{
+			return m_active;
+		}
+
+	private:
+		Task* m_task;
+		Job m_job;
+		bool m_active;
+	};
+
+	explicit WorkerPool(Firebird::MemoryPool& pool);
+	~WorkerPool();
+
+	// Execute given tasks and return when all of them are done. Calling thread
+	// executes tasks not taken by the workers. First error raised by any task
+	// is re-thrown to the caller.
+	static void run(Task* const* tasks, unsigned count);
+
+	// Number of parts an operation should be split into to use the pool
+	// with given per-database parallelism, 1 if parallel execution is disabled
+	static unsigned getParallelism(unsigned requested);
+
+private:
+	static WorkerPool& workerPool();
+
+	void start();
+	void submit(Job* job, bool background);
+	void complete(Job* job);
+	bool executeNext(Job* job);		// NULL job - oldest one from m_jobs
+	void worker();
+
+	static THREAD_ENTRY_DECLARE workerThread(THREAD_ENTRY_PARAM arg);
+
+	Firebird::Mutex m_mutex;					// guards everything below
+	Firebird::Semaphore m_wakeup;
+	Firebird::HalfStaticArray<Job*, 8> m_jobs;	// jobs having tasks not yet taken
+	Firebird::HalfStaticArray<Thread::Handle, 16> m_threads;
+	bool m_started;
+	bool m_shutdown;
+};
+
+} // namespace Jrd
+
+#endif // JRD_WORKER_POOL_H
@@ -45,6 +45,7 @@
 #include "../jrd/exe.h"
 #include "../jrd/req.h"
 #include "../jrd/blb.h"
+#include "../jrd/BlobPacker.h"
 #include "../jrd/ods.h"
 #include "../jrd/lls.h"
 #include "gen/iberror.h"
@@ -658,6 +659,9 @@ USHORT blb::BLB_get_segment(thread_db* tdbb, void* segment, USHORT buffer_length
 		return tmp_len;
 	}
 
+	if (blb_flags & BLB_compressed)
+		return get_packed_segment(tdbb, segment, buffer_length);
+
 	// If there is a seek pending, handle it here
 
 	USHORT seek = 0;
@@ -805,6 +809,8 @@ USHORT blb::BLB_get_segment(thread_db* tdbb, void* segment, USHORT buffer_length
 	length = to - static_cast<UCHAR*>(segment);
 	blb_seek += length;
 
+	tdbb->bumpStats(RuntimeStatistics::BLOB_BYTES_READ, length);
+
 	// If this is a stream blob, fake fragment unless we're at the end
 
 	if (!isSegmented())
@@ -1113,6 +1119,11 @@ void blb::move(thread_db* tdbb, dsc* from_desc, dsc* to_desc, const record_param
 	if (needFilter)
 		BLB_gen_bpb_from_descs(from_desc, to_desc, bpb);
 
+	// Blobs of user tables are compressed if asked, arrays are not as slices are read by seeks
+
+	const bool pack = (to_desc->dsc_dtype != dtype_array) && !relation->isSystem() &&
+		tdbb->getDatabase()->dbb_config->getBlobCompressionThreshold() && BlobPack::isAvailable();
+
 	while (true)
 	{
 		materialized_blob = false;
@@ -1120,7 +1131,7 @@ void blb::move(thread_db* tdbb, dsc* from_desc, dsc* to_desc, const record_param
 		if (source->bid_internal.bid_relation_id || needFilter)
 		{
 			blob = copy_blob(tdbb, source, destination,
-							 bpb.getCount(), bpb.begin(), relPages->rel_pg_space_id);
+							 bpb.getCount(), bpb.begin(), relPages->rel_pg_space_id, pack);
 		}
 		else if ((to_desc->dsc_dtype == dtype_array) && (array = find_array(transaction, source)) &&
 			(blob = store_array(tdbb, transaction, source)))
@@ -1167,11 +1178,21 @@ void blb::move(thread_db* tdbb, dsc* from_desc, dsc* to_desc, const record_param
 					ERR_post(Arg::Gds(isc_bad_segstr_id));
 				}
 
-				if (blob->blb_level && (blob->blb_pg_space_id != relPages->rel_pg_space_id))
+				// Temporary blob is copied if its pages are not in the relation page space or
+				// if it should be compressed. Copy is not needed if the blob is not compressible.
+
+				const bool mustCopy = blob->blb_level && (blob->blb_pg_space_id != relPages->rel_pg_space_id);
+				blb* newBlob = NULL;
+
+				if (mustCopy || (pack && blob->blb_length >= tdbb->getDatabase()->dbb_config->getBlobCompressionThreshold()))
+				{
+					newBlob = copy_blob(tdbb, source, destination,
+						bpb.getCount(), bpb.begin(), relPages->rel_pg_space_id, pack, mustCopy);
+				}
+
+				if (newBlob)
 				{
 					const ULONG oldTempID = blob->blb_temp_id;
-					blb* newBlob = copy_blob(tdbb, source, destination,
-						bpb.getCount(), bpb.begin(), relPages->rel_pg_space_id);
 
 					transaction->tra_blobs->locate(newBlob->blb_temp_id);
 					BlobIndex* newBlobIndex = &transaction->tra_blobs->current();
@@ -1428,6 +1449,9 @@ blb* blb::open2(thread_db* tdbb,
 
 		if (blob->blb_level == 0)
 			blob->blb_segment = blob->getBuffer();
+
+		if (blob->blb_flags & BLB_compressed)
+			blob->open_packed(tdbb, &blobId);
 	}
 
 	UCharBuffer new_bpb;
@@ -1929,7 +1953,7 @@ static ArrayField* alloc_array(jrd_tra* transaction, Ods::InternalArrayDesc* pro
 }
 
 
-blb* blb::allocate_blob(thread_db* tdbb, jrd_tra* transaction)
+blb* blb::allocate_blob(thread_db* tdbb, jrd_tra* transaction, bool registered)
 {
 /**************************************
  *
@@ -1938,7 +1962,9 @@ blb* blb::allocate_blob(thread_db* tdbb, jrd_tra* transaction)
  **************************************
  *
  * Functional description
- *      Create a shiney, new, empty blob.
+ *      Create a shiney, new, empty blob. Unless the blob is
+ *      used internally by another blob, it's registered in
+ *      the transaction.
  *
  **************************************/
 	fb_assert(!transaction->tra_outer);
@@ -1961,6 +1987,10 @@ blb* blb::allocate_blob(thread_db* tdbb, jrd_tra* transaction)
 							sizeof(Ods::blh);
 	blob->blb_max_pages = blob->blb_clump_size >> SHIFTLONG;
 	blob->blb_pointers = (dbb->dbb_page_size - BLP_SIZE) >> SHIFTLONG;
+
+	if (!registered)
+		return blob;
+
 	// This code is to handle huge number of blob updates done in one transaction.
 	// Blob index counter may wrap in this case
 	const ULONG sentry = transaction->tra_next_blob_id;
@@ -2069,7 +2099,7 @@ static ISC_STATUS blob_filter(USHORT action, BlobControl* control)
 
 blb* blb::copy_blob(thread_db* tdbb, const bid* source, bid* destination,
 					  USHORT bpb_length, const UCHAR* bpb,
-					  USHORT destPageSpaceID)
+					  USHORT destPageSpaceID, bool pack, bool mustCopy)
 {
 /**************************************
  *
@@ -2078,10 +2108,15 @@ blb* blb::copy_blob(thread_db* tdbb, const bid* source, bid* destination,
  **************************************
  *
  * Functional description
- *      Make a copy of an existing blob.
+ *      Make a copy of an existing blob. If asked, compress
+ *      the copy unless the blob is shorter than compression
+ *      threshold or not compressible. In the latter case
+ *      the copy is made as is, or not made at all and NULL
+ *      is returned if a copy is not really needed.
  *
  **************************************/
 	SET_TDBB(tdbb);
+	Database* const dbb = tdbb->getDatabase();
 
 	jrd_req* request = tdbb->getRequest();
 	jrd_tra* transaction = request ? request->req_transaction : tdbb->getTransaction();
@@ -2096,6 +2131,13 @@ blb* blb::copy_blob(thread_db* tdbb, const bid* source, bid* destination,
 		output->blb_flags |= BLB_stream;
 	}
 
+	AutoPtr<BlobPacker> packer;
+
+	// Older engines can't read compressed blobs, they are written since ODS 13.1 only
+	if (pack && ENCODE_ODS(dbb->dbb_ods_version, dbb->dbb_minor_version) >= ODS_13_1 &&
+		input->blb_length >= dbb->dbb_config->getBlobCompressionThreshold())
+		packer = FB_NEW_POOL(*transaction->tra_pool) BlobPacker(*transaction->tra_pool, output);
+
 	HalfStaticArray<UCHAR, 2048> buffer;
 	UCHAR* buff = buffer.getBuffer(input->blb_max_segment);
 
@@ -2105,7 +2147,18 @@ blb* blb::copy_blob(thread_db* tdbb, const bid* source, bid* destination,
 		if (input->blb_flags & BLB_eof) {
 			break;
 		}
-		output->BLB_put_segment(tdbb, buff, length);
+
+		if (!packer)
+			output->BLB_put_segment(tdbb, buff, length);
+		else if (!packer->put(tdbb, buff, length) && !mustCopy)
+			break;
+	}
+
+	if (packer && !packer->finish(tdbb) && !mustCopy)
+	{
+		input->BLB_close(tdbb);
+		output->BLB_cancel(tdbb);
+		return NULL;
 	}
 
 	input->BLB_close(tdbb);
@@ -2326,10 +2379,6 @@ blob_page* blb::get_next_page(thread_db* tdbb, WIN* window)
 	}
 
 	SET_TDBB(tdbb);
-#ifdef SUPERSERVER_V2
-	Database* dbb = tdbb->getDatabase();
-	ULONG pages[PREFETCH_MAX_PAGES];
-#endif
 
 	const vcl& vector = *blb_pages;
 
@@ -2337,46 +2386,20 @@ blob_page* blb::get_next_page(thread_db* tdbb, WIN* window)
 	// Level 1 blobs are much easier -- page number is in vector.
 	if (blb_level == 1)
 	{
-#ifdef SUPERSERVER_V2
-		// Perform prefetch of blob level 1 data pages.
-
-		if (!(blb_sequence % dbb->dbb_prefetch_sequence))
-		{
-			USHORT sequence = blb_sequence;
-			USHORT i = 0;
-			while (i < dbb->dbb_prefetch_pages && sequence <= blb_max_sequence)
-			{
-				 pages[i++] = vector[sequence++];
-			}
+		prefetch_pages(tdbb, vector.begin(), 0, 0);
 
-			CCH_PREFETCH(tdbb, pages, i);
-		}
-#endif
 		window->win_page = vector[blb_sequence];
 		page = (blob_page*) CCH_FETCH(tdbb, window, LCK_read, pag_blob);
 	}
 	else
 	{
-		window->win_page = vector[blb_sequence / blb_pointers];
+		const ULONG pointer = blb_sequence / blb_pointers;
+		window->win_page = vector[pointer];
 		page = (blob_page*) CCH_FETCH(tdbb, window, LCK_read, pag_blob);
-#ifdef SUPERSERVER_V2
-		// Perform prefetch of blob level 2 data pages.
 
-		USHORT sequence = blb_sequence % blb_pointers;
-		if (!(sequence % dbb->dbb_prefetch_sequence))
-		{
-			ULONG abs_sequence = blb_sequence;
-			USHORT i = 0;
-			while (i < dbb->dbb_prefetch_pages && sequence < blb_pointers &&
-				abs_sequence <= blb_max_sequence)
-			{
-				pages[i++] = page->blp_page[sequence++];
-				abs_sequence++;
-			}
+		prefetch_pages(tdbb, page->blp_page, pointer * blb_pointers,
+			pointer + 1 < vector.count() ? vector[pointer + 1] : 0);
 
-			CCH_PREFETCH(tdbb, pages, i);
-		}
-#endif
 		page = (blob_page*) CCH_HANDOFF(tdbb, window,
 										page->blp_page[blb_sequence % blb_pointers],
 										LCK_read, pag_blob);
@@ -2387,10 +2410,187 @@ blob_page* blb::get_next_page(thread_db* tdbb, WIN* window)
 
 	blb_sequence++;
 
+	tdbb->bumpStats(RuntimeStatistics::BLOB_PAGE_READS);
+
 	return page;
 }
 
 
+void blb::prefetch_pages(thread_db* tdbb, const ULONG* pages, ULONG first, ULONG next)
+{
+/**************************************
+ *
+ *      p r e f e t c h _ p a g e s
+ *
+ **************************************
+ *
+ * Functional description
+ *      Queue data pages which a sequential read of the blob
+ *      is going to visit soon for read-ahead. Pages are
+ *      requested by portions of ReadAheadPages pages, up to
+ *      two portions ahead of the current one. Vector of page
+ *      numbers starts at sequence "first", for level 2 blobs
+ *      it's the current pointer page and "next" is the page
+ *      number of the following pointer page, if any.
+ *
+ **************************************/
+	const ULONG portion = tdbb->getDatabase()->dbb_bcb->bcb_prefetch_pages;
+
+	if (!portion)
+		return;
+
+	// The read just started or seek happened
+
+	if (blb_prefetch_sequence <= blb_sequence ||
+		blb_prefetch_sequence > blb_sequence + 2 * portion + 1)
+	{
+		blb_prefetch_sequence = blb_sequence + 1;
+	}
+
+	// Wait until less than a portion is left requested ahead
+
+	if (blb_prefetch_sequence > blb_sequence + portion)
+		return;
+
+	const ULONG start = MAX(blb_prefetch_sequence, first);
+	ULONG last = MIN(blb_sequence + 2 * portion + 1, blb_max_sequence + 1);
+	bool piggyback = false;
+
+	if (blb_level == 2 && last >= first + blb_pointers)
+	{
+		last = first + blb_pointers;
+		piggyback = (next != 0);
+	}
+
+	if (start >= last)
+		return;
+
+	HalfStaticArray<ULONG, 64> numbers;
+
+	for (ULONG sequence = start; sequence < last; sequence++)
+		numbers.add(pages[sequence - first]);
+
+	// If the rest of pages is referred to by next pointer page, request it as well
+
+	if (piggyback)
+		numbers.add(next);
+
+	blb_prefetch_sequence = last;
+
+	CCH_prefetch(tdbb, blb_pg_space_id, numbers.begin(), numbers.getCount());
+}
+
+
+void blb::open_packed(thread_db* tdbb, const bid* blob_id)
+{
+/**************************************
+ *
+ *      o p e n _ p a c k e d
+ *
+ **************************************
+ *
+ * Functional description
+ *      Blob is stored compressed. Open the stored stream
+ *      blob as an unregistered inner blob and take the
+ *      attributes of the blob from the footer.
+ *
+ **************************************/
+	MemoryPool& pool = *blb_transaction->tra_pool;
+
+	blb* const stored = allocate_blob(tdbb, blb_transaction, false);
+	stored->blb_relation = blb_relation;
+	stored->blb_pg_space_id = blb_pg_space_id;
+
+	blb_unpacker = FB_NEW_POOL(pool) BlobUnpacker(pool, stored);
+
+	DPM_get_blob(tdbb, stored, blob_id->get_permanent_number(), false, 0);
+
+	if (stored->blb_level == 0)
+		stored->blb_segment = stored->getBuffer();
+
+	stored->blb_flags &= ~BLB_compressed;
+
+	BlobPack::Footer footer;
+	blb_unpacker->open(tdbb, footer);
+
+	blb_length = footer.length;
+	blb_count = footer.count;
+	blb_max_segment = footer.maxSegment;
+	blb_seek = 0;
+	blb_fragment_size = 0;
+
+	if (footer.flags & BlobPack::FLAG_STREAM)
+		blb_flags |= BLB_stream;
+	else
+		blb_flags &= ~BLB_stream;
+}
+
+
+USHORT blb::get_packed_segment(thread_db* tdbb, void* segment, USHORT buffer_length)
+{
+/**************************************
+ *
+ *      g e t _ p a c k e d _ s e g m e n t
+ *
+ **************************************
+ *
+ * Functional description
+ *      Get next segment or fragment of a compressed blob.
+ *      Segment lengths of segmented blob are kept in the
+ *      uncompressed image, as they are in the pages of
+ *      an ordinary blob.
+ *
+ **************************************/
+	fb_assert(blb_unpacker);
+
+	if (blb_flags & BLB_seek)
+	{
+		if (blb_seek >= blb_length)
+		{
+			blb_flags |= BLB_eof;
+			return 0;
+		}
+
+		blb_unpacker->seek(blb_seek);
+		blb_flags &= ~BLB_seek;
+		blb_fragment_size = 0;
+	}
+
+	if (blb_unpacker->isEof() && !blb_fragment_size)
+	{
+		blb_flags |= BLB_eof;
+		return 0;
+	}
+
+	USHORT length = buffer_length;
+
+	if (isSegmented())
+	{
+		if (!blb_fragment_size &&
+			blb_unpacker->read(tdbb, &blb_fragment_size, sizeof(USHORT)) != sizeof(USHORT))
+		{
+			blb_flags |= BLB_eof;
+			return 0;
+		}
+
+		length = MIN(length, blb_fragment_size);
+	}
+
+	length = (USHORT) blb_unpacker->read(tdbb, segment, length);
+	blb_seek += length;
+
+	if (isSegmented())
+	{
+		// Truncated image leaves the segment incomplete
+		blb_fragment_size = blb_unpacker->isEof() ? 0 : blb_fragment_size - length;
+	}
+	else
+		blb_fragment_size = (blb_seek == blb_length) ? 0 : 1;
+
+	return length;
+}
+
+
 void blb::insert_page(thread_db* tdbb)
 {
 /**************************************
@@ -2708,6 +2908,14 @@ void blb::destroy(const bool purge_flag)
 	delete blb_pages;
 	blb_pages = NULL;
 
+	if (blb_unpacker)
+	{
+		blb* const stored = blb_unpacker->getStored();
+		delete blb_unpacker;
+		blb_unpacker = NULL;
+		stored->destroy(false);
+	}
+
 	if ((blb_flags & BLB_temporary) && blb_temp_size > 0)
 	{
 		blb_transaction->getBlobSpace()->releaseSpace(blb_temp_offset, blb_temp_size);
@@ -50,6 +50,7 @@ namespace Jrd
 
 class Attachment;
 class BlobControl;
+class BlobUnpacker;
 class jrd_rel;
 class jrd_req;
 class jrd_tra;
@@ -68,7 +69,9 @@ class blb : public pool_alloc<type_blb>
 public:
 	blb(MemoryPool& pool, USHORT page_size)
 		: blb_interface(NULL),
+		  blb_unpacker(NULL),
 		  blb_buffer(pool, page_size / sizeof(SLONG)),
+		  blb_prefetch_sequence(0),
 		  blb_has_buffer(true)
 	{
 	}
@@ -125,11 +128,15 @@ public:
 	void storeToPage(USHORT* length, Firebird::Array<UCHAR>& buffer, const UCHAR** data, void* stack);
 
 private:
-	static blb* allocate_blob(thread_db*, jrd_tra*);
+	static blb* allocate_blob(thread_db*, jrd_tra*, bool = true);
 	static blb* copy_blob(thread_db* tdbb, const bid* source, bid* destination,
-					USHORT bpb_length, const UCHAR* bpb, USHORT destPageSpaceID);
+					USHORT bpb_length, const UCHAR* bpb, USHORT destPageSpaceID,
+					bool pack = false, bool mustCopy = true);
+	void open_packed(thread_db*, const bid*);
+	USHORT get_packed_segment(thread_db*, void*, USHORT);
 	void delete_blob(thread_db*, ULONG);
 	Ods::blob_page* get_next_page(thread_db*, win*);
+	void prefetch_pages(thread_db*, const ULONG*, ULONG, ULONG);
 	void insert_page(thread_db*);
 	void destroy(const bool purge_flag);
 
@@ -141,6 +148,7 @@ private:
 	BlobControl*	blb_filter;		// Blob filter control block, if any
 	bid			blb_blob_id;		// Id of materialized blob
 	vcl*		blb_pages;			// Vector of pages
+	BlobUnpacker*	blb_unpacker;	// Reader of compressed data, if any
 
 	Firebird::Array<SLONG> blb_buffer;	// buffer used in opened blobs - must be longword aligned
 
@@ -150,6 +158,7 @@ private:
 	ULONG blb_seek;					// Seek location
 	ULONG blb_max_sequence;			// Number of data pages
 	ULONG blb_count;				// Number of segments
+	ULONG blb_prefetch_sequence;	// Next page sequence to be read ahead
 
 	USHORT blb_pointers;			// Max pointer on a page
 	USHORT blb_clump_size;			// Size of data clump
@@ -171,7 +180,8 @@ const int BLB_stream		= 4;		// Stream style blob
 const int BLB_closed		= 8;		// Temporary blob has been closed
 const int BLB_damaged		= 16;		// Blob is busted
 const int BLB_seek			= 32;		// Seek is pending
-const int BLB_large_scan	= 64;		// Blob is larger than page buffer cache
+const int BLB_large_scan	= 64;		// Blob is larger than page buffer cache or LargeBlobPages
+const int BLB_compressed	= 128;		// Blob data is compressed, see BlobPacker.h
 
 /* Blob levels are:
 
@@ -195,6 +195,7 @@ static contents delete_node(thread_db*, WIN*, UCHAR*);
 static void delete_tree(thread_db*, USHORT, USHORT, PageNumber, PageNumber);
 static DSC* eval(thread_db*, const ValueExprNode*, DSC*, bool*);
 static ULONG fast_load(thread_db*, IndexCreation&, SelectivityList&);
+static UCHAR* fetch_sorted_key(thread_db*, IndexCreation&, Array<UCHAR*>&, FB_SIZE_T&);
 
 static index_root_page* fetch_root(thread_db*, WIN*, const jrd_rel*, const RelationPages*);
 static UCHAR* find_node_start_point(btree_page*, temporary_key*, UCHAR*, USHORT*,
@@ -269,6 +270,23 @@ bool BtrPageGCLock::isPageGCAllowed(thread_db* tdbb, const PageNumber& page)
 	return true;
 }
 
+// IndexCreation class
+
+IndexCreation::~IndexCreation()
+{
+	releaseSorts();
+}
+
+void IndexCreation::releaseSorts()
+{
+	sort.reset();
+
+	for (FB_SIZE_T i = 0; i < sortParts.getCount(); i++)
+		delete sortParts[i];
+
+	sortParts.clear();
+}
+
 // IndexErrorContext class
 
 void IndexErrorContext::raise(thread_db* tdbb, idx_e result, Record* record)
@@ -3331,7 +3349,10 @@ static ULONG fast_load(thread_db* tdbb,
 	jrd_rel* const relation = creation.relation;
 	index_desc* const idx = creation.index;
 	const USHORT key_length = creation.key_length;
-	Sort* const scb = creation.sort;
+
+	// Current records of the sort parts being merged
+	Array<UCHAR*> partRecords(*tdbb->getDefaultPool());
+	FB_SIZE_T lastPart = 0;
 
 	const USHORT pageSpaceID = relation->getPages(tdbb)->rel_pg_space_id;
 
@@ -3450,8 +3471,7 @@ static ULONG fast_load(thread_db* tdbb,
 		{
 			// Get the next record in sorted order.
 
-			UCHAR* record;
-			scb->get(tdbb, reinterpret_cast<ULONG**>(&record));
+			UCHAR* record = fetch_sorted_key(tdbb, creation, partRecords, lastPart);
 
 			if (!record || creation.duplicates)
 				break;
@@ -4039,7 +4059,7 @@ static ULONG fast_load(thread_db* tdbb,
 
 	// do some final housekeeping
 
-	creation.sort.reset();
+	creation.releaseSorts();
 
 	// If index flush fails, try to delete the index tree.
 	// If the index delete fails, just go ahead and punt.
@@ -4086,6 +4106,79 @@ static ULONG fast_load(thread_db* tdbb,
 }
 
 
+static UCHAR* fetch_sorted_key(thread_db* tdbb, IndexCreation& creation,
+							   Array<UCHAR*>& records, FB_SIZE_T& last)
+{
+/**************************************
+ *
+ *	f e t c h _ s o r t e d _ k e y
+ *
+ **************************************
+ *
+ * Functional description
+ *	Get the next sorted key record of the index being created.
+ *	If the keys were sorted in parts, merge them on the fly:
+ *	replace the record of the part returned last time by its
+ *	next one and return the lowest record of all the parts.
+ *
+ **************************************/
+	UCHAR* record;
+
+	if (creation.sort)
+	{
+		creation.sort->get(tdbb, reinterpret_cast<ULONG**>(&record));
+		return record;
+	}
+
+	const FB_SIZE_T count = creation.sortParts.getCount();
+
+	if (records.isEmpty())
+	{
+		records.grow(count);
+
+		for (FB_SIZE_T i = 0; i < count; i++)
+			creation.sortParts[i]->get(tdbb, reinterpret_cast<ULONG**>(&records[i]));
+	}
+	else
+		creation.sortParts[last]->get(tdbb, reinterpret_cast<ULONG**>(&records[last]));
+
+	// Keys are compared byte-wise, equal keys are ordered by record number
+
+	const USHORT key_length = creation.key_length;
+	record = NULL;
+
+	for (FB_SIZE_T i = 0; i < count; i++)
+	{
+		UCHAR* const candidate = records[i];
+
+		if (!candidate)
+			continue;
+
+		if (record)
+		{
+			const int result = memcmp(candidate, record, key_length);
+
+			if (result > 0)
+				continue;
+
+			if (!result)
+			{
+				const index_sort_record* const isr1 = (index_sort_record*) (candidate + key_length);
+				const index_sort_record* const isr2 = (index_sort_record*) (record + key_length);
+
+				if (isr1->isr_record_number > isr2->isr_record_number)
+					continue;
+			}
+		}
+
+		record = candidate;
+		last = i;
+	}
+
+	return record;
+}
+
+
 static index_root_page* fetch_root(thread_db* tdbb, WIN* window, const jrd_rel* relation,
 								   const RelationPages* relPages)
 {
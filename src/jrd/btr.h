@@ -249,11 +249,16 @@ public:
 
 struct IndexCreation
 {
+	~IndexCreation();
+
+	void releaseSorts();
+
 	jrd_rel* relation;
 	index_desc* index;
 	jrd_tra* transaction;
 	USHORT key_length;
 	Firebird::AutoPtr<Sort> sort;
+	Firebird::HalfStaticArray<Sort*, 8> sortParts;	// used instead of sort if keys are sorted in parallel
 	SINT64 dup_recno;
 	SLONG duplicates;
 };
@@ -77,10 +77,6 @@ using namespace Firebird;
 IMPLEMENT_TRACE_ROUTINE(cch_trace, "CCH")
 #endif
 
-#ifdef SUPERSERVER_V2
-#define CACHE_READER
-#endif
-
 
 static inline void PAGE_LOCK_RELEASE(thread_db* tdbb, BufferControl* bcb, Lock* lock)
 {
@@ -115,16 +111,10 @@ enum LatchState
 	lsPageChanged
 };
 
-static void adjust_scan_count(WIN* window, bool mustRead);
-static BufferDesc* alloc_bdb(thread_db*, BufferControl*, UCHAR **);
+static void adjust_scan_count(thread_db* tdbb, WIN* window, bool mustRead);
+static BufferDesc* alloc_bdb(thread_db*, BufferControl*, BufferPartition*, UCHAR **);
 static Lock* alloc_page_lock(Jrd::thread_db*, BufferDesc*);
 static int blocking_ast_bdb(void*);
-#ifdef CACHE_READER
-static void prefetch_epilogue(Prefetch*, FbStatusVector *);
-static void prefetch_init(Prefetch*, thread_db*);
-static void prefetch_io(Prefetch*, FbStatusVector *);
-static void prefetch_prologue(Prefetch*, SLONG *);
-#endif
 static void check_precedence(thread_db*, WIN*, PageNumber);
 static void clear_precedence(thread_db*, BufferDesc*);
 static BufferDesc* dealloc_bdb(BufferDesc*);
@@ -137,58 +127,135 @@ static ULONG get_prec_walk_mark(BufferControl*);
 static LatchState latch_buffer(thread_db*, Sync&, BufferDesc*, const PageNumber, SyncType, int);
 static LockState lock_buffer(thread_db*, BufferDesc*, const SSHORT, const SCHAR);
 static ULONG memory_init(thread_db*, BufferControl*, SLONG);
+static void rehash_partitions(BufferControl*);
 static void page_validation_error(thread_db*, win*, SSHORT);
+static void prefetch_pages(thread_db*, const PrefetchRequest*, FB_SIZE_T);
 static void purgePrecedence(BufferControl*, BufferDesc*);
 static SSHORT related(BufferDesc*, const BufferDesc*, SSHORT, const ULONG);
 static bool writeable(BufferDesc*);
 static bool is_writeable(BufferDesc*, const ULONG);
+static void write_batch(thread_db*, BufferDesc**, FB_SIZE_T, const bool);
 static int write_buffer(thread_db*, BufferDesc*, const PageNumber, const bool, FbStatusVector* const,
 	const bool);
 static bool write_page(thread_db*, BufferDesc*, FbStatusVector* const, const bool);
 static bool set_diff_page(thread_db*, BufferDesc*);
 static void clear_dirty_flag_and_nbak_state(thread_db*, BufferDesc*);
+static void page_written(thread_db*, BufferDesc*);
 
 
 
-static inline void insertDirty(BufferControl* bcb, BufferDesc* bdb)
+static inline void insertDirty(BufferDesc* bdb)
 {
 	if (bdb->bdb_dirty.que_forward != &bdb->bdb_dirty)
 		return;
 
-	Sync dirtySync(&bcb->bcb_syncDirtyBdbs, "insertDirty");
+	BufferPartition* const bcp = bdb->bdb_partition;
+
+	Sync dirtySync(&bcp->bcp_syncDirtyBdbs, "insertDirty");
 	dirtySync.lock(SYNC_EXCLUSIVE);
 
 	if (bdb->bdb_dirty.que_forward != &bdb->bdb_dirty)
 		return;
 
-	bcb->bcb_dirty_count++;
-	QUE_INSERT(bcb->bcb_dirty, bdb->bdb_dirty);
+	bcp->bcp_dirty_count++;
+	QUE_INSERT(bcp->bcp_dirty, bdb->bdb_dirty);
 }
 
-static inline void removeDirty(BufferControl* bcb, BufferDesc* bdb)
+static inline void removeDirty(BufferDesc* bdb)
 {
 	if (bdb->bdb_dirty.que_forward == &bdb->bdb_dirty)
 		return;
 
-	Sync dirtySync(&bcb->bcb_syncDirtyBdbs, "removeDirty");
+	BufferPartition* const bcp = bdb->bdb_partition;
+
+	Sync dirtySync(&bcp->bcp_syncDirtyBdbs, "removeDirty");
 	dirtySync.lock(SYNC_EXCLUSIVE);
 
 	if (bdb->bdb_dirty.que_forward == &bdb->bdb_dirty)
 		return;
 
-	fb_assert(bcb->bcb_dirty_count > 0);
+	fb_assert(bcp->bcp_dirty_count > 0);
 
-	bcb->bcb_dirty_count--;
+	bcp->bcp_dirty_count--;
 	QUE_DELETE(bdb->bdb_dirty);
 	QUE_INIT(bdb->bdb_dirty);
 }
 
+// Slot of partition's hash table for the given page. Partition contains pages
+// with the same remainder of division by number of partitions, thus quotient
+// is used to spread pages over hash table.
+static inline que* hash_que(const BufferControl* bcb, BufferPartition* bcp, const PageNumber& page)
+{
+	return &bcp->bcp_hash[(page.getPageNum() / bcb->bcb_partition_count) % bcp->bcp_hash_size];
+}
+
+// LRU que buffer belongs to, main or probation one
+static inline que& lruQue(BufferPartition* bcp, const BufferDesc* bdb)
+{
+	return bdb->bdb_probation ? bcp->bcp_probation : bcp->bcp_in_use;
+}
+
+static inline void lruRemove(BufferPartition* bcp, BufferDesc* bdb)
+{
+	QUE_DELETE(bdb->bdb_in_use);
+
+	if (bdb->bdb_probation)
+	{
+		fb_assert(bcp->bcp_probation_count > 0);
+		bcp->bcp_probation_count--;
+		bdb->bdb_probation = false;
+	}
+}
+
+// Put buffer assigned to the page at the head of LRU que. With 2Q policy page
+// goes into probation que unless it was evicted from there not so long ago.
+static inline void lruInsert(thread_db* tdbb, BufferControl* bcb, BufferPartition* bcp,
+	BufferDesc* bdb, const PageNumber& page)
+{
+	if (bcb->bcb_flags & BCB_2q)
+	{
+		if (bcp->bcp_ghosts.remove(page))
+			tdbb->bumpStats(RuntimeStatistics::PAGE_PROMOTIONS);
+		else
+		{
+			bdb->bdb_probation = true;
+			bcp->bcp_probation_count++;
+			QUE_INSERT(bcp->bcp_probation, bdb->bdb_in_use);
+			return;
+		}
+	}
+
+	QUE_INSERT(bcp->bcp_in_use, bdb->bdb_in_use);
+}
+
+// Locks all cache partitions in exclusive mode, in order of its numbers
+class PartitionsLockGuard
+{
+public:
+	PartitionsLockGuard(BufferControl* bcb, const char* from)
+		: m_bcb(bcb)
+	{
+		for (ULONG i = 0; i < m_bcb->bcb_partition_count; i++)
+			m_bcb->bcb_partitions[i].bcp_syncObject.lock(NULL, SYNC_EXCLUSIVE, from);
+	}
+
+	~PartitionsLockGuard()
+	{
+		for (ULONG i = m_bcb->bcb_partition_count; i > 0; i--)
+			m_bcb->bcb_partitions[i - 1].bcp_syncObject.unlock(NULL, SYNC_EXCLUSIVE);
+	}
+
+private:
+	BufferControl* const m_bcb;
+};
+
 static void flushDirty(thread_db* tdbb, SLONG transaction_mask, const bool sys_only);
 static void flushAll(thread_db* tdbb, USHORT flush_flag);
 static void flushPages(thread_db* tdbb, USHORT flush_flag, BufferDesc** begin, FB_SIZE_T count);
+static void writeReady(thread_db* tdbb, USHORT flush_flag, BufferDesc** begin, FB_SIZE_T count);
 
 static void recentlyUsed(BufferDesc* bdb);
-static void requeueRecentlyUsed(BufferControl* bcb);
+static void requeueRecentlyUsed(BufferPartition* bcp);
 
 
 const ULONG MIN_BUFFER_SEGMENT = 65536;
@@ -226,9 +293,10 @@ void CCH_clean_page(thread_db* tdbb, PageNumber page)
 		return;
 
 	BufferControl* bcb = dbb->dbb_bcb;
+	BufferPartition* bcp = bcb->getPartition(page);
 	BufferDesc* bdb = NULL;
 	{
-		Sync bcbSync(&bcb->bcb_syncObject, "CCH_clean_page");
+		Sync bcbSync(&bcp->bcp_syncObject, "CCH_clean_page");
 		bcbSync.lock(SYNC_SHARED);
 
 		bdb = find_buffer(bcb, page, false);
@@ -260,21 +328,21 @@ void CCH_clean_page(thread_db* tdbb, PageNumber page)
 		bdb->bdb_mark_transaction = 0;
 
 		if (!(bdb->bdb_bcb->bcb_flags & BCB_keep_pages))
-			removeDirty(dbb->dbb_bcb, bdb);
+			removeDirty(bdb);
 
 		bdb->bdb_flags &= ~(BDB_must_write | BDB_system_dirty | BDB_db_dirty);
 		clear_dirty_flag_and_nbak_state(tdbb, bdb);
 	}
 
 	{
-		Sync lruSync(&bcb->bcb_syncLRU, "CCH_release");
+		Sync lruSync(&bcp->bcp_syncLRU, "CCH_release");
 		lruSync.lock(SYNC_EXCLUSIVE);
 
 		if (bdb->bdb_flags & BDB_lru_chained)
-			requeueRecentlyUsed(bcb);
+			requeueRecentlyUsed(bcp);
 
 		QUE_DELETE(bdb->bdb_in_use);
-		QUE_APPEND(bcb->bcb_in_use, bdb->bdb_in_use);
+		QUE_APPEND(lruQue(bcp, bdb), bdb->bdb_in_use);
 	}
 
 	bdb->release(tdbb, true);
@@ -746,7 +814,7 @@ pag* CCH_fetch(thread_db* tdbb, WIN* window, int lock_type, SCHAR page_type, int
 		return NULL;			// latch or lock timeout
 	}
 
-	adjust_scan_count(window, lockState == lsLocked);
+	adjust_scan_count(tdbb, window, lockState == lsLocked);
 
 	// Validate the fetched page matches the expected type
 
@@ -845,6 +913,9 @@ void CCH_fetch_page(thread_db* tdbb, WIN* window, const bool read_shadow)
 	pag* page = bdb->bdb_buffer;
 	bdb->bdb_incarnation = ++bcb->bcb_page_incarnation;
 
+	// Page image could be already read by cache reader using batched I/O
+	const bool preread = (bdb->bdb_flags.exchangeBitAnd(~BDB_preread) & BDB_preread) != 0;
+
 	tdbb->bumpStats(RuntimeStatistics::PAGE_READS);
 
 	PageSpace* pageSpace = dbb->dbb_page_manager.findPageSpace(bdb->bdb_page.getPageSpaceID());
@@ -876,13 +947,19 @@ void CCH_fetch_page(thread_db* tdbb, WIN* window, const bool read_shadow)
 	class Pio : public CryptoManager::IOCallback
 	{
 	public:
-		Pio(jrd_file* f, BufferDesc* b, bool tp, bool rs, PageSpace* ps)
+		Pio(jrd_file* f, BufferDesc* b, bool tp, bool rs, PageSpace* ps, bool pr)
 			: file(f), bdb(b), isTempPage(tp),
-			  read_shadow(rs), pageSpace(ps)
+			  read_shadow(rs), pageSpace(ps), preread(pr)
 		{ }
 
 		bool callback(thread_db* tdbb, FbStatusVector* status, Ods::pag* page)
 		{
+			if (preread)
+			{
+				preread = false;
+				return true;
+			}
+
 			Database *dbb = tdbb->getDatabase();
 			int retryCount = 0;
 
@@ -914,6 +991,7 @@ void CCH_fetch_page(thread_db* tdbb, WIN* window, const bool read_shadow)
 		bool isTempPage;
 		bool read_shadow;
 		PageSpace* pageSpace;
+		bool preread;
 	};
 
 	BackupManager* bm = dbb->dbb_backup_manager;
@@ -937,7 +1015,7 @@ void CCH_fetch_page(thread_db* tdbb, WIN* window, const bool read_shadow)
 			bdb->bdb_page.getPageSpaceID(), bdb->bdb_page.getPageNum(), bak_state, diff_page));
 
 		// Read page from disk as normal
-		Pio io(file, bdb, isTempPage, read_shadow, pageSpace);
+		Pio io(file, bdb, isTempPage, read_shadow, pageSpace, preread);
 		if (!dbb->dbb_crypto_manager->read(tdbb, status, page, &io))
 		{
 			if (read_shadow && !isTempPage)
@@ -968,7 +1046,7 @@ void CCH_fetch_page(thread_db* tdbb, WIN* window, const bool read_shadow)
 			NBAK_TRACE(("Re-reading page %d, state=%d, diff page=%d from DISK",
 				bdb->bdb_page, bak_state, diff_page));
 
-			Pio io(file, bdb, false, read_shadow, pageSpace);
+			Pio io(file, bdb, false, read_shadow, pageSpace, false);
 			if (!dbb->dbb_crypto_manager->read(tdbb, status, page, &io))
 			{
 				if (read_shadow)
@@ -1013,13 +1091,13 @@ void CCH_forget_page(thread_db* tdbb, WIN* window)
 
 	clear_dirty_flag_and_nbak_state(tdbb, bdb);
 	bdb->bdb_flags = 0;
-	BufferControl* bcb = dbb->dbb_bcb;
+	BufferPartition* bcp = bdb->bdb_partition;
 
-	removeDirty(bcb, bdb);
+	removeDirty(bdb);
 
-	QUE_DELETE(bdb->bdb_in_use);
+	lruRemove(bcp, bdb);
 	QUE_DELETE(bdb->bdb_que);
-	QUE_INSERT(bcb->bcb_empty, bdb->bdb_que);
+	QUE_INSERT(bcp->bcp_empty, bdb->bdb_que);
 
 	if (tdbb->tdbb_flags & TDBB_no_cache_unwind)
 		bdb->release(tdbb, true);
@@ -1061,6 +1139,13 @@ void CCH_fini(thread_db* tdbb)
 	bcb->bcb_rpt = NULL;
 	bcb->bcb_count = 0;
 
+	for (ULONG i = 0; i < bcb->bcb_partition_count; i++)
+		delete[] bcb->bcb_partitions[i].bcp_hash;
+
+	delete[] bcb->bcb_partitions;
+	bcb->bcb_partitions = NULL;
+	bcb->bcb_partition_count = 0;
+
 	while (bcb->bcb_memory.hasData())
 		bcb->bcb_bufferpool->deallocate(bcb->bcb_memory.pop());
 
@@ -1297,7 +1382,7 @@ void CCH_get_related(thread_db* tdbb, PageNumber page, PagesArray &lowPages)
 	Database* dbb = tdbb->getDatabase();
 	BufferControl* bcb = dbb->dbb_bcb;
 
-	Sync bcbSync(&bcb->bcb_syncObject, "CCH_get_related");
+	Sync bcbSync(&bcb->getPartition(page)->bcp_syncObject, "CCH_get_related");
 	bcbSync.lock(SYNC_SHARED);
 
 	BufferDesc* bdb = find_buffer(bcb, page, false);
@@ -1411,7 +1496,7 @@ pag* CCH_handoff(thread_db*	tdbb, WIN* window, ULONG page, int lock, SCHAR page_
 			bdb->downgrade(SYNC_SHARED);
 	}
 
-	adjust_scan_count(window, must_read == lsLocked);
+	adjust_scan_count(tdbb, window, must_read == lsLocked);
 
 	// Validate the fetched page matches the expected type
 
@@ -1486,16 +1571,36 @@ void CCH_init(thread_db* tdbb, ULONG number)
 	bcb->bcb_flags = shared ? BCB_exclusive : 0;
 	//bcb->bcb_flags = BCB_exclusive;	// TODO detect real state using LM
 
-	QUE_INIT(bcb->bcb_in_use);
-	QUE_INIT(bcb->bcb_dirty);
-	bcb->bcb_dirty_count = 0;
-	QUE_INIT(bcb->bcb_empty);
+	// Shared cache is split into partitions to let concurrent attachments search
+	// and replace buffers in parallel. Don't make partitions too small though.
+
+	ULONG partitions = 1;
+	if (shared)
+	{
+		partitions = dbb->dbb_config->getDbCachePartitions();
+		partitions = MIN(partitions, MAX_CACHE_PARTITIONS);
+		partitions = MIN(partitions, number / MIN_PARTITION_BUFFERS);
+		partitions = MAX(partitions, 1);
+	}
+
+	bcb->bcb_partitions = FB_NEW_POOL(*bcb->bcb_bufferpool) BufferPartition[partitions];
+	bcb->bcb_partition_count = partitions;
+
+	if (fb_utils::stricmp(dbb->dbb_config->getDbCacheReplacement(), CacheReplacement2Q) == 0)
+		bcb->bcb_flags |= BCB_2q;
 
 	// initialization of memory is system-specific
 
 	bcb->bcb_count = memory_init(tdbb, bcb, static_cast<SLONG>(number));
+	rehash_partitions(bcb);
 	bcb->bcb_free_minimum = (SSHORT) MIN(bcb->bcb_count / 4, 128);
 
+	// Read-ahead is serviced by the cache reader threads which exist
+	// in the shared cache only
+
+	if (shared)
+		bcb->bcb_prefetch_pages = MIN(dbb->dbb_config->getReadAheadPages(), bcb->bcb_count / 16);
+
 	if (bcb->bcb_count < MIN_PAGE_BUFFERS)
 		ERR_post(Arg::Gds(isc_cache_too_small));
 
@@ -1520,19 +1625,40 @@ void CCH_init2(thread_db* tdbb)
 	if (!(bcb->bcb_flags & BCB_exclusive) || (bcb->bcb_flags & (BCB_cache_writer | BCB_writer_start)))
 		return;
 
-#ifdef CACHE_READER
-	if (gds__thread_start(cache_reader, dbb, THREAD_high, 0, 0))
+	const Attachment* att = tdbb->getAttachment();
+	const int readers = dbb->dbb_config->getReadAheadThreads();
+
+	if (bcb->bcb_prefetch_pages && readers > 0 &&
+		!(bcb->bcb_flags & BCB_cache_reader) && !(att->att_flags & ATT_security_db))
 	{
-		ERR_bugcheck_msg("cannot start thread");
-	}
+		// Don't let queued read-ahead requests occupy more than a quarter of the cache
 
-	{ // scope
-		Database::Checkout dcoHolder(dbb, FB_FUNCTION);
-		dbb->dbb_reader_init.enter();
-	}
-#endif
+		const ULONG capacity = MIN(readers * PREFETCH_QUEUE_REQUESTS * bcb->bcb_prefetch_pages,
+			bcb->bcb_count / 4);
 
-	const Attachment* att = tdbb->getAttachment();
+		bcb->bcb_prefetch_queue.resize(capacity);
+		bcb->bcb_flags |= BCB_cache_reader;
+
+		for (int i = 0; i < readers; i++)
+		{
+			BufferControl::BcbThreadSync* const reader = FB_NEW_POOL(*bcb->bcb_bufferpool)
+				BufferControl::BcbThreadSync(*bcb->bcb_bufferpool, BufferControl::cache_reader, THREAD_medium);
+			bcb->bcb_reader_fini.add(reader);
+
+			try
+			{
+				reader->run(bcb);
+			}
+			catch (const Exception&)
+			{
+				bcb->bcb_reader_fini.pop();
+				delete reader;
+				ERR_bugcheck_msg("cannot start cache reader thread");
+			}
+
+			bcb->bcb_reader_init.enter();
+		}
+	}
 	if (!(dbb->dbb_flags & DBB_read_only) && !(att->att_flags & ATT_security_db))
 	{
 		// writer startup in progress
@@ -1634,7 +1760,7 @@ void CCH_mark(thread_db* tdbb, WIN* window, bool mark_system, bool must_write)
 	bdb->bdb_flags |= newFlags;
 
 	if (!(tdbb->tdbb_flags & TDBB_sweeper) || (bdb->bdb_flags & BDB_system_dirty))
-		insertDirty(bcb, bdb);
+		insertDirty(bdb);
 
 	bdb->bdb_flags |= BDB_marked | BDB_dirty;
 }
@@ -1722,8 +1848,7 @@ void CCH_precedence(thread_db* tdbb, WIN* window, PageNumber page)
 }
 
 
-#ifdef CACHE_READER
-void CCH_prefetch(thread_db* tdbb, SLONG* pages, SSHORT count)
+void CCH_prefetch(thread_db* tdbb, USHORT pageSpaceId, const ULONG* pages, FB_SIZE_T count)
 {
 /**************************************
  *
@@ -1732,15 +1857,14 @@ void CCH_prefetch(thread_db* tdbb, SLONG* pages, SSHORT count)
  **************************************
  *
  * Functional description
- *	Given a vector of pages, set corresponding bits
- *	in global prefetch bitmap. Initiate an asynchronous
- *	I/O and get the cache reader reading in our behalf
- *	as well.
+ *	Given a vector of pages, queue the ones not yet
+ *	in the cache for asynchronous read by the cache
+ *	reader threads.
  *
  **************************************/
 	SET_TDBB(tdbb);
-	Database* dbb = tdbb->getDatabase();
-	BufferControl* bcb = dbb->dbb_bcb;
+	Database* const dbb = tdbb->getDatabase();
+	BufferControl* const bcb = dbb->dbb_bcb;
 
 	if (!count || !(bcb->bcb_flags & BCB_cache_reader))
 	{
@@ -1748,60 +1872,76 @@ void CCH_prefetch(thread_db* tdbb, SLONG* pages, SSHORT count)
 		return;
 	}
 
-	// Switch default pool to permanent pool for setting bits in prefetch bitmap.
-	Jrd::ContextPoolHolder context(tdbb, bcb->bcb_bufferpool);
+	// Don't bother cache readers with pages which are already in the cache
 
-	// The global prefetch bitmap is the key to the I/O coalescense mechanism which dovetails
-	// all thread prefetch requests to minimize sequential I/O requests.
-	// It also enables multipage I/O by implicitly sorting page vector requests.
+	HalfStaticArray<ULONG, 64> missing;
 
-	SLONG first_page = 0;
-	for (const SLONG* const end = pages + count; pages < end;)
+	for (const ULONG* const end = pages + count; pages < end; pages++)
 	{
-		const SLONG page = *pages++;
-		if (page)
-		{
-			SBM_set(tdbb, &bcb->bcb_prefetch, page);
-			if (!first_page)
-				first_page = page;
-		}
+		if (!*pages)
+			continue;
+
+		const PageNumber page(pageSpaceId, *pages);
+
+		Sync bcbSync(&bcb->getPartition(page)->bcp_syncObject, "CCH_prefetch");
+		bcbSync.lock(SYNC_SHARED);
+
+		if (!find_buffer(bcb, page, true))
+			missing.add(*pages);
 	}
 
-	// Not likely that the caller's page vector was empty but check anyway.
+	if (missing.isEmpty())
+		return;
+
+	// Misses of the cache readers are counted on the attachment asked for the pages
 
-	if (first_page)
+	PrefetchMisses* requester = NULL;
+	Attachment* const attachment = tdbb->getAttachment();
+
+	if (attachment)
 	{
-		prf prefetch;
+		if (!attachment->att_prefetch_misses)
+			attachment->att_prefetch_misses = FB_NEW PrefetchMisses;
 
-		prefetch_init(&prefetch, tdbb);
-		prefetch_prologue(&prefetch, &first_page);
-		prefetch_io(&prefetch, tdbb->tdbb_status_vector);
-		prefetch_epilogue(&prefetch, tdbb->tdbb_status_vector);
+		requester = attachment->att_prefetch_misses;
+
+		const ULONG misses = requester->misses.exchange(0);
+		if (misses)
+			tdbb->bumpStats(RuntimeStatistics::PAGE_PREFETCH_MISSES, misses);
 	}
-}
 
+	FB_SIZE_T queued = 0;
 
-bool CCH_prefetch_pages(thread_db* tdbb)
-{
-/**************************************
- *
- *	C C H _ p r e f e t c h _ p a g e s
- *
- **************************************
- *
- * Functional description
- *	Check the prefetch bitmap for a set
- *	of pages and read them into the cache.
- *
- **************************************/
+	{ // scope
+		MutexLockGuard guard(bcb->bcb_prefetchMutex, FB_FUNCTION);
 
-	// Placeholder to be implemented when predictive prefetch is
-	// enabled. This is called by VIO/garbage_collector() when it
-	// is idle to help satisfy the prefetch demand.
+		const ULONG capacity = bcb->bcb_prefetch_queue.getCount();
 
-	return false;
+		// If the queue is full then the cache readers are lagging behind,
+		// the rest of the pages will be read on demand
+
+		for (; queued < missing.getCount() && bcb->bcb_prefetch_count < capacity; queued++)
+		{
+			const ULONG pos = (bcb->bcb_prefetch_head + bcb->bcb_prefetch_count++) % capacity;
+			PrefetchRequest& request = bcb->bcb_prefetch_queue[pos];
+			request.page = PageNumber(pageSpaceId, missing[queued]);
+			request.requester = requester;
+
+			if (requester)
+				requester->addRef();
+		}
+	}
+
+	if (queued < missing.getCount())
+		tdbb->bumpStats(RuntimeStatistics::PAGE_PREFETCH_MISSES, missing.getCount() - queued);
+
+	if (queued)
+	{
+		// Counted when queued, the cache readers count misses only
+		tdbb->bumpStats(RuntimeStatistics::PAGE_PREFETCHES, queued);
+		bcb->bcb_reader_sem.release();
+	}
 }
-#endif // CACHE_READER
 
 
 bool set_diff_page(thread_db* tdbb, BufferDesc* bdb)
@@ -1949,7 +2089,7 @@ void CCH_release(thread_db* tdbb, WIN* window, const bool release_tail)
 
 			if (!write_buffer(tdbb, bdb, bdb->bdb_page, false, tdbb->tdbb_status_vector, true))
 			{
-				insertDirty(bcb, bdb);
+				insertDirty(bdb);
 				CCH_unwind(tdbb, true);
 			}
 		}
@@ -1992,23 +2132,25 @@ void CCH_release(thread_db* tdbb, WIN* window, const bool release_tail)
 				if (window->win_flags & WIN_garbage_collector)
 					bdb->bdb_flags &= ~BDB_garbage_collect;
 
-				{ // bcb_syncLRU scope
-					Sync lruSync(&bcb->bcb_syncLRU, "CCH_release");
+				{ // bcp_syncLRU scope
+					BufferPartition* const bcp = bdb->bdb_partition;
+
+					Sync lruSync(&bcp->bcp_syncLRU, "CCH_release");
 					lruSync.lock(SYNC_EXCLUSIVE);
 
 					if (bdb->bdb_flags & BDB_lru_chained)
 					{
-						requeueRecentlyUsed(bcb);
+						requeueRecentlyUsed(bcp);
 					}
 
 					QUE_DELETE(bdb->bdb_in_use);
-					QUE_APPEND(bcb->bcb_in_use, bdb->bdb_in_use);
+					QUE_APPEND(lruQue(bcp, bdb), bdb->bdb_in_use);
 				}
 
 				if ((bcb->bcb_flags & BCB_cache_writer) &&
 					(bdb->bdb_flags & (BDB_dirty | BDB_db_dirty)) )
 				{
-					insertDirty(bcb, bdb);
+					insertDirty(bdb);
 
 					bcb->bcb_flags |= BCB_free_pending;
 					if (!(bcb->bcb_flags & BCB_writer_active))
@@ -2101,16 +2243,32 @@ void CCH_shutdown(thread_db* tdbb)
 	if (!bcb)
 		return;
 
-#ifdef CACHE_READER
-	// Shutdown the dedicated cache reader for this database
+	// Shutdown the dedicated cache readers for this database
 
 	if (bcb->bcb_flags & BCB_cache_reader)
 	{
 		bcb->bcb_flags &= ~BCB_cache_reader;
-		dbb->dbb_reader_sem.release();
-		dbb->dbb_reader_fini.enter();
+		bcb->bcb_reader_sem.release(bcb->bcb_reader_fini.getCount()); // Wake up running threads
+
+		for (FB_SIZE_T i = 0; i < bcb->bcb_reader_fini.getCount(); i++)
+		{
+			bcb->bcb_reader_fini[i]->waitForCompletion();
+			delete bcb->bcb_reader_fini[i];
+		}
+
+		bcb->bcb_reader_fini.clear();
+
+		// Forget read-ahead requests not served
+
+		for (; bcb->bcb_prefetch_count; bcb->bcb_prefetch_count--)
+		{
+			PrefetchRequest& request = bcb->bcb_prefetch_queue[bcb->bcb_prefetch_head];
+			bcb->bcb_prefetch_head = (bcb->bcb_prefetch_head + 1) % bcb->bcb_prefetch_queue.getCount();
+
+			if (request.requester)
+				request.requester->release();
+		}
 	}
-#endif
 
 	// Wait for cache writer startup to complete
 
@@ -2420,7 +2578,7 @@ bool CCH_write_all_shadows(thread_db* tdbb, Shadow* shadow, BufferDesc* bdb, Ods
 }
 
 
-static void adjust_scan_count(WIN* window, bool mustRead)
+static void adjust_scan_count(thread_db* tdbb, WIN* window, bool mustRead)
 {
 /**************************************
  *
@@ -2428,6 +2586,7 @@ static void adjust_scan_count(WIN* window, bool mustRead)
  *
  **************************************/
 	BufferDesc* bdb = window->win_bdb;
+	const bool prefetched = (bdb->bdb_flags & BDB_prefetch);
 
 	// If a page was read or prefetched on behalf of a large scan
 	// then load the window scan count into the buffer descriptor.
@@ -2439,7 +2598,7 @@ static void adjust_scan_count(WIN* window, bool mustRead)
 
 	if (window->win_flags & WIN_large_scan)
 	{
-		if (mustRead || (bdb->bdb_flags & BDB_prefetch) || bdb->bdb_scan_count < 0)
+		if (mustRead || prefetched || bdb->bdb_scan_count < 0)
 			bdb->bdb_scan_count = window->win_scans;
 	}
 	else if (window->win_flags & WIN_garbage_collector)
@@ -2461,10 +2620,18 @@ static void adjust_scan_count(WIN* window, bool mustRead)
 		if (bdb->bdb_flags & BDB_garbage_collect)
 			bdb->bdb_flags &= ~BDB_garbage_collect;
 	}
+
+	// First reference of a page read by the cache reader
+
+	if (prefetched && !mustRead)
+	{
+		bdb->bdb_flags &= ~BDB_prefetch;
+		tdbb->bumpStats(RuntimeStatistics::PAGE_PREFETCH_HITS);
+	}
 }
 
 
-static BufferDesc* alloc_bdb(thread_db* tdbb, BufferControl* bcb, UCHAR** memory)
+static BufferDesc* alloc_bdb(thread_db* tdbb, BufferControl* bcb, BufferPartition* bcp, UCHAR** memory)
 {
 /**************************************
  *
@@ -2478,7 +2645,7 @@ static BufferDesc* alloc_bdb(thread_db* tdbb, BufferControl* bcb, UCHAR** memory
  **************************************/
 	SET_TDBB(tdbb);
 
-	BufferDesc* bdb = FB_NEW_POOL(*bcb->bcb_bufferpool) BufferDesc(bcb);
+	BufferDesc* bdb = FB_NEW_POOL(*bcb->bcb_bufferpool) BufferDesc(bcb, bcp);
 
 	try {
 		bdb->bdb_lock = alloc_page_lock(tdbb, bdb);
@@ -2492,7 +2659,8 @@ static BufferDesc* alloc_bdb(thread_db* tdbb, BufferControl* bcb, UCHAR** memory
 	bdb->bdb_buffer = (pag*) *memory;
 	*memory += bcb->bcb_page_size;
 
-	QUE_INSERT(bcb->bcb_empty, bdb->bdb_que);
+	QUE_INSERT(bcp->bcp_empty, bdb->bdb_que);
+	bcp->bcp_count++;
 
 	return bdb;
 }
@@ -2610,19 +2778,22 @@ static void flushDirty(thread_db* tdbb, SLONG transaction_mask, const bool sys_o
 	BufferControl* bcb = dbb->dbb_bcb;
 	Firebird::HalfStaticArray<BufferDesc*, 1024> flush;
 
-	{  // dirtySync scope
-		Sync dirtySync(&bcb->bcb_syncDirtyBdbs, "flushDirty");
+	for (ULONG i = 0; i < bcb->bcb_partition_count; i++)
+	{
+		BufferPartition* const bcp = &bcb->bcb_partitions[i];
+
+		Sync dirtySync(&bcp->bcp_syncDirtyBdbs, "flushDirty");
 		dirtySync.lock(SYNC_EXCLUSIVE);
 
-		QUE que_inst = bcb->bcb_dirty.que_forward, next;
-		for (; que_inst != &bcb->bcb_dirty; que_inst = next)
+		QUE que_inst = bcp->bcp_dirty.que_forward, next;
+		for (; que_inst != &bcp->bcp_dirty; que_inst = next)
 		{
 			next = que_inst->que_forward;
 			BufferDesc* bdb = BLOCK(que_inst, BufferDesc, bdb_dirty);
 
 			if (!(bdb->bdb_flags & BDB_dirty))
 			{
-				removeDirty(bcb, bdb);
+				removeDirty(bdb);
 				continue;
 			}
 
@@ -2648,7 +2819,12 @@ static void flushAll(thread_db* tdbb, USHORT flush_flag)
 	SET_TDBB(tdbb);
 	Database* dbb = tdbb->getDatabase();
 	BufferControl* bcb = dbb->dbb_bcb;
-	Firebird::HalfStaticArray<BufferDesc*, 1024> flush(bcb->bcb_dirty_count);
+
+	SLONG dirty_count = 0;
+	for (ULONG i = 0; i < bcb->bcb_partition_count; i++)
+		dirty_count += bcb->bcb_partitions[i].bcp_dirty_count;
+
+	Firebird::HalfStaticArray<BufferDesc*, 1024> flush(dirty_count);
 
 	const bool all_flag = (flush_flag & FLUSH_ALL) != 0;
 	const bool sweep_flag = (flush_flag & FLUSH_SWEEP) != 0;
@@ -2713,16 +2889,22 @@ extern "C" {
 // no such pages (i.e. all of not written yet pages have high precedence pages)
 // then write them all at last iteration (of course write_buffer will also check
 // for precedence before write).
+// Pages ready to be written are collected and written together to let batched
+// I/O submit them at once, see writeReady.
 static void flushPages(thread_db* tdbb, USHORT flush_flag, BufferDesc** begin, FB_SIZE_T count)
 {
-	FbStatusVector* const status = tdbb->tdbb_status_vector;
-	const bool all_flag = (flush_flag & FLUSH_ALL) != 0;
+	Database* const dbb = tdbb->getDatabase();
 	const bool release_flag = (flush_flag & FLUSH_RLSE) != 0;
-	const bool write_thru = release_flag;
+	const SyncType syncType = release_flag ? SYNC_EXCLUSIVE : SYNC_SHARED;
+
+	// Don't hold more latches than batched I/O is able to use
+	const PageSpace* const pageSpace = dbb->dbb_page_manager.findPageSpace(DB_PAGE_SPACE);
+	const FB_SIZE_T maxReady = MAX(PIO_get_batch_size(tdbb, pageSpace->file), 1);
 
 	qsort(begin, count, sizeof(BufferDesc*), cmpBdbs);
 
 	MarkIterator<BufferDesc*> iter(begin, count);
+	HalfStaticArray<BufferDesc*, 64> ready;
 
 	FB_SIZE_T written = 0;
 	bool writeAll = false;
@@ -2737,7 +2919,16 @@ static void flushPages(thread_db* tdbb, USHORT flush_flag, BufferDesc** begin, F
 			if (!bdb)
 				continue;
 
-			bdb->addRef(tdbb, release_flag ? SYNC_EXCLUSIVE : SYNC_SHARED);
+			// Never wait for a latch while holding latches of ready pages,
+			// write them first
+
+			if (!bdb->addRefConditional(tdbb, syncType))
+			{
+				writeReady(tdbb, flush_flag, ready.begin(), ready.getCount());
+				ready.clear();
+
+				bdb->addRef(tdbb, syncType);
+			}
 
 			BufferControl* bcb = bdb->bdb_bcb;
 			if (!writeAll)
@@ -2751,19 +2942,14 @@ static void flushPages(thread_db* tdbb, USHORT flush_flag, BufferDesc** begin, F
 						BUGCHECK(210);	// msg 210 page in use during flush
 				}
 
-				if (!all_flag || bdb->bdb_flags & (BDB_db_dirty | BDB_dirty))
+				ready.add(bdb);
+
+				if (ready.getCount() >= maxReady)
 				{
-					if (!write_buffer(tdbb, bdb, bdb->bdb_page, write_thru, status, true))
-						CCH_unwind(tdbb, true);
+					writeReady(tdbb, flush_flag, ready.begin(), ready.getCount());
+					ready.clear();
 				}
 
-				// release lock before losing control over bdb, it prevents
-				// concurrent operations on released lock
-				if (release_flag)
-					PAGE_LOCK_RELEASE(tdbb, bcb, bdb->bdb_lock);
-
-				bdb->release(tdbb, !release_flag && !(bdb->bdb_flags & BDB_dirty));
-
 				iter.mark();
 				found = true;
 				written++;
@@ -2774,6 +2960,9 @@ static void flushPages(thread_db* tdbb, USHORT flush_flag, BufferDesc** begin, F
 			}
 		}
 
+		writeReady(tdbb, flush_flag, ready.begin(), ready.getCount());
+		ready.clear();
+
 		if (!found)
 			writeAll = true;
 
@@ -2784,7 +2973,39 @@ static void flushPages(thread_db* tdbb, USHORT flush_flag, BufferDesc** begin, F
 }
 
 
-#ifdef CACHE_READER
+// Write latched pages collected by flushPages and release them. Pages which
+// need nothing but plain write to the database file are written at once by
+// write_batch, the rest is written by write_buffer one by one.
+static void writeReady(thread_db* tdbb, USHORT flush_flag, BufferDesc** begin, FB_SIZE_T count)
+{
+	FbStatusVector* const status = tdbb->tdbb_status_vector;
+	const bool all_flag = (flush_flag & FLUSH_ALL) != 0;
+	const bool release_flag = (flush_flag & FLUSH_RLSE) != 0;
+	const bool write_thru = release_flag;
+
+	write_batch(tdbb, begin, count, write_thru);
+
+	for (BufferDesc** const end = begin + count; begin < end; begin++)
+	{
+		BufferDesc* const bdb = *begin;
+		BufferControl* const bcb = bdb->bdb_bcb;
+
+		if (!all_flag || bdb->bdb_flags & (BDB_db_dirty | BDB_dirty))
+		{
+			if (!write_buffer(tdbb, bdb, bdb->bdb_page, write_thru, status, true))
+				CCH_unwind(tdbb, true);
+		}
+
+		// release lock before losing control over bdb, it prevents
+		// concurrent operations on released lock
+		if (release_flag)
+			PAGE_LOCK_RELEASE(tdbb, bcb, bdb->bdb_lock);
+
+		bdb->release(tdbb, !release_flag && !(bdb->bdb_flags & BDB_dirty));
+	}
+}
+
+
 void BufferControl::cache_reader(BufferControl* bcb)
 {
 /**************************************
@@ -2794,149 +3015,111 @@ void BufferControl::cache_reader(BufferControl* bcb)
  **************************************
  *
  * Functional description
- *	Prefetch pages into cache for sequential scans.
- *	Use asynchronous I/O to keep two prefetch requests
- *	busy at a time.
+ *	Read pages queued by sequential scans into the cache
+ *	ahead of their use.
  *
  **************************************/
-	Database* dbb = bcb->bcb_database;
-	Database::SyncGuard dsGuard(dbb);
-
 	FbLocalStatus status_vector;
+	Database* const dbb = bcb->bcb_database;
+	bool started = false;
 
-	// Establish a thread context.
-	ThreadContextHolder tdbb(status_vector);
-
-	// Dummy attachment needed for lock owner identification.
-	tdbb->setDatabase(dbb);
-	Jrd::Attachment* const attachment = Attachment::create(dbb, nullptr);
-	tdbb->setAttachment(attachment);
-	attachment->att_filename = dbb->dbb_filename;
-	Jrd::ContextPoolHolder context(tdbb, bcb->bcb_bufferpool);
-
-	// This try block is specifically to protect the LCK_init call: if
-	// LCK_init fails we won't be able to accomplish anything anyway, so
-	// return, unlike the other try blocks further down the page.
-
-	BufferControl* bcb = NULL;
-
-	try {
-
-		LCK_init(tdbb, LCK_OWNER_attachment);
-		TRA_init(attachment);
-		bcb = dbb->dbb_bcb;
-		bcb->bcb_flags |= BCB_cache_reader;
-		dbb->dbb_reader_init.post();	// Notify our creator that we have started
-	}
-	catch (const Firebird::Exception& ex)
+	try
 	{
-		ex.stuffException(status_vector);
-		iscDbLogStatus(dbb->dbb_filename.c_str(), status_vector);
-		return 0;
-	}
+		UserId user;
+		user.setUserName("Cache Reader");
 
-	try {
+		Jrd::Attachment* const attachment = Jrd::Attachment::create(dbb);
+		RefPtr<SysStableAttachment> sAtt(FB_NEW SysStableAttachment(attachment));
+		attachment->setStable(sAtt);
+		attachment->att_filename = dbb->dbb_filename;
+		attachment->att_user = &user;
 
-	// Set up dual prefetch control blocks to keep multiple prefetch
-	// requests active at a time. Also helps to prevent the cache reader
-	// from becoming dedicated or locked into a single request's prefetch demands.
+		BackgroundContextHolder tdbb(dbb, attachment, &status_vector, FB_FUNCTION);
 
-	prf prefetch1, prefetch2;
-	prefetch_init(&prefetch1, tdbb);
-	prefetch_init(&prefetch2, tdbb);
+		try
+		{
+			LCK_init(tdbb, LCK_OWNER_attachment);
+			PAG_attachment_id(tdbb);
+			TRA_init(attachment);
 
-	while (bcb->bcb_flags & BCB_cache_reader)
-	{
-		bcb->bcb_flags |= BCB_reader_active;
-		bool found = false;
-		SLONG starting_page = -1;
-		prf* next_prefetch = &prefetch1;
+			Monitoring::publishAttachment(tdbb);
 
-		if (dbb->dbb_flags & DBB_suspend_bgio)
-		{
-			Database::Checkout dcoHolder(dbb, FB_FUNCTION);
-			dbb->dbb_reader_sem.tryEnter(10);
-			continue;
-		}
+			sAtt->initDone();
 
-		// Make a pass thru the global prefetch bitmap looking for something
-		// to read. When the entire bitmap has been scanned and found to be
-		// empty then wait for new requests.
+			// Notify our creator that we have started
+			started = true;
+			bcb->bcb_reader_init.release();
 
-		do {
-			if (!(prefetch1.prf_flags & PRF_active) &&
-				SBM_next(bcb->bcb_prefetch, &starting_page, RSE_get_forward))
+			while (bcb->bcb_flags & BCB_cache_reader)
 			{
-				found = true;
-				prefetch_prologue(&prefetch1, &starting_page);
-				prefetch_io(&prefetch1, status_vector);
-			}
+				if (dbb->dbb_flags & DBB_suspend_bgio)
+				{
+					EngineCheckout cout(tdbb, FB_FUNCTION);
+					bcb->bcb_reader_sem.tryEnter(10);
+					continue;
+				}
 
-			if (!(prefetch2.prf_flags & PRF_active) &&
-				SBM_next(bcb->bcb_prefetch, &starting_page, RSE_get_forward))
-			{
-				found = true;
-				prefetch_prologue(&prefetch2, &starting_page);
-				prefetch_io(&prefetch2, status_vector);
-			}
+				PrefetchRequest requests[PREFETCH_BATCH_PAGES];
+				FB_SIZE_T count = 0;
 
-			prf* post_prefetch = next_prefetch;
-			next_prefetch = (post_prefetch == &prefetch1) ? &prefetch2 : &prefetch1;
+				{ // scope
+					MutexLockGuard guard(bcb->bcb_prefetchMutex, FB_FUNCTION);
 
-			if (post_prefetch->prf_flags & PRF_active)
-				prefetch_epilogue(post_prefetch, status_vector);
+					while (bcb->bcb_prefetch_count && count < PREFETCH_BATCH_PAGES)
+					{
+						requests[count++] = bcb->bcb_prefetch_queue[bcb->bcb_prefetch_head];
+						bcb->bcb_prefetch_head = (bcb->bcb_prefetch_head + 1) % bcb->bcb_prefetch_queue.getCount();
+						bcb->bcb_prefetch_count--;
+					}
+				}
 
-			if (found)
-			{
-				// If the cache writer or garbage collector is idle, put
-				// them to work prefetching pages.
-#ifdef CACHE_WRITER
-				if ((bcb->bcb_flags & BCB_cache_writer) && !(bcb->bcb_flags & BCB_writer_active))
-					dbb_writer_sem.release();
-#endif
-#ifdef GARBAGE_THREAD
-				if ((dbb->dbb_flags & DBB_garbage_collector) && !(dbb->dbb_flags & DBB_gc_active))
-					dbb->dbb_gc_sem.release();
-#endif
-			}
-		} while (prefetch1.prf_flags & PRF_active || prefetch2.prf_flags & PRF_active);
+				// If there's nothing to read, wait for event notification
 
-		// If there's more work to do voluntarily ask to be rescheduled.
-		// Otherwise, wait for event notification.
-		BufferDesc* bdb;
-		if (found)
-			JRD_reschedule(tdbb, 0, true);
-		else if (bcb->bcb_flags & BCB_free_pending &&
-			(bdb = get_buffer(tdbb, FREE_PAGE, LATCH_none, 1)))
-		{
-			// In our spare time, help writer clean the cache.
+				if (count)
+				{
+					prefetch_pages(tdbb, requests, count);
 
-			write_buffer(tdbb, bdb, bdb->bdb_page, true, status_vector, true);
+					for (FB_SIZE_T i = 0; i < count; i++)
+					{
+						if (requests[i].requester)
+							requests[i].requester->release();
+					}
+				}
+				else
+				{
+					EngineCheckout cout(tdbb, FB_FUNCTION);
+					bcb->bcb_reader_sem.tryEnter(10);
+				}
+			}
 		}
-		else
+		catch (const Firebird::Exception& ex)
 		{
-			bcb->bcb_flags &= ~BCB_reader_active;
-			Database::Checkout dcoHolder(dbb, FB_FUNCTION);
-			dbb->dbb_reader_sem.tryEnter(10);
+			ex.stuffException(&status_vector);
+			iscDbLogStatus(dbb->dbb_filename.c_str(), &status_vector);
+			// continue execution to clean up
 		}
-		bcb = dbb->dbb_bcb;
-	}
 
-	LCK_fini(tdbb, LCK_OWNER_attachment);
-	Jrd::Attachment::destroy(attachment);	// no need saving warning error strings here
-	tdbb->setAttachment(NULL);
-	bcb->bcb_flags &= ~BCB_cache_reader;
-	dbb->dbb_reader_fini.post();
+		Monitoring::cleanupAttachment(tdbb);
+		attachment->releaseLocks(tdbb);
+		LCK_fini(tdbb, LCK_OWNER_attachment);
 
+		attachment->releaseRelations(tdbb);
 	}	// try
 	catch (const Firebird::Exception& ex)
 	{
-		ex.stuffException(status_vector);
-		iscDbLogStatus(dbb->dbb_filename.c_str(), status_vector);
+		bcb->exceptionHandler(ex, cache_reader);
+	}
+
+	try
+	{
+		if (!started)
+			bcb->bcb_reader_init.release();
+	}
+	catch (const Firebird::Exception& ex)
+	{
+		bcb->exceptionHandler(ex, cache_reader);
 	}
-	return 0;
 }
-#endif
 
 
 void BufferControl::cache_writer(BufferControl* bcb)
@@ -2987,9 +3170,6 @@ void BufferControl::cache_writer(BufferControl* bcb)
 			while (bcb->bcb_flags & BCB_cache_writer)
 			{
 				bcb->bcb_flags |= BCB_writer_active;
-#ifdef CACHE_READER
-				SLONG starting_page = -1;
-#endif
 
 				if (dbb->dbb_flags & DBB_suspend_bgio)
 				{
@@ -3022,19 +3202,6 @@ void BufferControl::cache_writer(BufferControl* bcb)
 				{
 					JRD_reschedule(tdbb, 0, true);
 				}
-#ifdef CACHE_READER
-				else if (SBM_next(bcb->bcb_prefetch, &starting_page, RSE_get_forward))
-				{
-					// Prefetch some pages in our spare time and in the process
-					// garbage collect the prefetch bitmap.
-					prf prefetch;
-
-					prefetch_init(&prefetch, tdbb);
-					prefetch_prologue(&prefetch, &starting_page);
-					prefetch_io(&prefetch, status_vector);
-					prefetch_epilogue(&prefetch, status_vector);
-				}
-#endif
 				else
 				{
 					bcb->bcb_flags &= ~BCB_writer_active;
@@ -3139,7 +3306,7 @@ static void check_precedence(thread_db* tdbb, WIN* window, PageNumber page)
 
 	// Start by finding the buffer containing the high priority page
 
-	Sync bcbSync(&bcb->bcb_syncObject, "check_precedence");
+	Sync bcbSync(&bcb->getPartition(page)->bcp_syncObject, "check_precedence");
 	bcbSync.lock(SYNC_SHARED);
 
 	BufferDesc* high = find_buffer(bcb, page, false);
@@ -3288,6 +3455,7 @@ static BufferDesc* dealloc_bdb(BufferDesc* bdb)
 	{
 		delete bdb->bdb_lock;
 		QUE_DELETE(bdb->bdb_que);
+		bdb->bdb_partition->bcp_count--;
 
 		delete bdb;
 	}
@@ -3530,6 +3698,15 @@ static bool expand_buffers(thread_db* tdbb, ULONG number)
 	Sync syncBcb(&bcb->bcb_syncObject, "expand_buffers");
 	syncBcb.lock(SYNC_EXCLUSIVE);
 
+	// Cache could be expanded by another thread while we waited for the lock
+
+	if (number <= bcb->bcb_count)
+		return false;
+
+	// New buffers are added to all partitions and then partitions are rehashed
+
+	PartitionsLockGuard partitionsGuard(bcb, "expand_buffers");
+
 	// for Win16 platform, we want to ensure that no cache buffer ever ends on a segment boundary
 	// CVC: Is this code obsolete or only the comment?
 
@@ -3550,27 +3727,12 @@ static bool expand_buffers(thread_db* tdbb, ULONG number)
 
 	const bcb_repeat* const new_end = bcb->bcb_rpt + number;
 
-	// Initialize tail of new buffer control block
-	bcb_repeat* new_tail;
-	for (new_tail = bcb->bcb_rpt; new_tail < new_end; new_tail++)
-		QUE_INIT(new_tail->bcb_page_mod);
-
 	// Move any active buffers from old block to new
 
-	new_tail = bcb->bcb_rpt;
+	bcb_repeat* new_tail = bcb->bcb_rpt;
 
-	for (bcb_repeat* old_tail = old_rpt; old_tail < old_end; old_tail++, new_tail++)
-	{
+	for (const bcb_repeat* old_tail = old_rpt; old_tail < old_end; old_tail++, new_tail++)
 		new_tail->bcb_bdb = old_tail->bcb_bdb;
-		while (QUE_NOT_EMPTY(old_tail->bcb_page_mod))
-		{
-			QUE que_inst = old_tail->bcb_page_mod.que_forward;
-			BufferDesc* bdb = BLOCK(que_inst, BufferDesc, bdb_que);
-			QUE_DELETE(*que_inst);
-			QUE mod_que = &bcb->bcb_rpt[bdb->bdb_page.getPageNum() % bcb->bcb_count].bcb_page_mod;
-			QUE_INSERT(*mod_que, *que_inst);
-		}
-	}
 
 	// Allocate new buffer descriptor blocks
 
@@ -3592,7 +3754,9 @@ static bool expand_buffers(thread_db* tdbb, ULONG number)
 			if (num_per_seg > left_to_do)
 				num_per_seg = left_to_do;
 		}
-		new_tail->bcb_bdb = alloc_bdb(tdbb, bcb, &memory);
+		BufferPartition* const bcp =
+			&bcb->bcb_partitions[(new_tail - bcb->bcb_rpt) % bcb->bcb_partition_count];
+		new_tail->bcb_bdb = alloc_bdb(tdbb, bcb, bcp, &memory);
 		num_in_seg--;
 	}
 
@@ -3600,12 +3764,17 @@ static bool expand_buffers(thread_db* tdbb, ULONG number)
 
 	delete[] old_rpt;
 
+	rehash_partitions(bcb);
+
 	return true;
 }
 
 static BufferDesc* find_buffer(BufferControl* bcb, const PageNumber page, bool findPending)
 {
-	QUE mod_que = &bcb->bcb_rpt[page.getPageNum() % bcb->bcb_count].bcb_page_mod;
+	BufferPartition* const bcp = bcb->getPartition(page);
+	fb_assert(bcp->bcp_syncObject.isLocked());
+
+	QUE mod_que = hash_que(bcb, bcp, page);
 	QUE que_inst = mod_que->que_forward;
 	for (; que_inst != mod_que; que_inst = que_inst->que_forward)
 	{
@@ -3616,8 +3785,8 @@ static BufferDesc* find_buffer(BufferControl* bcb, const PageNumber page, bool f
 
 	if (findPending)
 	{
-		que_inst = bcb->bcb_pending.que_forward;
-		for (; que_inst != &bcb->bcb_pending; que_inst = que_inst->que_forward)
+		que_inst = bcp->bcp_pending.que_forward;
+		for (; que_inst != &bcp->bcp_pending; que_inst = que_inst->que_forward)
 		{
 			BufferDesc* bdb = BLOCK(que_inst, BufferDesc, bdb_que);
 			if (bdb->bdb_page == page || bdb->bdb_pending_page == page)
@@ -3716,67 +3885,33 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 	Database* dbb = tdbb->getDatabase();
 	BufferControl* bcb = dbb->dbb_bcb;
 
-	Sync bcbSync(&bcb->bcb_syncObject, "get_buffer");
-	if (page != FREE_PAGE)
-	{
-		bcbSync.lock(SYNC_SHARED);
-		BufferDesc* bdb = find_buffer(bcb, page, true);
-		while (bdb)
-		{
-			const LatchState ret = latch_buffer(tdbb, bcbSync, bdb, page, syncType, wait);
-			if (ret == lsOk)
-			{
-				tdbb->bumpStats(RuntimeStatistics::PAGE_FETCHES);
-				return bdb;
-			}
-
-			if (ret == lsTimeout)
-				return NULL;
+	// Every partition keeps its share of clean buffers
+	const int free_minimum = MAX(bcb->bcb_free_minimum / (int) bcb->bcb_partition_count, 1);
 
-			bcbSync.lock(SYNC_SHARED);
-			bdb = find_buffer(bcb, page, true);
-		}
-		bcbSync.unlock();
-	}
-
-	bcbSync.lock(SYNC_EXCLUSIVE);
-
-	QUE que_inst;
-	int walk = bcb->bcb_free_minimum;
-	while (true)
+	if (page == FREE_PAGE)
 	{
-		if (page != FREE_PAGE)
-		{
-			// Check to see if buffer has already been assigned to page
-			BufferDesc* bdb = find_buffer(bcb, page, true);
-			while (bdb)
-			{
-				const LatchState ret = latch_buffer(tdbb, bcbSync, bdb, page, syncType, wait);
-				if (ret == lsOk)
-				{
-					tdbb->bumpStats(RuntimeStatistics::PAGE_FETCHES);
-					return bdb;
-				}
+		// This code is only used by the background I/O threads:
+		// cache writer, cache reader and garbage collector.
+		// Look at LRU tails of all partitions, starting from the next one
+		// after the partition looked at first last time.
 
-				if (ret == lsTimeout)
-					return NULL;
+		//Database::Checkout dcoHolder(dbb);
 
-				bcbSync.lock(SYNC_EXCLUSIVE);
-				bdb = find_buffer(bcb, page, true);
-			}
-		}
-		else // page == FREE_PAGE
+		const ULONG first = bcb->bcb_writer_partition++;
+
+		for (ULONG n = 0; n < bcb->bcb_partition_count; n++)
 		{
-			// This code is only used by the background I/O threads:
-			// cache writer, cache reader and garbage collector.
+			BufferPartition* const bcp = &bcb->bcb_partitions[(first + n) % bcb->bcb_partition_count];
 
-			//Database::Checkout dcoHolder(dbb);
+			Sync bcbSync(&bcp->bcp_syncObject, "get_buffer");
+			bcbSync.lock(SYNC_EXCLUSIVE);
 
-			Sync lruSync(&bcb->bcb_syncLRU, "get_buffer");
+			Sync lruSync(&bcp->bcp_syncLRU, "get_buffer");
 			lruSync.lock(SYNC_EXCLUSIVE);
 
-			for (que_inst = bcb->bcb_in_use.que_backward;
-				 que_inst != &bcb->bcb_in_use; que_inst = que_inst->que_backward)
+			int walk = free_minimum;
+			for (QUE que_inst = bcp->bcp_in_use.que_backward;
+				 que_inst != &bcp->bcp_in_use; que_inst = que_inst->que_backward)
 			{
 				BufferDesc* bdb = BLOCK(que_inst, BufferDesc, bdb_in_use);
 
@@ -3790,53 +3925,94 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 				}
 
 				if (!--walk)
-				{
-					bcb->bcb_flags &= ~BCB_free_pending;
 					break;
-				}
 			}
+		}
+
+		// hvlad: removed in Vulcan
+		bcb->bcb_flags &= ~BCB_free_pending;
+		return NULL;
+	}
 
-			// hvlad: removed in Vulcan
-			bcb->bcb_flags &= ~BCB_free_pending;
+	BufferPartition* const bcp = bcb->getPartition(page);
+
+	Sync bcbSync(&bcp->bcp_syncObject, "get_buffer");
+	bcbSync.lock(SYNC_SHARED);
+	BufferDesc* bdb = find_buffer(bcb, page, true);
+	while (bdb)
+	{
+		const LatchState ret = latch_buffer(tdbb, bcbSync, bdb, page, syncType, wait);
+		if (ret == lsOk)
+		{
+			tdbb->bumpStats(RuntimeStatistics::PAGE_FETCHES);
+			return bdb;
+		}
+
+		if (ret == lsTimeout)
 			return NULL;
+
+		bcbSync.lock(SYNC_SHARED);
+		bdb = find_buffer(bcb, page, true);
+	}
+	bcbSync.unlock();
+
+	bcbSync.lock(SYNC_EXCLUSIVE);
+
+	QUE que_inst;
+	int walk = free_minimum;
+	while (true)
+	{
+		// Check to see if buffer has already been assigned to page
+		bdb = find_buffer(bcb, page, true);
+		while (bdb)
+		{
+			const LatchState ret = latch_buffer(tdbb, bcbSync, bdb, page, syncType, wait);
+			if (ret == lsOk)
+			{
+				tdbb->bumpStats(RuntimeStatistics::PAGE_FETCHES);
+				return bdb;
+			}
+
+			if (ret == lsTimeout)
+				return NULL;
+
+			bcbSync.lock(SYNC_EXCLUSIVE);
+			bdb = find_buffer(bcb, page, true);
 		}
 
 		// If there is an empty buffer sitting around, allocate it
 
-		if (QUE_NOT_EMPTY(bcb->bcb_empty))
+		if (QUE_NOT_EMPTY(bcp->bcp_empty))
 		{
-			que_inst = bcb->bcb_empty.que_forward;
+			que_inst = bcp->bcp_empty.que_forward;
 			QUE_DELETE(*que_inst);
-			BufferDesc* bdb = BLOCK(que_inst, BufferDesc, bdb_que);
+			bdb = BLOCK(que_inst, BufferDesc, bdb_que);
 
 			bcb->bcb_inuse++;
 			bdb->addRef(tdbb, SYNC_EXCLUSIVE);
 
-			if (page != FREE_PAGE)
-			{
-				QUE mod_que = &bcb->bcb_rpt[page.getPageNum() % bcb->bcb_count].bcb_page_mod;
-				QUE_INSERT(*mod_que, *que_inst);
+			QUE mod_que = hash_que(bcb, bcp, page);
+			QUE_INSERT(*mod_que, *que_inst);
 #ifdef SUPERSERVER_V2
-				// Reserve a buffer for header page with deferred header
-				// page write mechanism. Otherwise, a deadlock will occur
-				// if all dirty pages in the cache must force header page
-				// to disk before they can be written but there is no free
-				// buffer to read the header page into.
+			// Reserve a buffer for header page with deferred header
+			// page write mechanism. Otherwise, a deadlock will occur
+			// if all dirty pages in the cache must force header page
+			// to disk before they can be written but there is no free
+			// buffer to read the header page into.
 
-				if (page != HEADER_PAGE_NUMBER)
+			if (page != HEADER_PAGE_NUMBER)
 #endif
-				{
-					Sync lruSync(&bcb->bcb_syncLRU, "get_buffer");
-					lruSync.lock(SYNC_EXCLUSIVE);
+			{
+				Sync lruSync(&bcp->bcp_syncLRU, "get_buffer");
+				lruSync.lock(SYNC_EXCLUSIVE);
 
-					QUE_INSERT(bcb->bcb_in_use, bdb->bdb_in_use);
-				}
+				lruInsert(tdbb, bcb, bcp, bdb, page);
 			}
 
 			// This correction for bdb_use_count below is needed to
 			// avoid a deadlock situation in latching code.  It's not
 			// clear though how the bdb_use_count can get < 0 for a bdb
-			// in bcb_empty queue
+			// in bcp_empty queue
 
 			if (bdb->bdb_use_count < 0)
 				BUGCHECK(301);	// msg 301 Non-zero use_count of a buffer in the empty que_inst
@@ -3845,183 +4021,201 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 			bdb->bdb_flags = BDB_read_pending;	// we have buffer exclusively, this is safe
 			bdb->bdb_scan_count = 0;
 
-			if (page != FREE_PAGE)
-			{
-				CCH_TRACE(("bdb->bdb_lock->lck_logical = LCK_none; page=%i", bdb->bdb_page.getPageNum()));
-				bdb->bdb_lock->lck_logical = LCK_none;
-			}
-			else
-				PAGE_LOCK_RELEASE(tdbb, bcb, bdb->bdb_lock);
+			CCH_TRACE(("bdb->bdb_lock->lck_logical = LCK_none; page=%i", bdb->bdb_page.getPageNum()));
+			bdb->bdb_lock->lck_logical = LCK_none;
 
 			tdbb->bumpStats(RuntimeStatistics::PAGE_FETCHES);
 			return bdb;
 		}
 
-		Sync lruSync(&bcb->bcb_syncLRU, "get_buffer");
+		Sync lruSync(&bcp->bcp_syncLRU, "get_buffer");
 		lruSync.lock(SYNC_EXCLUSIVE);
 
-		if (bcb->bcb_lru_chain.load() != NULL)
-			requeueRecentlyUsed(bcb);
+		if (bcp->bcp_lru_chain.load() != NULL)
+			requeueRecentlyUsed(bcp);
 
-		for (que_inst = bcb->bcb_in_use.que_backward;
-			 que_inst != &bcb->bcb_in_use;
-			 que_inst = que_inst->que_backward)
-		{
-			// get the oldest buffer as the least recently used -- note
-			// that since there are no empty buffers this queue cannot be empty
-
-			if (bcb->bcb_in_use.que_forward == &bcb->bcb_in_use)
-				BUGCHECK(213);	// msg 213 insufficient cache size
-
-			BufferDesc* oldest = BLOCK(que_inst, BufferDesc, bdb_in_use);
+		// With 2Q policy buffers are taken from probation que first while it
+		// holds more than a quarter of partition buffers
 
-			if (oldest->bdb_flags & BDB_lru_chained)
-				continue;
+		QUE lru_ques[2] = {&bcp->bcp_in_use, NULL};
+		if (bcb->bcb_flags & BCB_2q)
+		{
+			const bool probation_first = (bcp->bcp_probation_count > bcp->bcp_count / 4);
+			lru_ques[0] = probation_first ? &bcp->bcp_probation : &bcp->bcp_in_use;
+			lru_ques[1] = probation_first ? &bcp->bcp_in_use : &bcp->bcp_probation;
+		}
 
-			if (oldest->bdb_use_count || !oldest->addRefConditional(tdbb, SYNC_EXCLUSIVE))
-				continue;
+		bool exhausted = true;
+		for (int n = 0; n < 2 && lru_ques[n] && exhausted; n++)
+		{
+			QUE lru_que = lru_ques[n];
 
-			if ((oldest->bdb_flags & BDB_free_pending) || !writeable(oldest))
+			for (que_inst = lru_que->que_backward;
+				 que_inst != lru_que;
+				 que_inst = que_inst->que_backward)
 			{
-				oldest->release(tdbb, true);
-				continue;
-			}
+				// get the oldest buffer as the least recently used -- note
+				// that since there are no empty buffers this queue cannot be empty
 
-#ifdef SUPERSERVER_V2
-			// If page has been prefetched but not yet fetched, let
-			// it cycle once more thru LRU queue before re-using it.
+				if (lru_que->que_forward == lru_que)
+					BUGCHECK(213);	// msg 213 insufficient cache size
 
-			if (oldest->bdb_flags & BDB_prefetch)
-			{
-				oldest->bdb_flags &= ~BDB_prefetch;
-				que_inst = que_inst->que_forward;
-				QUE_MOST_RECENTLY_USED(oldest->bdb_in_use);
-				//LATCH_MUTEX_RELEASE;
-				continue;
-			}
-#endif
+				BufferDesc* oldest = BLOCK(que_inst, BufferDesc, bdb_in_use);
 
-			if ((bcb->bcb_flags & BCB_cache_writer) &&
-				(oldest->bdb_flags & (BDB_dirty | BDB_db_dirty)) )
-			{
-				bcb->bcb_flags |= BCB_free_pending;
+				if (oldest->bdb_flags & BDB_lru_chained)
+					continue;
 
-				if (!(bcb->bcb_flags & BCB_writer_active))
-					bcb->bcb_writer_sem.release();
+				if (oldest->bdb_use_count || !oldest->addRefConditional(tdbb, SYNC_EXCLUSIVE))
+					continue;
 
-				if (walk)
+				if ((oldest->bdb_flags & BDB_free_pending) || !writeable(oldest))
 				{
 					oldest->release(tdbb, true);
-					if (!--walk)
-						break;
-
 					continue;
 				}
-			}
 
-			BufferDesc* bdb = oldest;
+				if ((bcb->bcb_flags & BCB_cache_writer) &&
+					(oldest->bdb_flags & (BDB_dirty | BDB_db_dirty)) )
+				{
+					bcb->bcb_flags |= BCB_free_pending;
 
-			// hvlad: we already have bcb_lruSync here
-			//recentlyUsed(bdb);
-			fb_assert(!(bdb->bdb_flags & BDB_lru_chained));
-			QUE_DELETE(bdb->bdb_in_use);
-			QUE_INSERT(bcb->bcb_in_use, bdb->bdb_in_use);
+					if (!(bcb->bcb_flags & BCB_writer_active))
+						bcb->bcb_writer_sem.release();
 
-			lruSync.unlock();
+					if (walk)
+					{
+						oldest->release(tdbb, true);
+						if (!--walk)
+						{
+							exhausted = false;
+							break;
+						}
 
-			bdb->bdb_flags |= BDB_free_pending;
-			bdb->bdb_pending_page = page;
+						continue;
+					}
+				}
 
-			QUE_DELETE(bdb->bdb_que);
-			QUE_INSERT(bcb->bcb_pending, bdb->bdb_que);
+				bdb = oldest;
 
-			const bool needCleanup = (bdb->bdb_flags & (BDB_dirty | BDB_db_dirty)) ||
-				QUE_NOT_EMPTY(bdb->bdb_higher) || QUE_NOT_EMPTY(bdb->bdb_lower);
+				// hvlad: we already have bcb_lruSync here
+				//recentlyUsed(bdb);
+				fb_assert(!(bdb->bdb_flags & BDB_lru_chained));
 
-			if (needCleanup)
-			{
-				bcbSync.unlock();
+				// Page evicted from probation que is remembered to be
+				// promoted to the main que if it's read again soon
+
+				if (bdb->bdb_probation)
+					bcp->bcp_ghosts.add(bdb->bdb_page);
+
+				lruRemove(bcp, bdb);
+				lruInsert(tdbb, bcb, bcp, bdb, page);
+				tdbb->bumpStats(RuntimeStatistics::PAGE_EVICTIONS);
 
-				// If the buffer selected is dirty, arrange to have it written.
+				lruSync.unlock();
 
-				if (bdb->bdb_flags & (BDB_dirty | BDB_db_dirty))
+				bdb->bdb_flags |= BDB_free_pending;
+				bdb->bdb_pending_page = page;
+
+				QUE_DELETE(bdb->bdb_que);
+				QUE_INSERT(bcp->bcp_pending, bdb->bdb_que);
+
+				const bool needCleanup = (bdb->bdb_flags & (BDB_dirty | BDB_db_dirty)) ||
+					QUE_NOT_EMPTY(bdb->bdb_higher) || QUE_NOT_EMPTY(bdb->bdb_lower);
+
+				if (needCleanup)
 				{
-					const bool write_thru = (bcb->bcb_flags & BCB_exclusive);
-					if (!write_buffer(tdbb, bdb, bdb->bdb_page, write_thru, tdbb->tdbb_status_vector, true))
+					bcbSync.unlock();
+
+					// If the buffer selected is dirty, arrange to have it written.
+
+					if (bdb->bdb_flags & (BDB_dirty | BDB_db_dirty))
 					{
-						bcbSync.lock(SYNC_EXCLUSIVE);
-						bdb->bdb_flags &= ~BDB_free_pending;
-						QUE_DELETE(bdb->bdb_in_use);
-						QUE_APPEND(bcb->bcb_in_use, bdb->bdb_in_use);
-						bcbSync.unlock();
-
-						bdb->release(tdbb, true);
-						CCH_unwind(tdbb, true);
+						const bool write_thru = (bcb->bcb_flags & BCB_exclusive);
+						if (!write_buffer(tdbb, bdb, bdb->bdb_page, write_thru, tdbb->tdbb_status_vector, true))
+						{
+							bcbSync.lock(SYNC_EXCLUSIVE);
+							bdb->bdb_flags &= ~BDB_free_pending;
+							QUE_DELETE(bdb->bdb_in_use);
+							QUE_APPEND(lruQue(bcp, bdb), bdb->bdb_in_use);
+							bcbSync.unlock();
+
+							bdb->release(tdbb, true);
+							CCH_unwind(tdbb, true);
+						}
 					}
-				}
-
-				// If the buffer is still in the dirty tree, remove it.
-				// In any case, release any lock it may have.
 
-				removeDirty(bcb, bdb);
+					// If the buffer is still in the dirty tree, remove it.
+					// In any case, release any lock it may have.
 
-				// Cleanup any residual precedence blocks.  Unless something is
-				// screwed up, the only precedence blocks that can still be hanging
-				// around are ones cleared at AST level.
+					removeDirty(bdb);
 
-				if (QUE_NOT_EMPTY(bdb->bdb_higher) || QUE_NOT_EMPTY(bdb->bdb_lower))
-				{
-					Sync precSync(&bcb->bcb_syncPrecedence, "get_buffer");
-					precSync.lock(SYNC_EXCLUSIVE);
+					// Cleanup any residual precedence blocks.  Unless something is
+					// screwed up, the only precedence blocks that can still be hanging
+					// around are ones cleared at AST level.
 
-					while (QUE_NOT_EMPTY(bdb->bdb_higher))
+					if (QUE_NOT_EMPTY(bdb->bdb_higher) || QUE_NOT_EMPTY(bdb->bdb_lower))
 					{
-						QUE que2 = bdb->bdb_higher.que_forward;
-						Precedence* precedence = BLOCK(que2, Precedence, pre_higher);
-						QUE_DELETE(precedence->pre_higher);
-						QUE_DELETE(precedence->pre_lower);
-						precedence->pre_hi = (BufferDesc*) bcb->bcb_free;
-						bcb->bcb_free = precedence;
+						Sync precSync(&bcb->bcb_syncPrecedence, "get_buffer");
+						precSync.lock(SYNC_EXCLUSIVE);
+
+						while (QUE_NOT_EMPTY(bdb->bdb_higher))
+						{
+							QUE que2 = bdb->bdb_higher.que_forward;
+							Precedence* precedence = BLOCK(que2, Precedence, pre_higher);
+							QUE_DELETE(precedence->pre_higher);
+							QUE_DELETE(precedence->pre_lower);
+							precedence->pre_hi = (BufferDesc*) bcb->bcb_free;
+							bcb->bcb_free = precedence;
+						}
+
+						clear_precedence(tdbb, bdb);
 					}
 
-					clear_precedence(tdbb, bdb);
+					bcbSync.lock(SYNC_EXCLUSIVE);
 				}
 
-				bcbSync.lock(SYNC_EXCLUSIVE);
-			}
-
-			QUE_DELETE(bdb->bdb_que);	// bcb_pending
+				QUE_DELETE(bdb->bdb_que);	// bcp_pending
 
-			QUE mod_que = &bcb->bcb_rpt[page.getPageNum() % bcb->bcb_count].bcb_page_mod;
-			QUE_INSERT((*mod_que), bdb->bdb_que);
-			bdb->bdb_flags &= ~BDB_free_pending;
+				QUE mod_que = hash_que(bcb, bcp, page);
+				QUE_INSERT((*mod_que), bdb->bdb_que);
+				bdb->bdb_flags &= ~BDB_free_pending;
 
-			// This correction for bdb_use_count below is needed to
-			// avoid a deadlock situation in latching code.  It's not
-			// clear though how the bdb_use_count can get < 0 for a bdb
-			// in bcb_empty queue
+				// This correction for bdb_use_count below is needed to
+				// avoid a deadlock situation in latching code.  It's not
+				// clear though how the bdb_use_count can get < 0 for a bdb
+				// in bcp_empty queue
 
-			if (bdb->bdb_use_count < 0)
-				BUGCHECK(301);	/* msg 301 Non-zero use_count of a buffer in the empty Que */
+				if (bdb->bdb_use_count < 0)
+					BUGCHECK(301);	/* msg 301 Non-zero use_count of a buffer in the empty Que */
 
-			bdb->bdb_page = page;
-			bdb->bdb_flags &= BDB_lru_chained; // yes, clear all except BDB_lru_chained
-			bdb->bdb_flags |= BDB_read_pending;
-			bdb->bdb_scan_count = 0;
+				bdb->bdb_page = page;
+				bdb->bdb_flags &= BDB_lru_chained; // yes, clear all except BDB_lru_chained
+				bdb->bdb_flags |= BDB_read_pending;
+				bdb->bdb_scan_count = 0;
 
-			bcbSync.unlock();
+				bcbSync.unlock();
 
-			if (page != FREE_PAGE)
 				bdb->bdb_lock->lck_logical = LCK_none;
-			else
-				PAGE_LOCK_RELEASE(tdbb, bcb, bdb->bdb_lock);
 
-			tdbb->bumpStats(RuntimeStatistics::PAGE_FETCHES);
-			return bdb;
+				tdbb->bumpStats(RuntimeStatistics::PAGE_FETCHES);
+				return bdb;
+			}
+
 		}
 
-		if (que_inst == &bcb->bcb_in_use)
-			expand_buffers(tdbb, bcb->bcb_count + 75);
+		if (exhausted)
+		{
+			// expand_buffers locks all partitions, release ours to not deadlock
+			// with concurrent expansion. New buffers are spread over partitions
+			// so add enough of them to get some into this partition.
+
+			lruSync.unlock();
+			bcbSync.unlock();
+
+			expand_buffers(tdbb, bcb->bcb_count + 75 * bcb->bcb_partition_count);
+
+			bcbSync.lock(SYNC_EXCLUSIVE);
+		}
 	}
 }
 
@@ -4321,11 +4515,11 @@ static ULONG memory_init(thread_db* tdbb, BufferControl* bcb, SLONG number)
 			old_buffers = buffers;
 		}
 
-		QUE_INIT(tail->bcb_page_mod);
-
 		try
 		{
-			tail->bcb_bdb = alloc_bdb(tdbb, bcb, &memory);
+			BufferPartition* const bcp =
+				&bcb->bcb_partitions[(tail - bcb->bcb_rpt) % bcb->bcb_partition_count];
+			tail->bcb_bdb = alloc_bdb(tdbb, bcb, bcp, &memory);
 		}
 		catch (Firebird::BadAlloc&)
 		{
@@ -4361,6 +4555,60 @@ static ULONG memory_init(thread_db* tdbb, BufferControl* bcb, SLONG number)
 }
 
 
+static void rehash_partitions(BufferControl* bcb)
+{
+/**************************************
+ *
+ *	r e h a s h _ p a r t i t i o n s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Resize hash tables of cache partitions to match the number
+ *	of buffers in every partition and move buffers into new tables.
+ *	Partitions must be locked by the caller or not used yet.
+ *
+ **************************************/
+	for (ULONG i = 0; i < bcb->bcb_partition_count; i++)
+	{
+		BufferPartition* const bcp = &bcb->bcb_partitions[i];
+
+		const ULONG new_size = MAX(bcp->bcp_count, 1);
+		if (new_size == bcp->bcp_hash_size)
+			continue;
+
+		// 2Q keeps numbers of pages evicted from probation que for the half of buffers
+
+		if (bcb->bcb_flags & BCB_2q)
+			bcp->bcp_ghosts.resize(*bcb->bcb_bufferpool, MAX(new_size / 2, 1));
+
+		que* const new_hash = FB_NEW_POOL(*bcb->bcb_bufferpool) que[new_size];
+		for (ULONG n = 0; n < new_size; n++)
+			QUE_INIT(new_hash[n]);
+
+		que* const old_hash = bcp->bcp_hash;
+		const ULONG old_size = bcp->bcp_hash_size;
+
+		bcp->bcp_hash = new_hash;
+		bcp->bcp_hash_size = new_size;
+
+		for (que* old_que = old_hash; old_que < old_hash + old_size; old_que++)
+		{
+			while (QUE_NOT_EMPTY(*old_que))
+			{
+				QUE que_inst = old_que->que_forward;
+				BufferDesc* bdb = BLOCK(que_inst, BufferDesc, bdb_que);
+				QUE_DELETE(*que_inst);
+				QUE mod_que = hash_que(bcb, bcp, bdb->bdb_page);
+				QUE_INSERT(*mod_que, *que_inst);
+			}
+		}
+
+		delete[] old_hash;
+	}
+}
+
+
 static void page_validation_error(thread_db* tdbb, WIN* window, SSHORT type)
 {
 /**************************************
@@ -4396,198 +4644,102 @@ static void page_validation_error(thread_db* tdbb, WIN* window, SSHORT type)
 }
 
 
-#ifdef CACHE_READER
-static void prefetch_epilogue(Prefetch* prefetch, FbStatusVector* status_vector)
+static void prefetch_pages(thread_db* tdbb, const PrefetchRequest* requests, FB_SIZE_T count)
 {
 /**************************************
  *
- *	p r e f e t c h _ e p i l o g u e
+ *	p r e f e t c h _ p a g e s
  *
  **************************************
  *
  * Functional description
- *	Stall on asynchronous I/O completion.
- *	Move data from prefetch buffer to database
- *	buffers, compute the checksum, and release
- *	the latch.
+ *	Read pages queued for read-ahead into the cache.
+ *	Never wait for a busy buffer - if somebody holds it
+ *	then the page is already being read or used.
+ *	Pages of the main database file are read at once by
+ *	batched I/O, then handed to CCH_fetch_page as usual.
+ *	Misses are counted on behalf of the requesters.
  *
  **************************************/
-	if (!(prefetch->prf_flags & PRF_active))
-		return;
-
-	thread_db* tdbb = prefetch->prf_tdbb;
-	Database* dbb = tdbb->getDatabase();
+	Database* const dbb = tdbb->getDatabase();
 
-	prefetch->prf_piob.piob_wait = TRUE;
-	const bool async_status = PIO_status(dbb, &prefetch->prf_piob, status_vector);
+	fb_assert(count <= PREFETCH_BATCH_PAGES);
 
-	// If there was an I/O error release all buffer latches acquired for the prefetch request.
+	win_for_array windows[PREFETCH_BATCH_PAGES];
+	PageIo batch[PREFETCH_BATCH_PAGES];
+	FB_SIZE_T locked = 0, batched = 0;
 
-	if (!async_status)
+	for (FB_SIZE_T i = 0; i < count; i++)
 	{
-		BufferDesc** next_bdb = prefetch->prf_bdbs;
-		for (USHORT i = 0; i < prefetch->prf_max_prefetch; i++)
-		{
-			if (*next_bdb)
-				release_bdb(tdbb, *next_bdb, true, false, false);
-
-			next_bdb++;
-		}
-		prefetch->prf_flags &= ~PRF_active;
-		return;
-	}
+		WIN& window = windows[locked];
+		window.win_page = requests[i].page;
+		PrefetchMisses* const requester = requests[i].requester;
 
-	const SCHAR* next_buffer = prefetch->prf_io_buffer;
-	BufferDesc** next_bdb = prefetch->prf_bdbs;
-
-	for (USHORT i = 0; i < prefetch->prf_max_prefetch; i++)
-	{
-		if (*next_bdb)
+		switch (CCH_fetch_lock(tdbb, &window, LCK_read, LCK_NO_WAIT, pag_undefined))
 		{
-			pag* page = (*next_bdb)->bdb_buffer;
-			if (next_buffer != reinterpret_cast<char*>(page))
-				memcpy(page, next_buffer, (ULONG) dbb->dbb_page_size);
+		case lsLocked:
+			locked++;
 
-			if (page->pag_pageno == (*next_bdb)->bdb_page.getPageNum())
+			if (window.win_page.getPageSpaceID() == DB_PAGE_SPACE)
 			{
-				(*next_bdb)->bdb_flags &= ~(BDB_read_pending | BDB_not_valid);
-				(*next_bdb)->bdb_flags |= BDB_prefetch;
+				batch[batched].pio_bdb = window.win_bdb;
+				batch[batched].pio_page = window.win_buffer;
+				batched++;
 			}
+			break;
 
-			release_bdb(tdbb, *next_bdb, true, false, false);
-		}
+		case lsLockedHavePage:
+			// Demand read was faster than us
+			CCH_RELEASE(tdbb, &window);
+			if (requester)
+				requester->misses++;
+			break;
 
-		next_buffer += dbb->dbb_page_size;
-		next_bdb++;
+		default:
+			// Buffer is busy or the page lock can't be granted right now
+			if (requester)
+				requester->misses++;
+			break;
+		}
 	}
 
-	prefetch->prf_flags &= ~PRF_active;
-}
-
-
-static void prefetch_init(Prefetch* prefetch, thread_db* tdbb)
-{
-/**************************************
- *
- *	p r e f e t c h _ i n i t
- *
- **************************************
- *
- * Functional description
- *	Initialize prefetch data structure.
- *	Most systems that allow access to "raw" I/O
- *	interfaces want the buffer address aligned.
- *
- **************************************/
-	Database* dbb = tdbb->getDatabase();
-
-	prefetch->prf_tdbb = tdbb;
-	prefetch->prf_flags = 0;
-	prefetch->prf_max_prefetch = PREFETCH_MAX_TRANSFER / dbb->dbb_page_size;
-	prefetch->prf_aligned_buffer =
-		(SCHAR*) (((U_IPTR) &prefetch->prf_unaligned_buffer + MIN_PAGE_SIZE - 1) &
-		~((U_IPTR) MIN_PAGE_SIZE - 1));
-}
-
-
-static void prefetch_io(Prefetch* prefetch, FbStatusVector* status_vector)
-{
-/**************************************
- *
- *	p r e f e t c h _ i o
- *
- **************************************
- *
- * Functional description
- *	Queue an asynchronous I/O to read
- *	multiple pages into prefetch buffer.
- *
- **************************************/
-	thread_db* tdbb = prefetch->prf_tdbb;
-	Database* dbb = tdbb->getDatabase();
-
-	if (!prefetch->prf_page_count)
-		prefetch->prf_flags &= ~PRF_active;
-	else
+	if (batched > 1 && dbb->dbb_backup_manager->getState() == Ods::hdr_nbak_normal)
 	{
-		// Get the cache reader working on our behalf too
+		PageSpace* const pageSpace = dbb->dbb_page_manager.findPageSpace(DB_PAGE_SPACE);
+		PIO_read_pages(tdbb, pageSpace->file, batch, batched);
 
-		if (!(dbb->dbb_bcb->bcb_flags & BCB_reader_active))
-			dbb->dbb_reader_sem.post();
-
-		const bool async_status =
-			PIO_read_ahead(dbb, prefetch->prf_start_page, prefetch->prf_io_buffer,
-						   prefetch->prf_page_count, &prefetch->prf_piob, status_vector);
-		if (!async_status)
+		for (FB_SIZE_T i = 0; i < batched; i++)
 		{
-			BufferDesc** next_bdb = prefetch->prf_bdbs;
-			for (USHORT i = 0; i < prefetch->prf_max_prefetch; i++)
-			{
-				if (*next_bdb)
-					release_bdb(tdbb, *next_bdb, true, false, false);
-
-				next_bdb++;
-			}
-			prefetch->prf_flags &= ~PRF_active;
+			if (batch[i].pio_done)
+				batch[i].pio_bdb->bdb_flags |= BDB_preread;
 		}
 	}
-}
-
 
-static void prefetch_prologue(Prefetch* prefetch, SLONG* start_page)
-{
-/**************************************
- *
- *	p r e f e t c h _ p r o l o g u e
- *
- **************************************
- *
- * Functional description
- *	Search for consecutive pages to be prefetched
- *	and latch them for I/O.
- *
- **************************************/
-	thread_db* tdbb = prefetch->prf_tdbb;
-	Database* dbb = tdbb->getDatabase();
-	BufferControl* bcb = dbb->dbb_bcb;
-
-	prefetch->prf_start_page = *start_page;
-	prefetch->prf_page_count = 0;
-	prefetch->prf_flags |= PRF_active;
-
-	BufferDesc** next_bdb = prefetch->prf_bdbs;
-	for (USHORT i = 0; i < prefetch->prf_max_prefetch; i++)
+	for (FB_SIZE_T i = 0; i < locked; i++)
 	{
-		*next_bdb = 0;
-		if (SBM_clear(bcb->bcb_prefetch, *start_page) &&
-			(*next_bdb = get_buffer(tdbb, *start_page, LATCH_shared, 0)))
+		WIN& window = windows[i];
+
+		try
 		{
-			if ((*next_bdb)->bdb_flags & BDB_read_pending)
-				prefetch->prf_page_count = i + 1;
-			else
-			{
-				release_bdb(tdbb, *next_bdb, true, false, false);
-				*next_bdb = 0;
-			}
+			CCH_fetch_page(tdbb, &window, true);
 		}
+		catch (const Firebird::Exception&)
+		{
+			// All our buffers are released by CCH_unwind and stay marked as
+			// read pending, so the I/O error will be reported by the demand read.
+			// Forget about pages read in advance, buffers may get other pages.
+			for (FB_SIZE_T j = i; j < locked; j++)
+				windows[j].win_bdb->bdb_flags &= ~BDB_preread;
 
-		next_bdb++;
-		(*start_page)++;
-	}
-
-	// Optimize non-sequential list prefetching to transfer directly to database buffers.
-
-	BufferDesc* bdb;
-	if (prefetch->prf_page_count == 1 && (bdb = prefetch->prf_bdbs[0]))
-		prefetch->prf_io_buffer = reinterpret_cast<char*>(bdb->bdb_buffer);
-	else
-		prefetch->prf_io_buffer = prefetch->prf_aligned_buffer;
-
-	// Reset starting page for next bitmap walk
+			fb_utils::init_status(tdbb->tdbb_status_vector);
+			return;
+		}
 
-	--(*start_page);
+		window.win_bdb->bdb_flags |= BDB_prefetch;
+		window.win_bdb->downgrade(SYNC_SHARED);
+		CCH_RELEASE(tdbb, &window);
+	}
 }
-#endif // CACHE_READER
 
 
 static SSHORT related(BufferDesc* low, const BufferDesc* high, SSHORT limit, const ULONG mark)
@@ -4717,6 +4869,100 @@ static bool is_writeable(BufferDesc* bdb, const ULONG mark)
 }
 
 
+static void write_batch(thread_db* tdbb, BufferDesc** begin, FB_SIZE_T count, const bool write_thru)
+{
+/**************************************
+ *
+ *	w r i t e _ b a t c h
+ *
+ **************************************
+ *
+ * Functional description
+ *	Write a set of latched dirty buffers submitting all writes
+ *	at once. Only pages of the main database file which need
+ *	nothing but plain write are handled here - no precedence,
+ *	shadows, difference file or encryption. Buffers which are
+ *	not written stay dirty and are written by write_buffer.
+ *
+ **************************************/
+	Database* const dbb = tdbb->getDatabase();
+
+	if (count < 2 || dbb->dbb_shadow)
+		return;
+
+	CryptoManager* const cryptoManager = dbb->dbb_crypto_manager;
+	HalfStaticArray<PageIo, 64> pages;
+
+	for (BufferDesc** const end = begin + count; begin < end; begin++)
+	{
+		BufferDesc* const bdb = *begin;
+
+		if (bdb->bdb_page.getPageSpaceID() != DB_PAGE_SPACE || bdb->bdb_page == HEADER_PAGE_NUMBER)
+			continue;
+
+		bdb->lockIO(tdbb);
+
+		// Dirty page holds nbackup state lock, thus backup state can't
+		// change until it is written
+
+		pag* const page = bdb->bdb_buffer;
+		const AtomicCounter::counter_type flags = bdb->bdb_flags;
+
+		if ((flags & (BDB_dirty | BDB_nbak_state_lock)) != (BDB_dirty | BDB_nbak_state_lock) ||
+			(flags & (BDB_marked | BDB_not_valid)) ||
+			QUE_NOT_EMPTY(bdb->bdb_higher) || !cryptoManager->isPlainWrite(page))
+		{
+			bdb->unLockIO(tdbb);
+			continue;
+		}
+
+		PageIo& io = pages.add();
+		io.pio_bdb = bdb;
+		io.pio_page = page;
+		io.pio_done = false;
+	}
+
+	const bool submit =
+		pages.getCount() > 1 && dbb->dbb_backup_manager->getState() == Ods::hdr_nbak_normal;
+
+	if (submit)
+	{
+		for (PageIo* io = pages.begin(); io < pages.end(); io++)
+		{
+			io->pio_page->pag_generation++;
+			io->pio_page->pag_pageno = io->pio_bdb->bdb_page.getPageNum();
+			io->pio_page->pag_flags &= ~Ods::crypted_page;
+		}
+
+		PageSpace* const pageSpace = dbb->dbb_page_manager.findPageSpace(DB_PAGE_SPACE);
+		PIO_write_pages(tdbb, pageSpace->file, pages.begin(), pages.getCount());
+	}
+
+	for (PageIo* io = pages.begin(); io < pages.end(); io++)
+	{
+		BufferDesc* const bdb = io->pio_bdb;
+
+		if (io->pio_done)
+		{
+			tdbb->bumpStats(RuntimeStatistics::PAGE_WRITES);
+
+			bdb->bdb_flags &= ~BDB_db_dirty;
+			page_written(tdbb, bdb);
+		}
+		else if (submit)
+		{
+			// Page is not written, write_page will increment generation again
+			io->pio_page->pag_generation--;
+		}
+
+		bdb->unLockIO(tdbb);
+
+		if (io->pio_done)
+			clear_precedence(tdbb, bdb);
+	}
+}
+
+
 static int write_buffer(thread_db* tdbb,
 						BufferDesc* bdb,
 						const PageNumber page,
@@ -5054,34 +5300,50 @@ static bool write_page(thread_db* tdbb, BufferDesc* bdb, FbStatusVector* const s
 		dbb->dbb_flags |= DBB_suspend_bgio;
 	}
 	else
-	{
-		// clear the dirty bit vector, since the buffer is now
-		// clean regardless of which transactions have modified it
+		page_written(tdbb, bdb);
 
-		// Destination difference page number is only valid between MARK and
-		// write_page so clean it now to avoid confusion
-		bdb->bdb_difference_page = 0;
-		bdb->bdb_transactions = 0;
-		bdb->bdb_mark_transaction = 0;
+	return result;
+}
 
-		if (!(bdb->bdb_bcb->bcb_flags & BCB_keep_pages))
-			removeDirty(bdb->bdb_bcb, bdb);
 
-		bdb->bdb_flags &= ~(BDB_must_write | BDB_system_dirty);
-		clear_dirty_flag_and_nbak_state(tdbb, bdb);
+static void page_written(thread_db* tdbb, BufferDesc* bdb)
+{
+/**************************************
+ *
+ *	p a g e _ w r i t t e n
+ *
+ **************************************
+ *
+ * Functional description
+ *	Mark buffer as clean after its page was successfully
+ *	written to disk.
+ *
+ **************************************/
 
-		if (bdb->bdb_flags & BDB_io_error)
-		{
-			// If a write error has cleared, signal background threads
-			// to resume their regular duties. If someone has freed up
-			// disk space these errors will spontaneously go away.
+	// clear the dirty bit vector, since the buffer is now
+	// clean regardless of which transactions have modified it
 
-			bdb->bdb_flags &= ~BDB_io_error;
-			dbb->dbb_flags &= ~DBB_suspend_bgio;
-		}
-	}
+	// Destination difference page number is only valid between MARK and
+	// write_page so clean it now to avoid confusion
+	bdb->bdb_difference_page = 0;
+	bdb->bdb_transactions = 0;
+	bdb->bdb_mark_transaction = 0;
 
-	return result;
+	if (!(bdb->bdb_bcb->bcb_flags & BCB_keep_pages))
+		removeDirty(bdb);
+
+	bdb->bdb_flags &= ~(BDB_must_write | BDB_system_dirty);
+	clear_dirty_flag_and_nbak_state(tdbb, bdb);
+
+	if (bdb->bdb_flags & BDB_io_error)
+	{
+		// If a write error has cleared, signal background threads
+		// to resume their regular duties. If someone has freed up
+		// disk space these errors will spontaneously go away.
+
+		bdb->bdb_flags &= ~BDB_io_error;
+		tdbb->getDatabase()->dbb_flags &= ~DBB_suspend_bgio;
+	}
 }
 
 static void clear_dirty_flag_and_nbak_state(thread_db* tdbb, BufferDesc* bdb)
@@ -5102,14 +5364,18 @@ static void clear_dirty_flag_and_nbak_state(thread_db* tdbb, BufferDesc* bdb)
 
 void recentlyUsed(BufferDesc* bdb)
 {
+	// Dirty read is fine, see also requeueRecentlyUsed
+	if (bdb->bdb_probation)
+		return;
+
 	const AtomicCounter::counter_type oldFlags = bdb->bdb_flags.exchangeBitOr(BDB_lru_chained);
 	if (oldFlags & BDB_lru_chained)
 		return;
 
-	BufferControl* bcb = bdb->bdb_bcb;
+	BufferPartition* bcp = bdb->bdb_partition;
 
 #ifdef DEV_BUILD
-	volatile BufferDesc* chain = bcb->bcb_lru_chain;
+	volatile BufferDesc* chain = bcp->bcp_lru_chain;
 	for (; chain; chain = chain->bdb_lru_chain)
 	{
 		if (chain == bdb)
@@ -5118,14 +5384,14 @@ void recentlyUsed(BufferDesc* bdb)
 #endif
 	for (;;)
 	{
-		bdb->bdb_lru_chain = bcb->bcb_lru_chain;
-		if (bcb->bcb_lru_chain.compare_exchange_strong(bdb->bdb_lru_chain, bdb))
+		bdb->bdb_lru_chain = bcp->bcp_lru_chain;
+		if (bcp->bcp_lru_chain.compare_exchange_strong(bdb->bdb_lru_chain, bdb))
 			break;
 	}
 }
 
 
-void requeueRecentlyUsed(BufferControl* bcb)
+void requeueRecentlyUsed(BufferPartition* bcp)
 {
 	BufferDesc* chain = NULL;
 
@@ -5133,8 +5399,8 @@ void requeueRecentlyUsed(BufferControl* bcb)
 
 	for (;;)
 	{
-		chain = bcb->bcb_lru_chain;
-		if (bcb->bcb_lru_chain.compare_exchange_strong(chain, NULL))
+		chain = bcp->bcp_lru_chain;
+		if (bcp->bcp_lru_chain.compare_exchange_strong(chain, NULL))
 			break;
 	}
 
@@ -5156,14 +5422,97 @@ void requeueRecentlyUsed(BufferControl* bcb)
 	while ((bdb = reversed) != NULL)
 	{
 		reversed = bdb->bdb_lru_chain;
-		QUE_DELETE(bdb->bdb_in_use);
-		QUE_INSERT(bcb->bcb_in_use, bdb->bdb_in_use);
+
+		// Probation que is FIFO, references don't change buffer position there
+		if (!bdb->bdb_probation)
+		{
+			QUE_DELETE(bdb->bdb_in_use);
+			QUE_INSERT(bcp->bcp_in_use, bdb->bdb_in_use);
+		}
 
 		bdb->bdb_lru_chain = NULL;
 		bdb->bdb_flags &= ~BDB_lru_chained;
 	}
 
-	chain = bcb->bcb_lru_chain;
+	chain = bcp->bcp_lru_chain;
+}
+
+
+void PageGhosts::resize(MemoryPool& pool, ULONG capacity)
+{
+	delete[] m_entries;
+	delete[] m_hash;
+	m_entries = NULL;
+	m_hash = NULL;
+
+	m_entries = FB_NEW_POOL(pool) Entry[capacity];
+	m_hash = FB_NEW_POOL(pool) ULONG[capacity];
+	m_capacity = capacity;
+	m_next = 0;
+
+	for (ULONG i = 0; i < capacity; i++)
+	{
+		m_entries[i].used = false;
+		m_hash[i] = NONE;
+	}
+}
+
+
+void PageGhosts::add(const PageNumber& page)
+{
+	if (!m_capacity)
+		return;
+
+	// Forget the oldest page if queue is full
+
+	Entry* const entry = &m_entries[m_next];
+	if (entry->used)
+		unlink(m_next);
+
+	ULONG* const head = slot(page);
+	entry->page = page;
+	entry->used = true;
+	entry->next = *head;
+	*head = m_next;
+
+	if (++m_next == m_capacity)
+		m_next = 0;
+}
+
+
+bool PageGhosts::remove(const PageNumber& page)
+{
+	if (!m_capacity)
+		return false;
+
+	for (ULONG index = *slot(page); index != NONE; index = m_entries[index].next)
+	{
+		if (m_entries[index].page == page)
+		{
+			unlink(index);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+void PageGhosts::unlink(ULONG index)
+{
+	Entry* const entry = &m_entries[index];
+	fb_assert(entry->used);
+
+	for (ULONG* ptr = slot(entry->page); *ptr != NONE; ptr = &m_entries[*ptr].next)
+	{
+		if (*ptr == index)
+		{
+			*ptr = entry->next;
+			break;
+		}
+	}
+
+	entry->used = false;
 }
 
 
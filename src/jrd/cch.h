@@ -26,14 +26,12 @@
 
 #include "../include/fb_blk.h"
 #include "../common/classes/alloc.h"
+#include "../common/classes/array.h"
+#include "../common/classes/locks.h"
 #include "../common/classes/RefCounted.h"
 #include "../common/classes/semaphore.h"
 #include "../common/classes/SyncObject.h"
 #include "../common/ThreadStart.h"
-#ifdef SUPERSERVER_V2
-#include "../jrd/sbm.h"
-#include "../jrd/pag.h"
-#endif
 
 #include "../jrd/que.h"
 #include "../jrd/lls.h"
@@ -73,12 +71,141 @@ const ULONG MAX_PAGE_BUFFERS = MAX_SLONG - 1;
 #endif
 
 
+// Maximum number of cache partitions and minimum number of buffers in partition
+
+const ULONG MAX_CACHE_PARTITIONS = 64;
+const ULONG MIN_PARTITION_BUFFERS = 1024;
+
+
+// PageGhosts -- Numbers of pages recently evicted from probation queue of 2Q
+// replacement policy (A1out queue). Fixed size FIFO with a hash index, the
+// oldest page number is forgotten when a new one is added to the full queue.
+
+class PageGhosts
+{
+public:
+	PageGhosts()
+		: m_entries(NULL), m_hash(NULL), m_capacity(0), m_next(0)
+	{ }
+
+	~PageGhosts()
+	{
+		delete[] m_entries;
+		delete[] m_hash;
+	}
+
+	void resize(Firebird::MemoryPool& pool, ULONG capacity);
+	void add(const PageNumber& page);
+	bool remove(const PageNumber& page);
+
+private:
+	static const ULONG NONE = ~0u;
+
+	struct Entry
+	{
+		PageNumber	page;
+		ULONG		next;		// Next entry in hash chain
+		bool		used;
+	};
+
+	ULONG* slot(const PageNumber& page) const
+	{
+		return &m_hash[page.getPageNum() % m_capacity];
+	}
+
+	void unlink(ULONG index);
+
+	Entry*		m_entries;
+	ULONG*		m_hash;
+	ULONG		m_capacity;
+	ULONG		m_next;			// Entry to be reused by next add()
+};
+
+
+// BufferPartition -- Part of page cache. Pages are distributed between partitions
+// by page number (see BufferControl::getPartition) and every buffer belongs to one
+// partition for its whole life. Partition has own hash table, LRU, empty, pending
+// and dirty queues guarded by own sync objects, so buffers of different partitions
+// are looked up and replaced concurrently.
+
+class BufferPartition
+{
+public:
+	BufferPartition()
+	{
+		QUE_INIT(bcp_in_use);
+		QUE_INIT(bcp_pending);
+		QUE_INIT(bcp_empty);
+		QUE_INIT(bcp_dirty);
+		QUE_INIT(bcp_probation);
+		bcp_probation_count = 0;
+		bcp_lru_chain = NULL;
+		bcp_dirty_count = 0;
+		bcp_count = 0;
+		bcp_hash = NULL;
+		bcp_hash_size = 0;
+	}
+
+	que			bcp_in_use;			// Que of buffers in use, main LRU que
+	que			bcp_pending;		// Que of buffers which are going to be freed and reassigned
+	que			bcp_empty;			// Que of empty buffers
+
+	// 2Q replacement policy: buffers with pages read once are kept in FIFO
+	// probation que and go to the main LRU que (bcp_in_use) only if page is
+	// read again after eviction from probation que, see bcp_ghosts
+	que			bcp_probation;
+	ULONG		bcp_probation_count;
+	PageGhosts	bcp_ghosts;
+
+	// Recently used buffer put there without locking common LRU que (bcp_in_use).
+	// When bcp_syncLRU is locked this chain is merged into bcp_in_use. See also
+	// requeueRecentlyUsed() and recentlyUsed()
+	std::atomic<BufferDesc*>	bcp_lru_chain;
+
+	que			bcp_dirty;			// que of dirty buffers
+	SLONG		bcp_dirty_count;	// count of pages in dirty que
+	ULONG		bcp_count;			// Number of buffers in partition
+	que*		bcp_hash;			// Hash table, que of buffers with page mod n in every slot
+	ULONG		bcp_hash_size;		// Number of slots in hash table
+
+	Firebird::SyncObject	bcp_syncObject;		// Guards hash table, pending and empty ques
+	Firebird::SyncObject	bcp_syncDirtyBdbs;
+	Firebird::SyncObject	bcp_syncLRU;
+};
+
+
 // BufferControl -- Buffer control block -- one per system
 
 struct bcb_repeat
 {
 	BufferDesc*	bcb_bdb;		// Buffer descriptor block
-	que			bcb_page_mod;	// Que of buffers with page mod n
+};
+
+// Read-ahead misses found by the cache readers on behalf of an attachment.
+// Shared by the attachment and its queued requests as the attachment may be
+// gone before they are served, misses are added to the attachment statistics
+// when it asks for read-ahead next time.
+
+class PrefetchMisses : public Firebird::RefCounted, public Firebird::GlobalStorage
+{
+public:
+	PrefetchMisses()
+		: misses(0)
+	{}
+
+	std::atomic<ULONG> misses;
+};
+
+// Page queued for read-ahead, the requester is referenced while queued
+
+struct PrefetchRequest
+{
+	PrefetchRequest()
+		: requester(NULL)
+	{}
+
+	PageNumber page;
+	PrefetchMisses* requester;
 };
 
 class BufferControl : public pool_alloc<type_bcb>
@@ -87,14 +214,14 @@ class BufferControl : public pool_alloc<type_bcb>
 		: bcb_bufferpool(&p),
 		  bcb_memory_stats(&parentStats),
 		  bcb_memory(p),
-		  bcb_writer_fini(p, cache_writer, THREAD_medium)
+		  bcb_writer_fini(p, cache_writer, THREAD_medium),
+		  bcb_reader_fini(p),
+		  bcb_prefetch_queue(p)
 	{
 		bcb_database = NULL;
-		QUE_INIT(bcb_in_use);
-		QUE_INIT(bcb_pending);
-		QUE_INIT(bcb_empty);
-		QUE_INIT(bcb_dirty);
-		bcb_dirty_count = 0;
+		bcb_partitions = NULL;
+		bcb_partition_count = 0;
+		bcb_writer_partition = 0;
 		bcb_free = NULL;
 		bcb_flags = 0;
 		bcb_free_minimum = 0;
@@ -103,9 +230,9 @@ class BufferControl : public pool_alloc<type_bcb>
 		bcb_prec_walk_mark = 0;
 		bcb_page_size = 0;
 		bcb_page_incarnation = 0;
-#ifdef SUPERSERVER_V2
-		bcb_prefetch = NULL;
-#endif
+		bcb_prefetch_pages = 0;
+		bcb_prefetch_head = 0;
+		bcb_prefetch_count = 0;
 	}
 
 public:
@@ -119,17 +246,15 @@ public:
 	Firebird::MemoryStats bcb_memory_stats;
 
 	UCharStack	bcb_memory;			// Large block partitioned into buffers
-	que			bcb_in_use;			// Que of buffers in use, main LRU que
-	que			bcb_pending;		// Que of buffers which are going to be freed and reassigned
-	que			bcb_empty;			// Que of empty buffers
 
-	// Recently used buffer put there without locking common LRU que (bcb_in_use).
-	// When bcb_syncLRU is locked this chain is merged into bcb_in_use. See also
-	// requeueRecentlyUsed() and recentlyUsed()
-	std::atomic<BufferDesc*>	bcb_lru_chain;
+	BufferPartition*	bcb_partitions;		// Cache partitions
+	ULONG		bcb_partition_count;		// Number of partitions, never changes
+	ULONG		bcb_writer_partition;		// Partition to look for dirty buffers at next time
 
-	que			bcb_dirty;			// que of dirty buffers
-	SLONG		bcb_dirty_count;	// count of pages in dirty page btree
+	BufferPartition* getPartition(const PageNumber& page) const
+	{
+		return &bcb_partitions[page.getPageNum() % bcb_partition_count];
+	}
 
 	Precedence*	bcb_free;			// Free precedence blocks
 	SSHORT		bcb_flags;			// see below
@@ -140,10 +265,8 @@ public:
 	ULONG		bcb_page_size;		// Database page size in bytes
 	ULONG		bcb_page_incarnation;	// Cache page incarnation counter
 
-	Firebird::SyncObject	bcb_syncObject;
-	Firebird::SyncObject	bcb_syncDirtyBdbs;
+	Firebird::SyncObject	bcb_syncObject;		// Guards bcb_rpt and bcb_count
 	Firebird::SyncObject	bcb_syncPrecedence;
-	Firebird::SyncObject	bcb_syncLRU;
 	//Firebird::SyncObject	bcb_syncPageWrite;
 
 	typedef ThreadFinishSync<BufferControl*> BcbThreadSync;
@@ -152,15 +275,19 @@ public:
 	Firebird::Semaphore bcb_writer_sem;		// Wake up cache writer
 	Firebird::Semaphore bcb_writer_init;	// Cache writer initialization
 	BcbThreadSync bcb_writer_fini;			// Cache writer finalization
-#ifdef SUPERSERVER_V2
+
 	static void cache_reader(BufferControl* bcb);
-	// the code in cch.cpp is not tested for semaphore instead event !!!
-	Firebird::Semaphore bcb_reader_sem;		// Wake up cache reader
+	Firebird::Semaphore bcb_reader_sem;		// Wake up cache readers
 	Firebird::Semaphore bcb_reader_init;	// Cache reader initialization
-	BcbThreadSync bcb_reader_fini;			// Cache reader finalization
+	Firebird::HalfStaticArray<BcbThreadSync*, 4> bcb_reader_fini;	// Cache readers finalization
 
-	PageBitmap*	bcb_prefetch;		// Bitmap of pages to prefetch
-#endif
+	// Read-ahead queue. It's a ring of pages requested by sequential scans and
+	// not yet read by the cache readers, guarded by bcb_prefetchMutex.
+	Firebird::Mutex	bcb_prefetchMutex;
+	Firebird::Array<PrefetchRequest> bcb_prefetch_queue;
+	ULONG		bcb_prefetch_head;	// Index of the oldest queued page
+	ULONG		bcb_prefetch_count;	// Number of queued pages
+	ULONG		bcb_prefetch_pages;	// Pages to read ahead per scan request, zero if disabled
 
 	void exceptionHandler(const Firebird::Exception& ex, BcbThreadSync::ThreadRoutine* routine);
 
@@ -171,12 +298,10 @@ const int BCB_keep_pages	= 1;	// set during btc_flush(), pages not removed from
 const int BCB_cache_writer	= 2;	// cache writer thread has been started
 const int BCB_writer_start  = 4;    // cache writer thread is starting now
 const int BCB_writer_active	= 8;	// no need to post writer event count
-#ifdef SUPERSERVER_V2
-const int BCB_cache_reader	= 16;	// cache reader thread has been started
-const int BCB_reader_active	= 32;	// cache reader not blocked on event
-#endif
+const int BCB_cache_reader	= 16;	// cache reader threads have been started
 const int BCB_free_pending	= 64;	// request cache writer to free pages
 const int BCB_exclusive		= 128;	// there is only BCB in whole system
+const int BCB_2q			= 256;	// 2Q replacement policy is used
 
 
 // BufferDesc -- Buffer descriptor block
@@ -184,8 +309,10 @@ const int BCB_exclusive		= 128;	// there is only BCB in whole system
 class BufferDesc : public pool_alloc<type_bdb>
 {
 public:
-	explicit BufferDesc(BufferControl* bcb)
+	explicit BufferDesc(BufferControl* bcb, BufferPartition* partition = NULL)
 		: bdb_bcb(bcb),
+		  bdb_partition(partition),
+		  bdb_probation(false),
 		  bdb_page(0, 0),
 		  bdb_pending_page(0, 0)
 	{
@@ -231,9 +358,11 @@ public:
 	}
 
 	BufferControl*	bdb_bcb;
+	BufferPartition*	bdb_partition;	// Cache partition buffer belongs to
+	bool		bdb_probation;			// Buffer is in probation que of 2Q policy
 	Firebird::SyncObject	bdb_syncPage;
 	Lock*		bdb_lock;				// Lock block for buffer
-	que			bdb_que;				// Either mod que in hash table or bcb_pending que if BDB_free_pending flag is set
+	que			bdb_que;				// Either mod que in hash table or bcp_pending que if BDB_free_pending flag is set
 	que			bdb_in_use;				// queue of buffers in use
 	que			bdb_dirty;				// dirty pages LRU queue
 	BufferDesc*	bdb_lru_chain;			// pending LRU chain
@@ -284,6 +413,7 @@ const int BDB_prefetch			= 0x4000;	// page has been prefetched but not yet refer
 const int BDB_no_blocking_ast	= 0x8000;	// No blocking AST registered with page lock
 const int BDB_lru_chained		= 0x10000;	// buffer is in pending LRU chain
 const int BDB_nbak_state_lock	= 0x20000;	// nbak state lock should be released after buffer is written
+const int BDB_preread			= 0x40000;	// page image was read by batched I/O, see prefetch_pages
 
 // bdb_ast_flags
 
@@ -340,35 +470,14 @@ enum LATCH
 };
 
 
+// Read-ahead queue capacity per cache reader thread, in read-ahead requests
 
-#ifdef SUPERSERVER_V2
-#include "../jrd/os/pio.h"
-
-// Constants used by prefetch mechanism
-
-const int PREFETCH_MAX_TRANSFER	= 16384;	// maximum block I/O transfer (bytes)
-// maximum pages allowed per prefetch request
-const int PREFETCH_MAX_PAGES	= (2 * PREFETCH_MAX_TRANSFER / MIN_PAGE_SIZE);
+const int PREFETCH_QUEUE_REQUESTS	= 8;
 
-// Prefetch block
+// Maximum number of pages taken from read-ahead queue and read at once by cache reader
 
-class Prefetch : public pool_alloc<type_prf>
-{
-public:
-	thread_db*	prf_tdbb;			// thread database context
-	SLONG		prf_start_page;		// starting page of multipage prefetch
-	USHORT		prf_max_prefetch;	// maximum no. of pages to prefetch
-	USHORT		prf_page_count;		// actual no. of pages being prefetched
-	phys_io_blk	prf_piob;			// physical I/O status block
-	SCHAR*		prf_aligned_buffer;	// buffer address aligned for raw (OS cache bypass) I/O
-	SCHAR*		prf_io_buffer;		// I/O buffer address
-	UCHAR		prf_flags;
-	BufferDesc*	prf_bdbs[PREFETCH_MAX_TRANSFER / MIN_PAGE_SIZE];
-	SCHAR		prf_unaligned_buffer[PREFETCH_MAX_TRANSFER + MIN_PAGE_SIZE];
-};
+const int PREFETCH_BATCH_PAGES		= 16;
 
-const int PRF_active	= 1;		// prefetch block currently in use
-#endif // SUPERSERVER_V2
 
 typedef Firebird::SortedArray<SLONG, Firebird::InlineStorage<SLONG, 256>, SLONG> PagesArray;
 
@@ -45,6 +45,7 @@
 #include "../jrd/rse.h"
 #include "../jrd/ext.h"
 #include "../jrd/tra.h"
+#include "../jrd/WorkerPool.h"
 #include "../dsql/ExprNodes.h"
 #include "gen/iberror.h"
 #include "../jrd/cmp_proto.h"
@@ -65,18 +66,14 @@
 // NS: in VS2003 these only work with static CRT
 extern "C" {
 int __cdecl _fseeki64(FILE*, __int64, int);
-__int64 __cdecl _ftelli64(FILE*);
 }
 #endif
 
 #ifdef WIN_NT
-#define FTELL64 _ftelli64
 #define FSEEK64 _fseeki64
 #elif defined(LSB_BUILD)
-#define FTELL64 ftello64
 #define FSEEK64 fseeko64
 #else
-#define FTELL64 ftello
 #define FSEEK64 fseeko
 #endif
 
@@ -111,6 +108,76 @@ namespace Jrd
 	private:
 		RefPtr<const Config> config;
 	};
+
+	// Reads the chunk of external file following the buffered one, so the file
+	// is read while the current chunk is decoded and stored by the attachment
+
+	class ExternalFileReadAhead : public WorkerPool::Task
+	{
+	public:
+		explicit ExternalFileReadAhead(MemoryPool& pool)
+			: buffer(FB_NEW_POOL(pool) UCHAR[EXT_BUFFER_SIZE]),
+			  position(0), length(0), error(0), file(NULL)
+		{
+		}
+
+		~ExternalFileReadAhead()
+		{
+			background.wait();
+			delete[] buffer;
+		}
+
+		void start(FILE* ifi, FB_UINT64 from)
+		{
+			file = ifi;
+			position = from;
+			length = 0;
+			error = 0;
+			background.start(this);
+		}
+
+		// Wait for the file to be left alone, return true if chunk at given position is read
+		bool finish(FB_UINT64 from)
+		{
+			if (!background.isActive())
+				return false;
+
+			background.wait();
+			return (!error && position == from && length);
+		}
+
+		// Discard the chunk as the file is going to be modified
+		void cancel()
+		{
+			background.wait();
+			length = 0;
+		}
+
+		void execute()
+		{
+			if (FSEEK64(file, position, SEEK_SET) != 0)
+			{
+				error = errno;
+				return;
+			}
+
+			const size_t n = fread(buffer, 1, EXT_BUFFER_SIZE, file);
+
+			if (n < EXT_BUFFER_SIZE && ferror(file))
+				error = errno;
+			else
+				length = (ULONG) n;
+		}
+
+		UCHAR* buffer;
+		FB_UINT64 position;
+		ULONG length;
+
+	private:
+		int error;
+		FILE* file;
+		WorkerPool::Background background;
+	};
 }
 
 using namespace Jrd;
@@ -156,6 +223,327 @@ namespace {
 
 		return ext_file->ext_ifi;
 	}
+
+	void ext_close(ExternalFile* ext_file)
+	{
+		MutexLockGuard guard(ext_file->ext_sync, FB_FUNCTION);
+
+		delete ext_file->ext_read_ahead;
+		ext_file->ext_read_ahead = NULL;
+
+		if (ext_file->ext_ifi)
+		{
+			fclose(ext_file->ext_ifi);
+			ext_file->ext_ifi = NULL;
+		}
+
+		delete[] ext_file->ext_buffer;
+		ext_file->ext_buffer = NULL;
+		ext_file->ext_buf_length = 0;
+	}
+
+	// Make the file data starting at the given position available in the read buffer.
+	// Return the number of bytes buffered from there, it's less than asked at EOF only.
+	// Records are read in large chunks, so the file is positioned once per chunk.
+
+	ULONG ext_read(thread_db* tdbb, MemoryPool& pool, ExternalFile* ext_file,
+		FB_UINT64 position, ULONG length)
+	{
+		const FB_UINT64 buf_end = ext_file->ext_buf_position + ext_file->ext_buf_length;
+
+		if (position >= ext_file->ext_buf_position && position + length <= buf_end)
+			return (ULONG) (buf_end - position);
+
+		if (!ext_file->ext_buffer)
+			ext_file->ext_buffer = FB_NEW_POOL(pool) UCHAR[EXT_BUFFER_SIZE];
+
+		// reset both flags cause we are going to move the file pointer
+		ext_file->ext_flags &= ~(EXT_last_write | EXT_last_read);
+		ext_file->ext_buf_length = 0;
+
+		ExternalFileReadAhead* read_ahead = ext_file->ext_read_ahead;
+
+		if (read_ahead && read_ahead->finish(position))
+		{
+			// Sequential read, the chunk is already read in background
+			UCHAR* const buffer = ext_file->ext_buffer;
+			ext_file->ext_buffer = read_ahead->buffer;
+			read_ahead->buffer = buffer;
+			ext_file->ext_buf_length = read_ahead->length;
+		}
+		else
+		{
+			if (FSEEK64(ext_file->ext_ifi, position, SEEK_SET) != 0)
+			{
+				ERR_post(Arg::Gds(isc_io_error) << STRINGIZE(FSEEK64) << Arg::Str(ext_file->ext_filename) <<
+						 Arg::Gds(isc_io_open_err) << SYS_ERR(errno));
+			}
+
+			const size_t n = fread(ext_file->ext_buffer, 1, EXT_BUFFER_SIZE, ext_file->ext_ifi);
+
+			if (n < EXT_BUFFER_SIZE && ferror(ext_file->ext_ifi))
+			{
+				ERR_post(Arg::Gds(isc_io_error) << Arg::Str("fread") << Arg::Str(ext_file->ext_filename) <<
+						 Arg::Gds(isc_io_read_err) << SYS_ERR(errno));
+			}
+
+			ext_file->ext_buf_length = (ULONG) n;
+		}
+
+		ext_file->ext_buf_position = position;
+		ext_file->ext_flags |= EXT_last_read;
+
+		// Start reading the next chunk unless EOF is reached
+
+		if (ext_file->ext_buf_length == EXT_BUFFER_SIZE &&
+			WorkerPool::getParallelism(tdbb->getDatabase()->dbb_config->getParallelWorkers()) > 1)
+		{
+			if (!read_ahead)
+				read_ahead = ext_file->ext_read_ahead = FB_NEW_POOL(pool) ExternalFileReadAhead(pool);
+
+			read_ahead->start(ext_file->ext_ifi, position + EXT_BUFFER_SIZE);
+		}
+
+		return ext_file->ext_buf_length;
+	}
+
+	// Find the line break ending a line of delimited text, the ones inside quoted
+	// values don't count. Return the end of data if it contains no line end.
+
+	const UCHAR* find_line_end(const UCHAR* p, const UCHAR* const end)
+	{
+		bool quoted = false;
+
+		for (; p < end; p++)
+		{
+			if (*p == '"')
+				quoted = !quoted;
+			else if (*p == '\n' && !quoted)
+				break;
+		}
+
+		return p;
+	}
+
+	// Get the next line of delimited text, quoted values may contain line breaks
+
+	bool get_line(thread_db* tdbb, MemoryPool& pool, ExternalFile* ext_file, FB_UINT64& position,
+		const UCHAR*& line, ULONG& length)
+	{
+		ULONG available = ext_read(tdbb, pool, ext_file, position, 1);
+
+		while (available)
+		{
+			const UCHAR* const start = ext_file->ext_buffer + (position - ext_file->ext_buf_position);
+			const UCHAR* const end = start + available;
+			const UCHAR* const p = find_line_end(start, end);
+
+			// Unterminated last line is taken as is
+
+			if (p < end || ext_file->ext_buf_length < EXT_BUFFER_SIZE)
+			{
+				line = start;
+				length = p - start;
+				position += length + (p < end ? 1 : 0);
+
+				if (length && line[length - 1] == '\r')
+					length--;
+
+				return true;
+			}
+
+			if (ext_file->ext_buf_position == position)
+			{
+				ERR_post(Arg::Gds(isc_ext_line_too_long) << Arg::Str(ext_file->ext_filename) <<
+						 Arg::Num(EXT_BUFFER_SIZE));
+			}
+
+			// Line continues past the buffered data, reload the buffer from its start
+
+			available = ext_read(tdbb, pool, ext_file, position, available + 1);
+		}
+
+		return false;
+	}
+
+	// Estimate the average line length of delimited text by the beginning of the file.
+	// The file is sampled through its own handle to not disturb the reads in progress.
+
+	double get_line_length(thread_db* tdbb, const ExternalFile* ext_file)
+	{
+		const ULONG SAMPLE_SIZE = 64 * 1024;
+
+		FILE* const file = os_utils::fopen(ext_file->ext_filename, FOPEN_READ_ONLY);
+		if (!file)
+			return 0;
+
+		HalfStaticArray<UCHAR, BUFFER_MEDIUM> buffer(*tdbb->getDefaultPool());
+		UCHAR* const sample = buffer.getBuffer(SAMPLE_SIZE);
+		const size_t n = fread(sample, 1, SAMPLE_SIZE, file);
+		fclose(file);
+
+		if (!n)
+			return 0;
+
+		const UCHAR* const end = sample + n;
+		ULONG lines = 0;
+
+		for (const UCHAR* p = find_line_end(sample, end); p < end; p = find_line_end(p + 1, end))
+			lines++;
+
+		// Unterminated last line of a small file counts as well, no line end in
+		// the sample at all means the lines are at least as long as the sample
+
+		if (n < SAMPLE_SIZE && sample[n - 1] != '\n')
+			lines++;
+
+		return (double) n / MAX(lines, 1);
+	}
+
+	// Decode a line of comma separated values into the record fields. Unquoted empty
+	// value or a missing one means NULL, quotes inside quoted values are doubled.
+
+	void decode_line(thread_db* tdbb, jrd_rel* relation, Record* record,
+		const UCHAR* line, ULONG length)
+	{
+		const Format* const format = record->getFormat();
+		const UCHAR* p = line;
+		const UCHAR* const end = line + length;
+		bool more = true;
+
+		HalfStaticArray<UCHAR, BUFFER_MEDIUM> buffer(*tdbb->getDefaultPool());
+
+		Format::fmt_desc_const_iterator desc_ptr = format->fmt_desc.begin();
+
+		SSHORT i = 0;
+		for (vec<jrd_fld*>::iterator itr = relation->rel_fields->begin();
+			i < format->fmt_count; ++i, ++itr, ++desc_ptr)
+		{
+			const jrd_fld* field = *itr;
+
+			record->setNull(i);
+
+			if (!desc_ptr->dsc_length || !field || field->fld_computation || !more)
+				continue;
+
+			const UCHAR* value = p;
+			bool quoted = false;
+
+			if (p < end && *p == '"')
+			{
+				quoted = true;
+				buffer.clear();
+
+				for (++p; p < end; ++p)
+				{
+					if (*p == '"')
+					{
+						if (p + 1 < end && p[1] == '"')
+							++p;
+						else
+							break;
+					}
+
+					buffer.add(*p);
+				}
+
+				// Skip closing quote and whatever is up to the delimiter
+				while (p < end && *p != ',')
+					++p;
+
+				value = buffer.begin();
+			}
+			else
+			{
+				while (p < end && *p != ',')
+					++p;
+			}
+
+			const ULONG value_length = quoted ? buffer.getCount() : (ULONG) (p - value);
+
+			if (p < end)
+				++p;
+			else
+				more = false;
+
+			if (!quoted && !value_length)
+				continue;
+
+			if (value_length > MAX_USHORT)
+				ERR_post(Arg::Gds(isc_imp_exc) << Arg::Gds(isc_blktoobig));
+
+			dsc from;
+			from.makeText((USHORT) value_length,
+				desc_ptr->isText() ? desc_ptr->getTextType() : (USHORT) ttype_ascii,
+				const_cast<UCHAR*>(value));
+
+			dsc to = *desc_ptr;
+			to.dsc_address = record->getData() + (IPTR) to.dsc_address;
+
+			MOV_move(tdbb, &from, &to);
+
+			const LiteralNode* literal = nodeAs<LiteralNode>(field->fld_missing_value);
+
+			if (literal && !MOV_compare(tdbb, &literal->litDesc, &to))
+				continue;
+
+			record->clearNull(i);
+		}
+	}
+
+	// Encode the record fields as a line of comma separated values
+
+	void encode_line(thread_db* tdbb, jrd_rel* relation, Record* record, string& line)
+	{
+		const Format* const format = record->getFormat();
+		bool first = true;
+
+		vec<jrd_fld*>::iterator field_ptr = relation->rel_fields->begin();
+		Format::fmt_desc_const_iterator desc_ptr = format->fmt_desc.begin();
+
+		for (USHORT i = 0; i < format->fmt_count; ++i, ++field_ptr, ++desc_ptr)
+		{
+			const jrd_fld* field = *field_ptr;
+
+			if (!field || field->fld_computation || !desc_ptr->dsc_length)
+				continue;
+
+			if (!first)
+				line += ',';
+
+			first = false;
+
+			// Missing value is already moved into the record by the caller
+
+			if (record->isNull(i) && !nodeAs<LiteralNode>(field->fld_missing_value))
+				continue;
+
+			dsc desc = *desc_ptr;
+			desc.dsc_address = record->getData() + (IPTR) desc.dsc_address;
+
+			const string value = MOV_make_string2(tdbb, &desc,
+				desc.isText() ? desc.getTextType() : (USHORT) ttype_ascii, false);
+
+			if (value.isEmpty() || value.find_first_of(",\"\r\n") != string::npos)
+			{
+				line += '"';
+
+				for (const char* p = value.begin(); p < value.end(); ++p)
+				{
+					if (*p == '"')
+						line += '"';
+
+					line += *p;
+				}
+
+				line += '"';
+			}
+			else
+				line += value;
+		}
+
+		line += '\n';
+	}
 } // namespace
 
 
@@ -202,6 +590,12 @@ double EXT_cardinality(thread_db* tdbb, jrd_rel* relation)
 			file->ext_ifi = NULL;
 		}
 
+		if (file->ext_flags & EXT_delimited)
+		{
+			const double line_length = get_line_length(tdbb, file);
+			return line_length ? file_size / line_length : 0;
+		}
+
 		const Format* const format = MET_current(tdbb, relation);
 		fb_assert(format && format->fmt_length);
 		const USHORT offset = (USHORT)(IPTR) format->fmt_desc[0].dsc_address;
@@ -310,6 +704,10 @@ ExternalFile* EXT_file(jrd_rel* relation, const TEXT* file_name) //, bid* descri
 	strcpy(file->ext_filename, file_name);
 	file->ext_flags = 0;
 	file->ext_ifi = NULL;
+	file->ext_buffer = NULL;
+	file->ext_buf_position = 0;
+	file->ext_buf_length = 0;
+	file->ext_read_ahead = NULL;
 
 	return file;
 }
@@ -330,11 +728,7 @@ void EXT_fini(jrd_rel* relation, bool close_only)
 	if (relation->rel_file)
 	{
 		ExternalFile* file = relation->rel_file;
-		if (file->ext_ifi)
-		{
-			fclose(file->ext_ifi);
-			file->ext_ifi = NULL;
-		}
+		ext_close(file);
 
 		// before zeroing out the rel_file we need to deallocate the memory
 		if (!close_only)
@@ -365,10 +759,6 @@ bool EXT_get(thread_db* tdbb, record_param* rpb, FB_UINT64& position)
 	Record* const record = rpb->rpb_record;
 	const Format* const format = record->getFormat();
 
-	const USHORT offset = (USHORT) (IPTR) format->fmt_desc[0].dsc_address;
-	UCHAR* p = record->getData() + offset;
-	const ULONG l = record->getLength() - offset;
-
 	if (file->ext_ifi == NULL)
 	{
 		ERR_post(Arg::Gds(isc_io_error) << "fseek" << Arg::Str(file->ext_filename) <<
@@ -376,45 +766,30 @@ bool EXT_get(thread_db* tdbb, record_param* rpb, FB_UINT64& position)
 				 Arg::Gds(isc_random) << "File not opened");
 	}
 
-	// hvlad: fseek will flush file buffer and degrade performance, so don't
-	// call it if it is not necessary. Note that we must flush file buffer if we
-	// do read after write
+	// Buffer is shared by all scans of the file, keep it while the record is decoded
+	MutexLockGuard guard(file->ext_sync, FB_FUNCTION);
 
-	bool doSeek = false;
-	if (!(file->ext_flags & EXT_last_read))
-	{
-		doSeek = true;
-	}
-	else
+	if (file->ext_flags & EXT_delimited)
 	{
-		SINT64 offset = FTELL64(file->ext_ifi);
-		if (offset < 0)
-		{
-			ERR_post(Arg::Gds(isc_io_error) << STRINGIZE(FTELL64) << Arg::Str(file->ext_filename) <<
-					 Arg::Gds(isc_io_read_err) << SYS_ERR(errno));
-		}
-		doSeek = (static_cast<FB_UINT64>(offset) != position);
-	}
+		const UCHAR* line;
+		ULONG length;
 
-	// reset both flags cause we are going to move the file pointer
-	file->ext_flags &= ~(EXT_last_write | EXT_last_read);
+		if (!get_line(tdbb, *relation->rel_pool, file, position, line, length))
+			return false;
 
-	if (doSeek)
-	{
-		if (FSEEK64(file->ext_ifi, position, SEEK_SET) != 0)
-		{
-			ERR_post(Arg::Gds(isc_io_error) << STRINGIZE(FSEEK64) << Arg::Str(file->ext_filename) <<
-					 Arg::Gds(isc_io_open_err) << SYS_ERR(errno));
-		}
+		decode_line(tdbb, relation, record, line, length);
+		return true;
 	}
 
-	if (!fread(p, l, 1, file->ext_ifi))
-	{
+	const USHORT offset = (USHORT) (IPTR) format->fmt_desc[0].dsc_address;
+	UCHAR* p = record->getData() + offset;
+	const ULONG l = record->getLength() - offset;
+
+	if (ext_read(tdbb, *relation->rel_pool, file, position, l) < l)
 		return false;
-	}
 
+	memcpy(p, file->ext_buffer + (position - file->ext_buf_position), l);
 	position += l;
-	file->ext_flags |= EXT_last_read;
 
 	// Loop thru fields setting missing fields to either blanks/zeros or the missing value
 
@@ -550,14 +925,34 @@ void EXT_store(thread_db* tdbb, record_param* rpb)
 		}
 	}
 
-	const USHORT offset = (USHORT) (IPTR) format->fmt_desc[0].dsc_address;
-	const UCHAR* p = record->getData() + offset;
-	const ULONG l = record->getLength() - offset;
+	string line;
+	const UCHAR* p;
+	ULONG l;
+
+	if (file->ext_flags & EXT_delimited)
+	{
+		encode_line(tdbb, relation, record, line);
+		p = (const UCHAR*) line.c_str();
+		l = line.length();
+	}
+	else
+	{
+		const USHORT offset = (USHORT) (IPTR) format->fmt_desc[0].dsc_address;
+		p = record->getData() + offset;
+		l = record->getLength() - offset;
+	}
+
+	MutexLockGuard guard(file->ext_sync, FB_FUNCTION);
 
 	// hvlad: fseek will flush file buffer and degrade performance, so don't
 	// call it if it is not necessary.	Note that we must flush file buffer if we
 	// do write after read
 	file->ext_flags &= ~EXT_last_read;
+	file->ext_buf_length = 0;
+
+	if (file->ext_read_ahead)
+		file->ext_read_ahead->cancel();
+
 	if (file->ext_ifi == NULL ||
 		(!(file->ext_flags & EXT_last_write) && FSEEK64(file->ext_ifi, (SINT64) 0, SEEK_END) != 0) )
 	{
@@ -611,9 +1006,6 @@ void EXT_tra_detach(ExternalFile* file, jrd_tra*)
  **************************************/
 
 	file->ext_tra_cnt--;
-	if (!file->ext_tra_cnt && file->ext_ifi)
-	{
-		fclose(file->ext_ifi);
-		file->ext_ifi = NULL;
-	}
+	if (!file->ext_tra_cnt)
+		ext_close(file);
 }
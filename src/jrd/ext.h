@@ -25,9 +25,12 @@
 #define JRD_EXT_H
 
 #include <stdio.h>
+#include "../common/classes/locks.h"
 
 namespace Jrd {
 
+class ExternalFileReadAhead;
+
 // External file access block
 
 class ExternalFile : public pool_alloc_rpt<SCHAR, type_ext>
@@ -36,12 +39,20 @@ public:
 	USHORT	ext_flags;			// Misc and cruddy flags
 	USHORT	ext_tra_cnt;		// How many transactions used the file
 	FILE*	ext_ifi;			// Internal file identifier
+	UCHAR*	ext_buffer;			// Read buffer
+	FB_UINT64	ext_buf_position;	// File position of the buffered data
+	ULONG	ext_buf_length;		// Length of the buffered data
+	ExternalFileReadAhead*	ext_read_ahead;	// Next chunk being read in background
+	Firebird::Mutex	ext_sync;	// Serializes use of file, buffer and read-ahead by attachments
 	char	ext_filename[1];
 };
 
 const int EXT_readonly		= 1;	// File could only be opened for read
 const int EXT_last_read		= 2;	// last operation was read
 const int EXT_last_write	= 4;	// last operation was write
+const int EXT_delimited		= 8;	// file contains delimited text (CSV)
+
+const ULONG EXT_BUFFER_SIZE	= 256 * 1024;	// Size of the read buffer
 
 } //namespace Jrd
 
@@ -41,7 +41,9 @@ const USHORT FILE_backing_up	= 64;
 
 // flags for RDB$RELATIONS
 
-const USHORT REL_sql			= 0x0001;
+const USHORT REL_sql					= 0x0001;
+const USHORT REL_compression_extended	= 0x0002;	// COMPRESSION EXTENDED
+const USHORT REL_ext_delimited			= 0x0004;	// FORMAT DELIMITED (external file)
 
 // flags for RDB$TRIGGERS
 
@@ -74,8 +74,8 @@
 	static_assert(f_mon_tra_stat_id == 12, "Wrong field id");
 	static_assert(f_mon_stmt_timer == 9, "Wrong field id");
 	static_assert(f_mon_call_pkg_name == 9, "Wrong field id");
-	static_assert(f_mon_io_page_marks == 5, "Wrong field id");
-	static_assert(f_mon_rec_imgc == 16, "Wrong field id");
+	static_assert(f_mon_io_blob_packed_size == 14, "Wrong field id");
+	static_assert(f_mon_rec_state_misses == 18, "Wrong field id");
 	static_assert(f_mon_ctx_var_value == 3, "Wrong field id");
 	static_assert(f_mon_mem_max_alloc == 5, "Wrong field id");
 	static_assert(f_pkg_sql_security == 8, "Wrong field id");
@@ -64,6 +64,8 @@
 #include "../jrd/vio_proto.h"
 #include "../jrd/tra_proto.h"
 #include "../jrd/Collation.h"
+#include "../jrd/WorkerPool.h"
+#include "../jrd/BulkInsert.h"
 
 using namespace Jrd;
 using namespace Ods;
@@ -74,6 +76,7 @@ static idx_e check_foreign_key(thread_db*, Record*, jrd_rel*, jrd_tra*, index_de
 static idx_e check_partner_index(thread_db*, jrd_rel*, Record*, jrd_tra*, index_desc*, jrd_rel*, USHORT);
 static bool cmpRecordKeys(thread_db*, Record*, jrd_rel*, index_desc*, Record*, jrd_rel*, index_desc*);
 static bool duplicate_key(const UCHAR*, const UCHAR*, void*);
+static bool duplicate_part_key(const UCHAR*, const UCHAR*, void*);
 static PageNumber get_root_page(thread_db*, jrd_rel*);
 static int index_block_flush(void*);
 static idx_e insert_key(thread_db*, jrd_rel*, Record*, jrd_tra*, WIN *, index_insertion*, IndexErrorContext&);
@@ -104,6 +107,105 @@ namespace
 		const USHORT l = key1->key_length;
 		return (l == key2->key_length && !memcmp(key1->key_data, key2->key_data, l));
 	}
+
+	// Relations smaller than that are not worth sorting their keys in parallel
+	const ULONG MIN_PARALLEL_INDEX_PAGES = 1024;
+
+	// Index keys are sorted in parts when parallel execution is enabled. Records
+	// are put into the current part until its memory is full, then the next part
+	// is used. When all the parts are full, they're sorted and written to their
+	// temporary spaces at once by the worker threads. Finally the parts are sorted
+	// in parallel too and fast_load() merges them.
+
+	class SortPartTask : public WorkerPool::Task
+	{
+	public:
+		explicit SortPartTask(const IndexCreation* aCreation)
+			: creation(aCreation), sort(NULL), dup_recno(-1), duplicates(0), final(false)
+		{}
+
+		void execute()
+		{
+			if (final)
+				sort->sort(NULL);
+			else
+				sort->flush();
+		}
+
+		const IndexCreation* const creation;
+		Sort* sort;
+		SINT64 dup_recno;		// duplicates are counted per part, as in IndexCreation
+		SLONG duplicates;
+		bool final;
+	};
+
+	class PartitionedSort : public PermanentStorage
+	{
+	public:
+		PartitionedSort(MemoryPool& pool, IndexCreation& creation)
+			: PermanentStorage(pool), m_creation(creation), m_parts(pool), m_tasks(pool), m_current(0)
+		{}
+
+		~PartitionedSort()
+		{
+			for (FB_SIZE_T i = 0; i < m_parts.getCount(); i++)
+				delete m_parts[i];
+		}
+
+		SortPartTask* addPart()
+		{
+			SortPartTask* const part = FB_NEW_POOL(getPool()) SortPartTask(&m_creation);
+			m_parts.add(part);
+			m_tasks.add(part);
+			return part;
+		}
+
+		void put(thread_db* tdbb, ULONG** record_address)
+		{
+			while (!m_parts[m_current]->sort->hasRoom())
+			{
+				if (++m_current == m_parts.getCount())
+				{
+					run(false);
+					m_current = 0;
+					break;
+				}
+			}
+
+			m_parts[m_current]->sort->put(tdbb, record_address);
+		}
+
+		void sort()
+		{
+			run(true);
+		}
+
+	private:
+		void run(bool final)
+		{
+			for (FB_SIZE_T i = 0; i < m_parts.getCount(); i++)
+				m_parts[i]->final = final;
+
+			WorkerPool::run(m_tasks.begin(), m_tasks.getCount());
+
+			// Report duplicates found by the parts the same way duplicate_key() does
+
+			for (FB_SIZE_T i = 0; i < m_parts.getCount(); i++)
+			{
+				SortPartTask* const part = m_parts[i];
+
+				if (part->duplicates && !m_creation.duplicates++)
+					m_creation.dup_recno = part->dup_recno;
+
+				part->duplicates = 0;
+			}
+		}
+
+		IndexCreation& m_creation;
+		HalfStaticArray<SortPartTask*, 8> m_parts;
+		HalfStaticArray<WorkerPool::Task*, 8> m_tasks;
+		FB_SIZE_T m_current;
+	};
 }
 
 
@@ -324,13 +426,42 @@ void IDX_create_index(thread_db* tdbb,
 	key_desc[1].setSkdOffset(key_desc);
 	key_desc[1].skd_vary_offset = 0;
 
-	FPTR_REJECT_DUP_CALLBACK callback = (idx->idx_flags & idx_unique) ? duplicate_key : NULL;
-	void* callback_arg = (idx->idx_flags & idx_unique) ? &creation : NULL;
+	const bool isUnique = (idx->idx_flags & idx_unique);
+	const unsigned parallelism = WorkerPool::getParallelism(dbb->dbb_config->getParallelWorkers());
 
-	Sort* const scb = FB_NEW_POOL(transaction->tra_sorts.getPool())
-		Sort(dbb, &transaction->tra_sorts, key_length + sizeof(index_sort_record),
-				  2, 1, key_desc, callback, callback_arg);
-	creation.sort = scb;
+	Sort* scb = NULL;
+	AutoPtr<PartitionedSort> parts;
+
+	if (parallelism > 1 && DPM_data_pages(tdbb, relation) >= MIN_PARALLEL_INDEX_PAGES)
+	{
+		// Sort the keys in parts using the worker threads. Every part is sorted
+		// single-threaded, the parallelism is achieved by sorting parts at once.
+
+		MemoryPool& pool = *tdbb->getDefaultPool();
+		parts = FB_NEW_POOL(pool) PartitionedSort(pool, creation);
+
+		for (unsigned i = 0; i < parallelism; i++)
+		{
+			SortPartTask* const part = parts->addPart();
+
+			part->sort = FB_NEW_POOL(transaction->tra_sorts.getPool())
+				Sort(dbb, &transaction->tra_sorts, key_length + sizeof(index_sort_record),
+					 2, 1, key_desc, isUnique ? duplicate_part_key : NULL, isUnique ? part : NULL);
+			creation.sortParts.add(part->sort);
+
+			part->sort->setParallelism(1);
+		}
+	}
+	else
+	{
+		FPTR_REJECT_DUP_CALLBACK callback = isUnique ? duplicate_key : NULL;
+		void* callback_arg = isUnique ? &creation : NULL;
+
+		scb = FB_NEW_POOL(transaction->tra_sorts.getPool())
+			Sort(dbb, &transaction->tra_sorts, key_length + sizeof(index_sort_record),
+					  2, 1, key_desc, callback, callback_arg);
+		creation.sort = scb;
+	}
 
 	jrd_rel* partner_relation = NULL;
 	USHORT partner_index_id = 0;
@@ -458,7 +589,11 @@ void IDX_create_index(thread_db* tdbb,
 			}
 
 			UCHAR* p;
-			scb->put(tdbb, reinterpret_cast<ULONG**>(&p));
+
+			if (parts)
+				parts->put(tdbb, reinterpret_cast<ULONG**>(&p));
+			else
+				scb->put(tdbb, reinterpret_cast<ULONG**>(&p));
 
 			// try to catch duplicates early
 
@@ -512,7 +647,12 @@ void IDX_create_index(thread_db* tdbb,
 		--relation->rel_scan_count;
 
 	if (!creation.duplicates)
-		scb->sort(tdbb);
+	{
+		if (parts)
+			parts->sort();
+		else
+			scb->sort(tdbb);
+	}
 
 	// ASF: We have a callback accessing "creation", so don't join above and below if's.
 
@@ -1048,7 +1188,7 @@ void IDX_statistics(thread_db* tdbb, jrd_rel* relation, USHORT id, SelectivityLi
 }
 
 
-void IDX_store(thread_db* tdbb, record_param* rpb, jrd_tra* transaction)
+void IDX_store(thread_db* tdbb, record_param* rpb, jrd_tra* transaction, BulkInsert* bulk)
 {
 /**************************************
  *
@@ -1060,6 +1200,8 @@ void IDX_store(thread_db* tdbb, record_param* rpb, jrd_tra* transaction)
  *	Update the various indices after a STORE operation.  If a duplicate
  *	index is violated, return the index number.  If successful, return
  *	-1.
+ *	With bulk insertion the keys of indices which can't be violated
+ *	are handed to it rather than inserted.
  *
  **************************************/
 	SET_TDBB(tdbb);
@@ -1091,6 +1233,9 @@ void IDX_store(thread_db* tdbb, record_param* rpb, jrd_tra* transaction)
 			context.raise(tdbb, error_code, rpb->rpb_record);
 		}
 
+		if (bulk && BulkInsert::isDeferred(&idx) && bulk->putKey(tdbb, &idx, &key, rpb->rpb_number))
+			continue;
+
 		if ( (error_code = insert_key(tdbb, rpb->rpb_relation, rpb->rpb_record, transaction,
 									  &window, &insertion, context)) )
 		{
@@ -1515,6 +1660,37 @@ static bool duplicate_key(const UCHAR* record1, const UCHAR* record2, void* ifl_
 }
 
 
+static bool duplicate_part_key(const UCHAR* record1, const UCHAR* record2, void* part_void)
+{
+/**************************************
+ *
+ *	d u p l i c a t e _ p a r t _ k e y
+ *
+ **************************************
+ *
+ * Functional description
+ *	Callback routine for duplicate keys during index creation
+ *	when the keys are sorted in parts by the worker threads.
+ *	Bump a counter of the part, it's reported by the caller
+ *	when all the parts are done.
+ *
+ **************************************/
+	SortPartTask* const part = static_cast<SortPartTask*>(part_void);
+	const USHORT key_length = part->creation->key_length;
+	const index_sort_record* rec1 = (index_sort_record*) (record1 + key_length);
+	const index_sort_record* rec2 = (index_sort_record*) (record2 + key_length);
+
+	if (!(rec1->isr_flags & (ISR_secondary | ISR_null)) &&
+		!(rec2->isr_flags & (ISR_secondary | ISR_null)))
+	{
+		if (!part->duplicates++)
+			part->dup_recno = rec2->isr_record_number;
+	}
+
+	return false;
+}
+
+
 static PageNumber get_root_page(thread_db* tdbb, jrd_rel* relation)
 {
 /**************************************
@@ -364,6 +364,7 @@ const USHORT WIN_large_scan			= 1;	// large sequential scan
 const USHORT WIN_secondary			= 2;	// secondary stream
 const USHORT WIN_garbage_collector	= 4;	// garbage collector's window
 const USHORT WIN_garbage_collect	= 8;	// scan left a page for garbage collector
+const USHORT WIN_prefetch			= 16;	// sequential scan asks for read-ahead of data pages
 
 
 #ifdef USE_ITIMER
@@ -288,6 +288,10 @@ NAME("MON$AUTO_COMMIT", nam_mon_auto_commit)
 NAME("MON$AUTO_UNDO", nam_mon_auto_undo)
 NAME("MON$BACKUP_STATE", nam_mon_backup_state)
 NAME("MON$BACKVERSION_READS", nam_mon_bkversion_reads)
+NAME("MON$BLOB_BYTES_READ", nam_mon_blob_bytes_read)
+NAME("MON$BLOB_PACKED_BYTES", nam_mon_blob_packed_bytes)
+NAME("MON$BLOB_PACKED_SIZE", nam_mon_blob_packed_size)
+NAME("MON$BLOB_PAGE_READS", nam_mon_blob_page_reads)
 NAME("MON$CALL_ID", nam_mon_call_id)
 NAME("MON$CALL_STACK", nam_mon_calls)
 NAME("MON$CALLER_ID", nam_mon_caller_id)
@@ -326,11 +330,16 @@ NAME("MON$OWNER", nam_mon_owner)
 NAME("MON$SEC_DATABASE", nam_mon_secdb)
 NAME("MON$PACKAGE_NAME", nam_mon_pkg_name)
 NAME("MON$PAGE_BUFFERS", nam_mon_page_bufs)
+NAME("MON$PAGE_EVICTIONS", nam_mon_page_evictions)
 NAME("MON$PAGE_FETCHES", nam_mon_page_fetches)
 NAME("MON$PAGE_MARKS", nam_mon_page_marks)
+NAME("MON$PAGE_PREFETCHES", nam_mon_page_prefetches)
+NAME("MON$PAGE_PROMOTIONS", nam_mon_page_promotions)
 NAME("MON$PAGE_READS", nam_mon_page_reads)
 NAME("MON$PAGE_WRITES", nam_mon_page_writes)
 NAME("MON$PAGES", nam_mon_pages)
+NAME("MON$PREFETCH_HITS", nam_mon_prefetch_hits)
+NAME("MON$PREFETCH_MISSES", nam_mon_prefetch_misses)
 NAME("MON$RECORD_BACKOUTS", nam_mon_rec_backouts)
 NAME("MON$RECORD_CONFLICTS", nam_mon_rec_conflicts)
 NAME("MON$RECORD_DELETES", nam_mon_rec_deletes)
@@ -363,6 +372,8 @@ NAME("MON$SQL_DIALECT", nam_mon_dialect)
 NAME("MON$STAT_GROUP", nam_mon_stat_group)
 NAME("MON$STAT_ID", nam_mon_stat_id)
 NAME("MON$STATE", nam_mon_state)
+NAME("MON$STATE_HITS", nam_mon_state_hits)
+NAME("MON$STATE_MISSES", nam_mon_state_misses)
 NAME("MON$STATEMENTS", nam_mon_statements)
 NAME("MON$STATEMENT_ID", nam_mon_stmt_id)
 NAME("MON$SWEEP_INTERVAL", nam_mon_sweep_int)
@@ -123,7 +123,8 @@ const USHORT ODS_CURRENT12		= 0;
 // Minor versions for ODS 13
 
 const USHORT ODS_CURRENT13_0	= 0;	// Firebird 4.0 features
-const USHORT ODS_CURRENT13		= 0;
+const USHORT ODS_CURRENT13_1	= 1;	// Long runs in records, compressed blobs
+const USHORT ODS_CURRENT13		= 1;
 
 // useful ODS macros. These are currently used to flag the version of the
 // system triggers and system indices in ini.e
@@ -144,6 +145,7 @@ const USHORT ODS_11_1		= ENCODE_ODS(ODS_VERSION11, 1);
 const USHORT ODS_11_2		= ENCODE_ODS(ODS_VERSION11, 2);
 const USHORT ODS_12_0		= ENCODE_ODS(ODS_VERSION12, 0);
 const USHORT ODS_13_0		= ENCODE_ODS(ODS_VERSION13, 0);
+const USHORT ODS_13_1		= ENCODE_ODS(ODS_VERSION13, 1);
 
 const USHORT ODS_FIREBIRD_FLAG = 0x8000;
 
@@ -171,7 +173,7 @@ const USHORT ODS_RELEASED = ODS_CURRENT13_0;	// The lowest stable minor version
 const USHORT ODS_CURRENT = ODS_CURRENT13;		// The highest defined minor version
 												// number for this ODS_VERSION!
 
-const USHORT ODS_CURRENT_VERSION = ODS_13_0;	// Current ODS version in use which includes
+const USHORT ODS_CURRENT_VERSION = ODS_13_1;	// Current ODS version in use which includes
 												// both major and minor ODS versions!
 
 
@@ -833,6 +835,7 @@ const USHORT rhd_damaged		= 128;		// object is known to be damaged
 const USHORT rhd_gc_active		= 256;		// garbage collecting dead record version
 const USHORT rhd_uk_modified	= 512;		// record key field values are changed
 const USHORT rhd_long_tranum	= 1024;		// transaction number is 64-bit
+const USHORT rhd_packed_blob	= 2048;		// blob data is compressed
 
 
 // This (not exact) copy of class DSC is used to store descriptors on disk.
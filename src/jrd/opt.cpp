@@ -326,6 +326,8 @@ static void gen_join(thread_db* tdbb, OptimizerBlk* opt, const StreamList& strea
 	RiverList& river_list, SortNode** sort_clause, PlanNode* plan_clause);
 static RecordSource* gen_outer(thread_db* tdbb, OptimizerBlk* opt, RseNode* rse,
 	RiverList& river_list, SortNode** sort_clause);
+static RecordSource* gen_outer_hash(thread_db* tdbb, OptimizerBlk* opt, RecordSource* leader,
+	StreamType innerStream, RecordSource* inner, BoolExprNode* boolean, JoinType joinType);
 static RecordSource* gen_residual_boolean(thread_db* tdbb, OptimizerBlk* opt, RecordSource* prior_rsb);
 static RecordSource* gen_retrieval(thread_db* tdbb, OptimizerBlk* opt, StreamType stream,
 	SortNode** sort_ptr, bool outer_flag, bool inner_flag, BoolExprNode** return_boolean);
@@ -1978,6 +1980,78 @@ void OPT_gen_aggregate_distincts(thread_db* tdbb, CompilerScratch* csb, MapNode*
 }
 
 
+// Estimate the number of distinct values of the grouping keys using index statistics.
+// Only the keys being plain fields of a single table covered by the leading segments
+// of some index are handled, zero is returned if the estimation is not possible.
+double OPT_estimate_groups(thread_db* tdbb, CompilerScratch* csb, const SortNode* group)
+{
+	SET_TDBB(tdbb);
+
+	const NestValueArray& keys = group->expressions;
+
+	if (keys.isEmpty() || keys.getCount() > MAX_INDEX_SEGMENTS)
+		return 0;
+
+	StreamType stream = INVALID_STREAM;
+	SortedArray<USHORT> fields(*tdbb->getDefaultPool());
+
+	for (const NestConst<ValueExprNode>* ptr = keys.begin(); ptr != keys.end(); ++ptr)
+	{
+		const FieldNode* const fieldNode = nodeAs<FieldNode>(*ptr);
+
+		if (!fieldNode || (stream != INVALID_STREAM && fieldNode->fieldStream != stream))
+			return 0;
+
+		stream = fieldNode->fieldStream;
+
+		if (!fields.exist(fieldNode->fieldId))
+			fields.add(fieldNode->fieldId);
+	}
+
+	jrd_rel* const relation = csb->csb_rpt[stream].csb_relation;
+
+	if (!relation || relation->rel_file || relation->isVirtual())
+		return 0;
+
+	IndexDescAlloc* indices = NULL;
+	const USHORT count = BTR_all(tdbb, relation, &indices, relation->getPages(tdbb));
+	const FB_SIZE_T segments = fields.getCount();
+
+	double selectivity = 0;
+
+	for (USHORT i = 0; i < count; i++)
+	{
+		const index_desc* const idx = &indices->items[i];
+
+		if ((idx->idx_flags & idx_expressn) || idx->idx_count < segments)
+			continue;
+
+		FB_SIZE_T matches = 0;
+
+		for (FB_SIZE_T j = 0; j < segments; j++)
+		{
+			if (fields.exist(idx->idx_rpt[j].idx_field))
+				matches++;
+		}
+
+		if (matches == segments && idx->idx_rpt[segments - 1].idx_selectivity > 0)
+		{
+			selectivity = idx->idx_rpt[segments - 1].idx_selectivity;
+			break;
+		}
+	}
+
+	delete indices;
+
+	if (selectivity <= 0)
+		return 0;
+
+	const double cardinality = get_cardinality(tdbb, relation, CMP_format(tdbb, csb, stream));
+
+	return MIN(1 / selectivity, MAX(cardinality, MINIMUM_CARDINALITY));
+}
+
+
 static void gen_join(thread_db*		tdbb,
 					 OptimizerBlk*	opt,
 					 const StreamList&	streams,
@@ -2089,11 +2163,15 @@ static RecordSource* gen_outer(thread_db* tdbb, OptimizerBlk* opt, RseNode* rse,
 
 	const bool isFullJoin = (rse->rse_jointype == blr_full);
 
+	// Explicit plan asks for nested loops
+	const bool allowHash = !rse->rse_plan;
+
 	if (!isFullJoin)
 	{
 		// Generate rsbs for the sub-streams.
 		// For the left sub-stream we also will get a boolean back.
 		BoolExprNode* boolean = NULL;
+		const bool sorted = sort_clause && *sort_clause;
 
 		if (!stream_o.stream_rsb)
 		{
@@ -2107,6 +2185,16 @@ static RecordSource* gen_outer(thread_db* tdbb, OptimizerBlk* opt, RseNode* rse,
 			//	   should never be used for the index retrieval
 			stream_i.stream_rsb =
 				gen_retrieval(tdbb, opt, stream_i.stream_num, NULL, false, true, NULL);
+
+			// Hash join doesn't keep order of the outer stream navigated instead of sorting
+			if (allowHash && !(sorted && !*sort_clause))
+			{
+				RecordSource* const rsb = gen_outer_hash(tdbb, opt, stream_o.stream_rsb,
+					stream_i.stream_num, stream_i.stream_rsb, boolean, OUTER_JOIN);
+
+				if (rsb)
+					return rsb;
+			}
 		}
 
 		// generate a parent boolean rsb for any remaining booleans that
@@ -2136,10 +2224,17 @@ static RecordSource* gen_outer(thread_db* tdbb, OptimizerBlk* opt, RseNode* rse,
 			gen_retrieval(tdbb, opt, stream_i.stream_num, NULL, false, true, NULL);
 	}
 
-	RecordSource* const innerRsb = gen_residual_boolean(tdbb, opt, stream_i.stream_rsb);
+	RecordSource* rsb1 = (allowHash && !hasInnerRsb) ?
+		gen_outer_hash(tdbb, opt, stream_o.stream_rsb, stream_i.stream_num, stream_i.stream_rsb,
+			boolean, OUTER_JOIN) : NULL;
 
-	RecordSource* const rsb1 = FB_NEW_POOL(*tdbb->getDefaultPool())
-		NestedLoopJoin(csb, stream_o.stream_rsb, innerRsb, boolean, OUTER_JOIN);
+	if (!rsb1)
+	{
+		RecordSource* const innerRsb = gen_residual_boolean(tdbb, opt, stream_i.stream_rsb);
+
+		rsb1 = FB_NEW_POOL(*tdbb->getDefaultPool())
+			NestedLoopJoin(csb, stream_o.stream_rsb, innerRsb, boolean, OUTER_JOIN);
+	}
 
 	for (FB_SIZE_T i = 0; i < opt->opt_conjuncts.getCount(); i++)
 	{
@@ -2171,15 +2266,136 @@ static RecordSource* gen_outer(thread_db* tdbb, OptimizerBlk* opt, RseNode* rse,
 			gen_retrieval(tdbb, opt, stream_o.stream_num, NULL, false, false, NULL);
 	}
 
-	RecordSource* const outerRsb = gen_residual_boolean(tdbb, opt, stream_o.stream_rsb);
+	RecordSource* rsb2 = (allowHash && !hasOuterRsb) ?
+		gen_outer_hash(tdbb, opt, stream_i.stream_rsb, stream_o.stream_num, stream_o.stream_rsb,
+			boolean, ANTI_JOIN) : NULL;
 
-	RecordSource* const rsb2 = FB_NEW_POOL(*tdbb->getDefaultPool())
-		NestedLoopJoin(csb, stream_i.stream_rsb, outerRsb, boolean, ANTI_JOIN);
+	if (!rsb2)
+	{
+		RecordSource* const outerRsb = gen_residual_boolean(tdbb, opt, stream_o.stream_rsb);
+
+		rsb2 = FB_NEW_POOL(*tdbb->getDefaultPool())
+			NestedLoopJoin(csb, stream_i.stream_rsb, outerRsb, boolean, ANTI_JOIN);
+	}
 
 	return FB_NEW_POOL(*tdbb->getDefaultPool()) FullOuterJoin(csb, rsb1, rsb2);
 }
 
 
+static RecordSource* gen_outer_hash(thread_db* tdbb, OptimizerBlk* opt, RecordSource* leader,
+	StreamType innerStream, RecordSource* inner, BoolExprNode* boolean, JoinType joinType)
+{
+/**************************************
+ *
+ *	g e n _ o u t e r _ h a s h
+ *
+ **************************************
+ *
+ * Functional description
+ *	Join the inner stream of an outer (or anti) join by hashing
+ *	if it's not looked up by an index and is related to the
+ *	leader by equality of the same typed values.  All the
+ *	remaining conjuncts, including the leader's boolean, become
+ *	the join condition checked for every hashed candidate.
+ *	Return NULL if the streams can't be joined this way.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+	DEV_BLKCHK(opt, type_opt);
+
+	CompilerScratch* const csb = opt->opt_csb;
+	MemoryPool& pool = *tdbb->getDefaultPool();
+
+	StreamList leaderStreams;
+	leader->findUsedStreams(leaderStreams);
+
+	NestValueArray* const leaderKeys = FB_NEW_POOL(pool) NestValueArray(pool);
+	NestValueArray* const innerKeys = FB_NEW_POOL(pool) NestValueArray(pool);
+
+	const OptimizerBlk::opt_conjunct* const opt_end =
+		opt->opt_conjuncts.begin() + opt->opt_base_conjuncts;
+
+	// Equalities used by an index lookup of the inner stream are already marked used
+
+	for (OptimizerBlk::opt_conjunct* tail = opt->opt_conjuncts.begin(); tail < opt_end; tail++)
+	{
+		if (tail->opt_conjunct_flags & opt_conjunct_used)
+			continue;
+
+		ComparativeBoolNode* const cmpNode = nodeAs<ComparativeBoolNode>(tail->opt_conjunct_node);
+
+		if (!cmpNode || cmpNode->blrOp != blr_eql)
+			continue;
+
+		ValueExprNode* leaderKey = cmpNode->arg1;
+		ValueExprNode* innerKey = cmpNode->arg2;
+
+		if (!innerKey->findStream(csb, innerStream))
+		{
+			leaderKey = cmpNode->arg2;
+			innerKey = cmpNode->arg1;
+		}
+
+		if (!innerKey->findStream(csb, innerStream) ||
+			!innerKey->computable(csb, innerStream, true) ||
+			!leaderKey->computable(csb, innerStream, false))
+		{
+			continue;
+		}
+
+		bool related = false;
+
+		for (const StreamType* iter = leaderStreams.begin(); !related && iter < leaderStreams.end(); iter++)
+			related = leaderKey->findStream(csb, *iter);
+
+		if (!related)
+			continue;
+
+		// Keys of both streams must hash the same way
+
+		dsc leaderDesc, innerDesc;
+		leaderKey->getDesc(tdbb, csb, &leaderDesc);
+		innerKey->getDesc(tdbb, csb, &innerDesc);
+
+		if (leaderDesc.isBlob() ||
+			leaderDesc.dsc_dtype != innerDesc.dsc_dtype ||
+			leaderDesc.dsc_length != innerDesc.dsc_length ||
+			leaderDesc.dsc_scale != innerDesc.dsc_scale ||
+			leaderDesc.dsc_sub_type != innerDesc.dsc_sub_type)
+		{
+			continue;
+		}
+
+		leaderKeys->add(leaderKey);
+		innerKeys->add(innerKey);
+	}
+
+	if (leaderKeys->isEmpty())
+	{
+		delete leaderKeys;
+		delete innerKeys;
+		return NULL;
+	}
+
+	// Equal hashes are not enough to join the records, so the
+	// equalities are the part of the join condition as well
+
+	for (OptimizerBlk::opt_conjunct* tail = opt->opt_conjuncts.begin(); tail < opt_end; tail++)
+	{
+		if (!(tail->opt_conjunct_flags & opt_conjunct_used))
+		{
+			compose(pool, &boolean, tail->opt_conjunct_node);
+			tail->opt_conjunct_flags |= opt_conjunct_used;
+		}
+	}
+
+	RecordSource* const rsbs[2] = {leader, inner};
+	NestValueArray* const keys[2] = {leaderKeys, innerKeys};
+
+	return FB_NEW_POOL(pool) HashJoin(tdbb, csb, 2, rsbs, keys, joinType, boolean);
+}
+
+
 static RecordSource* gen_residual_boolean(thread_db* tdbb, OptimizerBlk* opt, RecordSource* prior_rsb)
 {
 /**************************************
@@ -34,10 +34,18 @@
 #include "../common/classes/array.h"
 #include "../common/classes/File.h"
 
+namespace Ods {
+	struct pag;
+}
+
 namespace Jrd {
 
+class BufferDesc;
+
 #ifdef UNIX
 
+class IoRing;
+
 class jrd_file : public pool_alloc_rpt<SCHAR, type_fil>
 {
 public:
@@ -48,6 +56,8 @@ public:
 	USHORT fil_fudge;			// Fudge factor for page relocation
 	int fil_desc;
 	Firebird::Mutex fil_mutex;
+	IoRing* fil_ring;			// Queue for batched I/O, main file only
+	Firebird::Mutex fil_ring_mutex;
 	USHORT fil_flags;
 	SCHAR fil_string[1];		// Expanded file name
 };
@@ -89,6 +99,16 @@ const USHORT FIL_readonly			= 4;	// file opened in readonly mode
 const USHORT FIL_sh_write			= 8;	// file opened in shared write mode
 const USHORT FIL_no_fast_extend		= 16;	// file not supports fast extending
 const USHORT FIL_raw_device			= 32;	// file is raw device
+const USHORT FIL_no_io_ring			= 64;	// batched I/O is not available for file
+
+// Element of batched page I/O, see PIO_read_pages and PIO_write_pages
+
+struct PageIo
+{
+	BufferDesc* pio_bdb;		// Buffer the page belongs to
+	Ods::pag* pio_page;			// Page image to read or write
+	bool pio_done;				// Transfer completed successfully
+};
 
 // Physical IO trace events
 
@@ -49,6 +49,21 @@
 #include <linux/falloc.h>
 #endif
 
+#ifdef HAVE_LINUX_IO_URING_H
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+
+// Same numbers for all architectures
+#ifndef __NR_io_uring_setup
+#define __NR_io_uring_setup		425
+#endif
+#ifndef __NR_io_uring_enter
+#define __NR_io_uring_enter		426
+#endif
+#endif
+
 #ifdef SUPPORT_RAW_DEVICES
 #include <sys/ioctl.h>
 
@@ -138,6 +153,239 @@ static int  raw_devices_unlink_database (const PathName&);
 #endif
 static int	openFile(const Firebird::PathName&, const bool, const bool, const bool);
 static void	maybeCloseFile(int&);
+static bool	batch_io(thread_db*, jrd_file*, PageIo*, FB_SIZE_T, const bool);
+
+#ifdef HAVE_LINUX_IO_URING_H
+
+namespace Jrd {
+
+// Minimal wrapper of Linux io_uring interface used to submit a batch of
+// page reads or writes at once. Kernel interface is used directly, there
+// is no need in liburing for such simple usage.
+
+class IoRing
+{
+public:
+	explicit IoRing(unsigned entries);
+	~IoRing();
+
+	bool isValid() const
+	{
+		return ringDesc >= 0;
+	}
+
+	unsigned getDepth() const
+	{
+		return sqEntries;
+	}
+
+	bool queue(bool write, int desc, const iovec* iov, FB_UINT64 offset, FB_UINT64 userData);
+	void submit(unsigned minComplete);
+	bool reap(FB_UINT64* userData, int* result);
+	bool drain(unsigned inFlight);
+
+private:
+	void release();
+
+	int ringDesc;
+	unsigned sqEntries;
+	unsigned toSubmit;
+
+	void* sqRing;
+	size_t sqRingSize;
+	void* cqRing;
+	size_t cqRingSize;
+	io_uring_sqe* sqes;
+	size_t sqesSize;
+
+	unsigned* sqHead;
+	unsigned* sqTail;
+	unsigned* sqMask;
+	unsigned* sqArray;
+	unsigned* cqHead;
+	unsigned* cqTail;
+	unsigned* cqMask;
+	io_uring_cqe* cqes;
+};
+
+IoRing::IoRing(unsigned entries)
+	: ringDesc(-1), sqEntries(0), toSubmit(0),
+	  sqRing(MAP_FAILED), sqRingSize(0), cqRing(MAP_FAILED), cqRingSize(0),
+	  sqes((io_uring_sqe*) MAP_FAILED), sqesSize(0)
+{
+	io_uring_params params;
+	memset(&params, 0, sizeof(params));
+
+	const int desc = syscall(__NR_io_uring_setup, entries, &params);
+	if (desc < 0)
+		return;
+
+	sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+	sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+
+	sqRing = mmap(NULL, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+		desc, IORING_OFF_SQ_RING);
+	cqRing = mmap(NULL, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+		desc, IORING_OFF_CQ_RING);
+	sqes = (io_uring_sqe*) mmap(NULL, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+		desc, IORING_OFF_SQES);
+
+	ringDesc = desc;
+
+	if (sqRing == MAP_FAILED || cqRing == MAP_FAILED || sqes == MAP_FAILED)
+	{
+		release();
+		return;
+	}
+
+	UCHAR* const sq = (UCHAR*) sqRing;
+	sqHead = (unsigned*) (sq + params.sq_off.head);
+	sqTail = (unsigned*) (sq + params.sq_off.tail);
+	sqMask = (unsigned*) (sq + params.sq_off.ring_mask);
+	sqArray = (unsigned*) (sq + params.sq_off.array);
+
+	UCHAR* const cq = (UCHAR*) cqRing;
+	cqHead = (unsigned*) (cq + params.cq_off.head);
+	cqTail = (unsigned*) (cq + params.cq_off.tail);
+	cqMask = (unsigned*) (cq + params.cq_off.ring_mask);
+	cqes = (io_uring_cqe*) (cq + params.cq_off.cqes);
+
+	sqEntries = params.sq_entries;
+}
+
+IoRing::~IoRing()
+{
+	release();
+}
+
+void IoRing::release()
+{
+	if (sqes != MAP_FAILED)
+		munmap(sqes, sqesSize);
+	if (cqRing != MAP_FAILED)
+		munmap(cqRing, cqRingSize);
+	if (sqRing != MAP_FAILED)
+		munmap(sqRing, sqRingSize);
+	if (ringDesc >= 0)
+		close(ringDesc);
+
+	sqes = (io_uring_sqe*) MAP_FAILED;
+	cqRing = sqRing = MAP_FAILED;
+	ringDesc = -1;
+}
+
+// Put vectored read or write into submission queue, return false if queue is full
+bool IoRing::queue(bool write, int desc, const iovec* iov, FB_UINT64 offset, FB_UINT64 userData)
+{
+	const unsigned tail = *sqTail;
+	if (tail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) >= sqEntries)
+		return false;
+
+	const unsigned index = tail & *sqMask;
+	io_uring_sqe* const sqe = &sqes[index];
+	memset(sqe, 0, sizeof(io_uring_sqe));
+
+	sqe->opcode = write ? IORING_OP_WRITEV : IORING_OP_READV;
+	sqe->fd = desc;
+	sqe->addr = (FB_UINT64) (IPTR) iov;
+	sqe->len = 1;
+	sqe->off = offset;
+	sqe->user_data = userData;
+
+	sqArray[index] = index;
+	__atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+	toSubmit++;
+
+	return true;
+}
+
+// Pass queued requests to kernel and wait for at least minComplete completions.
+// If completion queue is full, only wait for completions: caller should reap
+// them and call submit again for the rest of queued requests.
+void IoRing::submit(unsigned minComplete)
+{
+	const unsigned flags = minComplete ? IORING_ENTER_GETEVENTS : 0;
+
+	while (true)
+	{
+		const int n = syscall(__NR_io_uring_enter, ringDesc, toSubmit, minComplete, flags, NULL, 0);
+
+		if (n >= 0)
+		{
+			toSubmit -= n;
+			if (!toSubmit)
+				break;
+		}
+		else if (errno == EBUSY)
+		{
+			// Retrying submit would not succeed until completions are reaped
+			while (syscall(__NR_io_uring_enter, ringDesc, 0, minComplete, flags, NULL, 0) < 0 &&
+				errno != EBUSY)
+			{
+				if (!SYSCALL_INTERRUPTED(errno))
+					system_call_failed::raise("io_uring_enter");
+			}
+
+			break;
+		}
+		else if (!SYSCALL_INTERRUPTED(errno) && errno != EAGAIN)
+			system_call_failed::raise("io_uring_enter");
+	}
+}
+
+// Get next completed request, return false if there is no one
+bool IoRing::reap(FB_UINT64* userData, int* result)
+{
+	const unsigned head = *cqHead;
+	if (head == __atomic_load_n(cqTail, __ATOMIC_ACQUIRE))
+		return false;
+
+	const io_uring_cqe* const cqe = &cqes[head & *cqMask];
+	*userData = cqe->user_data;
+	*result = cqe->res;
+
+	__atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+
+	return true;
+}
+
+// Forget requests not passed to kernel yet and wait for completion of the
+// rest of inFlight ones, so nothing refers to caller's buffers any more and
+// no completion is left for the next batch. Return false if ring can't be
+// waited for and must not be used again.
+bool IoRing::drain(unsigned inFlight)
+{
+	if (toSubmit)
+	{
+		fb_assert(inFlight >= toSubmit);
+		__atomic_store_n(sqTail, *sqTail - toSubmit, __ATOMIC_RELEASE);
+		inFlight -= toSubmit;
+		toSubmit = 0;
+	}
+
+	FB_UINT64 userData;
+	int result;
+
+	while (true)
+	{
+		while (inFlight && reap(&userData, &result))
+			inFlight--;
+
+		if (!inFlight)
+			return true;
+
+		if (syscall(__NR_io_uring_enter, ringDesc, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0 &&
+			!SYSCALL_INTERRUPTED(errno) && errno != EAGAIN && errno != EBUSY)
+		{
+			return false;
+		}
+	}
+}
+
+} // namespace Jrd
+
+#endif // HAVE_LINUX_IO_URING_H
 
 int PIO_add_file(thread_db* tdbb, jrd_file* main_file, const PathName& file_name, SLONG start)
 {
@@ -197,6 +445,11 @@ void PIO_close(jrd_file* main_file)
 			file->fil_desc = -1;
 		}
 	}
+
+#ifdef HAVE_LINUX_IO_URING_H
+	delete main_file->fil_ring;
+	main_file->fil_ring = NULL;
+#endif
 }
 
 
@@ -466,6 +719,29 @@ void PIO_force_write(jrd_file* file, const bool forcedWrites, const bool notUseF
 }
 
 
+ULONG PIO_get_batch_size(thread_db* tdbb, const jrd_file* main_file)
+{
+/**************************************
+ *
+ *	P I O _ g e t _ b a t c h _ s i z e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Return maximum number of pages worth to be passed
+ *	at once to batched I/O routines, zero if batched
+ *	I/O is not available.
+ *
+ **************************************/
+#ifdef HAVE_LINUX_IO_URING_H
+	if (!(main_file->fil_flags & FIL_no_io_ring))
+		return tdbb->getDatabase()->dbb_config->getIoQueueDepth();
+#endif
+
+	return 0;
+}
+
+
 ULONG PIO_get_number_of_pages(const jrd_file* file, const USHORT pagesize)
 {
 /**************************************
@@ -839,6 +1115,177 @@ bool PIO_write(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page,
 }
 
 
+bool PIO_read_pages(thread_db* tdbb, jrd_file* file, PageIo* pages, FB_SIZE_T count)
+{
+/**************************************
+ *
+ *	P I O _ r e a d _ p a g e s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Read a batch of pages submitting all requests at once.
+ *	Pages successfully read are marked as done, caller is
+ *	responsible to read the rest of pages one by one.
+ *	Return true if all pages are read.
+ *
+ **************************************/
+
+	return batch_io(tdbb, file, pages, count, false);
+}
+
+
+bool PIO_write_pages(thread_db* tdbb, jrd_file* file, PageIo* pages, FB_SIZE_T count)
+{
+/**************************************
+ *
+ *	P I O _ w r i t e _ p a g e s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Write a batch of pages submitting all requests at once.
+ *	Pages successfully written are marked as done, caller is
+ *	responsible to write the rest of pages one by one.
+ *	Return true if all pages are written.
+ *
+ **************************************/
+
+	return batch_io(tdbb, file, pages, count, true);
+}
+
+
+static bool batch_io(thread_db* tdbb, jrd_file* main_file, PageIo* pages, FB_SIZE_T count,
+	const bool write)
+{
+/**************************************
+ *
+ *	b a t c h _ i o
+ *
+ **************************************
+ *
+ * Functional description
+ *	Perform batched page I/O using io_uring of the main
+ *	database file. If the ring is not available or busy
+ *	serving another batch, do nothing and let caller do
+ *	the I/O in the regular way.
+ *
+ **************************************/
+
+	for (FB_SIZE_T i = 0; i < count; i++)
+		pages[i].pio_done = false;
+
+#ifdef HAVE_LINUX_IO_URING_H
+	Database* const dbb = tdbb->getDatabase();
+	const int depth = dbb->dbb_config->getIoQueueDepth();
+
+	if (count < 2 || !depth || (main_file->fil_flags & FIL_no_io_ring) || main_file->fil_desc == -1)
+		return false;
+
+	if (!main_file->fil_ring_mutex.tryEnter(FB_FUNCTION))
+		return false;
+
+	FB_SIZE_T done = 0;
+	IoRing* ring = main_file->fil_ring;
+	unsigned inFlight = 0;
+
+	try
+	{
+		if (!ring)
+		{
+			ring = FB_NEW_POOL(*dbb->dbb_permanent) IoRing(depth);
+
+			if (!ring->isValid())
+			{
+				// Kernel without io_uring support or not allowed to use it,
+				// don't try again for this file
+				delete ring;
+				main_file->fil_flags |= FIL_no_io_ring;
+				main_file->fil_ring_mutex.leave();
+				return false;
+			}
+
+			main_file->fil_ring = ring;
+		}
+
+		EngineCheckout cout(tdbb, FB_FUNCTION, true);
+
+		const FB_UINT64 size = dbb->dbb_page_size;
+		HalfStaticArray<iovec, 64> iov;
+		iovec* const vectors = iov.getBuffer(count);
+
+		FB_SIZE_T next = 0;
+
+		while (next < count || inFlight)
+		{
+			while (next < count && inFlight < ring->getDepth())
+			{
+				PageIo& io = pages[next];
+
+				FbLocalStatus status;
+				FB_UINT64 offset;
+				jrd_file* const file = seek_file(main_file, io.pio_bdb, &offset, &status);
+
+				if (file)
+				{
+					vectors[next].iov_base = io.pio_page;
+					vectors[next].iov_len = size;
+
+					if (!ring->queue(write, file->fil_desc, &vectors[next], offset, next))
+						break;
+
+					inFlight++;
+				}
+
+				next++;
+			}
+
+			if (!inFlight)
+				break;
+
+			ring->submit(1);
+
+			FB_UINT64 index;
+			int result;
+
+			while (ring->reap(&index, &result))
+			{
+				fb_assert(index < count && inFlight);
+				inFlight--;
+
+				if (result == (int) size)
+				{
+					pages[index].pio_done = true;
+					done++;
+				}
+			}
+		}
+	}
+	catch (const Exception&)
+	{
+		// Requests still in kernel refer to vectors and page buffers.
+		// If they can't be waited for, tear the ring down.
+		if (inFlight && !ring->drain(inFlight))
+		{
+			gds__log("Error waiting for batched I/O of file %s, it's not batched any more",
+				main_file->fil_string);
+			delete ring;
+			main_file->fil_ring = NULL;
+			main_file->fil_flags |= FIL_no_io_ring;
+		}
+
+		main_file->fil_ring_mutex.leave();
+		throw;
+	}
+
+	main_file->fil_ring_mutex.leave();
+
+	return done == count;
+#else
+	return false;
+#endif
+}
+
 static jrd_file* seek_file(jrd_file* file, BufferDesc* bdb, FB_UINT64* offset,
 	FbStatusVector* status_vector)
 {
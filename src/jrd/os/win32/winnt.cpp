@@ -765,6 +765,64 @@ bool PIO_write(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page,
 }
 
 
+ULONG PIO_get_batch_size(thread_db*, const jrd_file*)
+{
+/**************************************
+ *
+ *	P I O _ g e t _ b a t c h _ s i z e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Batched page I/O is not implemented on Windows.
+ *
+ **************************************/
+
+	return 0;
+}
+
+
+bool PIO_read_pages(thread_db*, jrd_file*, PageIo* pages, FB_SIZE_T count)
+{
+/**************************************
+ *
+ *	P I O _ r e a d _ p a g e s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Batched page I/O is not implemented on Windows,
+ *	caller reads pages one by one.
+ *
+ **************************************/
+
+	for (FB_SIZE_T i = 0; i < count; i++)
+		pages[i].pio_done = false;
+
+	return false;
+}
+
+
+bool PIO_write_pages(thread_db*, jrd_file*, PageIo* pages, FB_SIZE_T count)
+{
+/**************************************
+ *
+ *	P I O _ w r i t e _ p a g e s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Batched page I/O is not implemented on Windows,
+ *	caller writes pages one by one.
+ *
+ **************************************/
+
+	for (FB_SIZE_T i = 0; i < count; i++)
+		pages[i].pio_done = false;
+
+	return false;
+}
+
 ULONG PIO_get_number_of_pages(const jrd_file* file, const USHORT pagesize)
 {
 /**************************************
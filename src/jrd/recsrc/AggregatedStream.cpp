@@ -302,8 +302,6 @@ int BaseAggWinStream<ThisType, NextType>::lookForChange(thread_db* tdbb, jrd_req
 	if (!group)
 		return false;
 
-	Impure* const impure = getImpure(request);
-
 	for (const NestConst<ValueExprNode>* ptrValue = group->begin(), *endValue = group->end();
 		 ptrValue != endValue;
 		 ++ptrValue)
@@ -356,8 +354,9 @@ bool BaseAggWinStream<ThisType, NextType>::getNextRecord(thread_db* tdbb, jrd_re
 		return m_next->getRecord(tdbb);
 }
 
-// Export the template for WindowedStream::WindowStream.
+// Export the template for WindowedStream::WindowStream and HashAggregateStream.
 template class Jrd::BaseAggWinStream<WindowedStream::WindowStream, BaseBufferedStream>;
+template class Jrd::BaseAggWinStream<HashAggregateStream, RecordSource>;
 
 // ------------------------------
 
@@ -158,8 +158,6 @@ bool BufferedStream::getRecord(thread_db* tdbb) const
 	if (!(impure->irsb_flags & irsb_open))
 		return false;
 
-	dsc from, to;
-
 	Record* const buffer_record = impure->irsb_buffer->getTempRecord();
 
 	if (impure->irsb_flags & irsb_mustread)
@@ -173,128 +171,146 @@ bool BufferedStream::getRecord(thread_db* tdbb) const
 			return false;
 		}
 
-		buffer_record->nullify();
+		packRecord(tdbb, buffer_record);
 
-		// Assign the fields to the record to be stored
-		for (FB_SIZE_T i = 0; i < m_map.getCount(); i++)
-		{
-			const FieldMap& map = m_map[i];
-
-			record_param* const rpb = &request->req_rpb[map.map_stream];
-			Record* const record = rpb->rpb_record;
+		// Put the record into the buffer
+		impure->irsb_buffer->store(buffer_record);
+	}
+	else
+	{
+		// Read the record from the buffer
+		if (!impure->irsb_buffer->fetch(impure->irsb_position, buffer_record))
+			return false;
 
-			if (map.map_type == FieldMap::REGULAR_FIELD)
-			{
-				if (!EVL_field(rpb->rpb_relation, record, map.map_id, &from))
-					continue;
-			}
+		unpackRecord(tdbb, buffer_record);
+	}
 
-			buffer_record->clearNull(i);
+	impure->irsb_position++;
+	return true;
+}
 
-			if (!EVL_field(rpb->rpb_relation, buffer_record, (USHORT) i, &to))
-				fb_assert(false);
+void BufferedStream::packRecord(thread_db* tdbb, Record* buffer_record) const
+{
+	jrd_req* const request = tdbb->getRequest();
 
-			switch (map.map_type)
-			{
-			case FieldMap::REGULAR_FIELD:
-				MOV_move(tdbb, &from, &to);
-				break;
+	dsc from, to;
 
-			case FieldMap::TRANSACTION_ID:
-				*reinterpret_cast<SINT64*>(to.dsc_address) = rpb->rpb_transaction_nr;
-				break;
+	buffer_record->nullify();
 
-			case FieldMap::DBKEY_NUMBER:
-				*reinterpret_cast<SINT64*>(to.dsc_address) = rpb->rpb_number.getValue();
-				break;
+	// Assign the fields to the record to be stored
+	for (FB_SIZE_T i = 0; i < m_map.getCount(); i++)
+	{
+		const FieldMap& map = m_map[i];
 
-			case FieldMap::DBKEY_VALID:
-				*to.dsc_address = (UCHAR) rpb->rpb_number.isValid();
-				break;
+		record_param* const rpb = &request->req_rpb[map.map_stream];
+		Record* const record = rpb->rpb_record;
 
-			default:
-				fb_assert(false);
-			}
+		if (map.map_type == FieldMap::REGULAR_FIELD)
+		{
+			if (!EVL_field(rpb->rpb_relation, record, map.map_id, &from))
+				continue;
 		}
 
-		// Put the record into the buffer
-		impure->irsb_buffer->store(buffer_record);
+		buffer_record->clearNull(i);
+
+		if (!EVL_field(rpb->rpb_relation, buffer_record, (USHORT) i, &to))
+			fb_assert(false);
+
+		switch (map.map_type)
+		{
+		case FieldMap::REGULAR_FIELD:
+			MOV_move(tdbb, &from, &to);
+			break;
+
+		case FieldMap::TRANSACTION_ID:
+			*reinterpret_cast<SINT64*>(to.dsc_address) = rpb->rpb_transaction_nr;
+			break;
+
+		case FieldMap::DBKEY_NUMBER:
+			*reinterpret_cast<SINT64*>(to.dsc_address) = rpb->rpb_number.getValue();
+			break;
+
+		case FieldMap::DBKEY_VALID:
+			*to.dsc_address = (UCHAR) rpb->rpb_number.isValid();
+			break;
+
+		default:
+			fb_assert(false);
+		}
 	}
-	else
+}
+
+void BufferedStream::unpackRecord(thread_db* tdbb, Record* buffer_record) const
+{
+	jrd_req* const request = tdbb->getRequest();
+
+	dsc from, to;
+
+	StreamType stream = INVALID_STREAM;
+
+	// Assign fields back to their original streams
+	for (FB_SIZE_T i = 0; i < m_map.getCount(); i++)
 	{
-		// Read the record from the buffer
-		if (!impure->irsb_buffer->fetch(impure->irsb_position, buffer_record))
-			return false;
+		const FieldMap& map = m_map[i];
 
-		StreamType stream = INVALID_STREAM;
+		record_param* const rpb = &request->req_rpb[map.map_stream];
+		jrd_rel* const relation = rpb->rpb_relation;
 
-		// Assign fields back to their original streams
-		for (FB_SIZE_T i = 0; i < m_map.getCount(); i++)
+		if (relation &&
+			!relation->rel_file &&
+			!relation->rel_view_rse &&
+			!relation->isVirtual())
 		{
-			const FieldMap& map = m_map[i];
-
-			record_param* const rpb = &request->req_rpb[map.map_stream];
-			jrd_rel* const relation = rpb->rpb_relation;
+			rpb->rpb_runtime_flags |= RPB_refetch;
+		}
 
-			if (relation &&
-				!relation->rel_file &&
-				!relation->rel_view_rse &&
-				!relation->isVirtual())
-			{
-				rpb->rpb_runtime_flags |= RPB_refetch;
-			}
+		if (map.map_stream != stream)
+		{
+			stream = map.map_stream;
 
-			if (map.map_stream != stream)
-			{
-				stream = map.map_stream;
+			// See SortedStream::mapData() for explanations why we need
+			// to upgrade the record format
 
-				// See SortedStream::mapData() for explanations why we need
-				// to upgrade the record format
+			if (relation && !rpb->rpb_number.isValid())
+				VIO_record(tdbb, rpb, MET_current(tdbb, relation), tdbb->getDefaultPool());
+		}
 
-				if (relation && !rpb->rpb_number.isValid())
-					VIO_record(tdbb, rpb, MET_current(tdbb, relation), tdbb->getDefaultPool());
-			}
+		Record* const record = rpb->rpb_record;
+		record->reset();
 
-			Record* const record = rpb->rpb_record;
-			record->reset();
+		if (!EVL_field(relation, buffer_record, (USHORT) i, &from))
+		{
+			fb_assert(map.map_type == FieldMap::REGULAR_FIELD);
+			record->setNull(map.map_id);
+			continue;
+		}
 
-			if (!EVL_field(relation, buffer_record, (USHORT) i, &from))
+		switch (map.map_type)
+		{
+		case FieldMap::REGULAR_FIELD:
 			{
-				fb_assert(map.map_type == FieldMap::REGULAR_FIELD);
-				record->setNull(map.map_id);
-				continue;
+				EVL_field(relation, record, map.map_id, &to);
+				MOV_move(tdbb, &from, &to);
+				record->clearNull(map.map_id);
 			}
+			break;
 
-			switch (map.map_type)
-			{
-			case FieldMap::REGULAR_FIELD:
-				{
-					EVL_field(relation, record, map.map_id, &to);
-					MOV_move(tdbb, &from, &to);
-					record->clearNull(map.map_id);
-				}
-				break;
-
-			case FieldMap::TRANSACTION_ID:
-				rpb->rpb_transaction_nr = *reinterpret_cast<SINT64*>(from.dsc_address);
-				break;
-
-			case FieldMap::DBKEY_NUMBER:
-				rpb->rpb_number.setValue(*reinterpret_cast<SINT64*>(from.dsc_address));
-				break;
-
-			case FieldMap::DBKEY_VALID:
-				rpb->rpb_number.setValid(*from.dsc_address != 0);
-				break;
-
-			default:
-				fb_assert(false);
-			}
+		case FieldMap::TRANSACTION_ID:
+			rpb->rpb_transaction_nr = *reinterpret_cast<SINT64*>(from.dsc_address);
+			break;
+
+		case FieldMap::DBKEY_NUMBER:
+			rpb->rpb_number.setValue(*reinterpret_cast<SINT64*>(from.dsc_address));
+			break;
+
+		case FieldMap::DBKEY_VALID:
+			rpb->rpb_number.setValid(*from.dsc_address != 0);
+			break;
+
+		default:
+			fb_assert(false);
 		}
 	}
-
-	impure->irsb_position++;
-	return true;
 }
 
 bool BufferedStream::refetchRecord(thread_db* tdbb) const
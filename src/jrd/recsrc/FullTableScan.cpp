@@ -61,6 +61,13 @@ void FullTableScan::open(thread_db* tdbb) const
 	record_param* const rpb = &request->req_rpb[m_stream];
 	rpb->getWindow(tdbb).win_flags = 0;
 
+	BufferControl* const bcb = dbb->dbb_bcb;
+
+	// Ask the cache readers to read data pages ahead of the scan
+
+	if (bcb->bcb_flags & BCB_cache_reader)
+		rpb->getWindow(tdbb).win_flags |= WIN_prefetch;
+
 	// Unless this is the only attachment, limit the cache flushing
 	// effect of large sequential scans on the page working sets of
 	// other attachments
@@ -76,11 +83,9 @@ void FullTableScan::open(thread_db* tdbb) const
 		// because the cumulative effect of scanning all relations
 		// is equal to that of a single large relation.
 
-		BufferControl* const bcb = dbb->dbb_bcb;
-
 		if (attachment->isGbak() || DPM_data_pages(tdbb, m_relation) > bcb->bcb_count)
 		{
-			rpb->getWindow(tdbb).win_flags = WIN_large_scan;
+			rpb->getWindow(tdbb).win_flags |= WIN_large_scan;
 			rpb->rpb_org_scans = m_relation->rel_scan_count++;
 		}
 	}
@@ -0,0 +1,549 @@
+/*
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird Project.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#include "firebird.h"
+#include "../common/classes/Hash.h"
+#include "../jrd/jrd.h"
+#include "../jrd/req.h"
+#include "../jrd/intl.h"
+#include "../jrd/RecordBuffer.h"
+#include "../dsql/Nodes.h"
+#include "../dsql/ExprNodes.h"
+#include "../jrd/cmp_proto.h"
+#include "../jrd/evl_proto.h"
+#include "../jrd/intl_proto.h"
+#include "../jrd/mov_proto.h"
+#include "../jrd/vio_proto.h"
+
+#include "RecordSource.h"
+
+using namespace Firebird;
+using namespace Jrd;
+
+// ----------------------------------
+// Data access: hash based aggregation
+// ----------------------------------
+
+// Hash table grows to keep about HASH_LOAD_FACTOR groups per slot
+static const ULONG MIN_HASH_SIZE = 1009;
+static const ULONG MAX_HASH_SIZE = 1000003;
+static const ULONG HASH_LOAD_FACTOR = 4;
+static const FB_UINT64 MIN_MEMORY_BUDGET = 1024 * 1024;	// 1MB
+
+namespace
+{
+	// Memory available for the groups of a single pass. Records of other groups
+	// are put aside into the temporary space, so stay well within its in-memory part.
+
+	FB_UINT64 getMemoryBudget(thread_db* tdbb)
+	{
+		const FB_UINT64 budget = tdbb->getDatabase()->dbb_config->getTempCacheLimit() / 2;
+
+		return MAX(budget, MIN_MEMORY_BUDGET);
+	}
+
+	// Key values are copied into the hash key byte-wise, so the types
+	// having different binary images for equal values are not allowed.
+	// Values with time zone are equal if their UTC parts are, they are
+	// left to the sort which ignores the zone part of the key.
+
+	bool isKeyType(const dsc* desc)
+	{
+		switch (desc->dsc_dtype)
+		{
+		case dtype_real:
+		case dtype_double:
+		case dtype_dec64:
+		case dtype_dec128:
+		case dtype_blob:
+		case dtype_quad:
+		case dtype_array:
+		case dtype_sql_time_tz:
+		case dtype_timestamp_tz:
+		case dtype_ex_time_tz:
+		case dtype_ex_timestamp_tz:
+			return false;
+		}
+
+		return true;
+	}
+}
+
+
+// Groups are stored as fixed size entries in a contiguous buffer, every entry
+// consists of the group key, the image of the aggregated record and the images
+// of the aggregates impure areas. Entries are chained by hash slots.
+
+class HashAggregateStream::GroupTable : public PermanentStorage
+{
+	struct Entry
+	{
+		ULONG hash;
+		ULONG next;		// next entry in the slot plus one, zero terminates the chain
+	};
+
+public:
+	GroupTable(MemoryPool& pool, ULONG keyLength, ULONG dataLength)
+		: PermanentStorage(pool), m_keyLength(keyLength), m_entryLength(keyLength + dataLength),
+		  m_slots(pool), m_entries(pool), m_data(pool)
+	{
+		m_slots.resize(MIN_HASH_SIZE);
+		clear();
+	}
+
+	ULONG getCount() const
+	{
+		return m_entries.getCount();
+	}
+
+	FB_UINT64 getLength() const
+	{
+		return (FB_UINT64) m_data.getCount() +
+			m_entries.getCount() * sizeof(Entry) + m_slots.getCount() * sizeof(ULONG);
+	}
+
+	UCHAR* getData(ULONG position)
+	{
+		return m_data.begin() + (FB_SIZE_T) position * m_entryLength + m_keyLength;
+	}
+
+	UCHAR* find(ULONG hash, const UCHAR* key)
+	{
+		for (ULONG next = m_slots[hash % m_slots.getCount()]; next; next = m_entries[next - 1].next)
+		{
+			const ULONG position = next - 1;
+			UCHAR* const entry = m_data.begin() + (FB_SIZE_T) position * m_entryLength;
+
+			if (m_entries[position].hash == hash && !memcmp(entry, key, m_keyLength))
+				return entry + m_keyLength;
+		}
+
+		return NULL;
+	}
+
+	UCHAR* add(ULONG hash, const UCHAR* key)
+	{
+		const ULONG position = m_entries.getCount();
+
+		if (position >= m_slots.getCount() * HASH_LOAD_FACTOR &&
+			m_slots.getCount() < MAX_HASH_SIZE)
+		{
+			rehash(MIN(m_slots.getCount() * 2 + 1, MAX_HASH_SIZE));
+		}
+
+		ULONG& slot = m_slots[hash % m_slots.getCount()];
+
+		Entry entry;
+		entry.hash = hash;
+		entry.next = slot;
+		m_entries.add(entry);
+		slot = position + 1;
+
+		UCHAR* const data = m_data.getBuffer(m_data.getCount() + m_entryLength) +
+			(FB_SIZE_T) position * m_entryLength;
+		memcpy(data, key, m_keyLength);
+
+		return data + m_keyLength;
+	}
+
+	void clear()
+	{
+		m_entries.clear();
+		m_data.clear();
+		memset(m_slots.begin(), 0, m_slots.getCount() * sizeof(ULONG));
+	}
+
+private:
+	void rehash(ULONG size)
+	{
+		m_slots.resize(size);
+		memset(m_slots.begin(), 0, size * sizeof(ULONG));
+
+		for (ULONG position = 0; position < m_entries.getCount(); position++)
+		{
+			ULONG& slot = m_slots[m_entries[position].hash % size];
+			m_entries[position].next = slot;
+			slot = position + 1;
+		}
+	}
+
+	const ULONG m_keyLength;
+	const ULONG m_entryLength;
+	Array<ULONG> m_slots;
+	Array<Entry> m_entries;
+	Array<UCHAR> m_data;
+};
+
+
+HashAggregateStream::HashAggregateStream(thread_db* tdbb, CompilerScratch* csb, StreamType stream,
+			NestValueArray* group, MapNode* map, RecordSource* next)
+	: BaseAggWinStream(tdbb, csb, stream, group, map, false, next),
+	  m_aggs(csb->csb_pool), m_keyLengths(csb->csb_pool), m_totalKeyLength(0)
+{
+	fb_assert(group && map);
+
+	m_buffer = FB_NEW_POOL(csb->csb_pool) BufferedStream(csb, next);
+
+	for (const NestConst<ValueExprNode>* source = map->sourceList.begin();
+		 source != map->sourceList.end();
+		 ++source)
+	{
+		const AggNode* const aggNode = nodeAs<AggNode>(*source);
+
+		if (aggNode)
+			m_aggs.add(aggNode);
+	}
+
+	// Every key value is prefixed with its NULL flag
+
+	for (FB_SIZE_T i = 0; i < group->getCount(); i++)
+	{
+		dsc desc;
+		(*group)[i]->getDesc(tdbb, csb, &desc);
+
+		ULONG keyLength = desc.isText() ? desc.getStringLength() : desc.dsc_length;
+
+		if (IS_INTL_DATA(&desc))
+			keyLength = INTL_key_length(tdbb, INTL_INDEX_TYPE(&desc), keyLength);
+
+		m_keyLengths.add(keyLength);
+		m_totalKeyLength += keyLength + 1;
+	}
+}
+
+void HashAggregateStream::open(thread_db* tdbb) const
+{
+	BaseAggWinStream::open(tdbb);
+
+	jrd_req* const request = tdbb->getRequest();
+	Impure* const impure = getImpure(request);
+
+	MemoryPool& pool = *tdbb->getDefaultPool();
+
+	releaseBuffers(impure);
+	impure->irsb_position = 0;
+
+	const ULONG dataLength = m_format->fmt_length + m_aggs.getCount() * sizeof(impure_value_ex);
+	impure->irsb_groups = FB_NEW_POOL(pool) GroupTable(pool, m_totalKeyLength, dataLength);
+
+	aggregate(tdbb, request, impure);
+}
+
+void HashAggregateStream::close(thread_db* tdbb) const
+{
+	jrd_req* const request = tdbb->getRequest();
+	Impure* const impure = getImpure(request);
+
+	if (impure->irsb_flags & irsb_open)
+		releaseBuffers(impure);
+
+	BaseAggWinStream::close(tdbb);
+}
+
+void HashAggregateStream::print(thread_db* tdbb, string& plan, bool detailed, unsigned level) const
+{
+	if (detailed)
+		plan += printIndent(++level) + "Aggregate (hash)";
+
+	m_next->print(tdbb, plan, detailed, level);
+}
+
+bool HashAggregateStream::getRecord(thread_db* tdbb) const
+{
+	if (--tdbb->tdbb_quantum < 0)
+		JRD_reschedule(tdbb, 0, true);
+
+	jrd_req* const request = tdbb->getRequest();
+	record_param* const rpb = &request->req_rpb[m_stream];
+	Impure* const impure = getImpure(request);
+
+	if (!(impure->irsb_flags & irsb_open))
+	{
+		rpb->rpb_number.setValid(false);
+		return false;
+	}
+
+	GroupTable* const groups = impure->irsb_groups;
+
+	while (impure->irsb_position >= groups->getCount())
+	{
+		// All groups of this pass are returned, aggregate the records put aside
+
+		if (!impure->irsb_spill)
+		{
+			rpb->rpb_number.setValid(false);
+			return false;
+		}
+
+		delete impure->irsb_input;
+		impure->irsb_input = impure->irsb_spill;
+		impure->irsb_spill = NULL;
+		impure->irsb_position = 0;
+
+		groups->clear();
+		aggregate(tdbb, request, impure);
+	}
+
+	// Restore the group state and compute the aggregates
+
+	const UCHAR* data = groups->getData(impure->irsb_position++);
+
+	rpb->rpb_record->copyDataFrom(data);
+	data += m_format->fmt_length;
+
+	for (FB_SIZE_T i = 0; i < m_aggs.getCount(); i++)
+	{
+		memcpy(request->getImpure<impure_value_ex>(m_aggs[i]->impureOffset),
+			data, sizeof(impure_value_ex));
+		data += sizeof(impure_value_ex);
+	}
+
+	aggExecute(tdbb, request, m_groupMap->sourceList, m_groupMap->targetList);
+
+	rpb->rpb_number.setValid(true);
+	return true;
+}
+
+// Aggregate the input of a single pass: either the underlying stream or the records
+// put aside by the previous pass. New groups are added while they fit into the memory
+// budget, records of groups not added are put aside for the next pass.
+void HashAggregateStream::aggregate(thread_db* tdbb, jrd_req* request, Impure* impure) const
+{
+	MemoryPool& pool = *tdbb->getDefaultPool();
+
+	GroupTable* const groups = impure->irsb_groups;
+	RecordBuffer* const input = impure->irsb_input;
+	Record* const record = request->req_rpb[m_stream].rpb_record;
+
+	const FB_UINT64 budget = getMemoryBudget(tdbb);
+	const ULONG aggCount = m_aggs.getCount();
+
+	HalfStaticArray<UCHAR, 256> keyBuffer(pool);
+	UCHAR* const key = keyBuffer.getBuffer(m_totalKeyLength);
+
+	FB_UINT64 position = 0;
+
+	while (true)
+	{
+		if (--tdbb->tdbb_quantum < 0)
+			JRD_reschedule(tdbb, 0, true);
+
+		if (input)
+		{
+			if (!input->fetch(position++, input->getTempRecord()))
+				break;
+
+			m_buffer->unpackRecord(tdbb, input->getTempRecord());
+		}
+		else if (!m_next->getRecord(tdbb))
+			break;
+
+		const ULONG hash = computeKey(tdbb, request, key);
+		UCHAR* data = groups->find(hash, key);
+
+		if (data)
+		{
+			// Known group, accumulate the record into its state
+
+			UCHAR* const aggData = data + m_format->fmt_length;
+
+			for (ULONG i = 0; i < aggCount; i++)
+			{
+				memcpy(request->getImpure<impure_value_ex>(m_aggs[i]->impureOffset),
+					aggData + i * sizeof(impure_value_ex), sizeof(impure_value_ex));
+			}
+
+			aggPass(tdbb, request, m_groupMap->sourceList, m_groupMap->targetList);
+		}
+		else if (groups->getCount() && groups->getLength() >= budget)
+		{
+			// No room for another group, leave the record for the next pass
+
+			if (!impure->irsb_spill)
+				impure->irsb_spill = FB_NEW_POOL(pool) RecordBuffer(pool, m_buffer->getFormat());
+
+			Record* const spilled = impure->irsb_spill->getTempRecord();
+			m_buffer->packRecord(tdbb, spilled);
+			impure->irsb_spill->store(spilled);
+			continue;
+		}
+		else
+		{
+			// New group, its record image is saved after the first pass as
+			// by then it has all the non-aggregated values assigned
+
+			record->nullify();
+
+			aggInit(tdbb, request, m_groupMap);
+			aggPass(tdbb, request, m_groupMap->sourceList, m_groupMap->targetList);
+
+			data = groups->add(hash, key);
+			record->copyDataTo(data);
+		}
+
+		UCHAR* const aggData = data + m_format->fmt_length;
+
+		for (ULONG i = 0; i < aggCount; i++)
+		{
+			memcpy(aggData + i * sizeof(impure_value_ex),
+				request->getImpure<impure_value_ex>(m_aggs[i]->impureOffset), sizeof(impure_value_ex));
+		}
+	}
+
+	delete impure->irsb_input;
+	impure->irsb_input = NULL;
+}
+
+ULONG HashAggregateStream::computeKey(thread_db* tdbb, jrd_req* request, UCHAR* keyBuffer) const
+{
+	memset(keyBuffer, 0, m_totalKeyLength);
+
+	UCHAR* keyPtr = keyBuffer;
+
+	for (FB_SIZE_T i = 0; i < m_group->getCount(); i++)
+	{
+		dsc* const desc = EVL_expr(tdbb, request, (*m_group)[i]);
+		const ULONG keyLength = m_keyLengths[i];
+
+		if (desc && !(request->req_flags & req_null))
+		{
+			*keyPtr = 1;
+
+			if (desc->isText())
+			{
+				dsc to;
+				to.makeText(keyLength, desc->getTextType(), keyPtr + 1);
+
+				if (IS_INTL_DATA(desc))
+				{
+					// Convert the INTL string into the binary comparable form,
+					// so values equal in the collation make the same group
+					INTL_string_to_key(tdbb, INTL_INDEX_TYPE(desc),
+									   desc, &to, INTL_KEY_UNIQUE);
+				}
+				else
+				{
+					// This call ensures that the padding bytes are appended
+					MOV_move(tdbb, desc, &to);
+				}
+			}
+			else
+			{
+				fb_assert(keyLength == desc->dsc_length);
+				memcpy(keyPtr + 1, desc->dsc_address, keyLength);
+			}
+		}
+
+		keyPtr += keyLength + 1;
+	}
+
+	fb_assert(keyPtr - keyBuffer == m_totalKeyLength);
+
+	return InternalHash::hash(m_totalKeyLength, keyBuffer);
+}
+
+void HashAggregateStream::releaseBuffers(Impure* impure) const
+{
+	delete impure->irsb_groups;
+	impure->irsb_groups = NULL;
+
+	delete impure->irsb_input;
+	impure->irsb_input = NULL;
+
+	delete impure->irsb_spill;
+	impure->irsb_spill = NULL;
+}
+
+// Check whether the grouping may be done using a hash table, i.e. the group keys
+// may be compared byte-wise and every aggregate keeps its state in the impure area only.
+bool HashAggregateStream::isSupported(thread_db* tdbb, CompilerScratch* csb,
+	NestValueArray* group, MapNode* map)
+{
+	if (!group || group->isEmpty())
+		return false;
+
+	for (NestConst<ValueExprNode>* ptr = group->begin(); ptr != group->end(); ++ptr)
+	{
+		dsc desc;
+		(*ptr)->getDesc(tdbb, csb, &desc);
+
+		if (!isKeyType(&desc))
+			return false;
+	}
+
+	for (NestConst<ValueExprNode>* source = map->sourceList.begin();
+		 source != map->sourceList.end();
+		 ++source)
+	{
+		AggNode* const aggNode = nodeAs<AggNode>(*source);
+
+		if (!aggNode)
+			continue;
+
+		if (aggNode->distinct || aggNode->asb || aggNode->indexed)
+			return false;
+
+		switch (aggNode->aggInfo.blr)
+		{
+		case blr_agg_count2:
+		case blr_agg_total:
+		case blr_agg_average:
+			continue;
+
+		case blr_agg_max:
+		case blr_agg_min:
+			{
+				// Text values are kept outside of the impure area
+
+				dsc desc;
+				aggNode->arg->getDesc(tdbb, csb, &desc);
+
+				if (!desc.isText() && !desc.isBlob())
+					continue;
+			}
+			break;
+		}
+
+		return false;
+	}
+
+	return true;
+}
+
+// Check whether the estimated number of groups fits into the memory budget.
+bool HashAggregateStream::fitsMemory(thread_db* tdbb, CompilerScratch* csb, StreamType stream,
+	const MapNode* map, double groups)
+{
+	const Format* const format = CMP_format(tdbb, csb, stream);
+
+	FB_SIZE_T aggCount = 0;
+
+	for (const NestConst<ValueExprNode>* source = map->sourceList.begin();
+		 source != map->sourceList.end();
+		 ++source)
+	{
+		if (nodeIs<AggNode>(*source))
+			aggCount++;
+	}
+
+	// Assume the group key not being longer than the aggregated record
+	const double groupLength = 2.0 * format->fmt_length + aggCount * sizeof(impure_value_ex) +
+		sizeof(ULONG) * 3;
+
+	return groups * groupLength <= getMemoryBudget(tdbb);
+}
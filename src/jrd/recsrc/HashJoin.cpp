@@ -25,6 +25,7 @@
 #include "../jrd/jrd.h"
 #include "../jrd/req.h"
 #include "../jrd/intl.h"
+#include "../jrd/RecordBuffer.h"
 #include "../jrd/cmp_proto.h"
 #include "../jrd/evl_proto.h"
 #include "../jrd/mov_proto.h"
@@ -39,10 +40,59 @@ using namespace Jrd;
 // Data access: hash join
 // ----------------------
 
-// NS: FIXME - Why use static hash table here??? Hash table shall support dynamic resizing
-static const ULONG HASH_SIZE = 1009;
+// Hash table is sized to keep about HASH_LOAD_FACTOR records per slot
+static const ULONG MIN_HASH_SIZE = 1009;
+static const ULONG MAX_HASH_SIZE = 1000003;
+static const ULONG HASH_LOAD_FACTOR = 16;
 static const ULONG BUCKET_PREALLOCATE_SIZE = 32;	// 256 bytes per slot
 
+// If the inner streams don't fit into the memory budget, all the streams are split
+// into partitions by hash value and every partition is joined separately. Partitions
+// still too big are split again using other hash bits, up to the given depth.
+static const ULONG PARTITION_FANOUT = 16;
+static const ULONG MAX_PARTITION_LEVEL = 3;
+static const FB_UINT64 MIN_MEMORY_BUDGET = 1024 * 1024;	// 1MB
+
+namespace
+{
+	ULONG getHashSize(FB_UINT64 count)
+	{
+		const FB_UINT64 size = count / HASH_LOAD_FACTOR;
+
+		if (size <= MIN_HASH_SIZE)
+			return MIN_HASH_SIZE;
+
+		if (size >= MAX_HASH_SIZE)
+			return MAX_HASH_SIZE;
+
+		return (ULONG) size | 1;
+	}
+
+	// Partition of the record with given hash at given level of splitting.
+	// Hash bits are mixed differently per level, so records of a partition
+	// being split again don't end up in the same sub-partition.
+
+	ULONG getPartition(ULONG hash, ULONG level)
+	{
+		hash ^= level * 0x9E3779B9;
+		hash ^= hash >> 16;
+		hash *= 0x85EBCA6B;
+		hash ^= hash >> 13;
+
+		return hash % PARTITION_FANOUT;
+	}
+
+	// Memory available for the inner records of a partition. They are kept
+	// in the temporary space, so stay well within its in-memory part.
+
+	FB_UINT64 getMemoryBudget(thread_db* tdbb)
+	{
+		const FB_UINT64 budget = tdbb->getDatabase()->dbb_config->getTempCacheLimit() / 2;
+
+		return MAX(budget, MIN_MEMORY_BUDGET);
+	}
+}
+
 class HashJoin::HashTable : public PermanentStorage
 {
 	class CollisionList
@@ -118,7 +168,7 @@ class HashJoin::HashTable : public PermanentStorage
 	};
 
 public:
-	HashTable(MemoryPool& pool, ULONG streamCount, ULONG tableSize = HASH_SIZE)
+	HashTable(MemoryPool& pool, ULONG streamCount, ULONG tableSize)
 		: PermanentStorage(pool), m_streamCount(streamCount),
 		  m_tableSize(tableSize), m_slot(0)
 	{
@@ -206,15 +256,87 @@ private:
 };
 
 
+// Records of all the joined streams having hash values of the same partition
+
+class HashJoin::Partition : public PermanentStorage
+{
+public:
+	Partition(MemoryPool& pool, ULONG level)
+		: PermanentStorage(pool), next(NULL), m_level(level), m_buffers(pool)
+	{}
+
+	~Partition()
+	{
+		for (FB_SIZE_T i = 0; i < m_buffers.getCount(); i++)
+			delete m_buffers[i];
+	}
+
+	ULONG getLevel() const
+	{
+		return m_level;
+	}
+
+	// Records of the given stream (leader is zero), NULL if they're not buffered
+	RecordBuffer* getBuffer(FB_SIZE_T stream) const
+	{
+		return (stream < m_buffers.getCount()) ? m_buffers[stream] : NULL;
+	}
+
+	RecordBuffer* makeBuffer(FB_SIZE_T stream, const Format* format)
+	{
+		while (m_buffers.getCount() <= stream)
+			m_buffers.add(NULL);
+
+		fb_assert(!m_buffers[stream]);
+		m_buffers[stream] = FB_NEW_POOL(getPool()) RecordBuffer(getPool(), format);
+
+		return m_buffers[stream];
+	}
+
+	FB_UINT64 getCount(FB_SIZE_T stream) const
+	{
+		const RecordBuffer* const buffer = getBuffer(stream);
+		return buffer ? buffer->getCount() : 0;
+	}
+
+	// Total length of the inner records
+	FB_UINT64 getInnerLength() const
+	{
+		FB_UINT64 length = 0;
+
+		for (FB_SIZE_T i = 1; i < m_buffers.getCount(); i++)
+		{
+			const RecordBuffer* const buffer = m_buffers[i];
+
+			if (buffer)
+				length += buffer->getCount() * buffer->getFormat()->fmt_length;
+		}
+
+		return length;
+	}
+
+	Partition* next;
+
+private:
+	const ULONG m_level;
+	HalfStaticArray<RecordBuffer*, 4> m_buffers;
+};
+
+
 HashJoin::HashJoin(thread_db* tdbb, CompilerScratch* csb, FB_SIZE_T count,
-				   RecordSource* const* args, NestValueArray* const* keys)
-	: m_args(csb->csb_pool, count - 1)
+				   RecordSource* const* args, NestValueArray* const* keys,
+				   JoinType joinType, BoolExprNode* boolean)
+	: m_joinType(joinType), m_args(csb->csb_pool, count - 1), m_boolean(boolean)
 {
 	fb_assert(count >= 2);
+	// Only inner join may have many inner streams
+	fb_assert(joinType == INNER_JOIN || count == 2);
+	fb_assert(joinType != SEMI_JOIN);
 
 	m_impure = CMP_impure(csb, sizeof(Impure));
 
 	m_leader.source = args[0];
+	m_leader.buffer = FB_NEW_POOL(csb->csb_pool) BufferedStream(csb, args[0]);
 	m_leader.keys = keys[0];
 	const FB_SIZE_T leaderKeyCount = m_leader.keys->getCount();
 	m_leader.keyLengths = FB_NEW_POOL(csb->csb_pool) ULONG[leaderKeyCount];
@@ -240,6 +362,7 @@ HashJoin::HashJoin(thread_db* tdbb, CompilerScratch* csb, FB_SIZE_T count,
 		fb_assert(sub_rsb);
 
 		SubStream sub;
+		sub.source = sub_rsb;
 		sub.buffer = FB_NEW_POOL(csb->csb_pool) BufferedStream(csb, sub_rsb);
 		sub.keys = keys[i];
 		const FB_SIZE_T subKeyCount = sub.keys->getCount();
@@ -271,38 +394,83 @@ void HashJoin::open(thread_db* tdbb) const
 
 	impure->irsb_flags = irsb_open | irsb_mustread;
 
-	delete impure->irsb_hash_table;
+	releasePartitions(impure);
 	delete[] impure->irsb_leader_buffer;
 
 	MemoryPool& pool = *tdbb->getDefaultPool();
 
 	const FB_SIZE_T argCount = m_args.getCount();
 
-	impure->irsb_hash_table = FB_NEW_POOL(pool) HashTable(pool, argCount);
 	impure->irsb_leader_buffer = FB_NEW_POOL(pool) UCHAR[m_leader.totalKeyLength];
+	impure->irsb_leader_position = 0;
+
+	Partition* const root = FB_NEW_POOL(pool) Partition(pool, 0);
+	impure->irsb_partition = root;
+
+	const FB_UINT64 budget = getMemoryBudget(tdbb);
+	FB_UINT64 length = 0;
+	bool overflow = false;
 
 	UCharBuffer buffer(pool);
+	ObjectsArray<Array<ULONG> > hashes(pool);
+	FB_UINT64 maxCount = 0;
 
 	for (FB_SIZE_T i = 0; i < argCount; i++)
 	{
-		// Read and cache the inner streams. While doing that,
-		// hash the join condition values and populate hash tables.
+		// Read and cache the inner streams. While doing that and while they fit
+		// into the memory budget, hash the join condition values.
 
-		m_args[i].buffer->open(tdbb);
+		const SubStream& sub = m_args[i];
 
-		ULONG counter = 0;
-		UCHAR* const keyBuffer = buffer.getBuffer(m_args[i].totalKeyLength, false);
+		RecordBuffer* const records = root->makeBuffer(i + 1, sub.buffer->getFormat());
+		Record* const record = records->getTempRecord();
+		Array<ULONG>& streamHashes = hashes.add();
+		UCHAR* const keyBuffer = buffer.getBuffer(sub.totalKeyLength, false);
 
-		while (m_args[i].buffer->getRecord(tdbb))
+		sub.source->open(tdbb);
+
+		while (sub.source->getRecord(tdbb))
 		{
-			const ULONG hash = computeHash(tdbb, request, m_args[i], keyBuffer);
-			impure->irsb_hash_table->put(i, hash, counter++);
+			sub.buffer->packRecord(tdbb, record);
+			records->store(record);
+
+			if (!overflow)
+			{
+				streamHashes.add(computeHash(tdbb, request, sub, keyBuffer));
+
+				length += record->getLength();
+				overflow = (length > budget);
+			}
 		}
-	}
 
-	impure->irsb_hash_table->sort();
+		maxCount = MAX(maxCount, (FB_UINT64) records->getCount());
+	}
 
 	m_leader.source->open(tdbb);
+
+	if (overflow)
+	{
+		// Too big to be joined at once, partition all the streams including the leader
+
+		splitPartition(tdbb, impure);
+		nextPartition(tdbb, impure);
+		return;
+	}
+
+	// Populate the hash table
+
+	HashTable* const hashTable = FB_NEW_POOL(pool) HashTable(pool, argCount, getHashSize(maxCount));
+	impure->irsb_hash_table = hashTable;
+
+	for (FB_SIZE_T i = 0; i < argCount; i++)
+	{
+		const Array<ULONG>& streamHashes = hashes[i];
+
+		for (FB_SIZE_T position = 0; position < streamHashes.getCount(); position++)
+			hashTable->put(i, streamHashes[position], position);
+	}
+
+	hashTable->sort();
 }
 
 void HashJoin::close(thread_db* tdbb) const
@@ -316,14 +484,13 @@ void HashJoin::close(thread_db* tdbb) const
 	{
 		impure->irsb_flags &= ~irsb_open;
 
-		delete impure->irsb_hash_table;
-		impure->irsb_hash_table = NULL;
+		releasePartitions(impure);
 
 		delete[] impure->irsb_leader_buffer;
 		impure->irsb_leader_buffer = NULL;
 
 		for (FB_SIZE_T i = 0; i < m_args.getCount(); i++)
-			m_args[i].buffer->close(tdbb);
+			m_args[i].source->close(tdbb);
 
 		m_leader.source->close(tdbb);
 	}
@@ -346,7 +513,7 @@ bool HashJoin::getRecord(thread_db* tdbb) const
 		{
 			// Fetch the record from the leading stream
 
-			if (!m_leader.source->getRecord(tdbb))
+			if (!fetchLeader(tdbb, impure))
 				return false;
 
 			// Compute and hash the comparison keys
@@ -358,12 +525,52 @@ bool HashJoin::getRecord(thread_db* tdbb) const
 			// Setup the hash table for the iteration through collisions.
 
 			if (!impure->irsb_hash_table->setup(impure->irsb_leader_hash))
+			{
+				// Outer and anti joins return the unmatched leader record anyway
+
+				if (m_joinType != INNER_JOIN)
+				{
+					m_args[0].source->nullRecords(tdbb);
+					return true;
+				}
+
 				continue;
+			}
 
-			impure->irsb_flags &= ~irsb_mustread;
+			impure->irsb_flags &= ~(irsb_mustread | irsb_joined);
 			impure->irsb_flags |= irsb_first;
 		}
 
+		if (m_joinType != INNER_JOIN)
+		{
+			// Single inner stream, fetch the next record matching the leader
+
+			if (fetchMatch(tdbb, impure))
+			{
+				impure->irsb_flags |= irsb_joined;
+
+				if (m_joinType == OUTER_JOIN)
+					return true;
+
+				// Anti join needs no match, skip the leader record
+
+				impure->irsb_flags |= irsb_mustread;
+				continue;
+			}
+
+			impure->irsb_flags |= irsb_mustread;
+
+			if (!(impure->irsb_flags & irsb_joined))
+			{
+				// The leader record has not been joined to anything.
+				// Join it to a null valued inner stream.
+				m_args[0].source->nullRecords(tdbb);
+				return true;
+			}
+
+			continue;
+		}
+
 		// Fetch collisions from the inner streams
 
 		if (impure->irsb_flags & irsb_first)
@@ -414,12 +621,30 @@ void HashJoin::print(thread_db* tdbb, string& plan, bool detailed, unsigned leve
 {
 	if (detailed)
 	{
-		plan += printIndent(++level) + "Hash Join (inner)";
+		plan += printIndent(++level) + "Hash Join ";
+
+		switch (m_joinType)
+		{
+			case INNER_JOIN:
+				plan += "(inner)";
+				break;
+
+			case OUTER_JOIN:
+				plan += "(outer)";
+				break;
+
+			case ANTI_JOIN:
+				plan += "(anti)";
+				break;
+
+			default:
+				fb_assert(false);
+		}
 
 		m_leader.source->print(tdbb, plan, true, level);
 
 		for (FB_SIZE_T i = 0; i < m_args.getCount(); i++)
-			m_args[i].source->print(tdbb, plan, true, level);
+			m_args[i].buffer->print(tdbb, plan, true, level);
 	}
 	else
 	{
@@ -432,7 +657,7 @@ void HashJoin::print(thread_db* tdbb, string& plan, bool detailed, unsigned leve
 			if (i)
 				plan += ", ";
 
-			m_args[i].source->print(tdbb, plan, false, level);
+			m_args[i].buffer->print(tdbb, plan, false, level);
 		}
 		plan += ")";
 	}
@@ -524,14 +749,10 @@ bool HashJoin::fetchRecord(thread_db* tdbb, Impure* impure, FB_SIZE_T stream) co
 {
 	HashTable* const hashTable = impure->irsb_hash_table;
 
-	const BufferedStream* const arg = m_args[stream].buffer;
-
 	ULONG position;
 	if (hashTable->iterate(stream, impure->irsb_leader_hash, position))
 	{
-		arg->locate(tdbb, position);
-
-		if (arg->getRecord(tdbb))
+		if (fetchInner(tdbb, impure, stream, position))
 			return true;
 	}
 
@@ -544,10 +765,251 @@ bool HashJoin::fetchRecord(thread_db* tdbb, Impure* impure, FB_SIZE_T stream) co
 
 		if (hashTable->iterate(stream, impure->irsb_leader_hash, position))
 		{
-			arg->locate(tdbb, position);
-
-			if (arg->getRecord(tdbb))
+			if (fetchInner(tdbb, impure, stream, position))
 				return true;
 		}
 	}
 }
+
+bool HashJoin::fetchInner(thread_db* tdbb, Impure* impure, FB_SIZE_T stream, ULONG position) const
+{
+	RecordBuffer* const records = impure->irsb_partition->getBuffer(stream + 1);
+	Record* const record = records->getTempRecord();
+
+	if (!records->fetch(position, record))
+		return false;
+
+	m_args[stream].buffer->unpackRecord(tdbb, record);
+	return true;
+}
+
+bool HashJoin::fetchLeader(thread_db* tdbb, Impure* impure) const
+{
+	while (impure->irsb_partition)
+	{
+		RecordBuffer* const records = impure->irsb_partition->getBuffer(0);
+
+		// Leader is read directly unless the streams are partitioned
+
+		if (!records)
+			return m_leader.source->getRecord(tdbb);
+
+		Record* const record = records->getTempRecord();
+
+		if (records->fetch(impure->irsb_leader_position, record))
+		{
+			impure->irsb_leader_position++;
+			m_leader.buffer->unpackRecord(tdbb, record);
+			return true;
+		}
+
+		nextPartition(tdbb, impure);
+	}
+
+	return false;
+}
+
+bool HashJoin::fetchMatch(thread_db* tdbb, Impure* impure) const
+{
+	jrd_req* const request = tdbb->getRequest();
+	HashTable* const hashTable = impure->irsb_hash_table;
+
+	// Equal hashes are not enough to join the leader record to the inner one
+	// without the parent filter, so check the join condition here
+
+	ULONG position;
+	while (hashTable->iterate(0, impure->irsb_leader_hash, position))
+	{
+		if (fetchInner(tdbb, impure, 0, position) &&
+			(!m_boolean || m_boolean->execute(tdbb, request)))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void HashJoin::splitPartition(thread_db* tdbb, Impure* impure) const
+{
+	jrd_req* const request = tdbb->getRequest();
+	MemoryPool& pool = *tdbb->getDefaultPool();
+
+	Partition* const partition = impure->irsb_partition;
+	fb_assert(partition);
+
+	const ULONG level = partition->getLevel() + 1;
+	const FB_SIZE_T argCount = m_args.getCount();
+
+	Partition* parts[PARTITION_FANOUT];
+
+	for (ULONG i = 0; i < PARTITION_FANOUT; i++)
+	{
+		Partition* const part = FB_NEW_POOL(pool) Partition(pool, level);
+
+		part->next = impure->irsb_pending;
+		impure->irsb_pending = part;
+
+		part->makeBuffer(0, m_leader.buffer->getFormat());
+
+		for (FB_SIZE_T j = 0; j < argCount; j++)
+			part->makeBuffer(j + 1, m_args[j].buffer->getFormat());
+
+		parts[i] = part;
+	}
+
+	UCharBuffer buffer(pool);
+
+	// Distribute the inner records
+
+	for (FB_SIZE_T i = 0; i < argCount; i++)
+	{
+		const SubStream& sub = m_args[i];
+
+		RecordBuffer* const records = partition->getBuffer(i + 1);
+		Record* const record = records->getTempRecord();
+		UCHAR* const keyBuffer = buffer.getBuffer(sub.totalKeyLength, false);
+
+		for (offset_t position = 0; records->fetch(position, record); position++)
+		{
+			sub.buffer->unpackRecord(tdbb, record);
+
+			const ULONG hash = computeHash(tdbb, request, sub, keyBuffer);
+			parts[getPartition(hash, level)]->getBuffer(i + 1)->store(record);
+		}
+	}
+
+	// Distribute the leader records. Unless the partition was split before,
+	// they're read from the leading stream.
+
+	RecordBuffer* const leaderRecords = partition->getBuffer(0);
+	UCHAR* const keyBuffer = buffer.getBuffer(m_leader.totalKeyLength, false);
+
+	if (leaderRecords)
+	{
+		Record* const record = leaderRecords->getTempRecord();
+
+		for (offset_t position = 0; leaderRecords->fetch(position, record); position++)
+		{
+			m_leader.buffer->unpackRecord(tdbb, record);
+
+			const ULONG hash = computeHash(tdbb, request, m_leader, keyBuffer);
+			parts[getPartition(hash, level)]->getBuffer(0)->store(record);
+		}
+	}
+	else
+	{
+		while (m_leader.source->getRecord(tdbb))
+		{
+			const ULONG hash = computeHash(tdbb, request, m_leader, keyBuffer);
+
+			RecordBuffer* const records = parts[getPartition(hash, level)]->getBuffer(0);
+			Record* const record = records->getTempRecord();
+
+			m_leader.buffer->packRecord(tdbb, record);
+			records->store(record);
+		}
+	}
+
+	impure->irsb_partition = NULL;
+	delete partition;
+}
+
+bool HashJoin::nextPartition(thread_db* tdbb, Impure* impure) const
+{
+	jrd_req* const request = tdbb->getRequest();
+	MemoryPool& pool = *tdbb->getDefaultPool();
+
+	delete impure->irsb_hash_table;
+	impure->irsb_hash_table = NULL;
+
+	delete impure->irsb_partition;
+	impure->irsb_partition = NULL;
+
+	const FB_UINT64 budget = getMemoryBudget(tdbb);
+	const FB_SIZE_T argCount = m_args.getCount();
+
+	while (impure->irsb_pending)
+	{
+		Partition* const partition = impure->irsb_pending;
+		impure->irsb_pending = partition->next;
+		impure->irsb_partition = partition;
+
+		// Skip partitions that cannot produce anything
+
+		bool empty = !partition->getCount(0);
+
+		if (m_joinType == INNER_JOIN)
+		{
+			for (FB_SIZE_T i = 0; i < argCount; i++)
+			{
+				if (!partition->getCount(i + 1))
+					empty = true;
+			}
+		}
+
+		if (empty)
+		{
+			impure->irsb_partition = NULL;
+			delete partition;
+			continue;
+		}
+
+		if (partition->getLevel() < MAX_PARTITION_LEVEL && partition->getInnerLength() > budget)
+		{
+			splitPartition(tdbb, impure);
+			continue;
+		}
+
+		// Populate the hash table with the inner records of this partition
+
+		FB_UINT64 maxCount = 0;
+
+		for (FB_SIZE_T i = 0; i < argCount; i++)
+			maxCount = MAX(maxCount, partition->getCount(i + 1));
+
+		HashTable* const hashTable =
+			FB_NEW_POOL(pool) HashTable(pool, argCount, getHashSize(maxCount));
+		impure->irsb_hash_table = hashTable;
+
+		UCharBuffer buffer(pool);
+
+		for (FB_SIZE_T i = 0; i < argCount; i++)
+		{
+			const SubStream& sub = m_args[i];
+
+			RecordBuffer* const records = partition->getBuffer(i + 1);
+			Record* const record = records->getTempRecord();
+			UCHAR* const keyBuffer = buffer.getBuffer(sub.totalKeyLength, false);
+
+			for (offset_t position = 0; records->fetch(position, record); position++)
+			{
+				sub.buffer->unpackRecord(tdbb, record);
+				hashTable->put(i, computeHash(tdbb, request, sub, keyBuffer), (ULONG) position);
+			}
+		}
+
+		hashTable->sort();
+
+		impure->irsb_leader_position = 0;
+		return true;
+	}
+
+	return false;
+}
+
+void HashJoin::releasePartitions(Impure* impure) const
+{
+	delete impure->irsb_hash_table;
+	impure->irsb_hash_table = NULL;
+
+	delete impure->irsb_partition;
+	impure->irsb_partition = NULL;
+
+	while (impure->irsb_pending)
+	{
+		Partition* const partition = impure->irsb_pending;
+		impure->irsb_pending = partition->next;
+		delete partition;
+	}
+}
@@ -773,6 +773,57 @@ namespace Jrd
 		bool getRecord(thread_db* tdbb) const;
 	};
 
+	// Grouping without sorting the input: the aggregate state of every group is kept
+	// in a hash table. Records of groups not fitting into the memory budget are put
+	// aside into the temporary space and aggregated by the subsequent passes.
+	// Only aggregates whose state is fully contained in their impure area may be used.
+
+	class HashAggregateStream : public BaseAggWinStream<HashAggregateStream, RecordSource>
+	{
+		class GroupTable;
+
+	public:
+		struct Impure : public BaseAggWinStream::Impure
+		{
+			GroupTable* irsb_groups;
+			RecordBuffer* irsb_input;		// records being aggregated by the current pass
+			RecordBuffer* irsb_spill;		// records put aside for the next pass
+			ULONG irsb_position;			// next group to be returned
+		};
+
+	public:
+		HashAggregateStream(thread_db* tdbb, CompilerScratch* csb, StreamType stream,
+			NestValueArray* group, MapNode* map, RecordSource* next);
+
+	public:
+		void open(thread_db* tdbb) const;
+		void close(thread_db* tdbb) const;
+
+		void print(thread_db* tdbb, Firebird::string& plan, bool detailed, unsigned level) const;
+		bool getRecord(thread_db* tdbb) const;
+
+		static bool isSupported(thread_db* tdbb, CompilerScratch* csb,
+			NestValueArray* group, MapNode* map);
+		static bool fitsMemory(thread_db* tdbb, CompilerScratch* csb, StreamType stream,
+			const MapNode* map, double groups);
+
+	protected:
+		Impure* getImpure(jrd_req* request) const
+		{
+			return request->getImpure<Impure>(m_impure);
+		}
+
+	private:
+		void aggregate(thread_db* tdbb, jrd_req* request, Impure* impure) const;
+		ULONG computeKey(thread_db* tdbb, jrd_req* request, UCHAR* keyBuffer) const;
+		void releaseBuffers(Impure* impure) const;
+
+		BufferedStream* m_buffer;		// maps the input records to the spilled ones
+		Firebird::Array<const AggNode*> m_aggs;
+		Firebird::Array<ULONG> m_keyLengths;
+		ULONG m_totalKeyLength;
+	};
+
 	class WindowedStream : public RecordSource
 	{
 	public:
@@ -951,6 +1002,17 @@ namespace Jrd
 			return impure->irsb_position;
 		}
 
+		// Conversion between the current records of the underlying streams and
+		// a single record of getFormat(), for callers buffering records themselves
+
+		const Format* getFormat() const
+		{
+			return m_format;
+		}
+
+		void packRecord(thread_db* tdbb, Record* buffer_record) const;
+		void unpackRecord(thread_db* tdbb, Record* buffer_record) const;
+
 	private:
 		NestConst<RecordSource> m_next;
 		Firebird::HalfStaticArray<FieldMap, OPT_STATIC_ITEMS> m_map;
@@ -1019,14 +1081,12 @@ namespace Jrd
 	class HashJoin : public RecordSource
 	{
 		class HashTable;
+		class Partition;
 
 		struct SubStream
 		{
-			union
-			{
-				RecordSource* source;
-				BufferedStream* buffer;
-			};
+			RecordSource* source;
+			BufferedStream* buffer;		// maps the stream records to the buffered ones
 
 			NestValueArray* keys;
 			ULONG* keyLengths;
@@ -1038,11 +1098,15 @@ namespace Jrd
 			HashTable* irsb_hash_table;
 			UCHAR* irsb_leader_buffer;
 			ULONG irsb_leader_hash;
+			Partition* irsb_partition;			// partition being joined
+			Partition* irsb_pending;			// partitions to be joined after it
+			FB_UINT64 irsb_leader_position;		// next buffered leader record
 		};
 
 	public:
 		HashJoin(thread_db* tdbb, CompilerScratch* csb, FB_SIZE_T count,
-				 RecordSource* const* args, NestValueArray* const* keys);
+				 RecordSource* const* args, NestValueArray* const* keys,
+				 JoinType joinType = INNER_JOIN, BoolExprNode* boolean = NULL);
 
 		void open(thread_db* tdbb) const override;
 		void close(thread_db* tdbb) const override;
@@ -1064,9 +1128,18 @@ namespace Jrd
 		ULONG computeHash(thread_db* tdbb, jrd_req* request,
 						  const SubStream& sub, UCHAR* buffer) const;
 		bool fetchRecord(thread_db* tdbb, Impure* impure, FB_SIZE_T stream) const;
+		bool fetchInner(thread_db* tdbb, Impure* impure, FB_SIZE_T stream, ULONG position) const;
+		bool fetchLeader(thread_db* tdbb, Impure* impure) const;
+		bool fetchMatch(thread_db* tdbb, Impure* impure) const;
+
+		void splitPartition(thread_db* tdbb, Impure* impure) const;
+		bool nextPartition(thread_db* tdbb, Impure* impure) const;
+		void releasePartitions(Impure* impure) const;
 
+		const JoinType m_joinType;
 		SubStream m_leader;
 		Firebird::Array<SubStream> m_args;
+		NestConst<BoolExprNode> const m_boolean;
 	};
 
 	class MergeJoin : public RecordSource
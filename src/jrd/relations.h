@@ -579,6 +579,15 @@ RELATION(nam_mon_io_stats, rel_mon_io_stats, ODS_11_1, rel_virtual)
 	FIELD(f_mon_io_page_writes, nam_mon_page_writes, fld_counter, 0, ODS_11_1)
 	FIELD(f_mon_io_page_fetches, nam_mon_page_fetches, fld_counter, 0, ODS_11_1)
 	FIELD(f_mon_io_page_marks, nam_mon_page_marks, fld_counter, 0, ODS_11_1)
+	FIELD(f_mon_io_page_prefetches, nam_mon_page_prefetches, fld_counter, 0, ODS_13_1)
+	FIELD(f_mon_io_prefetch_hits, nam_mon_prefetch_hits, fld_counter, 0, ODS_13_1)
+	FIELD(f_mon_io_prefetch_misses, nam_mon_prefetch_misses, fld_counter, 0, ODS_13_1)
+	FIELD(f_mon_io_page_evictions, nam_mon_page_evictions, fld_counter, 0, ODS_13_1)
+	FIELD(f_mon_io_page_promotions, nam_mon_page_promotions, fld_counter, 0, ODS_13_1)
+	FIELD(f_mon_io_blob_page_reads, nam_mon_blob_page_reads, fld_counter, 0, ODS_13_1)
+	FIELD(f_mon_io_blob_bytes_read, nam_mon_blob_bytes_read, fld_counter, 0, ODS_13_1)
+	FIELD(f_mon_io_blob_packed_bytes, nam_mon_blob_packed_bytes, fld_counter, 0, ODS_13_1)
+	FIELD(f_mon_io_blob_packed_size, nam_mon_blob_packed_size, fld_counter, 0, ODS_13_1)
 END_RELATION
 
 // Relation 39 (MON$RECORD_STATS)
@@ -600,6 +609,8 @@ RELATION(nam_mon_rec_stats, rel_mon_rec_stats, ODS_11_1, rel_virtual)
 	FIELD(f_mon_rec_frg_reads, nam_mon_fragment_reads, fld_counter, 0, ODS_12_0)
 	FIELD(f_mon_rec_rpt_reads, nam_mon_rec_rpt_reads, fld_counter, 0, ODS_12_0)
 	FIELD(f_mon_rec_imgc, nam_mon_rec_imgc, fld_counter, 0, ODS_13_0)
+	FIELD(f_mon_rec_state_hits, nam_mon_state_hits, fld_counter, 0, ODS_13_1)
+	FIELD(f_mon_rec_state_misses, nam_mon_state_misses, fld_counter, 0, ODS_13_1)
 END_RELATION
 
 // Relation 40 (MON$CONTEXT_VARIABLES)
@@ -51,6 +51,7 @@ class jrd_tra;
 class Savepoint;
 class Cursor;
 class thread_db;
+class BulkInsert;
 
 // record parameter block
 
@@ -125,6 +126,7 @@ const USHORT RPB_s_update	= 0x01;	// input stream fetched for update
 const USHORT RPB_s_no_data	= 0x02;	// nobody is going to access the data
 const USHORT RPB_s_sweeper	= 0x04;	// garbage collector - skip swept pages
 const USHORT RPB_s_unstable = 0x08;	// don't use undo log, used with unstable explicit cursors
+const USHORT RPB_s_bulk		= 0x10;	// bulk insertion - store into new data pages
 
 // Runtime flags
 
@@ -182,7 +184,8 @@ public:
 		  req_sorts(*req_pool),
 		  req_rpb(*req_pool),
 		  impureArea(*req_pool),
-		  req_auto_trans(*req_pool)
+		  req_auto_trans(*req_pool),
+		  req_bulk_insert(NULL)
 	{
 		fb_assert(statement);
 		setAttachment(attachment);
@@ -337,6 +340,7 @@ public:
 
 	StatusXcp req_last_xcp;			// last known exception
 	bool req_batch_mode;
+	BulkInsert* req_bulk_insert;	// bulk insertion of batch, if any
 
 	template <typename T> T* getImpure(unsigned offset)
 	{
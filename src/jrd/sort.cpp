@@ -41,6 +41,7 @@
 #include "../jrd/rse.h"
 #include "../jrd/val.h"
 #include "../jrd/err_proto.h"
+#include "../jrd/WorkerPool.h"
 #include "../yvalve/gds_proto.h"
 
 #ifdef HAVE_SYS_TYPES_H
@@ -85,6 +86,8 @@ void SortOwner::unlinkAll()
 
 const ULONG MAX_SORT_BUFFER_SIZE = 1024 * 128;	// 128KB
 const ULONG MIN_RECORDS_TO_ALLOC = 8;
+const ULONG MIN_PARALLEL_SORT_RECORDS = 8192;	// per part of parallel in-memory sort
+const unsigned MAX_PARALLEL_SORT_PARTS = 64;
 
 // the size of sr_bckptr (everything before sort_record) in bytes
 #define SIZEOF_SR_BCKPTR offsetof(sr, sr_sort_record)
@@ -154,9 +157,94 @@ namespace
 		*a = *b;
 		*b = temp;
 	}
+
+	// Compare keys the same way quick() does, i.e. by given number of longwords
+
+	inline int compareKeys(const SORTP* p, const SORTP* q, ULONG length)
+	{
+		for (; length; p++, q++, length--)
+		{
+			if (*p != *q)
+				return (*p > *q) ? 1 : -1;
+		}
+
+		return 0;
+	}
+
+	// Merge two adjacent sorted runs of record pointers into other array,
+	// second run may be empty
+
+	class MergeRunsTask : public WorkerPool::Task
+	{
+	public:
+		MergeRunsTask()
+			: m_source(NULL), m_target(NULL), m_count1(0), m_count2(0), m_length(0)
+		{}
+
+		void setup(SORTP** source, ULONG count1, ULONG count2, SORTP** target, ULONG length)
+		{
+			m_source = source;
+			m_target = target;
+			m_count1 = count1;
+			m_count2 = count2;
+			m_length = length;
+		}
+
+		void execute()
+		{
+			SORTP** p = m_source;
+			SORTP** const end1 = m_source + m_count1;
+			SORTP** q = end1;
+			SORTP** const end2 = end1 + m_count2;
+			SORTP** out = m_target;
+
+			while (p < end1 && q < end2)
+				*out++ = (compareKeys(*p, *q, m_length) > 0) ? *q++ : *p++;
+
+			if (p < end1)
+				memcpy(out, p, (end1 - p) * sizeof(SORTP*));
+			else if (q < end2)
+				memcpy(out, q, (end2 - q) * sizeof(SORTP*));
+		}
+
+	private:
+		SORTP** m_source;
+		SORTP** m_target;
+		ULONG m_count1;
+		ULONG m_count2;
+		ULONG m_length;
+	};
 } // namespace
 
 
+// Sort part of the buffer copied into separate array together with guard records
+
+class Sort::SortChunkTask : public WorkerPool::Task
+{
+public:
+	SortChunkTask()
+		: m_pointers(NULL), m_count(0), m_longs(0)
+	{}
+
+	void setup(SORTP** pointers, ULONG count, ULONG longs)
+	{
+		m_pointers = pointers;
+		m_count = count;
+		m_longs = longs;
+	}
+
+	void execute()
+	{
+		Sort::sortPointers(m_pointers, m_count, m_longs);
+	}
+
+private:
+	SORTP** m_pointers;
+	ULONG m_count;
+	ULONG m_longs;
+};
+
+
 Sort::Sort(Database* dbb,
 		   SortOwner* owner,
 		   ULONG record_length,
@@ -169,6 +257,7 @@ Sort::Sort(Database* dbb,
 	: m_dbb(dbb), m_last_record(NULL), m_next_pointer(NULL), m_records(0),
 	  m_runs(NULL), m_merge(NULL), m_free_runs(NULL),
 	  m_flags(0), m_merge_pool(NULL),
+	  m_parallelism(WorkerPool::getParallelism(dbb->dbb_config->getParallelWorkers())),
 	  m_description(owner->getPool(), keys)
 {
 /**************************************
@@ -383,27 +472,9 @@ void Sort::put(thread_db* tdbb, ULONG** record_address)
 		}
 
 		// If there isn't room for the record, sort and write the run.
-		// Check that we are not at the beginning of the buffer in addition
-		// to checking for space for the record. This avoids the pointer
-		// record from underflowing in the second condition.
-		if ((UCHAR*) record < m_memory + m_longs ||
-			(UCHAR*) NEXT_RECORD(record) <= (UCHAR*) (m_next_pointer + 1))
+		if (!hasRoom())
 		{
-			putRun(tdbb);
-			while (true)
-			{
-				run_control* run = m_runs;
-				const USHORT depth = run->run_depth;
-				if (depth == MAX_MERGE_LEVEL)
-					break;
-				USHORT count = 1;
-				while ((run = run->run_next) && run->run_depth == depth)
-					count++;
-				if (count < RUN_GROUP)
-					break;
-				mergeRuns(count);
-			}
-			init();
+			flushRun(tdbb);
 			record = m_last_record;
 		}
 
@@ -432,6 +503,54 @@ void Sort::put(thread_db* tdbb, ULONG** record_address)
 }
 
 
+bool Sort::hasRoom() const
+{
+/**************************************
+ *
+ * Check whether there is room for another record in the sort memory.
+ * Check that we are not at the beginning of the buffer in addition
+ * to checking for space for the record. This avoids the pointer
+ * record from underflowing in the second condition.
+ *
+ **************************************/
+	const SR* const record = m_last_record;
+
+	return !((UCHAR*) record < m_memory + m_longs ||
+		(UCHAR*) NEXT_RECORD(record) <= (UCHAR*) (m_next_pointer + 1));
+}
+
+
+void Sort::flush()
+{
+/**************************************
+ *
+ * Sort the records collected so far and write them as a run,
+ * regardless of the room left in the sort memory. Called outside
+ * of the engine context for the parts of a partitioned sort.
+ *
+ **************************************/
+	try
+	{
+		if (m_last_record == (SR*) m_end_memory)
+			return;
+
+		diddleKey((UCHAR*) KEYOF(m_last_record), true, false);
+
+		flushRun(NULL);
+	}
+	catch (const BadAlloc&)
+	{
+		Firebird::Arg::Gds(isc_sort_mem_err).raise();
+	}
+	catch (const status_exception& ex)
+	{
+		Firebird::Arg::Gds status(isc_sort_err);
+		status.append(Firebird::Arg::StatusVector(ex.value()));
+		status.raise();
+	}
+}
+
+
 void Sort::sort(thread_db* tdbb)
 {
 /**************************************
@@ -463,9 +582,11 @@ void Sort::sort(thread_db* tdbb)
 			return;
 		}
 
-		// Write the last records as a run_control
+		// Write the last records as a run_control. The buffer may be empty
+		// if the sort has been flushed explicitly.
 
-		putRun(tdbb);
+		if (m_next_pointer > m_first_pointer + 1)
+			putRun(tdbb);
 
 		CHECK_FILE(NULL);
 
@@ -520,9 +641,10 @@ void Sort::sort(thread_db* tdbb)
 		}
 		else
 		{
-			// Merge of 1 or 0 runs doesn't make sense
-			fb_assert(false);				// We really shouldn't get here
-			merge = (merge_control*) *streams;	// But if we do...
+			// Merge of a single run doesn't make sense, it's possible
+			// only if the sort has been flushed explicitly
+			fb_assert(count == 1);
+			merge = (merge_control*) *streams;
 		}
 
 		// Each pass through the vector builds a level of the merge tree
@@ -1393,7 +1515,20 @@ void Sort::init()
 	if (m_size_memory <= m_max_alloc_size && m_runs &&
 		m_runs->run_depth == MAX_MERGE_LEVEL)
 	{
-		const ULONG mem_size = m_max_alloc_size * RUN_GROUP;
+		ULONG mem_size = m_max_alloc_size * RUN_GROUP;
+
+		// Buffer sorted in parallel could be as many times bigger as there are
+		// parts, if it still fits into the room left by TempCacheLimit
+
+		if (m_parallelism > 1)
+		{
+			const ULONG parallel_size = mem_size * m_parallelism;
+
+			MutexLockGuard guard(m_dbb->dbb_temp_cache_mutex, FB_FUNCTION);
+
+			if (m_dbb->dbb_temp_cache_size + parallel_size <= m_dbb->dbb_config->getTempCacheLimit())
+				mem_size = parallel_size;
+		}
 
 		try
 		{
@@ -1956,7 +2091,7 @@ void Sort::orderAndSave(thread_db* tdbb)
  * scratch file as one big chunk
  *
  **************************************/
-	EngineCheckout(tdbb, FB_FUNCTION);
+	EngineCheckout(tdbb, FB_FUNCTION, true);
 
 	run_control* run = m_runs;
 	run->run_records = 0;
@@ -2042,6 +2177,34 @@ void Sort::putRun(thread_db* tdbb)
 }
 
 
+void Sort::flushRun(thread_db* tdbb)
+{
+/**************************************
+ *
+ * Write the sort memory as a run, merge the runs of the same depth
+ * if there are enough of them and prepare for the next records.
+ *
+ **************************************/
+	putRun(tdbb);
+
+	while (true)
+	{
+		run_control* run = m_runs;
+		const USHORT depth = run->run_depth;
+		if (depth == MAX_MERGE_LEVEL)
+			break;
+		USHORT count = 1;
+		while ((run = run->run_next) && run->run_depth == depth)
+			count++;
+		if (count < RUN_GROUP)
+			break;
+		mergeRuns(count);
+	}
+
+	init();
+}
+
+
 void Sort::sortBuffer(thread_db* tdbb)
 {
 /**************************************
@@ -2052,7 +2215,7 @@ void Sort::sortBuffer(thread_db* tdbb)
  * been requested, detect and handle them.
  *
  **************************************/
-	EngineCheckout(tdbb, FB_FUNCTION);
+	EngineCheckout(tdbb, FB_FUNCTION, true);
 
 	// First, insert a pointer to the high key
 
@@ -2064,30 +2227,8 @@ void Sort::sortBuffer(thread_db* tdbb)
 	SORTP** j = (SORTP**) (m_first_pointer) + 1;
 	const ULONG n = (SORTP**) (m_next_pointer) - j;	// calculate # of records
 
-	quick(n, j, m_longs);
-
-	// Scream through and correct any out of order pairs
-	// hvlad: don't compare user keys against high_key
-	while (j < (SORTP**) m_next_pointer - 1)
-	{
-		SORTP** i = j;
-		j++;
-		if (**i >= **j)
-		{
-			const SORTP* p = *i;
-			const SORTP* q = *j;
-			ULONG tl = m_longs - 1;
-			while (tl && *p == *q)
-			{
-				p++;
-				q++;
-				tl--;
-			}
-			if (tl && *p > *q) {
-				swap(i, j);
-			}
-		}
-	}
+	if (!sortParallel(j, n))
+		sortPointers(j, n, m_longs);
 
 	// If duplicate handling hasn't been requested, we're done
 
@@ -2135,6 +2276,157 @@ void Sort::sortBuffer(thread_db* tdbb)
 }
 
 
+void Sort::sortPointers(SORTP** pointers, ULONG count, ULONG longs)
+{
+/**************************************
+ *
+ * Quick sort an array of record pointers surrounded by guard
+ * records and fix the partitions of length 2 left by it.
+ *
+ **************************************/
+	quick(count, pointers, longs);
+
+	// Scream through and correct any out of order pairs
+	// hvlad: don't compare user keys against high_key
+
+	SORTP** j = pointers;
+	SORTP** const end = pointers + count;
+
+	while (j < end - 1)
+	{
+		SORTP** i = j;
+		j++;
+		if (**i >= **j)
+		{
+			const SORTP* p = *i;
+			const SORTP* q = *j;
+			ULONG tl = longs - 1;
+			while (tl && *p == *q)
+			{
+				p++;
+				q++;
+				tl--;
+			}
+			if (tl && *p > *q) {
+				swap(i, j);
+			}
+		}
+	}
+}
+
+
+bool Sort::sortParallel(SORTP** pointers, ULONG count)
+{
+/**************************************
+ *
+ * Sort an array of record pointers using the worker pool.
+ * The array is split into parts sorted independently, then sorted
+ * parts are merged pairwise, every round of merges in parallel too.
+ * Return false if the array is not worth it or there is no memory
+ * for the scratch array, caller sorts it by itself then.
+ *
+ **************************************/
+	const ULONG parts = MIN(MIN(m_parallelism, MAX_PARALLEL_SORT_PARTS),
+		count / MIN_PARALLEL_SORT_RECORDS);
+
+	if (parts <= 1)
+		return false;
+
+	// Every part gets own guard records to be sorted by quick()
+
+	Array<SORTP*> scratch(m_owner->getPool());
+	SORTP** buffer;
+
+	try
+	{
+		buffer = scratch.getBuffer(count + 2 * parts);
+	}
+	catch (const BadAlloc&)
+	{
+		return false;
+	}
+
+	ULONG offsets[MAX_PARALLEL_SORT_PARTS + 1];
+	SortChunkTask sortTasks[MAX_PARALLEL_SORT_PARTS];
+	MergeRunsTask mergeTasks[MAX_PARALLEL_SORT_PARTS];
+	WorkerPool::Task* tasks[MAX_PARALLEL_SORT_PARTS];
+
+	for (ULONG i = 0; i <= parts; i++)
+		offsets[i] = (ULONG) ((FB_UINT64) count * i / parts);
+
+	SORTP** chunk = buffer;
+
+	for (ULONG i = 0; i < parts; i++)
+	{
+		const ULONG length = offsets[i + 1] - offsets[i];
+
+		*chunk++ = reinterpret_cast<SORTP*>(low_key);
+		memcpy(chunk, pointers + offsets[i], length * sizeof(SORTP*));
+
+		sortTasks[i].setup(chunk, length, m_longs);
+		tasks[i] = &sortTasks[i];
+
+		chunk += length;
+		*chunk++ = reinterpret_cast<SORTP*>(high_key);
+	}
+
+	WorkerPool::run(tasks, parts);
+
+	// Put sorted parts back without guards and merge them
+
+	chunk = buffer;
+
+	for (ULONG i = 0; i < parts; i++)
+	{
+		const ULONG length = offsets[i + 1] - offsets[i];
+
+		memcpy(pointers + offsets[i], ++chunk, length * sizeof(SORTP*));
+		chunk += length + 1;
+	}
+
+	SORTP** source = pointers;
+	SORTP** target = buffer;
+
+	for (ULONG runs = parts; runs > 1; )
+	{
+		ULONG merges = 0;
+
+		for (ULONG i = 0; i < runs; i += 2)
+		{
+			const ULONG start = offsets[i];
+			const ULONG middle = offsets[i + 1];
+			const ULONG end = (i + 2 <= runs) ? offsets[i + 2] : middle;
+
+			mergeTasks[merges].setup(source + start, middle - start, end - middle,
+				target + start, m_longs - 1);
+			tasks[merges] = &mergeTasks[merges];
+
+			// Merged run starts where its first half did
+			offsets[merges++] = start;
+		}
+
+		offsets[merges] = count;
+
+		WorkerPool::run(tasks, merges);
+
+		SORTP** const temp = source;
+		source = target;
+		target = temp;
+		runs = merges;
+	}
+
+	if (source != pointers)
+		memcpy(pointers, source, count * sizeof(SORTP*));
+
+	// Records were moved without swap(), so fix all the back pointers
+
+	for (SORTP** p = pointers; p < pointers + count; p++)
+		((SORTP***) (*p))[BACK_OFFSET] = p;
+
+	return true;
+}
+
+
 void Sort::sortRunsBySeek(int n)
 {
 /**************************************
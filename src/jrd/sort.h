@@ -262,6 +262,19 @@ public:
 	void put(Jrd::thread_db*, ULONG**);
 	void sort(Jrd::thread_db*);
 
+	// Support for the sorts being parts of a bigger one. Such sorts are filled
+	// by the caller one by one while they have room for another record, then
+	// flushed and finally sorted by the worker threads, i.e. without thread_db.
+	// Caller merges the output of the parts.
+
+	bool hasRoom() const;
+	void flush();
+
+	void setParallelism(unsigned parallelism)
+	{
+		m_parallelism = parallelism;
+	}
+
 	static FB_UINT64 readBlock(TempSpace* space, FB_UINT64 seek, UCHAR* address, ULONG length)
 	{
 		const size_t bytes = space->read(seek, address, length);
@@ -288,7 +301,9 @@ private:
 	ULONG order();
 	void orderAndSave(Jrd::thread_db*);
 	void putRun(Jrd::thread_db*);
+	void flushRun(Jrd::thread_db*);
 	void sortBuffer(Jrd::thread_db*);
+	bool sortParallel(SORTP**, ULONG);
 	void sortRunsBySeek(int);
 
 #ifdef DEV_BUILD
@@ -296,6 +311,9 @@ private:
 #endif
 
 	static void quick(SLONG, SORTP**, ULONG);
+	static void sortPointers(SORTP**, ULONG, ULONG);
+
+	class SortChunkTask;
 
 	Database* m_dbb;							// Database
 	SortOwner* m_owner;							// Sort owner
@@ -321,6 +339,7 @@ private:
 
 	ULONG m_min_alloc_size;						// MIN and MAX values
 	ULONG m_max_alloc_size;						// for the run buffer size
+	unsigned m_parallelism;						// number of parts in-memory sort is split into
 
 	Firebird::Array<sort_key_def> m_description;
 };
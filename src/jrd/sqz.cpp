@@ -28,39 +28,155 @@
 #include "../jrd/err_proto.h"
 #include "../yvalve/gds_proto.h"
 
+// SSE2 is a part of x86-64 baseline, so no run-time check is needed
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SQZ_SSE2
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
 using namespace Jrd;
 
+namespace
+{
+	// Scanning kernels. Records are mostly scanned in long stretches
+	// (literal data, runs of NULLs, equal parts of record versions),
+	// so compare 16 bytes at once where possible.
+
+#ifdef SQZ_SSE2
+	const FB_SIZE_T VECTOR_SIZE = sizeof(__m128i);
+
+	inline FB_SIZE_T firstBit(unsigned mask)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward(&index, mask);
+		return index;
+#else
+		return __builtin_ctz(mask);
+#endif
+	}
+
+	inline __m128i load(const UCHAR* p)
+	{
+		return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+	}
+#endif
+
+	// Find the first byte starting three equal bytes, return end if there is none
+
+	inline const UCHAR* findRun(const UCHAR* data, const UCHAR* const end)
+	{
+		if (end - data < 3)
+			return end;
+
+		const UCHAR* const last = end - 2;
+
+#ifdef SQZ_SSE2
+		while (last - data >= (ptrdiff_t) VECTOR_SIZE)
+		{
+			const __m128i v0 = load(data);
+			const __m128i eq = _mm_and_si128(_mm_cmpeq_epi8(v0, load(data + 1)),
+				_mm_cmpeq_epi8(v0, load(data + 2)));
+			const unsigned mask = _mm_movemask_epi8(eq);
+
+			if (mask)
+				return data + firstBit(mask);
+
+			data += VECTOR_SIZE;
+		}
+#endif
+
+		for (; data < last; data++)
+		{
+			if (data[0] == data[1] && data[0] == data[2])
+				return data;
+		}
+
+		return end;
+	}
+
+	// Return the number of leading bytes equal to the first one, up to max
+
+	inline FB_SIZE_T getRunLength(const UCHAR* const data, FB_SIZE_T max)
+	{
+		const UCHAR* p = data;
+		const UCHAR* const end = data + max;
+		const UCHAR c = *data;
+
+#ifdef SQZ_SSE2
+		const __m128i v0 = _mm_set1_epi8((char) c);
+
+		while (end - p >= (ptrdiff_t) VECTOR_SIZE)
+		{
+			const unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(v0, load(p))) ^ 0xFFFF;
+
+			if (mask)
+				return p - data + firstBit(mask);
+
+			p += VECTOR_SIZE;
+		}
+#endif
+
+		while (p < end && *p == c)
+			p++;
+
+		return p - data;
+	}
+
+	// Return the number of leading bytes equal in both strings, up to max
+
+	inline FB_SIZE_T getEqualLength(const UCHAR* const data1, const UCHAR* data2, FB_SIZE_T max)
+	{
+		const UCHAR* p = data1;
+		const UCHAR* const end = data1 + max;
+
+#ifdef SQZ_SSE2
+		while (end - p >= (ptrdiff_t) VECTOR_SIZE)
+		{
+			const unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(load(p), load(data2))) ^ 0xFFFF;
+
+			if (mask)
+				return p - data1 + firstBit(mask);
+
+			p += VECTOR_SIZE;
+			data2 += VECTOR_SIZE;
+		}
+#endif
+
+		while (p < end && *p == *data2)
+		{
+			p++;
+			data2++;
+		}
+
+		return p - data1;
+	}
+}
+
 
-Compressor::Compressor(MemoryPool& pool, FB_SIZE_T length, const UCHAR* data)
+Compressor::Compressor(MemoryPool& pool, FB_SIZE_T length, const UCHAR* data, bool longRuns)
 	: m_control(pool), m_length(0)
 {
+	// Control string holds a byte per packed item. A long run takes LONG_RUN_SIZE
+	// bytes: LONG_RUN, the run length and LONG_RUN again, so the string could be
+	// walked backwards as well (see store_big_record in dpm.epp).
+
 	UCHAR* control = m_control.getBuffer((length + 1) / 2, false);
+	const FB_SIZE_T maxRun = longRuns ? MAX_LONG_RUN : 128;
 	const UCHAR* const end = data + length;
 
 	FB_SIZE_T count;
 	FB_SIZE_T max;
-	while ( (count = end - data) )
+	while (data < end)
 	{
-		const UCHAR* start = data;
-
 		// Find length of non-compressable run
 
-		if ((max = count - 1) > 1)
-		{
-			do {
-				if (data[0] != data[1] || data[0] != data[2])
-				{
-					data++;
-				}
-				else
-				{
-					count = data - start;
-					break;
-				}
-			} while (--max > 1);
-		}
-
-		data = start + count;
+		const UCHAR* const start = data;
+		data = findRun(data, end);
+		count = data - start;
 
 		// Non-compressable runs are limited to 127 bytes
 
@@ -72,23 +188,30 @@ Compressor::Compressor(MemoryPool& pool, FB_SIZE_T length, const UCHAR* data)
 			*control++ = (UCHAR) max;
 		}
 
-		// Find compressible run. Compressable runs are limited to 128 bytes.
+		// Find compressible run. Compressable runs are limited to 128 bytes,
+		// unless long runs are allowed.
 
-		if ((max = MIN(128, end - data)) >= 3)
+		if ((max = MIN(maxRun, (FB_SIZE_T) (end - data))) >= 3)
 		{
-			start = data;
-			const UCHAR c = *data;
-			do
-			{
-				if (*data != c)
-				{
-					break;
-				}
-				++data;
-			} while (--max);
+			const FB_SIZE_T run = getRunLength(data, max);
+			data += run;
 
-			*control++ = (UCHAR) (start - data);
-			m_length += 2;
+			if (run > 128)
+			{
+				// Long run never takes more space than the short runs it replaces.
+				// Run of a single byte is never produced, thus LONG_RUN is unique.
+
+				*control++ = (UCHAR) LONG_RUN;
+				*control++ = (UCHAR) run;
+				*control++ = (UCHAR) (run >> 8);
+				*control++ = (UCHAR) LONG_RUN;
+				m_length += LONG_RUN_SIZE;
+			}
+			else
+			{
+				*control++ = (UCHAR) -(int) run;
+				m_length += 2;
+			}
 		}
 	}
 
@@ -179,7 +302,31 @@ FB_SIZE_T Compressor::pack(const UCHAR* input, FB_SIZE_T outLength, UCHAR* outpu
 		int length = (signed char) *control++;
 		*output++ = (UCHAR) length;
 
-		if (length < 0)
+		if (length == LONG_RUN)
+		{
+			if (space < (int) LONG_RUN_SIZE - 1)
+			{
+				// Not enough room for the long run, store its head as a short run
+				// and fill the remaining byte (if any) with an empty literal
+
+				output[-1] = (UCHAR) -128;
+				*output++ = *input;
+				input += 128;
+
+				if (--space > 0)
+					*output = 0;
+
+				return input - start;
+			}
+
+			space -= LONG_RUN_SIZE - 1;
+			*output++ = *control++;
+			*output++ = *control++;
+			*output++ = *input;
+			input += getLongRun(control - 2);
+			control++;
+		}
+		else if (length < 0)
 		{
 			--space;
 			*output++ = *input;
@@ -236,7 +383,19 @@ FB_SIZE_T Compressor::getPartialLength(FB_SIZE_T inLength, const UCHAR* input) c
 
 		int length = (signed char) *control++;
 
-		if (length < 0)
+		if (length == LONG_RUN)
+		{
+			if (space < (int) LONG_RUN_SIZE - 1)
+			{
+				input += 128;
+				return input - start;
+			}
+
+			space -= LONG_RUN_SIZE - 1;
+			input += getLongRun(control);
+			control += LONG_RUN_SIZE - 1;
+		}
+		else if (length < 0)
 		{
 			--space;
 			input += (-length) & 255;
@@ -277,14 +436,27 @@ UCHAR* Compressor::unpack(FB_SIZE_T inLength,
 
 		if (len < 0)
 		{
-			if (input >= end || (output - len) > output_end)
+			FB_SIZE_T run = -len;
+
+			if (len == LONG_RUN)
+			{
+				if (end - input < 2)
+				{
+					BUGCHECK(179);	// msg 179 decompression overran buffer
+				}
+
+				run = getLongRun(input);
+				input += 2;
+			}
+
+			if (input >= end || run > (FB_SIZE_T) (output_end - output))
 			{
 				BUGCHECK(179);	// msg 179 decompression overran buffer
 			}
 
 			const UCHAR c = *input++;
-			memset(output, c, (-1 * len));
-			output -= len;
+			memset(output, c, run);
+			output += run;
 		}
 		else
 		{
@@ -391,13 +563,14 @@ FB_SIZE_T Compressor::makeDiff(FB_SIZE_T length1,
 			continue;
 		}
 
-		for (p = rec2; rec1 < end1 && *rec1 == *rec2; rec1++, rec2++)
-			; // no-op
+		const FB_SIZE_T equal = getEqualLength(rec1, rec2, end1 - rec1);
+		rec1 += equal;
+		rec2 += equal;
 
 		// This "l" could be more than 32K since the Old and New records
 		// could be the same for more than 32K characters.
 		// MAX record size is currently 64K. Hence it is defined as "int".
-		int l = p - rec2;
+		int l = -(int) equal;
 
 		while (l < -127)
 		{
@@ -446,7 +619,15 @@ void Compressor::pack(const UCHAR* input, UCHAR* output) const
 		const int length = (signed char) *control++;
 		*output++ = (UCHAR) length;
 
-		if (length < 0)
+		if (length == LONG_RUN)
+		{
+			*output++ = *control++;
+			*output++ = *control++;
+			*output++ = *input;
+			input += getLongRun(control - 2);
+			control++;
+		}
+		else if (length < 0)
 		{
 			*output++ = *input;
 			input -= length;
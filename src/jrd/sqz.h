@@ -32,7 +32,15 @@ namespace Jrd
 	class Compressor
 	{
 	public:
-		Compressor(MemoryPool& pool, FB_SIZE_T length, const UCHAR* data);
+		// Runs longer than 128 bytes are packed as LONG_RUN followed by the
+		// 16-bit run length (low byte first) and the repeated byte. Older
+		// engines don't know this token, so it's produced only on request.
+
+		static const int LONG_RUN = -1;
+		static const FB_SIZE_T LONG_RUN_SIZE = 4;
+		static const FB_SIZE_T MAX_LONG_RUN = MAX_USHORT;
+
+		Compressor(MemoryPool& pool, FB_SIZE_T length, const UCHAR* data, bool longRuns);
 
 		FB_SIZE_T getPackedLength() const
 		{
@@ -58,6 +66,11 @@ namespace Jrd
 		static FB_SIZE_T makeDiff(FB_SIZE_T, const UCHAR*, FB_SIZE_T, UCHAR*, FB_SIZE_T, UCHAR*);
 		static FB_SIZE_T makeNoDiff(FB_SIZE_T, UCHAR*);
 
+		static FB_SIZE_T getLongRun(const UCHAR* p)
+		{
+			return p[0] | (p[1] << 8);
+		}
+
 	private:
 		Firebird::HalfStaticArray<UCHAR, 2048> m_control;
 		FB_SIZE_T m_length;
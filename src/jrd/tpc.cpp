@@ -113,6 +113,7 @@ TipCache::TipCache(Database* dbb)
 	  globalTpcInitializer(this), snapshotsInitializer(this), memBlockInitializer(this),
 	  m_blocks_memory(*dbb->dbb_permanent)
 {
+	forgetBlocks();
 }
 
 TipCache::~TipCache()
@@ -136,6 +137,8 @@ void TipCache::finalizeTpc(thread_db* tdbb)
 		ERR_bugcheck_msg("Unable to obtain TPC lock (SW)");
 
 	// Release locks and deallocate all shared memory structures
+	forgetBlocks();
+
 	if (m_blocks_memory.getFirst())
 	{
 		do
@@ -198,6 +201,46 @@ CommitNumber TipCache::cacheState(TraNumber number)
 	return state;
 }
 
+CommitNumber TipCache::cacheState(thread_db* tdbb, TraNumber number)
+{
+	Attachment* const attachment = tdbb->getAttachment();
+
+	if (!attachment)
+		return cacheState(number);
+
+	const TransactionStates::Entry& entry =
+		attachment->att_tra_states.m_entries[number & (TransactionStates::CACHE_SIZE - 1)];
+
+	if (entry.number == number && entry.state != CN_ACTIVE)
+	{
+		tdbb->bumpStats(RuntimeStatistics::TRA_STATE_HITS);
+		return entry.state;
+	}
+
+	tdbb->bumpStats(RuntimeStatistics::TRA_STATE_MISSES);
+
+	const CommitNumber state = cacheState(number);
+	rememberState(tdbb, number, state);
+
+	return state;
+}
+
+void TipCache::rememberState(thread_db* tdbb, TraNumber number, CommitNumber state)
+{
+	// Active and limbo transactions may change their state at any moment
+	if (state == CN_ACTIVE || state == CN_LIMBO)
+		return;
+
+	if (Attachment* const attachment = tdbb->getAttachment())
+	{
+		TransactionStates::Entry& entry =
+			attachment->att_tra_states.m_entries[number & (TransactionStates::CACHE_SIZE - 1)];
+
+		entry.number = number;
+		entry.state = state;
+	}
+}
+
 void TipCache::initializeTpc(thread_db *tdbb)
 {
 	Database* dbb = tdbb->getDatabase();
@@ -401,13 +444,34 @@ TipCache::TransactionStatusBlock* TipCache::createTransactionStatusBlock(ULONG b
 
 TipCache::TransactionStatusBlock* TipCache::getTransactionStatusBlock(GlobalTpcHeader* header, TpcBlockNumber blockNumber)
 {
+	// Most of lookups are served by the slots array and do not write to any shared
+	// cache line. Generation of the slot is re-read after the block number and pointer
+	// to detect concurrent change of the slot, even if the same number was put back.
+	// Blocks being released are older than any transaction our callers may look for,
+	// that's covered by the safety gap in releaseSharedMemory.
+	const BlockSlot& slot = m_block_slots[blockNumber % BLOCK_SLOTS];
+	const FB_UINT64 generation = slot.generation.load(std::memory_order_acquire);
+
+	if (!(generation & 1))
+	{
+		const TpcBlockNumber number = slot.number.load(std::memory_order_relaxed);
+		TransactionStatusBlock* const block = slot.block.load(std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		if (number == blockNumber && slot.generation.load(std::memory_order_relaxed) == generation)
+			return block;
+	}
+
 	// This is a double-checked locking pattern. SyncLockGuard uses atomic ops internally and should be cheap
 	TransactionStatusBlock* block = NULL;
 	{
 		SyncLockGuard sync(&m_sync_status, SYNC_SHARED, "TipCache::getTransactionStatusBlock");
 		BlocksMemoryMap::ConstAccessor acc(&m_blocks_memory);
 		if (acc.locate(blockNumber))
+		{
 			block = acc.current()->memory->getHeader();
+			publishBlock(blockNumber, block);
+		}
 	}
 
 	if (!block)
@@ -423,10 +487,75 @@ TipCache::TransactionStatusBlock* TipCache::getTransactionStatusBlock(GlobalTpcH
 			if (blockNumber >= oldest / m_transactionsPerBlock)
 				block = createTransactionStatusBlock(header->tpc_block_size, blockNumber);
 		}
+
+		if (block)
+			publishBlock(blockNumber, block);
 	}
 	return block;
 }
 
+bool TipCache::lockSlot(BlockSlot& slot, FB_UINT64& generation)
+{
+	// Make generation odd to let readers know the slot is being changed.
+	// Returns false if somebody else is changing it.
+
+	generation = slot.generation.load(std::memory_order_acquire);
+
+	if (generation & 1)
+		return false;
+
+	return slot.generation.compare_exchange_strong(generation, generation + 1, std::memory_order_acquire);
+}
+
+void TipCache::publishBlock(TpcBlockNumber blockNumber, TransactionStatusBlock* block)
+{
+	// Caller holds m_sync_status, so the block can't be released meanwhile.
+	// Slot is just a hint, give up if somebody else is changing it.
+
+	BlockSlot& slot = m_block_slots[blockNumber % BLOCK_SLOTS];
+
+	if (slot.number.load(std::memory_order_relaxed) == blockNumber)
+		return;
+
+	FB_UINT64 generation;
+	if (!lockSlot(slot, generation))
+		return;
+
+	slot.number.store(blockNumber, std::memory_order_relaxed);
+	slot.block.store(block, std::memory_order_relaxed);
+	slot.generation.store(generation + 2, std::memory_order_release);
+}
+
+void TipCache::forgetBlock(TpcBlockNumber blockNumber)
+{
+	BlockSlot& slot = m_block_slots[blockNumber % BLOCK_SLOTS];
+
+	FB_UINT64 generation;
+	while (!lockSlot(slot, generation))
+	{
+		// Publisher is about to complete, wait for it
+		Thread::yield();
+	}
+
+	if (slot.number.load(std::memory_order_relaxed) == blockNumber)
+	{
+		slot.number.store(SLOT_EMPTY, std::memory_order_relaxed);
+		slot.block.store(NULL, std::memory_order_relaxed);
+	}
+
+	slot.generation.store(generation + 2, std::memory_order_release);
+}
+
+void TipCache::forgetBlocks()
+{
+	for (ULONG i = 0; i < BLOCK_SLOTS; i++)
+	{
+		m_block_slots[i].generation.store(0, std::memory_order_relaxed);
+		m_block_slots[i].number.store(SLOT_EMPTY, std::memory_order_relaxed);
+		m_block_slots[i].block.store(NULL, std::memory_order_relaxed);
+	}
+}
+
 TraNumber TipCache::findStates(TraNumber minNumber, TraNumber maxNumber, ULONG mask, int& state)
 {
 	// Can only be called on initialized TipCache
@@ -570,7 +699,7 @@ CommitNumber TipCache::snapshotState(thread_db* tdbb, TraNumber number)
 	fb_assert(m_tpcHeader);
 
 	// Get data from cache
-	CommitNumber stateCn = cacheState(number);
+	CommitNumber stateCn = cacheState(tdbb, number);
 
 	// Transaction is committed or dead?
 	if (stateCn == CN_DEAD || (stateCn >= CN_PREHISTORIC && stateCn <= CN_MAX_NUMBER))
@@ -607,6 +736,7 @@ CommitNumber TipCache::snapshotState(thread_db* tdbb, TraNumber number)
 
 	// Update cache and return new state
 	stateCn = setState(number, state);
+	rememberState(tdbb, number, stateCn);
 	return stateCn;
 }
 
@@ -637,6 +767,7 @@ int TipCache::tpc_block_blocking_ast(void* arg)
 		cache->m_tpcHeader->getHeader()->oldest_transaction.load(std::memory_order_relaxed);
 
 	// Release shared memory
+	cache->forgetBlock(data->blockNumber);
 	data->clear(tdbb);
 
 	// Check if there is a bug in cleanup code and we were requested to
@@ -691,6 +822,8 @@ void TipCache::releaseSharedMemory(thread_db* tdbb, TraNumber oldest_old, TraNum
 	{
 		TpcBlockNumber blockNumber = blocksToCleanup.pop();
 
+		forgetBlock(blockNumber);
+
 		if (m_blocks_memory.locate(blockNumber))
 		{
 			StatusBlockData* block = m_blocks_memory.current();
@@ -69,6 +69,10 @@ public:
 	// Get the current state of a transaction in the cache
 	CommitNumber cacheState(TraNumber number);
 
+	// Same as above, but look into the attachment's cache of recently seen transactions
+	// first. Final states (committed with commit# or dead) are remembered there.
+	CommitNumber cacheState(thread_db* tdbb, TraNumber number);
+
 	// Return the oldest transaction in the given state.
 	// Lookup in the [min_number, max_number) bounds.
 	// If not found, return zero.
@@ -146,6 +150,10 @@ public:
 	}
 
 private:
+	// Shared data read at every state lookup is kept apart from the counters
+	// changed by every transaction, to not bounce their cache lines between CPUs
+	static const size_t CACHE_LINE_SIZE = 128;
+
 	class GlobalTpcHeader : public Firebird::MemoryHeader
 	{
 	public:
@@ -157,18 +165,18 @@ private:
 		// The assumption of the code is that it is not possible to process full
 		// memory block worth of transactions during the period of cache decoherence
 		// of any one CPU accessing this variable
-		std::atomic<TraNumber> oldest_transaction;
+		alignas(CACHE_LINE_SIZE) std::atomic<TraNumber> oldest_transaction;
+
+		// Size of memory chunk with TransactionStatusBlock
+		ULONG tpc_block_size; // final
 
 		// Incremented each time whenever snapshot is released
-		std::atomic<ULONG> snapshot_release_count;
+		alignas(CACHE_LINE_SIZE) std::atomic<ULONG> snapshot_release_count;
 
 		// Shared counters
 		std::atomic<TraNumber> latest_transaction_id;
 		std::atomic<AttNumber> latest_attachment_id;
 		std::atomic<StmtNumber> latest_statement_id;
-
-		// Size of memory chunk with TransactionStatusBlock
-		ULONG tpc_block_size; // final
 	};
 
 	struct SnapshotData
@@ -192,7 +200,7 @@ private:
 	class TransactionStatusBlock : public Firebird::MemoryHeader
 	{
 	public:
-		std::atomic<CommitNumber> data[1];
+		alignas(CACHE_LINE_SIZE) std::atomic<CommitNumber> data[1];
 	};
 
 	typedef TransactionStatusBlock* PTransactionStatusBlock;
@@ -251,8 +259,20 @@ private:
 
 	typedef Firebird::BePlusTree<StatusBlockData*, TpcBlockNumber, Firebird::MemoryPool, StatusBlockData> BlocksMemoryMap;
 
-	static const ULONG TPC_VERSION = 1;
+	// Slot of the direct-mapped array of recently used status blocks.
+	// Generation is odd while the slot is being changed. Number and block read
+	// between two equal even values of generation belong to each other.
+	struct BlockSlot
+	{
+		std::atomic<FB_UINT64> generation;
+		std::atomic<TpcBlockNumber> number;
+		std::atomic<TransactionStatusBlock*> block;
+	};
+
+	static const ULONG TPC_VERSION = 2;
 	static const int SAFETY_GAP_BLOCKS = 1;
+	static const ULONG BLOCK_SLOTS = 64;
+	static const TpcBlockNumber SLOT_EMPTY = MAX_UINT64;
 
 	Firebird::SharedMemory<GlobalTpcHeader>* m_tpcHeader; // final
 	Firebird::SharedMemory<SnapshotList>* m_snapshots; // final
@@ -266,6 +286,9 @@ private:
 	// Reads and writes to the tree are protected with m_sync_status.
 	BlocksMemoryMap m_blocks_memory;
 
+	// Blocks found in the tree, looked up there without locking
+	BlockSlot m_block_slots[BLOCK_SLOTS];
+
 	Firebird::SyncObject m_sync_status;
 
 	void initTransactionsPerBlock(ULONG blockSize);
@@ -277,6 +300,15 @@ private:
 	// Map shared memory for a block
 	TransactionStatusBlock* createTransactionStatusBlock(ULONG blockSize, TpcBlockNumber blockNumber);
 
+	// Maintain lock-free lookup array of the mapped blocks
+	void publishBlock(TpcBlockNumber blockNumber, TransactionStatusBlock* block);
+	bool lockSlot(BlockSlot& slot, FB_UINT64& generation);
+	void forgetBlock(TpcBlockNumber blockNumber);
+	void forgetBlocks();
+
+	// Put final state of a transaction into the attachment's cache
+	static void rememberState(thread_db* tdbb, TraNumber number, CommitNumber state);
+
 	// Release shared memory blocks, if possible.
 	// We utilize one full MemoryBlock as a safety margin to account for possible
 	// race conditions during lockless operations, so this operation shall be pretty safe.
@@ -297,7 +329,7 @@ private:
 
 inline int TPC_cache_state(thread_db* tdbb, TraNumber number)
 {
-	CommitNumber stateCn = tdbb->getDatabase()->dbb_tip_cache->cacheState(number);
+	CommitNumber stateCn = tdbb->getDatabase()->dbb_tip_cache->cacheState(tdbb, number);
 	switch (stateCn)
 	{
 	case CN_ACTIVE:	return tra_active;
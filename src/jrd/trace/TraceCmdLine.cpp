@@ -97,13 +97,21 @@ namespace
 		const int MAIN_USAGE[] = {3, 21};
 		const int EXAMPLES[] = {22, 27};
 		const int NOTES[] = {28, 29};
+		const int DECODE_USAGE[] = {41, 44};
+		const int DECODE_EXAMPLES[] = {45, 45};
 
 		for (int i = MAIN_USAGE[0]; i <= MAIN_USAGE[1]; ++i)
 			printMsg(i);
 
+		printf("\n");
+		for (int i = DECODE_USAGE[0]; i <= DECODE_USAGE[1]; ++i)
+			printMsg(i);
+
 		printf("\n");
 		for (int i = EXAMPLES[0]; i <= EXAMPLES[1]; ++i)
 			printMsg(i);
+		for (int i = DECODE_EXAMPLES[0]; i <= DECODE_EXAMPLES[1]; ++i)
+			printMsg(i);
 
 		printf("\n");
 		for (int i = NOTES[0]; i <= NOTES[1]; ++i)
@@ -175,6 +183,8 @@ void fbtrace(UtilSvc* uSvc, TraceSvcIntf* traceSvc)
 	const Switches optSwitches(trace_option_in_sw_table, FB_NELEM(trace_option_in_sw_table),
 								false, true);
 	TraceSession session(*getDefaultMemoryPool());
+	PathName decode_file;
+	bool json = false;
 	for (int itr = 1; itr < argc; ++itr)
 	{
 		if (!argv[itr])
@@ -195,6 +205,7 @@ void fbtrace(UtilSvc* uSvc, TraceSvcIntf* traceSvc)
 				case IN_SW_TRACE_SUSPEND:
 				case IN_SW_TRACE_RESUME:
 				case IN_SW_TRACE_LIST:
+				case IN_SW_TRACE_DECODE:
 					usage(uSvc, isc_trace_param_act_notcompat, sw->in_sw_name, action_sw->in_sw_name);
 					break;
 			}
@@ -216,6 +227,7 @@ void fbtrace(UtilSvc* uSvc, TraceSvcIntf* traceSvc)
 				case IN_SW_TRACE_SUSPEND:
 				case IN_SW_TRACE_RESUME:
 				case IN_SW_TRACE_LIST:
+				case IN_SW_TRACE_DECODE:
 					usage(uSvc, isc_trace_param_act_notcompat, sw->in_sw_name, action_sw->in_sw_name);
 					break;
 			}
@@ -235,6 +247,7 @@ void fbtrace(UtilSvc* uSvc, TraceSvcIntf* traceSvc)
 			{
 				case IN_SW_TRACE_START:
 				case IN_SW_TRACE_LIST:
+				case IN_SW_TRACE_DECODE:
 					usage(uSvc, isc_trace_param_act_notcompat, sw->in_sw_name, action_sw->in_sw_name);
 					break;
 			}
@@ -253,6 +266,27 @@ void fbtrace(UtilSvc* uSvc, TraceSvcIntf* traceSvc)
 				usage(uSvc, isc_trace_param_val_miss, sw->in_sw_name);
 			break;
 
+		case IN_SW_TRACE_FILE:
+			if (action_sw->in_sw != IN_SW_TRACE_DECODE)
+				usage(uSvc, isc_trace_param_act_notcompat, sw->in_sw_name, action_sw->in_sw_name);
+
+			if (decode_file.hasData())
+				usage(uSvc, isc_trace_switch_once, sw->in_sw_name);
+
+			itr++;
+			if (itr < argc && argv[itr])
+				decode_file = argv[itr];
+			else
+				usage(uSvc, isc_trace_param_val_miss, sw->in_sw_name);
+			break;
+
+		case IN_SW_TRACE_JSON:
+			if (action_sw->in_sw != IN_SW_TRACE_DECODE)
+				usage(uSvc, isc_trace_param_act_notcompat, sw->in_sw_name, action_sw->in_sw_name);
+
+			json = true;
+			break;
+
 		default:
 			fb_assert(false);
 		}
@@ -372,6 +406,19 @@ void fbtrace(UtilSvc* uSvc, TraceSvcIntf* traceSvc)
 		}
 	}
 
+	// binary log is decoded locally, no connection to the server is needed
+	if (action_sw->in_sw == IN_SW_TRACE_DECODE)
+	{
+		if (uSvc->isService())
+			usage(uSvc, isc_trace_switch_user_only, action_sw->in_sw_name);
+
+		if (decode_file.isEmpty())
+			usage(uSvc, isc_trace_switch_param_miss, "FILE", action_sw->in_sw_name);
+
+		traceSvc->decodeLog(decode_file, json);
+		return;
+	}
+
 	// validate missed action's parameters and perform action
 	if (!uSvc->isService() && svc_name.isEmpty()) {
 		usage(uSvc, isc_trace_mandatory_switch_miss, "SERVICE");
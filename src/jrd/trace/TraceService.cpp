@@ -64,6 +64,7 @@ public:
 	virtual void stopSession(ULONG id);
 	virtual void setActive(ULONG id, bool active);
 	virtual void listSessions();
+	virtual void decodeLog(const PathName& fileName, bool json);
 
 private:
 	void readSession(TraceSession& session);
@@ -276,6 +277,13 @@ void TraceSvcJrd::listSessions()
 	}
 }
 
+void TraceSvcJrd::decodeLog(const PathName& /*fileName*/, bool /*json*/)
+{
+	// Binary log is decoded by fbtracemgr locally, not by the server
+
+	(Arg::Gds(isc_trace_switch_user_only) << "DECODE").raise();
+}
+
 void TraceSvcJrd::readSession(TraceSession& session)
 {
 	if (session.ses_logfile.empty())
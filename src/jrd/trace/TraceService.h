@@ -55,6 +55,7 @@ public:
 	virtual void stopSession(ULONG id) = 0;
 	virtual void setActive(ULONG id, bool active) = 0;
 	virtual void listSessions() = 0;
+	virtual void decodeLog(const PathName& fileName, bool json) = 0;
 
 	virtual ~TraceSvcIntf() { }
 };
@@ -41,6 +41,9 @@ const int IN_SW_TRACE_FETCH_PWD		= 12;
 const int IN_SW_TRACE_TRUSTED_AUTH	= 13;
 const int IN_SW_TRACE_VERSION		= 14;
 const int IN_SW_TRACE_ROLE			= 15;
+const int IN_SW_TRACE_DECODE		= 16;
+const int IN_SW_TRACE_FILE			= 17;
+const int IN_SW_TRACE_JSON			= 18;
 
 
 // list of possible actions (services) for use with trace services
@@ -52,6 +55,7 @@ static const struct Switches::in_sw_tab_t trace_action_in_sw_table [] =
 	{IN_SW_TRACE_START,		isc_action_svc_trace_start,		"START",	0, 0, 0, false,	false,	0,	3, NULL},
 	{IN_SW_TRACE_SUSPEND,	isc_action_svc_trace_suspend,	"SUSPEND",	0, 0, 0, false,	false,	0,	2, NULL},
 	{IN_SW_TRACE_VERSION,	0,								"Z",		0, 0, 0, false,	false, 0,	1, NULL},
+	{IN_SW_TRACE_DECODE,	0,								"DECODE",	0, 0, 0, false,	false, 0,	2, NULL},
 	{0,						0,								NULL,		0, 0, 0, false,	false, 0,	0, NULL}	// End of List
 };
 
@@ -62,6 +66,8 @@ static const struct Switches::in_sw_tab_t trace_option_in_sw_table [] =
 	{IN_SW_TRACE_CONFIG,	isc_spb_trc_cfg,	"CONFIG", 	0, 0, 0, false,	false,	0,	1, NULL},
 	{IN_SW_TRACE_ID,		isc_spb_trc_id,		"ID",		0, 0, 0, false,	false,	0,	1, NULL},
 	{IN_SW_TRACE_NAME,		isc_spb_trc_name,	"NAME", 	0, 0, 0, false,	false,	0,	1, NULL},
+	{IN_SW_TRACE_FILE,		0,					"FILE", 	0, 0, 0, false,	false,	0,	2, NULL},
+	{IN_SW_TRACE_JSON,		0,					"JSON", 	0, 0, 0, false,	false,	0,	1, NULL},
 	{0,						0,					NULL,		0, 0, 0, false,	false, 0,	0, NULL}	// End of List
 };
 
@@ -2116,7 +2116,7 @@ void VIO_intermediate_gc(thread_db* tdbb, record_param* rpb, jrd_tra* transactio
 		prev_snapshot_number = current_snapshot_number;
 
 		Record *record = rev_i.object();
-		CommitNumber cn = tipCache->cacheState(record->getTransactionNumber());
+		CommitNumber cn = tipCache->cacheState(tdbb, record->getTransactionNumber());
 		if (cn >= CN_PREHISTORIC && cn <= CN_MAX_NUMBER)
 			current_snapshot_number = att->att_active_snapshots.getSnapshotForVersion(cn);
 		else
@@ -143,6 +143,14 @@ const SLONG HASH_MIN_SLOTS	= 101;
 const SLONG HASH_MAX_SLOTS	= 65521;
 const USHORT HISTORY_BLOCKS	= 256;
 
+// The spinlock of a partition is never held while waiting for anything,
+// its contenders spin, then yield and check occasionally whether the holder
+// is still alive.
+
+const USHORT PARTITION_HISTORY_BLOCKS	= 32;
+const ULONG PARTITION_SPINS				= 100;
+const ULONG PARTITION_PROBE_INTERVAL	= 1000;
+
 // SRQ_ABS_PTR uses this macro.
 #define SRQ_BASE                    ((UCHAR*) m_sharedMemory->getHeader())
 
@@ -172,6 +180,7 @@ LockManager::LockManager(const string& id, const Config* conf)
 	  m_cleanupSync(getPool(), blocking_action_thread, THREAD_high),
 	  m_sharedMemory(NULL),
 	  m_blockage(false),
+	  m_partitionsOwned(false),
 	  m_dbId(id),
 	  m_config(conf),
 	  m_acquireSpins(m_config->getLockAcquireSpins()),
@@ -422,7 +431,10 @@ void LockManager::shutdownOwner(thread_db* tdbb, SRQ_PTR* owner_handle)
 	// This assert expects that all the granted locks have been explicitly
 	// released before destroying the lock owner. This is not strictly required,
 	// but it enforces the proper object lifetime discipline through the codebase.
-	fb_assert(SRQ_EMPTY(owner->own_requests));
+#ifdef DEV_BUILD
+	for (USHORT i = 0; i < m_sharedMemory->getHeader()->lhb_partitions; i++)
+		fb_assert(SRQ_EMPTY(owner->own_requests[i]));
+#endif
 
 	purge_owner(owner_offset, owner);
 
@@ -460,6 +472,16 @@ SRQ_PTR LockManager::enqueue(thread_db* tdbb,
 	if (!owner_offset)
 		return 0;
 
+	if (!prior_request && !data)
+	{
+		SRQ_PTR request_offset;
+		if (fast_enqueue(statusVector, owner_offset, series, value, length, type,
+						 ast_routine, ast_argument, lck_wait, &request_offset))
+		{
+			return request_offset;
+		}
+	}
+
 	LockTableGuard guard(this, FB_FUNCTION, owner_offset);
 
 	own* owner = (own*) SRQ_ABS_PTR(owner_offset);
@@ -477,25 +499,19 @@ SRQ_PTR LockManager::enqueue(thread_db* tdbb,
 	if (prior_request)
 		internal_dequeue(prior_request);
 
-	// Allocate or reuse a lock request block
+	// Determine the partition the lock belongs to
 
-	lrq* request;
+	const USHORT partition = (USHORT)
+		(InternalHash::hash(length, value, m_sharedMemory->getHeader()->lhb_hash_slots) %
+		 m_sharedMemory->getHeader()->lhb_partitions);
 
-	ASSERT_ACQUIRED;
-	if (SRQ_EMPTY(m_sharedMemory->getHeader()->lhb_free_requests))
-	{
-		if (!(request = (lrq*) alloc(sizeof(lrq), statusVector)))
-			return 0;
+	// Allocate or reuse a lock request block
 
-		owner = (own*) SRQ_ABS_PTR(owner_offset);
-	}
-	else
-	{
-		ASSERT_ACQUIRED;
-		request = (lrq*) ((UCHAR*) SRQ_NEXT(m_sharedMemory->getHeader()->lhb_free_requests) -
-						 offsetof(lrq, lrq_lbl_requests));
-		remove_que(&request->lrq_lbl_requests);
-	}
+	lrq* request = alloc_request(partition, statusVector);
+	if (!request)
+		return 0;
+
+	owner = (own*) SRQ_ABS_PTR(owner_offset);
 
 	post_history(his_enq, owner_offset, (SRQ_PTR)0, SRQ_REL_PTR(request), true);
 
@@ -507,7 +523,7 @@ SRQ_PTR LockManager::enqueue(thread_db* tdbb,
 	request->lrq_owner = owner_offset;
 	request->lrq_ast_routine = ast_routine;
 	request->lrq_ast_argument = ast_argument;
-	insert_tail(&owner->own_requests, &request->lrq_own_requests);
+	insert_tail(&owner->own_requests[partition], &request->lrq_own_requests);
 	SRQ_INIT(request->lrq_own_blocks);
 	SRQ_INIT(request->lrq_own_pending);
 
@@ -538,18 +554,20 @@ SRQ_PTR LockManager::enqueue(thread_db* tdbb,
 
 	// Lock doesn't exist. Allocate lock block and set it up.
 
-	if (!(lock = alloc_lock(length, statusVector)))
+	if (!(lock = alloc_lock(length, partition, statusVector)))
 	{
 		// lock table is exhausted: release request gracefully
+		request = (lrq*) SRQ_ABS_PTR(request_offset);
 		remove_que(&request->lrq_own_requests);
 		request->lrq_type = type_null;
-		insert_tail(&m_sharedMemory->getHeader()->lhb_free_requests, &request->lrq_lbl_requests);
+		insert_tail(&get_partition(partition)->lpt_free_requests, &request->lrq_lbl_requests);
 		return 0;
 	}
 
 	lock->lbl_state = type;
 	fb_assert(series <= MAX_UCHAR);
 	lock->lbl_series = (UCHAR)series;
+	lock->lbl_partition = partition;
 
 	// Maintain lock series data queue
 
@@ -603,6 +621,10 @@ bool LockManager::convert(thread_db* tdbb,
  **************************************/
 	LOCK_TRACE(("LM::convert (%d, %d)\n", type, lck_wait));
 
+	bool result;
+	if (fast_convert(statusVector, request_offset, type, lck_wait, ast_routine, ast_argument, &result))
+		return result;
+
 	LockTableGuard guard(this, FB_FUNCTION, DUMMY_OWNER);
 
 	lrq* const request = get_request(request_offset);
@@ -621,9 +643,8 @@ bool LockManager::convert(thread_db* tdbb,
 	else
 		++(m_sharedMemory->getHeader()->lhb_operations[0]);
 
-	const bool result =
-		internal_convert(tdbb, statusVector, request_offset, type, lck_wait,
-						 ast_routine, ast_argument);
+	result = internal_convert(tdbb, statusVector, request_offset, type, lck_wait,
+							  ast_routine, ast_argument);
 
 	return result;
 }
@@ -709,6 +730,10 @@ bool LockManager::dequeue(const SRQ_PTR request_offset)
  **************************************/
 	LOCK_TRACE(("LM::dequeue (%ld)\n", request_offset));
 
+	bool result;
+	if (fast_dequeue(request_offset, &result))
+		return result;
+
 	LockTableGuard guard(this, FB_FUNCTION, DUMMY_OWNER);
 
 	lrq* const request = get_request(request_offset);
@@ -935,6 +960,10 @@ LOCK_DATA_T LockManager::readData(SRQ_PTR request_offset)
  **************************************/
 	LOCK_TRACE(("LM::readData (%ld)\n", request_offset));
 
+	LOCK_DATA_T result;
+	if (fast_read_data(request_offset, &result))
+		return result;
+
 	LockTableGuard guard(this, FB_FUNCTION, DUMMY_OWNER);
 
 	const lrq* const request = get_request(request_offset);
@@ -973,6 +1002,10 @@ LOCK_DATA_T LockManager::readData2(USHORT series,
 	if (!owner_offset)
 		return 0;
 
+	LOCK_DATA_T result;
+	if (fast_read_data2(series, value, length, &result))
+		return result;
+
 	LockTableGuard guard(this, FB_FUNCTION, owner_offset);
 
 	++(m_sharedMemory->getHeader()->lhb_read_data);
@@ -1003,6 +1036,9 @@ LOCK_DATA_T LockManager::writeData(SRQ_PTR request_offset, LOCK_DATA_T data)
  **************************************/
 	LOCK_TRACE(("LM::writeData (%ld)\n", request_offset));
 
+	if (fast_write_data(request_offset, data))
+		return data;
+
 	LockTableGuard guard(this, FB_FUNCTION, DUMMY_OWNER);
 
 	const lrq* const request = get_request(request_offset);
@@ -1024,6 +1060,118 @@ LOCK_DATA_T LockManager::writeData(SRQ_PTR request_offset, LOCK_DATA_T data)
 }
 
 
+lpt* LockManager::acquire_partition(USHORT number)
+{
+/**************************************
+ *
+ *	a c q u i r e _ p a r t i t i o n
+ *
+ **************************************
+ *
+ * Functional description
+ *	Acquire the spinlock of a lock table partition. The caller
+ *	holds m_remapSync for reading, it's released while yielding
+ *	to let the mutex holder remap the lock table. Return NULL if
+ *	the operation should be done under the lock table mutex instead.
+ *
+ **************************************/
+	for (ULONG spins = 0; ; spins++)
+	{
+		lpt* const partition = get_partition(number);
+
+		int holder = 0;
+		if (partition->lpt_mutex.compare_exchange_strong(holder, PID))
+		{
+			// Blocks of the lock table extended by another process are not
+			// accessible until the mutex holder remaps the lock table
+
+			if (m_sharedMemory->getHeader()->lhb_length > m_sharedMemory->sh_mem_length_mapped)
+			{
+				partition->lpt_mutex.store(0);
+				return NULL;
+			}
+
+			++partition->lpt_acquires;
+			if (spins)
+				++partition->lpt_acquire_blocks;
+
+			return partition;
+		}
+
+		if (spins < PARTITION_SPINS)
+			continue;
+
+		// The holder might die keeping the partition, the mutex holder will recover it
+
+		if (holder != PID && !(spins % PARTITION_PROBE_INTERVAL) &&
+			!ISC_check_process_existence(holder))
+		{
+			return NULL;
+		}
+
+#ifdef HAVE_OBJECT_MAP
+		m_remapSync.endRead();
+#endif
+		Thread::yield();
+#ifdef HAVE_OBJECT_MAP
+		m_remapSync.beginRead(FB_FUNCTION);
+#endif
+	}
+}
+
+
+void LockManager::acquire_partitions()
+{
+/**************************************
+ *
+ *	a c q u i r e _ p a r t i t i o n s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Acquire all the lock table partitions on behalf of
+ *	the lock table mutex holder. A partition kept by a
+ *	dead process is taken over and its unfinished queue
+ *	operation is completed.
+ *
+ **************************************/
+	lhb* const header = m_sharedMemory->getHeader();
+
+	if (header->lhb_partitions < 2)
+		return;
+
+	for (USHORT number = 0; number < header->lhb_partitions; number++)
+	{
+		lpt* const partition = get_partition(number);
+
+		for (ULONG spins = 0; ; spins++)
+		{
+			int holder = 0;
+			if (partition->lpt_mutex.compare_exchange_strong(holder, PID))
+				break;
+
+			if (spins < PARTITION_SPINS)
+				continue;
+
+			if (holder != PID && !(spins % PARTITION_PROBE_INTERVAL) &&
+				!ISC_check_process_existence(holder))
+			{
+				if (partition->lpt_mutex.compare_exchange_strong(holder, PID))
+				{
+					post_history(his_active, header->lhb_active_owner, 0, (SRQ_PTR) 0, false);
+					recover_que(partition);
+					break;
+				}
+			}
+
+			Thread::yield();
+		}
+	}
+
+	m_partitionsOwned = true;
+}
+
+
 void LockManager::acquire_shmem(SRQ_PTR owner_offset)
 {
 /**************************************
@@ -1143,6 +1291,10 @@ void LockManager::acquire_shmem(SRQ_PTR owner_offset)
 	}
 #endif //USE_SHMEM_EXT
 
+	// The mutex holder owns the whole lock table
+
+	acquire_partitions();
+
 	// If we were able to acquire the MUTEX, but there is an prior owner marked
 	// in the the lock table, it means that someone died while owning
 	// the lock mutex.  In that event, lets see if there is any unfinished work
@@ -1151,25 +1303,7 @@ void LockManager::acquire_shmem(SRQ_PTR owner_offset)
 	if (prior_active > 0)
 	{
 		post_history(his_active, owner_offset, prior_active, (SRQ_PTR) 0, false);
-		shb* const recover = (shb*) SRQ_ABS_PTR(m_sharedMemory->getHeader()->lhb_secondary);
-		if (recover->shb_remove_node)
-		{
-			// There was a remove_que operation in progress when the prior_owner died
-			DEBUG_MSG(0, ("Got to the funky shb_remove_node code\n"));
-			remove_que((SRQ) SRQ_ABS_PTR(recover->shb_remove_node));
-		}
-		else if (recover->shb_insert_que && recover->shb_insert_prior)
-		{
-			// There was a insert_que operation in progress when the prior_owner died
-			DEBUG_MSG(0, ("Got to the funky shb_insert_que code\n"));
-
-			SRQ lock_srq = (SRQ) SRQ_ABS_PTR(recover->shb_insert_que);
-			lock_srq->srq_backward = recover->shb_insert_prior;
-			lock_srq = (SRQ) SRQ_ABS_PTR(recover->shb_insert_prior);
-			lock_srq->srq_forward = recover->shb_insert_que;
-			recover->shb_insert_que = 0;
-			recover->shb_insert_prior = 0;
-		}
+		recover_que(NULL);
 	}
 }
 
@@ -1273,7 +1407,7 @@ UCHAR* LockManager::alloc(USHORT size, CheckStatusWrapper* statusVector)
 }
 
 
-lbl* LockManager::alloc_lock(USHORT length, CheckStatusWrapper* statusVector)
+lbl* LockManager::alloc_lock(USHORT length, USHORT partition, CheckStatusWrapper* statusVector)
 {
 /**************************************
  *
@@ -1283,27 +1417,33 @@ lbl* LockManager::alloc_lock(USHORT length, CheckStatusWrapper* statusVector)
  *
  * Functional description
  *	Allocate a lock for a key of a given length.  Look first to see
- *	if a spare of the right size is sitting around.  If not, allocate
- *	one.
+ *	if a spare of the right size is sitting around in the given
+ *	partition or in the lock table.  If not, allocate one.
  *
  **************************************/
 	length = FB_ALIGN(length, 8);
 
 	ASSERT_ACQUIRED;
-	srq* lock_srq;
-	SRQ_LOOP(m_sharedMemory->getHeader()->lhb_free_locks, lock_srq)
+	srq* const free_locks[2] =
+		{&get_partition(partition)->lpt_free_locks, &m_sharedMemory->getHeader()->lhb_free_locks};
+
+	for (unsigned i = 0; i < FB_NELEM(free_locks); i++)
 	{
-		lbl* lock = (lbl*) ((UCHAR*) lock_srq - offsetof(lbl, lbl_lhb_hash));
-		// Here we use the "first fit" approach which costs us some memory,
-		// but works fast. The "best fit" one is proven to be unacceptably slow.
-		// Maybe there could be some compromise, e.g. limiting the number of "best fit"
-		// iterations before defaulting to a "first fit" match. Another idea could be
-		// to introduce yet another hash table for the free locks queue.
-		if (lock->lbl_size >= length)
-		{
-			remove_que(&lock->lbl_lhb_hash);
-			lock->lbl_type = type_lbl;
-			return lock;
+		srq* lock_srq;
+		SRQ_LOOP((*free_locks[i]), lock_srq)
+		{
+			lbl* lock = (lbl*) ((UCHAR*) lock_srq - offsetof(lbl, lbl_lhb_hash));
+			// Here we use the "first fit" approach which costs us some memory,
+			// but works fast. The "best fit" one is proven to be unacceptably slow.
+			// Maybe there could be some compromise, e.g. limiting the number of "best fit"
+			// iterations before defaulting to a "first fit" match. Another idea could be
+			// to introduce yet another hash table for the free locks queue.
+			if (lock->lbl_size >= length)
+			{
+				remove_que(&lock->lbl_lhb_hash);
+				lock->lbl_type = type_lbl;
+				return lock;
+			}
 		}
 	}
 
@@ -1323,6 +1463,35 @@ lbl* LockManager::alloc_lock(USHORT length, CheckStatusWrapper* statusVector)
 }
 
 
+lrq* LockManager::alloc_request(USHORT partition, CheckStatusWrapper* statusVector)
+{
+/**************************************
+ *
+ *	a l l o c _ r e q u e s t
+ *
+ **************************************
+ *
+ * Functional description
+ *	Allocate a lock request block. Reuse a spare one of the
+ *	given partition or of the lock table, if any.
+ *
+ **************************************/
+	ASSERT_ACQUIRED;
+	srq* free_requests = &get_partition(partition)->lpt_free_requests;
+
+	if (SRQ_EMPTY((*free_requests)))
+		free_requests = &m_sharedMemory->getHeader()->lhb_free_requests;
+
+	if (SRQ_EMPTY((*free_requests)))
+		return (lrq*) alloc(sizeof(lrq), statusVector);
+
+	lrq* const request = (lrq*) ((UCHAR*) SRQ_NEXT((*free_requests)) - offsetof(lrq, lrq_lbl_requests));
+	remove_que(&request->lrq_lbl_requests);
+
+	return request;
+}
+
+
 void LockManager::blocking_action(thread_db* tdbb, SRQ_PTR blocking_owner_offset)
 {
 /**************************************
@@ -1665,7 +1834,10 @@ SRQ_PTR LockManager::create_owner(CheckStatusWrapper* statusVector,
 	own* owner = 0;
 	if (SRQ_EMPTY(m_sharedMemory->getHeader()->lhb_free_owners))
 	{
-		if (!(owner = (own*) alloc(sizeof(own), statusVector)))
+		const USHORT size = sizeof(own) +
+			(m_sharedMemory->getHeader()->lhb_partitions - 1) * sizeof(owner->own_requests[0]);
+
+		if (!(owner = (own*) alloc(size, statusVector)))
 			return 0;
 	}
 	else
@@ -2027,132 +2199,566 @@ void LockManager::debug_delay(ULONG lineno)
 }
 #endif
 
-lbl* LockManager::find_lock(USHORT series,
-							const UCHAR* value,
-							USHORT length,
-							USHORT* slot)
+bool LockManager::fast_convert(CheckStatusWrapper* statusVector,
+							   SRQ_PTR request_offset,
+							   UCHAR type,
+							   SSHORT lck_wait,
+							   lock_ast_t ast_routine,
+							   void* ast_argument,
+							   bool* result)
 {
 /**************************************
  *
- *	f i n d _ l o c k
+ *	f a s t _ c o n v e r t
  *
  **************************************
  *
  * Functional description
- *	Find a lock block given a resource
- *	name. If it doesn't exist, the hash
- *	slot will be useful for enqueing a
- *	lock.
+ *	Try to perform a lock conversion holding just the partition
+ *	of the lock.  Return false if the conversion should be done
+ *	under the lock table mutex, i.e. if it could need to wait or
+ *	to grant pending requests.
  *
  **************************************/
+	PartitionGuard guard(this);
 
-	// See if the lock already exists
+	lpt* partition;
+	lrq* const request = get_fast_request(request_offset, guard, &partition);
+	if (!request)
+		return false;
 
-	const USHORT hash_slot = *slot =
-		(USHORT) InternalHash::hash(length, value, m_sharedMemory->getHeader()->lhb_hash_slots);
+	const own* const owner = (own*) SRQ_ABS_PTR(request->lrq_owner);
+	if (!owner->own_count)
+	{
+		*result = false;
+		return true;
+	}
 
-	ASSERT_ACQUIRED;
-	srq* const hash_header = &m_sharedMemory->getHeader()->lhb_hash[hash_slot];
+	lbl* const lock = (lbl*) SRQ_ABS_PTR(request->lrq_lock);
+	if (owner->own_waits || lock->lbl_pending_lrq_count)
+		return false;
 
-	for (srq* lock_srq = (SRQ) SRQ_ABS_PTR(hash_header->srq_forward);
-		 lock_srq != hash_header; lock_srq = (SRQ) SRQ_ABS_PTR(lock_srq->srq_forward))
+	// Compute the state of the lock without the request
+
+	--lock->lbl_counts[request->lrq_state];
+	const UCHAR temp = lock_state(lock);
+
+	if (!compatibility[type][temp])
 	{
-		lbl* lock = (lbl*) ((UCHAR*) lock_srq - offsetof(lbl, lbl_lhb_hash));
-		if (lock->lbl_series != series || lock->lbl_length != length)
-		{
-			continue;
-		}
+		++lock->lbl_counts[request->lrq_state];
 
-		if (!length || !memcmp(value, lock->lbl_key, length))
-			return lock;
+		if (lck_wait)
+			return false;
 	}
 
-	return NULL;
+	++partition->lpt_converts;
+	++partition->lpt_operations[lock->lbl_series < LCK_MAX_SERIES ? lock->lbl_series : 0];
+
+	post_history(his_convert, request->lrq_owner, request->lrq_lock, request_offset, true, partition);
+	request->lrq_flags &= ~LRQ_blocking_seen;
+
+	if (!compatibility[type][temp])
+	{
+		++partition->lpt_denies;
+		Arg::Gds(isc_lock_conflict).copyTo(statusVector);
+		*result = false;
+		return true;
+	}
+
+	request->lrq_requested = type;
+	request->lrq_ast_routine = ast_routine;
+	request->lrq_ast_argument = ast_argument;
+	grant(request, lock, partition);
+
+	*result = true;
+	return true;
 }
 
 
-lrq* LockManager::get_request(SRQ_PTR offset)
+bool LockManager::fast_dequeue(SRQ_PTR request_offset, bool* result)
 {
 /**************************************
  *
- *	g e t _ r e q u e s t
+ *	f a s t _ d e q u e u e
  *
  **************************************
  *
  * Functional description
- *	Locate and validate user supplied request offset.
+ *	Try to release a lock holding just its partition.  Return
+ *	false if the request should be released under the lock table
+ *	mutex, i.e. if it's blocking someone or somebody waits for
+ *	the lock.
  *
  **************************************/
-	TEXT s[BUFFER_TINY];
+	PartitionGuard guard(this);
 
-	lrq* request = (lrq*) SRQ_ABS_PTR(offset);
-	if (offset == -1 || request->lrq_type != type_lrq)
+	lpt* partition;
+	lrq* const request = get_fast_request(request_offset, guard, &partition);
+	if (!request)
+		return false;
+
+	const own* const owner = (own*) SRQ_ABS_PTR(request->lrq_owner);
+	if (!owner->own_count)
 	{
-		sprintf(s, "invalid lock id (%" SLONGFORMAT")", offset);
-		bug(NULL, s);
+		*result = false;
+		return true;
 	}
 
-	const lbl* lock = (lbl*) SRQ_ABS_PTR(request->lrq_lock);
-	if (lock->lbl_type != type_lbl)
+	const lbl* const lock = (lbl*) SRQ_ABS_PTR(request->lrq_lock);
+	if (lock->lbl_pending_lrq_count || (request->lrq_flags & (LRQ_blocking | LRQ_pending)) ||
+		!SRQ_EMPTY(lock->lbl_lhb_data))
 	{
-		sprintf(s, "invalid lock (%" SLONGFORMAT")", offset);
-		bug(NULL, s);
+		return false;
 	}
 
-	return request;
+	++partition->lpt_deqs;
+	++partition->lpt_operations[lock->lbl_series < LCK_MAX_SERIES ? lock->lbl_series : 0];
+
+	post_history(his_deq, request->lrq_owner, request->lrq_lock, request_offset, true, partition);
+	request->lrq_ast_routine = NULL;
+	release_request(request, partition);
+
+	*result = true;
+	return true;
 }
 
 
-void LockManager::grant(lrq* request, lbl* lock)
+bool LockManager::fast_enqueue(CheckStatusWrapper* statusVector,
+							   SRQ_PTR owner_offset,
+							   USHORT series,
+							   const UCHAR* value,
+							   USHORT length,
+							   UCHAR type,
+							   lock_ast_t ast_routine,
+							   void* ast_argument,
+							   SSHORT lck_wait,
+							   SRQ_PTR* request_offset)
 {
 /**************************************
  *
- *	g r a n t
+ *	f a s t _ e n q u e u e
  *
  **************************************
  *
  * Functional description
- *	Grant a lock request.  If the lock is a conversion, assume the caller
- *	has already decremented the former lock type count in the lock block.
+ *	Try to enque on a lock holding just the partition of its hash
+ *	slot.  Return false if the request should be processed under
+ *	the lock table mutex, i.e. if it could need to wait, to allocate
+ *	memory or to be queued behind pending requests.
  *
  **************************************/
+	PartitionGuard guard(this);
 
-	// Request must be for THIS lock
-	CHECK(SRQ_REL_PTR(lock) == request->lrq_lock);
+	if (m_sharedMemory->getHeader()->lhb_partitions < 2)
+		return false;
 
-	post_history(his_grant, request->lrq_owner, request->lrq_lock, SRQ_REL_PTR(request), true);
+	const USHORT hash_slot = (USHORT)
+		InternalHash::hash(length, value, m_sharedMemory->getHeader()->lhb_hash_slots);
+	const USHORT number = hash_slot % m_sharedMemory->getHeader()->lhb_partitions;
 
-	++lock->lbl_counts[request->lrq_requested];
-	request->lrq_state = request->lrq_requested;
-	if (request->lrq_data)
+	lpt* const partition = guard.enter(number);
+	if (!partition)
+		return false;
+
+	own* const owner = (own*) SRQ_ABS_PTR(owner_offset);
+	if (!owner->own_count)
 	{
-		remove_que(&lock->lbl_lhb_data);
-		if ( (lock->lbl_data = request->lrq_data) )
-			insert_data_que(lock);
-		request->lrq_data = 0;
+		*request_offset = 0;
+		return true;
 	}
 
-	lock->lbl_state = lock_state(lock);
+	if (owner->own_waits)
+		return false;
 
-	if (request->lrq_flags & LRQ_pending)
+	// See if the lock already exists. If so, there should be nobody waiting
+	// for it and the request could be either granted or denied at once.
+
+	USHORT junk;
+	lbl* lock = find_lock(series, value, length, &junk);
+
+	if (lock)
 	{
-		remove_que(&request->lrq_own_pending);
-		request->lrq_flags &= ~LRQ_pending;
-		lock->lbl_pending_lrq_count--;
+		if (lock->lbl_pending_lrq_count)
+			return false;
+
+		if (!compatibility[type][lock->lbl_state])
+		{
+			if (lck_wait)
+				return false;
+
+			++partition->lpt_enqs;
+			++partition->lpt_operations[series < LCK_MAX_SERIES ? series : 0];
+			++partition->lpt_denies;
+
+			post_history(his_deny, owner_offset, SRQ_REL_PTR(lock), (SRQ_PTR) 0, true, partition);
+
+			Arg::Gds(isc_lock_conflict).copyTo(statusVector);
+			*request_offset = 0;
+			return true;
+		}
 	}
 
-	post_wakeup((own*) SRQ_ABS_PTR(request->lrq_owner));
-}
+	// Only spare blocks of the partition may be reused, allocation needs the mutex
 
+	if (SRQ_EMPTY(partition->lpt_free_requests))
+		return false;
 
-bool LockManager::grant_or_que(thread_db* tdbb, lrq* request, lbl* lock, SSHORT lck_wait)
-{
-/**************************************
- *
- *	g r a n t _ o r _ q u e
- *
- **************************************
- *
+	lbl* spare_lock = NULL;
+
+	if (!lock)
+	{
+		const USHORT size = FB_ALIGN(length, 8);
+
+		srq* lock_srq;
+		SRQ_LOOP(partition->lpt_free_locks, lock_srq)
+		{
+			lbl* const candidate = (lbl*) ((UCHAR*) lock_srq - offsetof(lbl, lbl_lhb_hash));
+			if (candidate->lbl_size >= size)
+			{
+				spare_lock = candidate;
+				break;
+			}
+		}
+
+		if (!spare_lock)
+			return false;
+	}
+
+	++partition->lpt_enqs;
+	++partition->lpt_operations[series < LCK_MAX_SERIES ? series : 0];
+
+	lrq* const request = (lrq*) ((UCHAR*) SRQ_NEXT(partition->lpt_free_requests) -
+		offsetof(lrq, lrq_lbl_requests));
+	remove_que(&request->lrq_lbl_requests, partition);
+
+	post_history(his_enq, owner_offset, (SRQ_PTR) 0, SRQ_REL_PTR(request), true, partition);
+
+	request->lrq_type = type_lrq;
+	request->lrq_flags = 0;
+	request->lrq_requested = type;
+	request->lrq_state = LCK_none;
+	request->lrq_data = 0;
+	request->lrq_owner = owner_offset;
+	request->lrq_ast_routine = ast_routine;
+	request->lrq_ast_argument = ast_argument;
+	insert_tail(&owner->own_requests[number], &request->lrq_own_requests, partition);
+	SRQ_INIT(request->lrq_own_blocks);
+	SRQ_INIT(request->lrq_own_pending);
+
+	if (!lock)
+	{
+		lock = spare_lock;
+		remove_que(&lock->lbl_lhb_hash, partition);
+		lock->lbl_type = type_lbl;
+		lock->lbl_state = type;
+		fb_assert(series <= MAX_UCHAR);
+		lock->lbl_series = (UCHAR) series;
+		lock->lbl_partition = number;
+		lock->lbl_data = 0;
+		SRQ_INIT(lock->lbl_lhb_data);
+		lock->lbl_flags = 0;
+		lock->lbl_pending_lrq_count = 0;
+		memset(lock->lbl_counts, 0, sizeof(lock->lbl_counts));
+		lock->lbl_length = length;
+		memcpy(lock->lbl_key, value, length);
+
+		SRQ_INIT(lock->lbl_requests);
+		insert_tail(&m_sharedMemory->getHeader()->lhb_hash[hash_slot], &lock->lbl_lhb_hash, partition);
+	}
+
+	insert_tail(&lock->lbl_requests, &request->lrq_lbl_requests, partition);
+	request->lrq_lock = SRQ_REL_PTR(lock);
+	grant(request, lock, partition);
+
+	*request_offset = SRQ_REL_PTR(request);
+	return true;
+}
+
+
+bool LockManager::fast_read_data(SRQ_PTR request_offset, LOCK_DATA_T* data)
+{
+/**************************************
+ *
+ *	f a s t _ r e a d _ d a t a
+ *
+ **************************************
+ *
+ * Functional description
+ *	Try to read data associated with a lock holding
+ *	just its partition.
+ *
+ **************************************/
+	PartitionGuard guard(this);
+
+	lpt* partition;
+	const lrq* const request = get_fast_request(request_offset, guard, &partition);
+	if (!request)
+		return false;
+
+	const lbl* const lock = (lbl*) SRQ_ABS_PTR(request->lrq_lock);
+
+	++partition->lpt_read_data;
+	++partition->lpt_operations[lock->lbl_series < LCK_MAX_SERIES ? lock->lbl_series : 0];
+
+	*data = lock->lbl_data;
+	return true;
+}
+
+
+bool LockManager::fast_read_data2(USHORT series, const UCHAR* value, USHORT length, LOCK_DATA_T* data)
+{
+/**************************************
+ *
+ *	f a s t _ r e a d _ d a t a 2
+ *
+ **************************************
+ *
+ * Functional description
+ *	Try to read data associated with a transient
+ *	lock holding just the partition of its hash slot.
+ *
+ **************************************/
+	PartitionGuard guard(this);
+
+	if (m_sharedMemory->getHeader()->lhb_partitions < 2)
+		return false;
+
+	const USHORT number = (USHORT)
+		(InternalHash::hash(length, value, m_sharedMemory->getHeader()->lhb_hash_slots) %
+		 m_sharedMemory->getHeader()->lhb_partitions);
+
+	lpt* const partition = guard.enter(number);
+	if (!partition)
+		return false;
+
+	++partition->lpt_read_data;
+	++partition->lpt_operations[series < LCK_MAX_SERIES ? series : 0];
+
+	USHORT junk;
+	const lbl* const lock = find_lock(series, value, length, &junk);
+
+	*data = lock ? lock->lbl_data : 0;
+	return true;
+}
+
+
+bool LockManager::fast_write_data(SRQ_PTR request_offset, LOCK_DATA_T data)
+{
+/**************************************
+ *
+ *	f a s t _ w r i t e _ d a t a
+ *
+ **************************************
+ *
+ * Functional description
+ *	Try to write data into a lock holding just its
+ *	partition.  Data of the locks maintained in the
+ *	series data queues is written under the mutex.
+ *
+ **************************************/
+	PartitionGuard guard(this);
+
+	lpt* partition;
+	const lrq* const request = get_fast_request(request_offset, guard, &partition);
+	if (!request)
+		return false;
+
+	lbl* const lock = (lbl*) SRQ_ABS_PTR(request->lrq_lock);
+	if (lock->lbl_series < LCK_MAX_SERIES)
+		return false;
+
+	++partition->lpt_write_data;
+	++partition->lpt_operations[0];
+
+	lock->lbl_data = data;
+	return true;
+}
+
+
+lbl* LockManager::find_lock(USHORT series,
+							const UCHAR* value,
+							USHORT length,
+							USHORT* slot)
+{
+/**************************************
+ *
+ *	f i n d _ l o c k
+ *
+ **************************************
+ *
+ * Functional description
+ *	Find a lock block given a resource
+ *	name. If it doesn't exist, the hash
+ *	slot will be useful for enqueing a
+ *	lock.
+ *
+ **************************************/
+
+	// See if the lock already exists
+
+	const USHORT hash_slot = *slot =
+		(USHORT) InternalHash::hash(length, value, m_sharedMemory->getHeader()->lhb_hash_slots);
+
+	srq* const hash_header = &m_sharedMemory->getHeader()->lhb_hash[hash_slot];
+
+	for (srq* lock_srq = (SRQ) SRQ_ABS_PTR(hash_header->srq_forward);
+		 lock_srq != hash_header; lock_srq = (SRQ) SRQ_ABS_PTR(lock_srq->srq_forward))
+	{
+		lbl* lock = (lbl*) ((UCHAR*) lock_srq - offsetof(lbl, lbl_lhb_hash));
+		if (lock->lbl_series != series || lock->lbl_length != length)
+		{
+			continue;
+		}
+
+		if (!length || !memcmp(value, lock->lbl_key, length))
+			return lock;
+	}
+
+	return NULL;
+}
+
+
+lrq* LockManager::get_fast_request(SRQ_PTR offset, PartitionGuard& guard, lpt** partition)
+{
+/**************************************
+ *
+ *	g e t _ f a s t _ r e q u e s t
+ *
+ **************************************
+ *
+ * Functional description
+ *	Locate user supplied request and acquire the partition
+ *	of its lock.  Return NULL if the request should be dealt
+ *	with under the lock table mutex, get_request() reports
+ *	invalid requests then.
+ *
+ **************************************/
+	if (m_sharedMemory->getHeader()->lhb_partitions < 2 || offset <= 0)
+		return NULL;
+
+	// The request belongs to the caller, thus neither it nor its lock
+	// can go away or move to another partition while we get there
+
+	const lrq* request = (lrq*) SRQ_ABS_PTR(offset);
+	if (request->lrq_type != type_lrq)
+		return NULL;
+
+	const lbl* const lock = (lbl*) SRQ_ABS_PTR(request->lrq_lock);
+	if (lock->lbl_type != type_lbl)
+		return NULL;
+
+	if (!(*partition = guard.enter(lock->lbl_partition)))
+		return NULL;
+
+	return (lrq*) SRQ_ABS_PTR(offset);
+}
+
+
+lpt* LockManager::get_partition(USHORT number)
+{
+/**************************************
+ *
+ *	g e t _ p a r t i t i o n
+ *
+ **************************************
+ *
+ * Functional description
+ *	Locate the lock table partition.
+ *
+ **************************************/
+	fb_assert(number < m_sharedMemory->getHeader()->lhb_partitions);
+
+	return (lpt*) SRQ_ABS_PTR(m_sharedMemory->getHeader()->lhb_partition + number * LPT_SIZE);
+}
+
+
+lrq* LockManager::get_request(SRQ_PTR offset)
+{
+/**************************************
+ *
+ *	g e t _ r e q u e s t
+ *
+ **************************************
+ *
+ * Functional description
+ *	Locate and validate user supplied request offset.
+ *
+ **************************************/
+	TEXT s[BUFFER_TINY];
+
+	lrq* request = (lrq*) SRQ_ABS_PTR(offset);
+	if (offset == -1 || request->lrq_type != type_lrq)
+	{
+		sprintf(s, "invalid lock id (%" SLONGFORMAT")", offset);
+		bug(NULL, s);
+	}
+
+	const lbl* lock = (lbl*) SRQ_ABS_PTR(request->lrq_lock);
+	if (lock->lbl_type != type_lbl)
+	{
+		sprintf(s, "invalid lock (%" SLONGFORMAT")", offset);
+		bug(NULL, s);
+	}
+
+	return request;
+}
+
+
+void LockManager::grant(lrq* request, lbl* lock, lpt* partition)
+{
+/**************************************
+ *
+ *	g r a n t
+ *
+ **************************************
+ *
+ * Functional description
+ *	Grant a lock request.  If the lock is a conversion, assume the caller
+ *	has already decremented the former lock type count in the lock block.
+ *	If the partition is given, the caller holds just it, there must be
+ *	no lock data to maintain and no pending request to grant then.
+ *
+ **************************************/
+
+	// Request must be for THIS lock
+	CHECK(SRQ_REL_PTR(lock) == request->lrq_lock);
+
+	post_history(his_grant, request->lrq_owner, request->lrq_lock, SRQ_REL_PTR(request), true,
+				 partition);
+
+	fb_assert(!partition || !(request->lrq_data || (request->lrq_flags & LRQ_pending)));
+
+	++lock->lbl_counts[request->lrq_requested];
+	request->lrq_state = request->lrq_requested;
+	if (request->lrq_data)
+	{
+		remove_que(&lock->lbl_lhb_data);
+		if ( (lock->lbl_data = request->lrq_data) )
+			insert_data_que(lock);
+		request->lrq_data = 0;
+	}
+
+	lock->lbl_state = lock_state(lock);
+
+	if (request->lrq_flags & LRQ_pending)
+	{
+		remove_que(&request->lrq_own_pending);
+		request->lrq_flags &= ~LRQ_pending;
+		lock->lbl_pending_lrq_count--;
+	}
+
+	post_wakeup((own*) SRQ_ABS_PTR(request->lrq_owner));
+}
+
+
+bool LockManager::grant_or_que(thread_db* tdbb, lrq* request, lbl* lock, SSHORT lck_wait)
+{
+/**************************************
+ *
+ *	g r a n t _ o r _ q u e
+ *
+ **************************************
+ *
  * Functional description
  *	There is a request against an existing lock.  If the request
  *	is compatible with the lock, grant it.  Otherwise lock_srq it.
@@ -2225,7 +2831,8 @@ bool LockManager::init_owner_block(CheckStatusWrapper* statusVector, own* owner,
 	owner->own_thread_id = 0;
 	SRQ_INIT(owner->own_lhb_owners);
 	SRQ_INIT(owner->own_prc_owners);
-	SRQ_INIT(owner->own_requests);
+	for (USHORT i = 0; i < m_sharedMemory->getHeader()->lhb_partitions; i++)
+		SRQ_INIT(owner->own_requests[i]);
 	SRQ_INIT(owner->own_blocks);
 	SRQ_INIT(owner->own_pending);
 	owner->own_acquire_time = 0;
@@ -2350,6 +2957,49 @@ bool LockManager::initialize(SharedMemoryBase* sm, bool initializeMemory)
 		history->his_next = (j == 0) ? hdr->lhb_history : secondary_header->shb_history;
 	}
 
+	// Allocate the lock table partitions, each one with its own history
+
+#ifdef USE_SHMEM_EXT
+	hdr->lhb_partitions = 1;
+#else
+	hdr->lhb_partitions = (USHORT) m_config->getLockHashPartitions();
+#endif
+
+	const USHORT partitions_size = (USHORT) (hdr->lhb_partitions * LPT_SIZE + LPT_ALIGNMENT);
+	UCHAR* const partitions = alloc(partitions_size, NULL);
+	if (!partitions)
+	{
+		fb_utils::logAndDie("Fatal lock manager error: lock manager out of room");
+	}
+
+	memset(partitions, 0, partitions_size);
+	hdr->lhb_partition = FB_ALIGN(SRQ_REL_PTR(partitions), LPT_ALIGNMENT);
+
+	for (USHORT number = 0; number < hdr->lhb_partitions; number++)
+	{
+		lpt* const partition = get_partition(number);
+		partition->lpt_mutex.store(0);
+		partition->lpt_shb.shb_type = type_shb;
+		SRQ_INIT(partition->lpt_free_locks);
+		SRQ_INIT(partition->lpt_free_requests);
+
+		SRQ_PTR* prior = &partition->lpt_shb.shb_history;
+
+		for (i = 0; i < PARTITION_HISTORY_BLOCKS; i++)
+		{
+			if (!(history = (his*) alloc(sizeof(his), NULL)))
+			{
+				fb_utils::logAndDie("Fatal lock manager error: lock manager out of room");
+			}
+			*prior = SRQ_REL_PTR(history);
+			history->his_type = type_his;
+			history->his_operation = 0;
+			prior = &history->his_next;
+		}
+
+		history->his_next = partition->lpt_shb.shb_history;
+	}
+
 	// Done initializing, unmark owner information
 	hdr->lhb_active_owner = 0;
 
@@ -2391,7 +3041,7 @@ void LockManager::insert_data_que(lbl* lock)
 }
 
 
-void LockManager::insert_tail(SRQ lock_srq, SRQ node)
+void LockManager::insert_tail(SRQ lock_srq, SRQ node, lpt* partition)
 {
 /**************************************
  *
@@ -2411,9 +3061,18 @@ void LockManager::insert_tail(SRQ lock_srq, SRQ node)
  *	eg: it will put the queue back to the state
  *	prior to the insertion being started.
  *
+ *	If the partition is given, the caller holds just it
+ *	and the recovery data is kept in the partition.
+ *
  **************************************/
-	ASSERT_ACQUIRED;
-	shb* const recover = (shb*) SRQ_ABS_PTR(m_sharedMemory->getHeader()->lhb_secondary);
+	shb* recover;
+	if (partition)
+		recover = &partition->lpt_shb;
+	else
+	{
+		ASSERT_ACQUIRED;
+		recover = (shb*) SRQ_ABS_PTR(m_sharedMemory->getHeader()->lhb_secondary);
+	}
 	DEBUG_DELAY;
 	recover->shb_insert_que = SRQ_REL_PTR(lock_srq);
 	DEBUG_DELAY;
@@ -2677,7 +3336,8 @@ void LockManager::post_history(USHORT operation,
 							   SRQ_PTR process,
 							   SRQ_PTR lock,
 							   SRQ_PTR request,
-							   bool old_version)
+							   bool old_version,
+							   lpt* partition)
 {
 /**************************************
  *
@@ -2686,12 +3346,18 @@ void LockManager::post_history(USHORT operation,
  **************************************
  *
  * Functional description
- *	Post a history item.
+ *	Post a history item. Operations done holding
+ *	just a partition go to the partition history.
  *
  **************************************/
 	his* history;
 
-	if (old_version)
+	if (partition)
+	{
+		history = (his*) SRQ_ABS_PTR(partition->lpt_shb.shb_history);
+		partition->lpt_shb.shb_history = history->his_next;
+	}
+	else if (old_version)
 	{
 		history = (his*) SRQ_ABS_PTR(m_sharedMemory->getHeader()->lhb_history);
 		ASSERT_ACQUIRED;
@@ -2868,10 +3534,13 @@ void LockManager::purge_owner(SRQ_PTR purging_owner_offset, own* owner)
 	// Release any locks that are active
 
 	SRQ lock_srq;
-	while ((lock_srq = SRQ_NEXT(owner->own_requests)) != &owner->own_requests)
+	for (USHORT i = 0; i < m_sharedMemory->getHeader()->lhb_partitions; i++)
 	{
-		lrq* request = (lrq*) ((UCHAR*) lock_srq - offsetof(lrq, lrq_own_requests));
-		release_request(request);
+		while ((lock_srq = SRQ_NEXT(owner->own_requests[i])) != &owner->own_requests[i])
+		{
+			lrq* request = (lrq*) ((UCHAR*) lock_srq - offsetof(lrq, lrq_own_requests));
+			release_request(request);
+		}
 	}
 
 	// Release any repost requests left dangling on blocking queue
@@ -2931,6 +3600,43 @@ void LockManager::purge_process(prc* process)
 }
 
 
+void LockManager::recover_que(lpt* partition)
+{
+/**************************************
+ *
+ *	r e c o v e r _ q u e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Finish the queue operation interrupted by the death of
+ *	the lock table mutex holder or of the partition holder.
+ *
+ **************************************/
+	shb* const recover = partition ? &partition->lpt_shb :
+		(shb*) SRQ_ABS_PTR(m_sharedMemory->getHeader()->lhb_secondary);
+
+	if (recover->shb_remove_node)
+	{
+		// There was a remove_que operation in progress when the prior_owner died
+		DEBUG_MSG(0, ("Got to the funky shb_remove_node code\n"));
+		remove_que((SRQ) SRQ_ABS_PTR(recover->shb_remove_node), partition);
+	}
+	else if (recover->shb_insert_que && recover->shb_insert_prior)
+	{
+		// There was a insert_que operation in progress when the prior_owner died
+		DEBUG_MSG(0, ("Got to the funky shb_insert_que code\n"));
+
+		SRQ lock_srq = (SRQ) SRQ_ABS_PTR(recover->shb_insert_que);
+		lock_srq->srq_backward = recover->shb_insert_prior;
+		lock_srq = (SRQ) SRQ_ABS_PTR(recover->shb_insert_prior);
+		lock_srq->srq_forward = recover->shb_insert_que;
+		recover->shb_insert_que = 0;
+		recover->shb_insert_prior = 0;
+	}
+}
+
+
 void LockManager::remap_local_owners()
 {
 /**************************************
@@ -2969,7 +3675,7 @@ void LockManager::remap_local_owners()
 }
 
 
-void LockManager::remove_que(SRQ node)
+void LockManager::remove_que(SRQ node, lpt* partition)
 {
 /**************************************
  *
@@ -2991,9 +3697,18 @@ void LockManager::remove_que(SRQ node)
  *	nodes may have changed prior to the crash, we need to redo the
  *	work only based on what is in <node>.
  *
+ *	If the partition is given, the caller holds just it
+ *	and the recovery data is kept in the partition.
+ *
  **************************************/
-	ASSERT_ACQUIRED;
-	shb* recover = (shb*) SRQ_ABS_PTR(m_sharedMemory->getHeader()->lhb_secondary);
+	shb* recover;
+	if (partition)
+		recover = &partition->lpt_shb;
+	else
+	{
+		ASSERT_ACQUIRED;
+		recover = (shb*) SRQ_ABS_PTR(m_sharedMemory->getHeader()->lhb_secondary);
+	}
 	DEBUG_DELAY;
 	recover->shb_remove_node = SRQ_REL_PTR(node);
 	DEBUG_DELAY;
@@ -3033,6 +3748,46 @@ void LockManager::remove_que(SRQ node)
 }
 
 
+void LockManager::release_partition(lpt* partition)
+{
+/**************************************
+ *
+ *	r e l e a s e _ p a r t i t i o n
+ *
+ **************************************
+ *
+ * Functional description
+ *	Release the spinlock of a lock table partition.
+ *
+ **************************************/
+	fb_assert(partition->lpt_mutex.load() == PID);
+	partition->lpt_mutex.store(0);
+}
+
+
+void LockManager::release_partitions()
+{
+/**************************************
+ *
+ *	r e l e a s e _ p a r t i t i o n s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Release all the lock table partitions owned
+ *	by the lock table mutex holder.
+ *
+ **************************************/
+	if (!m_partitionsOwned)
+		return;
+
+	m_partitionsOwned = false;
+
+	for (USHORT number = 0; number < m_sharedMemory->getHeader()->lhb_partitions; number++)
+		release_partition(get_partition(number));
+}
+
+
 void LockManager::release_shmem(SRQ_PTR owner_offset)
 {
 /**************************************
@@ -3065,6 +3820,8 @@ void LockManager::release_shmem(SRQ_PTR owner_offset)
 
 	DEBUG_DELAY;
 
+	release_partitions();
+
 	m_sharedMemory->getHeader()->lhb_active_owner = 0;
 
 	m_sharedMemory->mutexUnlock();
@@ -3073,7 +3830,7 @@ void LockManager::release_shmem(SRQ_PTR owner_offset)
 }
 
 
-void LockManager::release_request(lrq* request)
+void LockManager::release_request(lrq* request, lpt* partition)
 {
 /**************************************
  *
@@ -3083,19 +3840,24 @@ void LockManager::release_request(lrq* request)
  *
  * Functional description
  *	Release a request.  This is called both by release lock
- *	and by the cleanup handler.
+ *	and by the cleanup handler.  The request and lock blocks
+ *	are kept as spares of the partition the lock belongs to.
+ *	If the partition is given, the caller holds just it, the
+ *	request must not be blocking or pending then.
  *
  **************************************/
-	ASSERT_ACQUIRED;
+	fb_assert(!partition || !(request->lrq_flags & (LRQ_blocking | LRQ_pending)));
+
+	lbl* const lock = (lbl*) SRQ_ABS_PTR(request->lrq_lock);
+	lpt* const spares = partition ? partition : get_partition(lock->lbl_partition);
 
 	// Start by disconnecting request from both lock and process
 
-	remove_que(&request->lrq_lbl_requests);
-	remove_que(&request->lrq_own_requests);
+	remove_que(&request->lrq_lbl_requests, partition);
+	remove_que(&request->lrq_own_requests, partition);
 
 	request->lrq_type = type_null;
-	insert_tail(&m_sharedMemory->getHeader()->lhb_free_requests, &request->lrq_lbl_requests);
-	lbl* const lock = (lbl*) SRQ_ABS_PTR(request->lrq_lock);
+	insert_tail(&spares->lpt_free_requests, &request->lrq_lbl_requests, partition);
 
 	// If the request is marked as blocking, clean it up
 
@@ -3123,11 +3885,11 @@ void LockManager::release_request(lrq* request)
 	{
 		CHECK(lock->lbl_pending_lrq_count == 0);
 
-		remove_que(&lock->lbl_lhb_hash);
-		remove_que(&lock->lbl_lhb_data);
+		remove_que(&lock->lbl_lhb_hash, partition);
+		remove_que(&lock->lbl_lhb_data, partition);
 		lock->lbl_type = type_null;
 
-		insert_tail(&m_sharedMemory->getHeader()->lhb_free_locks, &lock->lbl_lhb_hash);
+		insert_tail(&spares->lpt_free_locks, &lock->lbl_lhb_hash, partition);
 		return;
 	}
 
@@ -3312,6 +4074,34 @@ void LockManager::validate_lhb(const lhb* alhb)
 		validate_request(SRQ_REL_PTR(request), EXPECT_freed, RECURSE_not);
 	}
 
+	for (USHORT i = 0; i < alhb->lhb_partitions; i++)
+	{
+		const lpt* const partition = get_partition(i);
+
+		CHECK(partition->lpt_shb.shb_type == type_shb);
+		validate_history(partition->lpt_shb.shb_history);
+
+		SRQ_LOOP(partition->lpt_free_locks, lock_srq)
+		{
+			// Validate that the next backpointer points back to us
+			const srq* const que_next = SRQ_NEXT((*lock_srq));
+			CHECK(que_next->srq_backward == SRQ_REL_PTR(lock_srq));
+
+			const lbl* const lock = (lbl*) ((UCHAR*) lock_srq - offsetof(lbl, lbl_lhb_hash));
+			validate_lock(SRQ_REL_PTR(lock), EXPECT_freed, (SRQ_PTR) 0);
+		}
+
+		SRQ_LOOP(partition->lpt_free_requests, lock_srq)
+		{
+			// Validate that the next backpointer points back to us
+			const srq* const que_next = SRQ_NEXT((*lock_srq));
+			CHECK(que_next->srq_backward == SRQ_REL_PTR(lock_srq));
+
+			const lrq* const request = (lrq*) ((UCHAR*) lock_srq - offsetof(lrq, lrq_lbl_requests));
+			validate_request(SRQ_REL_PTR(request), EXPECT_freed, RECURSE_not);
+		}
+	}
+
 	CHECK(alhb->lhb_used <= alhb->lhb_length);
 
 	validate_history(alhb->lhb_history);
@@ -3448,84 +4238,88 @@ void LockManager::validate_owner(const SRQ_PTR own_ptr, USHORT freed)
 	CHECK(!(owner->own_flags & ~(OWN_scanned | OWN_wakeup | OWN_signaled)));
 
 	const srq* lock_srq;
-	SRQ_LOOP(owner->own_requests, lock_srq)
+
+	for (USHORT i = 0; i < m_sharedMemory->getHeader()->lhb_partitions; i++)
 	{
-		// Validate that the next backpointer points back to us
-		const srq* const que_next = SRQ_NEXT((*lock_srq));
-		CHECK(que_next->srq_backward == SRQ_REL_PTR(lock_srq));
+		SRQ_LOOP(owner->own_requests[i], lock_srq)
+		{
+			// Validate that the next backpointer points back to us
+			const srq* const que_next = SRQ_NEXT((*lock_srq));
+			CHECK(que_next->srq_backward == SRQ_REL_PTR(lock_srq));
 
-		CHECK(freed == EXPECT_inuse);	// should not be in loop for freed owner
+			CHECK(freed == EXPECT_inuse);	// should not be in loop for freed owner
 
-		const lrq* const request = (lrq*) ((UCHAR*) lock_srq - offsetof(lrq, lrq_own_requests));
-		validate_request(SRQ_REL_PTR(request), EXPECT_inuse, RECURSE_not);
-		CHECK(request->lrq_owner == own_ptr);
+			const lrq* const request = (lrq*) ((UCHAR*) lock_srq - offsetof(lrq, lrq_own_requests));
+			validate_request(SRQ_REL_PTR(request), EXPECT_inuse, RECURSE_not);
+			CHECK(request->lrq_owner == own_ptr);
 
-		// Make sure that request marked as blocking also exists in the blocking list
+			// Make sure that request marked as blocking also exists in the blocking list
 
-		if (request->lrq_flags & LRQ_blocking)
-		{
-			ULONG found = 0;
-			const srq* que2;
-			SRQ_LOOP(owner->own_blocks, que2)
+			if (request->lrq_flags & LRQ_blocking)
 			{
-				// Validate that the next backpointer points back to us
-				const srq* const que2_next = SRQ_NEXT((*que2));
-				CHECK(que2_next->srq_backward == SRQ_REL_PTR(que2));
+				ULONG found = 0;
+				const srq* que2;
+				SRQ_LOOP(owner->own_blocks, que2)
+				{
+					// Validate that the next backpointer points back to us
+					const srq* const que2_next = SRQ_NEXT((*que2));
+					CHECK(que2_next->srq_backward == SRQ_REL_PTR(que2));
 
-				const lrq* const request2 = (lrq*) ((UCHAR*) que2 - offsetof(lrq, lrq_own_blocks));
-				CHECK(request2->lrq_owner == own_ptr);
+					const lrq* const request2 = (lrq*) ((UCHAR*) que2 - offsetof(lrq, lrq_own_blocks));
+					CHECK(request2->lrq_owner == own_ptr);
 
-				if (SRQ_REL_PTR(request2) == SRQ_REL_PTR(request))
-					found++;
+					if (SRQ_REL_PTR(request2) == SRQ_REL_PTR(request))
+						found++;
 
-				CHECK(found <= 1);	// watch for loops in queue
+					CHECK(found <= 1);	// watch for loops in queue
+				}
+				CHECK(found == 1);	// request marked as blocking must be in blocking queue
 			}
-			CHECK(found == 1);	// request marked as blocking must be in blocking queue
-		}
 
-		// Make sure that request marked as pending also exists in the pending list,
-		// as well as in the queue for the lock
+			// Make sure that request marked as pending also exists in the pending list,
+			// as well as in the queue for the lock
 
-		if (request->lrq_flags & LRQ_pending)
-		{
-			ULONG found = 0;
-			const srq* que2;
-			SRQ_LOOP(owner->own_pending, que2)
+			if (request->lrq_flags & LRQ_pending)
 			{
-				// Validate that the next backpointer points back to us
-				const srq* const que2_next = SRQ_NEXT((*que2));
-				CHECK(que2_next->srq_backward == SRQ_REL_PTR(que2));
-
-				const lrq* const request2 = (lrq*) ((UCHAR*) que2 - offsetof(lrq, lrq_own_pending));
-				CHECK(request2->lrq_owner == own_ptr);
+				ULONG found = 0;
+				const srq* que2;
+				SRQ_LOOP(owner->own_pending, que2)
+				{
+					// Validate that the next backpointer points back to us
+					const srq* const que2_next = SRQ_NEXT((*que2));
+					CHECK(que2_next->srq_backward == SRQ_REL_PTR(que2));
 
-				if (SRQ_REL_PTR(request2) == SRQ_REL_PTR(request))
-					found++;
+					const lrq* const request2 = (lrq*) ((UCHAR*) que2 - offsetof(lrq, lrq_own_pending));
+					CHECK(request2->lrq_owner == own_ptr);
 
-				CHECK(found <= 1);	// watch for loops in queue
-			}
-			CHECK(found == 1);	// request marked as pending must be in pending queue
+					if (SRQ_REL_PTR(request2) == SRQ_REL_PTR(request))
+						found++;
 
-			// Make sure the pending request is on the list of requests for the lock
+					CHECK(found <= 1);	// watch for loops in queue
+				}
+				CHECK(found == 1);	// request marked as pending must be in pending queue
 
-			const lbl* const lock = (lbl*) SRQ_ABS_PTR(request->lrq_lock);
+				// Make sure the pending request is on the list of requests for the lock
 
-			bool found_pending = false;
-			const srq* que_of_lbl_requests;
-			SRQ_LOOP(lock->lbl_requests, que_of_lbl_requests)
-			{
-				const lrq* const pending =
-					(lrq*) ((UCHAR*) que_of_lbl_requests - offsetof(lrq, lrq_lbl_requests));
+				const lbl* const lock = (lbl*) SRQ_ABS_PTR(request->lrq_lock);
 
-				if (SRQ_REL_PTR(pending) == SRQ_REL_PTR(request))
+				bool found_pending = false;
+				const srq* que_of_lbl_requests;
+				SRQ_LOOP(lock->lbl_requests, que_of_lbl_requests)
 				{
-					found_pending = true;
-					break;
+					const lrq* const pending =
+						(lrq*) ((UCHAR*) que_of_lbl_requests - offsetof(lrq, lrq_lbl_requests));
+
+					if (SRQ_REL_PTR(pending) == SRQ_REL_PTR(request))
+					{
+						found_pending = true;
+						break;
+					}
 				}
-			}
 
-			// pending request must exist in the lock's request queue
-			CHECK(found_pending);
+				// pending request must exist in the lock's request queue
+				CHECK(found_pending);
+			}
 		}
 	}
 
@@ -3553,9 +4347,11 @@ void LockManager::validate_owner(const SRQ_PTR own_ptr, USHORT freed)
 
 		// Make sure that each block also exists in the request list
 
+		const lbl* const lock = (lbl*) SRQ_ABS_PTR(request->lrq_lock);
+
 		ULONG found = 0;
 		const srq* que2;
-		SRQ_LOOP(owner->own_requests, que2)
+		SRQ_LOOP(owner->own_requests[lock->lbl_partition], que2)
 		{
 			// Validate that the next backpointer points back to us
 			const srq* const que2_next = SRQ_NEXT((*que2));
@@ -3595,9 +4391,11 @@ void LockManager::validate_owner(const SRQ_PTR own_ptr, USHORT freed)
 
 		// Make sure that each pending request also exists in the request list
 
+		const lbl* const lock = (lbl*) SRQ_ABS_PTR(request->lrq_lock);
+
 		ULONG found = 0;
 		const srq* que2;
-		SRQ_LOOP(owner->own_requests, que2)
+		SRQ_LOOP(owner->own_requests[lock->lbl_partition], que2)
 		{
 			// Validate that the next backpointer points back to us
 			const srq* const que2_next = SRQ_NEXT((*que2));
@@ -31,6 +31,7 @@
 
 #include <stdio.h>
 #include <sys/types.h>
+#include <atomic>
 
 #include "../common/classes/semaphore.h"
 #include "../common/classes/rwlock.h"
@@ -93,7 +94,7 @@ const UCHAR type_lpr	= 7;
 
 // Version number of the lock table.
 // Must be increased every time the shmem layout is changed.
-const USHORT BASE_LHB_VERSION = 18;
+const USHORT BASE_LHB_VERSION = 19;
 
 #if SIZEOF_VOID_P == 8
 const USHORT PLATFORM_LHB_VERSION = 128;	// 64-bit target
@@ -119,6 +120,8 @@ struct lhb : public Firebird::MemoryHeader
 	ULONG lhb_length;				// Size of lock table
 	ULONG lhb_used;					// Bytes of lock table in use
 	USHORT lhb_hash_slots;			// Number of hash slots allocated
+	USHORT lhb_partitions;			// Number of lock table partitions
+	SRQ_PTR lhb_partition;			// First partition block
 
 	SRQ_PTR lhb_history;
 	ULONG lhb_scan_interval;		// Deadlock scan interval (secs)
@@ -158,6 +161,33 @@ struct shb
 	SRQ_PTR shb_insert_prior;		// Prior of inserting queue
 };
 
+// Lock table partition -- hash slots are spread among the partitions. Operations
+// touching a single lock and never waiting (compatible enqueue, dequeue without
+// pending requests, etc) are done holding just the partition spinlock, all the
+// rest is done holding the lock table mutex which implies owning all the partitions.
+
+struct lpt
+{
+	std::atomic<int> lpt_mutex;		// Process ID of the holder, zero if free
+	shb lpt_shb;					// Queue recovery data and history of the partition
+	srq lpt_free_locks;				// Free lock blocks
+	srq lpt_free_requests;			// Free lock requests
+	FB_UINT64 lpt_acquires;
+	FB_UINT64 lpt_acquire_blocks;
+	FB_UINT64 lpt_enqs;
+	FB_UINT64 lpt_converts;
+	FB_UINT64 lpt_deqs;
+	FB_UINT64 lpt_read_data;
+	FB_UINT64 lpt_write_data;
+	FB_UINT64 lpt_denies;
+	FB_UINT64 lpt_operations[LCK_MAX_SERIES];
+};
+
+// Partitions are laid out one after another, aligned to not share cache lines
+
+const ULONG LPT_ALIGNMENT	= 128;
+const ULONG LPT_SIZE		= (sizeof(lpt) + LPT_ALIGNMENT - 1) & ~(LPT_ALIGNMENT - 1);
+
 // Lock block
 
 struct lbl
@@ -172,6 +202,7 @@ struct lbl
 	LOCK_DATA_T lbl_data;			// User data
 	UCHAR lbl_series;				// Lock series
 	UCHAR lbl_flags;				// Unused. Misc flags
+	USHORT lbl_partition;			// Partition owning the hash slot of the lock
 	USHORT lbl_pending_lrq_count;	// count of lbl_requests with LRQ_pending
 	USHORT lbl_counts[LCK_max];		// Counts of granted locks
 	UCHAR lbl_key[1];				// Key value
@@ -229,7 +260,6 @@ struct own
 	LOCK_OWNER_T own_owner_id;		// Owner ID
 	srq own_lhb_owners;				// Owner que (global)
 	srq own_prc_owners;				// Owner que (process wide)
-	srq own_requests;				// Lock requests granted
 	srq own_blocks;					// Lock requests blocking
 	srq own_pending;				// Lock requests pending
 	SRQ_PTR own_process;			// Process we belong to
@@ -239,6 +269,7 @@ struct own
 	USHORT own_ast_count;			// Number of ASTs being delivered
 	Firebird::event_t own_wakeup;	// Wakeup event block
 	USHORT own_flags;				// Misc stuff
+	srq own_requests[1];			// Lock requests granted, one que per partition
 };
 
 // Flags in own_flags
@@ -389,6 +420,43 @@ class LockManager final : public Firebird::GlobalStorage, public Firebird::IpcOb
 	};
 #undef FB_LOCKED_FROM
 
+	class PartitionGuard
+	{
+	public:
+		explicit PartitionGuard(LockManager* lm)
+			: m_lm(lm), m_partition(NULL)
+		{
+#ifdef HAVE_OBJECT_MAP
+			m_lm->m_remapSync.beginRead(FB_FUNCTION);
+#endif
+		}
+
+		~PartitionGuard()
+		{
+			if (m_partition)
+				m_lm->release_partition(m_partition);
+
+#ifdef HAVE_OBJECT_MAP
+			m_lm->m_remapSync.endRead();
+#endif
+		}
+
+		lpt* enter(USHORT number)
+		{
+			fb_assert(!m_partition);
+			m_partition = m_lm->acquire_partition(number);
+			return m_partition;
+		}
+
+	private:
+		// Forbid copying
+		PartitionGuard(const PartitionGuard&);
+		PartitionGuard& operator=(const PartitionGuard&);
+
+		LockManager* m_lm;
+		lpt* m_partition;
+	};
+
 	const int PID;
 
 public:
@@ -416,8 +484,11 @@ public:
 
 private:
 	void acquire_shmem(SRQ_PTR);
+	lpt* acquire_partition(USHORT);
+	void acquire_partitions();
 	UCHAR* alloc(USHORT, Firebird::CheckStatusWrapper*);
-	lbl* alloc_lock(USHORT, Firebird::CheckStatusWrapper*);
+	lbl* alloc_lock(USHORT, USHORT, Firebird::CheckStatusWrapper*);
+	lrq* alloc_request(USHORT, Firebird::CheckStatusWrapper*);
 	void blocking_action(thread_db*, SRQ_PTR);
 	void blocking_action_thread();
 	void bug(Firebird::CheckStatusWrapper*, const TEXT*);
@@ -428,28 +499,40 @@ private:
 	lrq* deadlock_scan(own*, lrq*);
 	lrq* deadlock_walk(lrq*, bool*);
 	void debug_delay(ULONG);
+	bool fast_convert(Firebird::CheckStatusWrapper*, SRQ_PTR, UCHAR, SSHORT, lock_ast_t, void*, bool*);
+	bool fast_dequeue(SRQ_PTR, bool*);
+	bool fast_enqueue(Firebird::CheckStatusWrapper*, SRQ_PTR, USHORT, const UCHAR*, USHORT, UCHAR,
+		lock_ast_t, void*, SSHORT, SRQ_PTR*);
+	bool fast_read_data(SRQ_PTR, LOCK_DATA_T*);
+	bool fast_read_data2(USHORT, const UCHAR*, USHORT, LOCK_DATA_T*);
+	bool fast_write_data(SRQ_PTR, LOCK_DATA_T);
 	lbl* find_lock(USHORT, const UCHAR*, USHORT, USHORT*);
+	lrq* get_fast_request(SRQ_PTR, PartitionGuard&, lpt**);
+	lpt* get_partition(USHORT);
 	lrq* get_request(SRQ_PTR);
-	void grant(lrq*, lbl*);
+	void grant(lrq*, lbl*, lpt* = NULL);
 	bool grant_or_que(thread_db*, lrq*, lbl*, SSHORT);
 	bool init_owner_block(Firebird::CheckStatusWrapper*, own*, UCHAR, LOCK_OWNER_T);
 	void insert_data_que(lbl*);
-	void insert_tail(SRQ, SRQ);
+	void insert_tail(SRQ, SRQ, lpt* = NULL);
 	bool internal_convert(thread_db* database, Firebird::CheckStatusWrapper*, SRQ_PTR, UCHAR, SSHORT,
 		lock_ast_t, void*);
 	void internal_dequeue(SRQ_PTR);
 	static USHORT lock_state(const lbl*);
 	void post_blockage(thread_db*, lrq*, lbl*);
-	void post_history(USHORT, SRQ_PTR, SRQ_PTR, SRQ_PTR, bool);
+	void post_history(USHORT, SRQ_PTR, SRQ_PTR, SRQ_PTR, bool, lpt* = NULL);
 	void post_pending(lbl*);
 	void post_wakeup(own*);
 	bool probe_processes();
 	void purge_owner(SRQ_PTR, own*);
 	void purge_process(prc*);
+	void recover_que(lpt*);
 	void remap_local_owners();
-	void remove_que(SRQ);
+	void remove_que(SRQ, lpt* = NULL);
+	void release_partition(lpt*);
+	void release_partitions();
 	void release_shmem(SRQ_PTR);
-	void release_request(lrq*);
+	void release_request(lrq*, lpt* = NULL);
 	bool signal_owner(thread_db*, own*);
 
 	void validate_history(const SRQ_PTR history_header);
@@ -487,6 +570,7 @@ public:
 
 private:
 	bool m_blockage;
+	bool m_partitionsOwned;			// lock table mutex holder owns all the partitions
 
 	const Firebird::string& m_dbId;
 	const Config* const m_config;
@@ -167,6 +167,8 @@ namespace
 	};
 }
 
+static const lpt* get_partition(const lhb*, USHORT);
+static void get_totals(const lhb*, lhb*);
 static void prt_lock_activity(OUTFILE, const lhb*, USHORT, ULONG, ULONG);
 static void prt_history(OUTFILE, const lhb*, SRQ_PTR, const SCHAR*);
 static void prt_lock(OUTFILE, const lhb*, const lbl*, USHORT);
@@ -821,11 +823,14 @@ int CLIB_ROUTINE main( int argc, char *argv[])
 			(const TEXT*)HtmlLink(preOwn, LOCK_header->lhb_active_owner),
 			LOCK_header->lhb_length, LOCK_header->lhb_used);
 
+	lhb totals;
+	get_totals(LOCK_header, &totals);
+
 	FPRINTF(outfile,
 			"\tEnqs: %6" UQUADFORMAT", Converts: %6" UQUADFORMAT
 			", Rejects: %6" UQUADFORMAT", Blocks: %6" UQUADFORMAT"\n",
-			LOCK_header->lhb_enqs, LOCK_header->lhb_converts,
-			LOCK_header->lhb_denies, LOCK_header->lhb_blocks);
+			totals.lhb_enqs, totals.lhb_converts,
+			totals.lhb_denies, LOCK_header->lhb_blocks);
 
 	FPRINTF(outfile,
 			"\tDeadlock scans: %6" UQUADFORMAT", Deadlocks: %6" UQUADFORMAT
@@ -848,6 +853,25 @@ int CLIB_ROUTINE main( int argc, char *argv[])
 	else
 		FPRINTF(outfile, "\tMutex wait: 0.0%%\n");
 
+	if (LOCK_header->lhb_partitions > 1)
+	{
+		FB_UINT64 acquires = 0, acquire_blocks = 0, enqs = 0, deqs = 0;
+
+		for (USHORT n = 0; n < LOCK_header->lhb_partitions; n++)
+		{
+			const lpt* const partition = get_partition(LOCK_header, n);
+			acquires += partition->lpt_acquires;
+			acquire_blocks += partition->lpt_acquire_blocks;
+			enqs += partition->lpt_enqs;
+			deqs += partition->lpt_deqs;
+		}
+
+		FPRINTF(outfile,
+				"\tPartitions: %2d, Acquires: %6" UQUADFORMAT", Acquire blocks: %6" UQUADFORMAT
+				", Enqs: %6" UQUADFORMAT", Deqs: %6" UQUADFORMAT"\n",
+				LOCK_header->lhb_partitions, acquires, acquire_blocks, enqs, deqs);
+	}
+
 	SLONG hash_total_count = 0;
 	SLONG hash_max_count = 0;
 	SLONG hash_min_count = 10000000;
@@ -906,6 +930,19 @@ int CLIB_ROUTINE main( int argc, char *argv[])
 	prt_que(outfile, LOCK_header, "\tFree requests",
 			&LOCK_header->lhb_free_requests, offsetof(lrq, lrq_lbl_requests));
 
+	for (USHORT n = 0; n < LOCK_header->lhb_partitions; n++)
+	{
+		const lpt* const partition = get_partition(LOCK_header, n);
+		TEXT title[64];
+
+		sprintf(title, "\tPartition %d free locks", n);
+		prt_que(outfile, LOCK_header, title,
+				&partition->lpt_free_locks, offsetof(lbl, lbl_lhb_hash));
+		sprintf(title, "\tPartition %d free requests", n);
+		prt_que(outfile, LOCK_header, title,
+				&partition->lpt_free_requests, offsetof(lrq, lrq_lbl_requests));
+	}
+
 	FPRINTF(outfile, "\n");
 
 	// Print known owners
@@ -942,6 +979,17 @@ int CLIB_ROUTINE main( int argc, char *argv[])
 	{
 		prt_history(outfile, LOCK_header, LOCK_header->lhb_history, "History");
 		prt_history(outfile, LOCK_header, a_shb->shb_history, "Event log");
+
+		if (LOCK_header->lhb_partitions > 1)
+		{
+			for (USHORT n = 0; n < LOCK_header->lhb_partitions; n++)
+			{
+				TEXT title[64];
+				sprintf(title, "Partition %d history", n);
+				prt_history(outfile, LOCK_header,
+							get_partition(LOCK_header, n)->lpt_shb.shb_history, title);
+			}
+		}
 	}
 
 	prt_html_end(outfile);
@@ -950,8 +998,56 @@ int CLIB_ROUTINE main( int argc, char *argv[])
 }
 
 
+static const lpt* get_partition(const lhb* LOCK_header, USHORT number)
+{
+/**************************************
+ *
+ *	g e t _ p a r t i t i o n
+ *
+ **************************************
+ *
+ * Functional description
+ *	Locate the lock table partition.
+ *
+ **************************************/
+	return (lpt*) SRQ_ABS_PTR(LOCK_header->lhb_partition + number * LPT_SIZE);
+}
+
+
+static void get_totals(const lhb* LOCK_header, lhb* totals)
+{
+/**************************************
+ *
+ *	g e t _ t o t a l s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Copy the lock header adding the activity of
+ *	operations done holding just a partition.
+ *
+ **************************************/
+	*totals = *LOCK_header;
+
+	for (USHORT n = 0; n < LOCK_header->lhb_partitions; n++)
+	{
+		const lpt* const partition = get_partition(LOCK_header, n);
+
+		totals->lhb_enqs += partition->lpt_enqs;
+		totals->lhb_converts += partition->lpt_converts;
+		totals->lhb_deqs += partition->lpt_deqs;
+		totals->lhb_read_data += partition->lpt_read_data;
+		totals->lhb_write_data += partition->lpt_write_data;
+		totals->lhb_denies += partition->lpt_denies;
+
+		for (int i = 0; i < LCK_MAX_SERIES; i++)
+			totals->lhb_operations[i] += partition->lpt_operations[i];
+	}
+}
+
+
 static void prt_lock_activity(OUTFILE outfile,
-							  const lhb* header,
+							  const lhb* LOCK_header,
 							  USHORT flag,
 							  ULONG seconds,
 							  ULONG intervals)
@@ -985,6 +1081,10 @@ static void prt_lock_activity(OUTFILE outfile,
 
 	FPRINTF(outfile, "\n");
 
+	lhb current;
+	get_totals(LOCK_header, &current);
+	const lhb* const header = &current;
+
 	lhb base = *header;
 	lhb prior = *header;
 
@@ -1004,6 +1104,8 @@ static void prt_lock_activity(OUTFILE outfile,
 		clock = time(NULL);
 		d = *localtime(&clock);
 
+		get_totals(LOCK_header, &current);
+
 		FPRINTF(outfile, "%02d:%02d:%02d ", d.tm_hour, d.tm_min, d.tm_sec);
 
 		if (flag & SW_I_ACQUIRE)
@@ -1408,8 +1510,17 @@ static void prt_owner(OUTFILE outfile,
 	FPRINTF(outfile, " %s", (flags & OWN_signaled) ? "sgnl" : "    ");
 	FPRINTF(outfile, "\n");
 
-	prt_que(outfile, LOCK_header, "\tRequests", &owner->own_requests,
-			offsetof(lrq, lrq_own_requests), preRequest);
+	for (USHORT n = 0; n < LOCK_header->lhb_partitions; n++)
+	{
+		TEXT title[64];
+		if (LOCK_header->lhb_partitions > 1)
+			sprintf(title, "\tRequests (partition %d)", n);
+		else
+			strcpy(title, "\tRequests");
+
+		prt_que(outfile, LOCK_header, title, &owner->own_requests[n],
+				offsetof(lrq, lrq_own_requests), preRequest);
+	}
 	prt_que(outfile, LOCK_header, "\tBlocks", &owner->own_blocks,
 			offsetof(lrq, lrq_own_blocks), preRequest);
 	prt_que(outfile, LOCK_header, "\tPending", &owner->own_pending,
@@ -1435,10 +1546,13 @@ static void prt_owner(OUTFILE outfile,
 		}
 		else
 		{
-			const srq* que_inst;
-			SRQ_LOOP(owner->own_requests, que_inst)
-				prt_request(outfile, LOCK_header,
-							(lrq*) ((UCHAR*) que_inst - offsetof(lrq, lrq_own_requests)));
+			for (USHORT n = 0; n < LOCK_header->lhb_partitions; n++)
+			{
+				const srq* que_inst;
+				SRQ_LOOP(owner->own_requests[n], que_inst)
+					prt_request(outfile, LOCK_header,
+								(lrq*) ((UCHAR*) que_inst - offsetof(lrq, lrq_own_requests)));
+			}
 		}
 	}
 }
@@ -1,7 +1,7 @@
 /* MAX_NUMBER is the next number to be used, always one more than the highest message number. */
 set bulk_insert INSERT INTO FACILITIES (LAST_CHANGE, FACILITY, FAC_CODE, MAX_NUMBER) VALUES (?, ?, ?, ?);
 --
-('2020-03-04 16:39:50', 'JRD', 0, 949)
+('2026-10-18 12:00:00', 'JRD', 0, 951)
 ('2015-03-17 18:33:00', 'QLI', 1, 533)
 ('2018-03-17 12:00:00', 'GFIX', 3, 136)
 ('1996-11-07 13:39:40', 'GPRE', 4, 1)
@@ -18,8 +18,8 @@ set bulk_insert INSERT INTO FACILITIES (LAST_CHANGE, FACILITY, FAC_CODE, MAX_NUM
 ('2019-10-19 12:52:29', 'GSTAT', 21, 63)
 ('2019-12-10 17:55:05', 'FBSVCMGR', 22, 61)
 ('2009-07-18 12:12:12', 'UTL', 23, 2)
-('2016-03-20 15:30:00', 'NBACKUP', 24, 80)
-('2009-07-20 07:55:48', 'FBTRACEMGR', 25, 41)
+('2026-10-18 12:00:00', 'NBACKUP', 24, 85)
+('2026-10-18 12:00:00', 'FBTRACEMGR', 25, 46)
 ('2015-07-27 00:00:00', 'JAYBIRD', 26, 1)
 stop
 
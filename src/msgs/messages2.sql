@@ -1056,6 +1056,8 @@ Data source : @4', NULL, NULL)
 ('truncate_warn', NULL, 'cvt.cpp', NULL, 0, 946, NULL, 'String truncated warning due to the following reason', NULL, NULL);
 ('truncate_monitor', NULL, 'Monitoring.cpp', NULL, 0, 947, NULL, 'Monitoring data does not fit into the field', NULL, NULL);
 ('truncate_context', NULL, 'SysFunction.cpp', NULL, 0, 948, NULL, 'Engine data does not fit into return value of system function', NULL, NULL);
+('ext_line_too_long', 'get_line', 'ext.cpp', NULL, 0, 949, NULL, 'Line of external file @1 is longer than @2 bytes', NULL, NULL);
+('ext_format_not_ext', NULL, 'DdlNodes.epp', NULL, 0, 950, NULL, 'FORMAT clause is allowed for EXTERNAL FILE tables only, table @1', NULL, NULL);
 -- QLI
 (NULL, NULL, NULL, NULL, 1, 0, NULL, 'expected type', NULL, NULL);
 (NULL, NULL, NULL, NULL, 1, 1, NULL, 'bad block type', NULL, NULL);
@@ -3592,6 +3594,11 @@ Analyzing database pages ...', NULL, NULL);
 ('nbackup_lostrec_guid_db', 'NBackup::backup_database', 'nbackup.cpp', NULL, 24, 77, NULL, 'Cannot find record for database "@1" backup GUID @2 in the backup history', NULL, NULL)
 (NULL, 'usage', 'nbackup.cpp', NULL, 24, 78, NULL, '  -I(NPLACE)                             Restore incremental backup(s) to existing database', NULL, NULL)
 (NULL, 'usage', 'nbackup.cpp', NULL, 24, 79, NULL, '  -INPLACE option could corrupt the database that has changed since previous restore', NULL, NULL)
+(NULL, 'usage', 'nbackup.cpp', NULL, 24, 80, NULL, '  -ZIP                                   Compress backup file (restore recognizes such files itself)', NULL, NULL)
+(NULL, 'usage', 'nbackup.cpp', NULL, 24, 81, NULL, '  -PAR(ALLEL) <n>                        Number of threads to (de)compress backup file', NULL, NULL)
+('nbackup_zip_not_loaded', 'ZipStream::ZipStream', 'nbackup.cpp', NULL, 24, 82, NULL, 'Compression support library not loaded', NULL, NULL)
+('nbackup_zip_not_supported', 'ZipStream::ZipStream', 'nbackup.cpp', NULL, 24, 83, NULL, 'Compression is not supported by this build', NULL, NULL)
+('nbackup_zip_call_err', 'ZipStream::compress', 'nbackup.cpp', NULL, 24, 84, NULL, 'Compression library call @1() failed with error @2', NULL, NULL)
 -- FBTRACEMGR
 -- All messages use the new format.
 (NULL, 'usage', 'TraceCmdLine.cpp', NULL, 25, 1, NULL, 'Firebird Trace Manager version @1', NULL, NULL)
@@ -3634,6 +3641,11 @@ Analyzing database pages ...', NULL, NULL);
 ('trace_switch_param_miss', 'usage', 'TraceCmdLine.cpp', NULL, 25, 38, NULL, 'mandatory parameter "@1" for switch "@2" is missing', NULL, NULL)
 ('trace_param_act_notcompat', 'usage', 'TraceCmdLine.cpp', NULL, 25, 39, NULL, 'parameter "@1" is incompatible with action "@2"', NULL, NULL)
 ('trace_mandatory_switch_miss', 'usage', 'TraceCmdLine.cpp', NULL, 25, 40, NULL, 'mandatory switch "@1" is missing', NULL, NULL)
+(NULL, 'usage', 'TraceCmdLine.cpp', NULL, 25, 41, NULL, 'Decoding of binary trace log:', NULL, NULL)
+(NULL, 'usage', 'TraceCmdLine.cpp', NULL, 25, 42, NULL, '  -DE[CODE]                             Decode binary trace log', NULL, NULL)
+(NULL, 'usage', 'TraceCmdLine.cpp', NULL, 25, 43, NULL, '  -FI[LE]     <string>                  Binary trace log file name', NULL, NULL)
+(NULL, 'usage', 'TraceCmdLine.cpp', NULL, 25, 44, NULL, '  -J[SON]                               Decode into JSON, one event per line', NULL, NULL)
+(NULL, 'usage', 'TraceCmdLine.cpp', NULL, 25, 45, NULL, '  fbtracemgr -DECODE -FILE audit.bin -JSON', NULL, NULL)
 --(NULL, 'usage', 'TraceCmdLine.cpp', NULL, 25, , NULL, '', NULL, NULL)
 --(NULL, 'usage', 'TraceCmdLine.cpp', NULL, 25, , NULL, '', NULL, NULL)
 stop
@@ -955,6 +955,8 @@ set bulk_insert INSERT INTO SYSTEM_ERRORS (SQL_CODE, SQL_CLASS, SQL_SUBCLASS, FA
 (304, '01', '004', 0, 946, 'truncate_warn', NULL, NULL)
 (304, '01', '004', 0, 947, 'truncate_monitor', NULL, NULL)
 (304, '01', '004', 0, 948, 'truncate_context', NULL, NULL)
+(-902, 'HY', '000', 0, 949, 'ext_line_too_long', NULL, NULL)
+(-607, '42', '000', 0, 950, 'ext_format_not_ext', NULL, NULL)
 -- GFIX
 (-901, '00', '000', 3, 1, 'gfix_db_name', NULL, NULL)
 (-901, '00', '000', 3, 2, 'gfix_invalid_sw', NULL, NULL)
@@ -1447,6 +1449,9 @@ COMMIT WORK;
 (-901, '08', '006', 24, 73, 'nbackup_user_stop', NULL, NULL)
 (-901, '54', '023', 24, 75, 'nbackup_deco_parse', NULL, NULL)
 (-901, '00', '000', 24, 77, 'nbackup_lostrec_guid_db', NULL, NULL)
+(-901, '00', '000', 24, 82, 'nbackup_zip_not_loaded', NULL, NULL)
+(-901, '0A', '000', 24, 83, 'nbackup_zip_not_supported', NULL, NULL)
+(-901, '00', '000', 24, 84, 'nbackup_zip_call_err', NULL, NULL)
 -- FBTRACEMGR
 (-901, '00', '000', 25, 30, 'trace_conflict_acts', NULL, NULL)
 (-901, '00', '000', 25, 31, 'trace_act_notfound', NULL, NULL)
@@ -990,6 +990,7 @@ extern "C" void FB_PLUGIN_ENTRY_POINT(IMaster* master)
 
 namespace Remote {
 
+static USHORT adapt_fetch(rem_port*, Rsr*, USHORT);
 static Rvnt* add_event(rem_port*);
 static void add_other_params(rem_port*, ClumpletWriter&, const ParametersSet&);
 static void add_working_directory(ClumpletWriter&, const PathName&);
@@ -1010,9 +1011,11 @@ static void info(CheckStatusWrapper*, Rdb*, P_OP, USHORT, USHORT, USHORT,
 	const UCHAR*, USHORT, const UCHAR*, ULONG, UCHAR*);
 static void init(CheckStatusWrapper*, ClntAuthBlock&, rem_port*, P_OP, PathName&,
 	ClumpletWriter&, IntlParametersBlock&, ICryptKeyCallback* cryptCallback);
+static bool low_inventory(const Rsr*);
 static Rtr* make_transaction(Rdb*, USHORT);
 static void mov_dsql_message(const UCHAR*, const rem_fmt*, UCHAR*, const rem_fmt*);
 static void move_error(const Arg::StatusVector& v);
+static RMessage* next_message(Rsr*);
 static void receive_after_start(Rrq*, USHORT);
 static void receive_packet(rem_port*, PACKET *);
 static void receive_packet_noqueue(rem_port*, PACKET *);
@@ -4094,13 +4097,22 @@ int ResultSet::fetchNext(CheckStatusWrapper* status, void* buffer)
 		fprintf(stdout, "Rows Pending in REM_fetch=%lu\n", statement->rsr_rows_pending);
 #endif
 
+		// In adaptive mode remember that application waits for rows already
+		// asked for, the next op_fetch asks for more of them
+
+		if (statement->rsr_fetch_depth && !statement->rsr_msgs_waiting &&
+			statement->rsr_flags.test(Rsr::FETCHED) &&
+			!statement->rsr_flags.test(Rsr::EOF_SET | Rsr::STREAM_ERR))
+		{
+			statement->rsr_fetch_stalled = true;
+		}
+
 		// Check to see if data is waiting.  If not, solicite data.
 
 		if ((!statement->rsr_flags.test(Rsr::EOF_SET | Rsr::STREAM_ERR) &&
 				(!statement->rsr_message->msg_address) && (statement->rsr_rows_pending == 0)) ||
 			(					// Low in inventory
-				(statement->rsr_rows_pending <= statement->rsr_reorder_level) &&
-				(statement->rsr_msgs_waiting <= statement->rsr_reorder_level) &&
+				low_inventory(statement) &&
 				// not using named pipe on NT
 				// Pipelining causes both server & client to
 				// write at the same time. In named pipes, writes
@@ -4129,6 +4141,9 @@ int ResultSet::fetchNext(CheckStatusWrapper* status, void* buffer)
 				sqldata->p_sqldata_messages =
 					REMOTE_compute_batch_size(port, 0, op_fetch_response, statement->rsr_select_format);
 
+				if (port->getPortConfig()->getClientAdaptiveFetch())
+					sqldata->p_sqldata_messages = adapt_fetch(port, statement, sqldata->p_sqldata_messages);
+
 				// Reorder data when the local buffer is half empty
 
 				statement->rsr_reorder_level = sqldata->p_sqldata_messages / 2;
@@ -4153,6 +4168,11 @@ int ResultSet::fetchNext(CheckStatusWrapper* status, void* buffer)
 
 			send_packet(port, packet);
 
+			// Round trip is measured for op_fetch not waiting behind other batches
+
+			if (statement->rsr_fetch_depth && !statement->rsr_batch_count)
+				statement->rsr_fetch_time = fb_utils::query_performance_counter();
+
 			statement->rsr_batch_count++;
 
 			// Queue up receipt of the pending data
@@ -6421,6 +6441,47 @@ void Attachment::ping(CheckStatusWrapper* status)
 	}
 }
 
+static USHORT adapt_fetch(rem_port* port, Rsr* statement, USHORT batch)
+{
+/**************************************
+ *
+ *	a d a p t _ f e t c h
+ *
+ **************************************
+ *
+ * Functional description
+ *	Return number of rows to ask by op_fetch in adaptive mode,
+ *	batch is the number asked in non-adaptive one.  While the
+ *	application has to wait for rows over the slow link, double
+ *	the number of rows up to what server sends in one batch and
+ *	then keep one more batch in pipeline, see low_inventory().
+ *
+ **************************************/
+
+	if (!statement->rsr_fetch_depth)
+	{
+		statement->rsr_fetch_rows = batch;
+		statement->rsr_fetch_depth = 1;
+	}
+
+	// Row size changes with format of the cursor
+
+	const USHORT limit = REMOTE_compute_fetch_limit(port, statement->rsr_select_format);
+
+	if (statement->rsr_fetch_stalled && statement->rsr_fetch_rtt >= MIN_ADAPTIVE_FETCH_RTT)
+	{
+		if (statement->rsr_fetch_rows < limit)
+			statement->rsr_fetch_rows = (USHORT) MIN((ULONG) statement->rsr_fetch_rows * 2, limit);
+		else if (statement->rsr_fetch_depth < MAX_FETCH_BATCHES)
+			statement->rsr_fetch_depth++;
+	}
+
+	statement->rsr_fetch_stalled = false;
+
+	return MAX(MIN(statement->rsr_fetch_rows, limit), batch);
+}
+
+
 static Rvnt* add_event( rem_port* port)
 {
 /*************************************
@@ -6769,7 +6830,7 @@ static void clear_stmt_que(rem_port* port, Rsr* statement)
  *
  **************************************/
 
-	fb_assert(statement->rsr_batch_count == 0 || statement->rsr_batch_count == 1);
+	fb_assert(statement->rsr_batch_count <= MAX_FETCH_BATCHES + 1);
 
 	while (statement->rsr_batch_count)
 	{
@@ -6846,19 +6907,7 @@ static void batch_dsql_fetch(rem_port*	port,
 
 		// Swallow up data. If a buffer isn't available, allocate another.
 
-		RMessage* message = statement->rsr_buffer;
-		if (message->msg_address)
-		{
-			RMessage* new_msg = FB_NEW RMessage(statement->rsr_fmt_length);
-			statement->rsr_buffer = new_msg;
-
-			new_msg->msg_next = message;
-
-			while (message->msg_next != new_msg->msg_next) {
-				message = message->msg_next;
-			}
-			message->msg_next = new_msg;
-		}
+		next_message(statement);
 
 		try {
 			receive_packet_noqueue(port, packet);
@@ -6872,6 +6921,13 @@ static void batch_dsql_fetch(rem_port*	port,
 			throw;
 		}
 
+		if (statement->rsr_fetch_time)
+		{
+			const SINT64 elapsed = fb_utils::query_performance_counter() - statement->rsr_fetch_time;
+			statement->rsr_fetch_rtt = (ULONG) (elapsed * 1000 / fb_utils::query_performance_frequency());
+			statement->rsr_fetch_time = 0;
+		}
+
 		if (packet->p_operation != op_fetch_response)
 		{
 			statement->rsr_flags.set(Rsr::STREAM_ERR);
@@ -6892,9 +6948,40 @@ static void batch_dsql_fetch(rem_port*	port,
 			break;
 		}
 
+		// Since PROTOCOL_FETCH_BATCH whole batch comes in single packet
+
+		const bool packed = (port->port_protocol >= PROTOCOL_FETCH_BATCH);
+
+		if (packed)
+		{
+			const CSTRING& rows = packet->p_sqldata.p_sqldata_rows;
+			const UCHAR* row = rows.cstr_address;
+			const UCHAR* const end = row + rows.cstr_length;
+
+			for (USHORT n = packet->p_sqldata.p_sqldata_messages; n; n--)
+			{
+				RMessage* const message = next_message(statement);
+
+				if (!REMOTE_unpack_row(statement->rsr_format, row, end, message->msg_buffer))
+				{
+					statement->rsr_rows_pending = 0;
+					--statement->rsr_batch_count;
+					dequeue_receive(port);
+					Arg::Gds(isc_net_read_err).raise();
+				}
+
+				message->msg_address = message->msg_buffer;
+				statement->rsr_buffer = message->msg_next;
+				statement->rsr_msgs_waiting++;
+
+				if (statement->rsr_rows_pending)
+					statement->rsr_rows_pending--;
+			}
+		}
+
 		// See if we're at end of the batch
 
-		if (packet->p_sqldata.p_sqldata_status || !packet->p_sqldata.p_sqldata_messages)
+		if (packed || packet->p_sqldata.p_sqldata_status || !packet->p_sqldata.p_sqldata_messages)
 		{
 			if (packet->p_sqldata.p_sqldata_status == 100)
 			{
@@ -7644,6 +7731,34 @@ static void init(CheckStatusWrapper* status, ClntAuthBlock& cBlock, rem_port* po
 }
 
 
+static bool low_inventory(const Rsr* statement)
+{
+/**************************************
+ *
+ *	l o w _ i n v e n t o r y
+ *
+ **************************************
+ *
+ * Functional description
+ *	Check if rows cached and on the way are few enough to
+ *	ask for the next batch in advance.  In adaptive mode up
+ *	to rsr_fetch_depth more batches are kept in pipeline.
+ *
+ **************************************/
+
+	if (statement->rsr_msgs_waiting > statement->rsr_reorder_level)
+		return false;
+
+	if (!statement->rsr_fetch_depth)
+		return statement->rsr_rows_pending <= statement->rsr_reorder_level;
+
+	const ULONG ahead = (ULONG) (statement->rsr_fetch_depth - 1) * statement->rsr_fetch_rows;
+
+	return statement->rsr_batch_count <= statement->rsr_fetch_depth &&
+		statement->rsr_rows_pending <= ahead + statement->rsr_reorder_level;
+}
+
+
 static Rtr* make_transaction( Rdb* rdb, USHORT id)
 {
 /**************************************
@@ -7727,6 +7842,38 @@ static void move_error(const Arg::StatusVector& v)
 }
 
 
+static RMessage* next_message(Rsr* statement)
+{
+/**************************************
+ *
+ *	n e x t _ m e s s a g e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Return the buffer to receive the next row of
+ *	the cursor into.  If it is still in use, put
+ *	a new one into the ring.
+ *
+ **************************************/
+	RMessage* message = statement->rsr_buffer;
+	if (message->msg_address)
+	{
+		RMessage* new_msg = FB_NEW RMessage(statement->rsr_fmt_length);
+		statement->rsr_buffer = new_msg;
+
+		new_msg->msg_next = message;
+
+		while (message->msg_next != new_msg->msg_next) {
+			message = message->msg_next;
+		}
+		message->msg_next = new_msg;
+	}
+
+	return statement->rsr_buffer;
+}
+
+
 static void receive_after_start(Rrq* request, USHORT msg_type)
 {
 /*****************************************
@@ -95,6 +95,12 @@
 #include <sys/select.h>
 #endif
 
+// Dispatcher thread of multiclient server waits for its ports using epoll
+#if defined(HAVE_SYS_EPOLL_H) && defined(HAVE_POLL)
+#include <sys/epoll.h>
+#define INET_EPOLL
+#endif
+
 #endif // !WIN_NT
 
 const int INET_RETRY_CALL = 5;
@@ -254,10 +260,18 @@ public:
 	Select()
 		: slct_time(0), slct_count(0), slct_poll(*getDefaultMemoryPool()),
 		  slct_ready(*getDefaultMemoryPool())
+#ifdef INET_EPOLL
+		  , slct_epoll(EPOLL_UNUSED), slct_pending(false), slct_next(0),
+		  slct_fds(*getDefaultMemoryPool()), slct_ports(*getDefaultMemoryPool())
+#endif
 	{ }
 
 	explicit Select(Firebird::MemoryPool& pool)
 		: slct_time(0), slct_count(0), slct_poll(pool), slct_ready(pool)
+#ifdef INET_EPOLL
+		  , slct_epoll(EPOLL_UNUSED), slct_pending(false), slct_next(0),
+		  slct_fds(pool), slct_ports(pool)
+#endif
 	{ }
 #else
 	Select()
@@ -273,6 +287,16 @@ public:
 	}
 #endif
 
+#ifdef INET_EPOLL
+	~Select()
+	{
+		releasePorts();
+
+		if (slct_epoll >= 0)
+			close(slct_epoll);
+	}
+#endif
+
 	enum HandleState {SEL_BAD, SEL_DISCONNECTED, SEL_NO_DATA, SEL_READY};
 
 	// set first port to check for readyness
@@ -280,12 +304,47 @@ public:
 	{
 		slct_main = port;
 		slct_port = port;
+#ifdef INET_EPOLL
+		slct_next = 0;
+#endif
 	}
 
 	// get port to check for readyness
 	// assume port_mutex is locked
 	HandleState checkNext(RemPortPtr& port)
 	{
+#ifdef INET_EPOLL
+		if (slct_epoll >= 0)
+		{
+			// only ports found by collect() are checked
+			while (slct_next < slct_ports.getCount())
+			{
+				ReadyPort& ready = slct_ports[slct_next];
+
+#ifdef WIRE_COMPRESS_SUPPORT
+				if (ready.port->port_flags & PORT_z_data)
+				{
+					port = ready.port;
+					return SEL_READY;
+				}
+#endif
+
+				// take over the reference held by slct_ports
+				port = RemPortPtr(REF_NO_INCR, ready.port);
+				ready.port = nullptr;
+				slct_next++;
+
+				if (port->port_state == rem_port::DISCONNECTED)
+					return SEL_DISCONNECTED;
+
+				return ready.state;
+			}
+
+			port = nullptr;
+			return SEL_NO_DATA;
+		}
+#endif
+
 		if (slct_port && slct_port->port_state == rem_port::DISCONNECTED)
 		{
 			// restart from main port
@@ -388,10 +447,25 @@ public:
 #endif
 		slct_main = nullptr;
 		slct_port = nullptr;
+#ifdef INET_EPOLL
+		releasePorts();
+		slct_pending = false;
+#endif
 	}
 
 	void select(timeval* timeout)
 	{
+#ifdef INET_EPOLL
+		if (slct_epoll >= 0)
+		{
+			// don't sleep when some port has decompressed data to process
+			const int milliseconds = slct_pending ? 0 :
+				timeout ? timeout->tv_sec * 1000 + timeout->tv_usec / 1000 : -1;
+			slct_count = epoll_wait(slct_epoll, slct_events, EPOLL_EVENTS, milliseconds);
+			return;
+		}
+#endif
+
 #ifdef HAVE_POLL
 		slct_ready.clear();
 		bool hasRequest = false;
@@ -436,9 +510,164 @@ public:
 		return slct_count;
 	}
 
+#ifdef INET_EPOLL
+	// Ports are kept in epoll set between waits instead of passing all of them
+	// to poll() every time. Port is registered for the single event (EPOLLONESHOT)
+	// and armed again by arm() after it's dispatched, so its handle is read by
+	// the dispatcher thread only. Readiness is level-triggered: port is read one
+	// packet at a time and the rest of data must wake up the next wait.
+
+	// create epoll set on first call, false if poll() should be used instead
+	bool epoll()
+	{
+		if (slct_epoll == EPOLL_UNUSED)
+		{
+			slct_epoll = epoll_create1(EPOLL_CLOEXEC);
+			if (slct_epoll < 0)
+			{
+				gds__log("INET/select_wait: epoll_create1 failed, errno = %d, using poll", errno);
+				slct_epoll = EPOLL_FAILED;
+			}
+		}
+
+		return slct_epoll >= 0;
+	}
+
+	// wait for port's handle unless already waiting for it
+	// assume port_mutex is locked
+	void arm(rem_port* port)
+	{
+#ifdef WIRE_COMPRESS_SUPPORT
+		if (port->port_flags & PORT_z_data)
+			slct_pending = true;
+#endif
+
+		const SOCKET n = port->port_handle;
+		if (port->port_armed == n)
+			return;
+
+		epoll_event event;
+		event.events = EPOLLIN | EPOLLONESHOT;
+		event.data.fd = n;
+
+		// Handle which fired before is still in the set, new one or one reused
+		// after close() (that removes it from the set) has to be added
+		if (epoll_ctl(slct_epoll, EPOLL_CTL_MOD, n, &event) == 0 ||
+			(errno == ENOENT && epoll_ctl(slct_epoll, EPOLL_CTL_ADD, n, &event) == 0))
+		{
+			port->port_armed = n;
+			return;
+		}
+
+		gds__log("INET/select_wait: epoll_ctl failed for socket %" HANDLEFORMAT", errno = %d",
+				 n, errno);
+
+		// this will lead to receive() which will break bad connection
+		addPort(port, SEL_BAD);
+	}
+
+	// stop waiting for port's handle, used for main port when server is shutting down
+	// assume port_mutex is locked
+	void disarm(rem_port* port)
+	{
+		const SOCKET n = port->port_handle;
+		if (port->port_armed != n)
+			return;
+
+		epoll_event event;	// ignored, but must be non-NULL for old kernels
+		if (epoll_ctl(slct_epoll, EPOLL_CTL_DEL, n, &event) != 0)
+		{
+			gds__log("INET/select_wait: epoll_ctl failed for socket %" HANDLEFORMAT", errno = %d",
+					 n, errno);
+		}
+
+		port->port_armed = INVALID_SOCKET;
+	}
+
+	// ports which failed to be armed
+	bool hasPorts() const
+	{
+		return slct_ports.hasData();
+	}
+
+	// find ports to check after epoll_wait(): ready ones, ones with decompressed
+	// data and ones with expired keepalive timer
+	// Port list is still walked here, as well as in select_wait() before waiting,
+	// because keepalive timers of all ports are checked and events carry handles,
+	// not ports (pointer to port could dangle after it's released with its handle
+	// waiting in ports_to_close). Epoll saves the syscall cost: kernel does not
+	// scan every handle and only changed registrations call epoll_ctl().
+	// assume port_mutex is locked
+	void collect(rem_port* main_port)
+	{
+		slct_fds.clear();
+		for (int i = 0; i < slct_count; i++)
+			slct_fds.add(slct_events[i].data.fd);
+
+		for (rem_port* port = main_port; port; port = port->port_next)
+		{
+			const SOCKET n = port->port_handle;
+			HandleState state = SEL_NO_DATA;
+
+			if (n != INVALID_SOCKET && port->port_armed == n && slct_fds.exist(n))
+			{
+				port->port_armed = INVALID_SOCKET;
+				state = SEL_READY;
+			}
+
+#ifdef WIRE_COMPRESS_SUPPORT
+			if (port->port_flags & PORT_z_data)
+				state = SEL_READY;
+#endif
+
+			if (port->port_state == rem_port::PENDING &&
+				(state == SEL_READY || port->port_dummy_timeout < 0))
+			{
+				addPort(port, state);
+			}
+		}
+	}
+#endif
+
 	time_t	slct_time;
 
 private:
+#ifdef INET_EPOLL
+	static const int EPOLL_UNUSED = -1;
+	static const int EPOLL_FAILED = -2;
+	static const int EPOLL_EVENTS = 64;
+
+	struct ReadyPort
+	{
+		rem_port* port;		// referenced
+		HandleState state;
+	};
+
+	void addPort(rem_port* port, HandleState state)
+	{
+		ReadyPort ready;
+		ready.port = port;
+		ready.state = state;
+		port->addRef();
+		slct_ports.add(ready);
+	}
+
+	void releasePorts()
+	{
+		for (ReadyPort* ready = slct_ports.begin(); ready < slct_ports.end(); ready++)
+		{
+			if (ready->port)
+			{
+				// drop the reference taken by addPort()
+				RemPortPtr release(REF_NO_INCR, ready->port);
+			}
+		}
+
+		slct_ports.clear();
+		slct_next = 0;
+	}
+#endif
+
 	int		slct_count;
 #ifdef HAVE_POLL
 	class PollToFD
@@ -450,6 +679,14 @@ private:
 
 	SortedArray<pollfd, InlineStorage<pollfd, 8>, int, PollToFD>  slct_poll;
 	SortedArray<pollfd*, InlineStorage<pollfd*, 8>, int, PollToFD>  slct_ready;
+#ifdef INET_EPOLL
+	int		slct_epoll;
+	bool	slct_pending;	// some port has decompressed data
+	FB_SIZE_T slct_next;	// next port to check in slct_ports
+	SortedArray<int, InlineStorage<int, EPOLL_EVENTS> > slct_fds;
+	HalfStaticArray<ReadyPort, EPOLL_EVENTS> slct_ports;
+	epoll_event slct_events[EPOLL_EVENTS];
+#endif
 #else
 	int		slct_width;
 	fd_set	slct_fdset;
@@ -673,7 +910,8 @@ rem_port* INET_analyze(ClntAuthBlock* cBlock,
 		REMOTE_PROTOCOL(PROTOCOL_VERSION13, ptype_lazy_send, 4),
 		REMOTE_PROTOCOL(PROTOCOL_VERSION14, ptype_lazy_send, 5),
 		REMOTE_PROTOCOL(PROTOCOL_VERSION15, ptype_lazy_send, 6),
-		REMOTE_PROTOCOL(PROTOCOL_VERSION16, ptype_lazy_send, 7)
+		REMOTE_PROTOCOL(PROTOCOL_VERSION16, ptype_lazy_send, 7),
+		REMOTE_PROTOCOL(PROTOCOL_VERSION17, ptype_lazy_send, 8)
 	};
 	fb_assert(FB_NELEM(protocols_to_try) <= FB_NELEM(cnct->p_cnct_versions));
 	cnct->p_cnct_count = FB_NELEM(protocols_to_try);
@@ -2222,6 +2460,9 @@ static bool select_wait( rem_port* main_port, Select* selct)
  **************************************/
 	struct timeval timeout;
 	bool checkPorts = false;
+#ifdef INET_EPOLL
+	const bool epoll = selct->epoll();
+#endif
 
 	for (;;)
 	{
@@ -2303,9 +2544,21 @@ static bool select_wait( rem_port* main_port, Select* selct)
 					// if process is shuting down - don't listen on main port
 					if (!INET_shutting_down || port != main_port)
 					{
+#ifdef INET_EPOLL
+						if (epoll)
+							selct->arm(port);
+						else
+#endif
 						selct->set(port->port_handle);
 						found = true;
 					}
+#ifdef INET_EPOLL
+					else if (epoll)
+					{
+						// main port may still be armed since previous wait
+						selct->disarm(port);
+					}
+#endif
 				}
 			}
 			checkPorts = false;
@@ -2319,6 +2572,15 @@ static bool select_wait( rem_port* main_port, Select* selct)
 			return false;
 		}
 
+#ifdef INET_EPOLL
+		if (epoll && selct->hasPorts())
+		{
+			RemPortPtr p(main_port);
+			selct->checkStart(p);
+			return true;
+		}
+#endif
+
 		for (;;)
 		{
 			// Before waiting for incoming packet, check for server shutdown
@@ -2346,6 +2608,15 @@ static bool select_wait( rem_port* main_port, Select* selct)
 				RemPortPtr p(main_port);
 				selct->checkStart(p);
 
+#ifdef INET_EPOLL
+				if (epoll)
+				{
+					MutexLockGuard guard(port_mutex, FB_FUNCTION);
+					selct->collect(main_port);
+					return true;
+				}
+#endif
+
 				// if selct->slct_count is zero it means that we timed out of
 				// select with nothing to read or accept, so clear the fd_set
 				// bit as this value is undefined on some platforms (eg. HP-UX),
@@ -2363,7 +2634,11 @@ static bool select_wait( rem_port* main_port, Select* selct)
 			}
 			if (INTERRUPT_ERROR(inetErrNo))
 				continue;
+#ifdef INET_EPOLL
+			if (inetErrNo == NOTASOCKET && !epoll)
+#else
 			if (inetErrNo == NOTASOCKET)
+#endif
 			{
 				checkPorts = true;
 				break;
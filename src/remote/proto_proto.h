@@ -28,6 +28,6 @@
 void	xdr_debug_memory (XDR*, enum xdr_op, const void*, const void*, ULONG);
 #endif
 bool_t	xdr_protocol (XDR*, struct packet*);
-ULONG	xdr_protocol_overhead (P_OP);
+ULONG	xdr_protocol_overhead (P_OP, USHORT);
 
 #endif	//  REMOTE_PROTO_PROTO_H
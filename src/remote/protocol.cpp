@@ -717,6 +717,19 @@ bool_t xdr_protocol(XDR* xdrs, PACKET* p)
 
 		// Changes to this op's protocol must mirror in xdr_protocol_overhead
 
+		{
+			const rem_port* const port = (rem_port*) xdrs->x_public;
+
+			if (port->port_protocol >= PROTOCOL_FETCH_BATCH || xdrs->x_op == XDR_FREE)
+			{
+				// Whole batch of rows, see REMOTE_pack_row()
+
+				MAP(xdr_cstring, sqldata->p_sqldata_rows);
+				DEBUG_PRINTSIZE(xdrs, p->p_operation);
+				return P_TRUE(xdrs, p);
+			}
+		}
+
 		if (sqldata->p_sqldata_messages)
 		{
 			return xdr_sql_message(xdrs, (SLONG)sqldata->p_sqldata_statement) ?
@@ -1143,7 +1156,7 @@ static bool_t xdr_bytes(XDR* xdrs, void* bytes, ULONG size)
 }
 
 
-ULONG xdr_protocol_overhead(P_OP op)
+ULONG xdr_protocol_overhead(P_OP op, USHORT protocol)
 {
 /**************************************
  *
@@ -1162,6 +1175,9 @@ ULONG xdr_protocol_overhead(P_OP op)
  *	it is unknown how portable that Solaris call is to other
  *	OS.
  *
+ *	Layout of some packets depends on the protocol version
+ *	of the connection.
+ *
  **************************************/
 	ULONG size = 4; // xdr_sizeof (xdr_enum, p->p_operation)
 
@@ -1170,6 +1186,12 @@ ULONG xdr_protocol_overhead(P_OP op)
 	case op_fetch_response:
 		size += 4				// xdr_sizeof (xdr_long, sqldata->p_sqldata_status)
 			+ 4;				// xdr_sizeof (xdr_short, sqldata->p_sqldata_messages)
+
+		if (protocol >= PROTOCOL_FETCH_BATCH)
+		{
+			size += 4			// xdr_sizeof (xdr_cstring, sqldata->p_sqldata_rows) length
+				+ 3;			// maximum padding of the packed rows to 4 bytes
+		}
 		break;
 
 	case op_send:
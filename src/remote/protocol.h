@@ -93,6 +93,12 @@ const USHORT PROTOCOL_VERSION15 = (FB_PROTOCOL_FLAG | 15);
 const USHORT PROTOCOL_VERSION16 = (FB_PROTOCOL_FLAG | 16);
 const USHORT PROTOCOL_STMT_TOUT = PROTOCOL_VERSION16;
 
+// Protocol 17:
+//	- sends all rows of op_fetch batch in single op_fetch_response, encoded compactly
+
+const USHORT PROTOCOL_VERSION17 = (FB_PROTOCOL_FLAG | 17);
+const USHORT PROTOCOL_FETCH_BATCH = PROTOCOL_VERSION17;
+
 // Architecture types
 
 enum P_ARCH
@@ -596,6 +602,7 @@ typedef struct p_sqldata
     USHORT	p_sqldata_out_message_number;
     ULONG	p_sqldata_status;			// final eof status
 	ULONG	p_sqldata_timeout;			// statement timeout
+	CSTRING	p_sqldata_rows;				// rows of op_fetch_response since PROTOCOL_FETCH_BATCH
 } P_SQLDATA;
 
 typedef struct p_sqlfree
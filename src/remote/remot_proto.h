@@ -46,14 +46,17 @@ enum LegacyPlugin {PLUGIN_NEW = 0, PLUGIN_LEGACY, PLUGIN_TRUSTED};
 
 void		REMOTE_cleanup_transaction (struct Rtr *);
 USHORT		REMOTE_compute_batch_size (rem_port*, USHORT, P_OP, const rem_fmt*);
+USHORT		REMOTE_compute_fetch_limit (rem_port*, const rem_fmt*);
 void		REMOTE_get_timeout_params(rem_port* port, Firebird::ClumpletReader* pb);
 struct Rrq*	REMOTE_find_request (struct Rrq *, USHORT);
 void		REMOTE_free_packet (rem_port*, struct packet *, bool = false);
 struct rem_str*	REMOTE_make_string (const SCHAR*);
+bool		REMOTE_pack_row (const rem_fmt*, const UCHAR*, Firebird::UCharBuffer&);
 void		REMOTE_release_messages (struct RMessage*);
 void		REMOTE_release_request (struct Rrq *);
 void		REMOTE_reset_request (struct Rrq *, struct RMessage*);
 void		REMOTE_reset_statement (struct Rsr *);
+bool		REMOTE_unpack_row (const rem_fmt*, const UCHAR*&, const UCHAR*, UCHAR*);
 bool_t		REMOTE_getbytes (XDR*, SCHAR*, u_int);
 LegacyPlugin REMOTE_legacy_auth(const char* nm, int protocol);
 Firebird::RefPtr<const Config> REMOTE_get_config(const Firebird::PathName* dbName,
@@ -200,6 +200,9 @@ USHORT REMOTE_compute_batch_size(rem_port* port,
  * Each data block has one overhead packet
  * to indicate the data is present.
  *
+ * Since PROTOCOL_FETCH_BATCH the whole batch is sent as a
+ * single op_fetch_response, with rows encoded by REMOTE_pack_row.
+ *
  * (See also op_send in receive_msg() - which is a kissing cousin
  *  to this routine)
  *
@@ -219,7 +222,7 @@ USHORT REMOTE_compute_batch_size(rem_port* port,
  *
  **************************************/
 
-	const USHORT op_overhead = (USHORT) xdr_protocol_overhead(op_code);
+	const USHORT op_overhead = (USHORT) xdr_protocol_overhead(op_code, port->port_protocol);
 
 #ifdef DEBUG
 	fprintf(stderr,
@@ -229,9 +232,9 @@ USHORT REMOTE_compute_batch_size(rem_port* port,
 #endif
 
 	const ULONG row_size = op_overhead +
-		(port->port_flags & PORT_symmetric) ?
+		((port->port_flags & PORT_symmetric) ?
 			ROUNDUP(format->fmt_length, 4) : 	// Same architecture connection
-			ROUNDUP(format->fmt_net_length, 4);	// Using XDR for data transfer
+			ROUNDUP(format->fmt_net_length, 4));	// Using XDR for data transfer
 
 	ULONG result = (port->port_protocol >= PROTOCOL_VERSION13) ?
 		MAX_ROWS_PER_BATCH : (MAX_PACKETS_PER_BATCH * port->port_buff_size - buffer_used) / row_size;
@@ -249,6 +252,514 @@ USHORT REMOTE_compute_batch_size(rem_port* port,
 }
 
 
+USHORT REMOTE_compute_fetch_limit(rem_port* port, const rem_fmt* format)
+{
+/**************************************
+ *
+ *	R E M O T E _ c o m p u t e _ f e t c h _ l i m i t
+ *
+ **************************************
+ *
+ * Functional description
+ *	Return the largest number of rows worth asking by a
+ *	single op_fetch in adaptive mode.  Server stops the batch
+ *	after MAX_PACKETS_PER_BATCH packets, so ask no more than
+ *	fits into them, and no more than we can cache.
+ *
+ **************************************/
+
+	const ULONG op_overhead = xdr_protocol_overhead(op_fetch_response, port->port_protocol);
+
+	const ULONG row_size = op_overhead +
+		((port->port_flags & PORT_symmetric) ?
+			ROUNDUP(format->fmt_length, 4) :
+			ROUNDUP(format->fmt_net_length, 4));
+
+	// Leave a packet for the end of batch and rounding of packets
+
+	ULONG result = (MAX_PACKETS_PER_BATCH - 1) * port->port_buff_size / row_size;
+
+	result = MIN(result, MAX_BATCH_CACHE_SIZE / format->fmt_length);
+	result = MIN(result, MAX_USHORT);
+
+	// Never less than in non-adaptive mode
+
+	const USHORT batch = REMOTE_compute_batch_size(port, 0, op_fetch_response, format);
+
+	return MAX(static_cast<USHORT>(result), batch);
+}
+
+
+// Compact encoding of rows of op_fetch_response, see REMOTE_pack_row()
+
+namespace
+{
+	UCHAR* putUnsigned(UCHAR* ptr, FB_UINT64 value)
+	{
+		while (value >= 0x80)
+		{
+			*ptr++ = (UCHAR) (value | 0x80);
+			value >>= 7;
+		}
+
+		*ptr++ = (UCHAR) value;
+		return ptr;
+	}
+
+	UCHAR* putSigned(UCHAR* ptr, SINT64 value)
+	{
+		// Zigzag, small negative numbers take few bytes too
+		return putUnsigned(ptr, ((FB_UINT64) value << 1) ^ (FB_UINT64) (value >> 63));
+	}
+
+	UCHAR* putFixed(UCHAR* ptr, FB_UINT64 value, unsigned length)
+	{
+		// Most significant byte first, as XDR does
+		for (int shift = (length - 1) * 8; shift >= 0; shift -= 8)
+			*ptr++ = (UCHAR) (value >> shift);
+
+		return ptr;
+	}
+
+	UCHAR* putBytes(UCHAR* ptr, const UCHAR* data, ULONG length)
+	{
+		ptr = putUnsigned(ptr, length);
+		memcpy(ptr, data, length);
+		return ptr + length;
+	}
+
+	class RowReader
+	{
+	public:
+		RowReader(const UCHAR* ptr, const UCHAR* end)
+			: m_ptr(ptr), m_end(end)
+		{ }
+
+		bool getUnsigned(FB_UINT64& value)
+		{
+			value = 0;
+
+			for (unsigned shift = 0; shift < 64; shift += 7)
+			{
+				if (m_ptr >= m_end)
+					return false;
+
+				const UCHAR c = *m_ptr++;
+				value |= (FB_UINT64) (c & 0x7F) << shift;
+
+				if (!(c & 0x80))
+					return true;
+			}
+
+			return false;
+		}
+
+		template <typename T>
+		bool getSigned(T* value)
+		{
+			FB_UINT64 temp;
+			if (!getUnsigned(temp))
+				return false;
+
+			*value = (T) (SINT64) ((temp >> 1) ^ (~(temp & 1) + 1));
+			return true;
+		}
+
+		bool getFixed(FB_UINT64& value, unsigned length)
+		{
+			if ((ULONG) (m_end - m_ptr) < length)
+				return false;
+
+			value = 0;
+			while (length--)
+				value = (value << 8) | *m_ptr++;
+
+			return true;
+		}
+
+		bool getBytes(UCHAR* data, ULONG maxLength, ULONG& length)
+		{
+			FB_UINT64 temp;
+			if (!getUnsigned(temp) || temp > maxLength || temp > (FB_UINT64) (m_end - m_ptr))
+				return false;
+
+			length = (ULONG) temp;
+			memcpy(data, m_ptr, length);
+			m_ptr += length;
+			return true;
+		}
+
+		bool getRaw(UCHAR* data, ULONG length)
+		{
+			if ((ULONG) (m_end - m_ptr) < length)
+				return false;
+
+			memcpy(data, m_ptr, length);
+			m_ptr += length;
+			return true;
+		}
+
+		const UCHAR* getPosition() const
+		{
+			return m_ptr;
+		}
+
+	private:
+		const UCHAR* m_ptr;
+		const UCHAR* const m_end;
+	};
+
+	inline UCHAR textPad(const dsc* desc)
+	{
+		return desc->getCharSet() == CS_BINARY ? '\0' : ' ';
+	}
+
+	// Parts of 128-bit values in the order xdr_dec128() and xdr_int128() use
+
+#ifndef WORDS_BIGENDIAN
+	const unsigned HIGH_HALF = 8, LOW_HALF = 0;
+#else
+	const unsigned HIGH_HALF = 0, LOW_HALF = 8;
+#endif
+
+	UCHAR* packDatum(UCHAR* ptr, const dsc* desc, const UCHAR* message)
+	{
+		const UCHAR* const p = message + (IPTR) desc->dsc_address;
+
+		switch (desc->dsc_dtype)
+		{
+		case dtype_text:
+			{
+				const UCHAR pad = textPad(desc);
+				ULONG length = desc->dsc_length;
+
+				while (length && p[length - 1] == pad)
+					length--;
+
+				return putBytes(ptr, p, length);
+			}
+
+		case dtype_dbkey:
+		case dtype_boolean:
+			memcpy(ptr, p, desc->dsc_length);
+			return ptr + desc->dsc_length;
+
+		case dtype_varying:
+			{
+				const vary* const v = reinterpret_cast<const vary*>(p);
+				return putBytes(ptr, reinterpret_cast<const UCHAR*>(v->vary_string),
+					MIN((USHORT) (desc->dsc_length - 2), v->vary_length));
+			}
+
+		case dtype_cstring:
+			return putBytes(ptr, p,
+				MIN(static_cast<ULONG>(strlen(reinterpret_cast<const char*>(p))), (ULONG) (desc->dsc_length - 1)));
+
+		case dtype_short:
+			return putSigned(ptr, *reinterpret_cast<const SSHORT*>(p));
+
+		case dtype_sql_time:
+		case dtype_sql_date:
+		case dtype_long:
+			return putSigned(ptr, *reinterpret_cast<const SLONG*>(p));
+
+		case dtype_sql_time_tz:
+			ptr = putSigned(ptr, *reinterpret_cast<const SLONG*>(p));
+			return putSigned(ptr, *reinterpret_cast<const SSHORT*>(p + sizeof(SLONG)));
+
+		case dtype_ex_time_tz:
+			ptr = putSigned(ptr, *reinterpret_cast<const SLONG*>(p));
+			ptr = putSigned(ptr, *reinterpret_cast<const SSHORT*>(p + sizeof(SLONG)));
+			return putSigned(ptr, *reinterpret_cast<const SSHORT*>(p + sizeof(SLONG) + sizeof(SSHORT)));
+
+		case dtype_timestamp:
+			ptr = putSigned(ptr, reinterpret_cast<const SLONG*>(p)[0]);
+			return putSigned(ptr, reinterpret_cast<const SLONG*>(p)[1]);
+
+		case dtype_timestamp_tz:
+			ptr = putSigned(ptr, reinterpret_cast<const SLONG*>(p)[0]);
+			ptr = putSigned(ptr, reinterpret_cast<const SLONG*>(p)[1]);
+			return putSigned(ptr, *reinterpret_cast<const SSHORT*>(p + 2 * sizeof(SLONG)));
+
+		case dtype_ex_timestamp_tz:
+			ptr = putSigned(ptr, reinterpret_cast<const SLONG*>(p)[0]);
+			ptr = putSigned(ptr, reinterpret_cast<const SLONG*>(p)[1]);
+			ptr = putSigned(ptr, *reinterpret_cast<const SSHORT*>(p + 2 * sizeof(SLONG)));
+			return putSigned(ptr, *reinterpret_cast<const SSHORT*>(p + 2 * sizeof(SLONG) + sizeof(SSHORT)));
+
+		case dtype_int64:
+			return putSigned(ptr, *reinterpret_cast<const SINT64*>(p));
+
+		case dtype_real:
+			{
+				ULONG bits;
+				memcpy(&bits, p, sizeof(bits));
+				return putFixed(ptr, bits, sizeof(bits));
+			}
+
+		case dtype_double:
+			{
+				// Same words order as xdr_double()
+				ULONG words[2];
+				memcpy(words, p, sizeof(words));
+				ptr = putFixed(ptr, words[FB_LONG_DOUBLE_FIRST], sizeof(ULONG));
+				return putFixed(ptr, words[FB_LONG_DOUBLE_SECOND], sizeof(ULONG));
+			}
+
+		case dtype_dec64:
+			{
+				FB_UINT64 bits;
+				memcpy(&bits, p, sizeof(bits));
+				return putFixed(ptr, bits, sizeof(bits));
+			}
+
+		case dtype_dec128:
+		case dtype_int128:
+			{
+				FB_UINT64 bits[2];
+				memcpy(&bits[0], p + HIGH_HALF, sizeof(FB_UINT64));
+				memcpy(&bits[1], p + LOW_HALF, sizeof(FB_UINT64));
+				ptr = putFixed(ptr, bits[0], sizeof(FB_UINT64));
+				return putFixed(ptr, bits[1], sizeof(FB_UINT64));
+			}
+
+		case dtype_array:
+		case dtype_quad:
+		case dtype_blob:
+			{
+				const SQUAD* const quad = reinterpret_cast<const SQUAD*>(p);
+				ptr = putFixed(ptr, (ULONG) quad->gds_quad_high, sizeof(ULONG));
+				return putFixed(ptr, quad->gds_quad_low, sizeof(ULONG));
+			}
+
+		default:
+			fb_assert(false);
+			return NULL;
+		}
+	}
+
+	bool unpackDatum(RowReader& reader, const dsc* desc, UCHAR* message)
+	{
+		UCHAR* const p = message + (IPTR) desc->dsc_address;
+		FB_UINT64 bits, bits2;
+		ULONG length;
+
+		switch (desc->dsc_dtype)
+		{
+		case dtype_text:
+			if (!reader.getBytes(p, desc->dsc_length, length))
+				return false;
+			memset(p + length, textPad(desc), desc->dsc_length - length);
+			return true;
+
+		case dtype_dbkey:
+		case dtype_boolean:
+			return reader.getRaw(p, desc->dsc_length);
+
+		case dtype_varying:
+			{
+				vary* const v = reinterpret_cast<vary*>(p);
+				if (!reader.getBytes(reinterpret_cast<UCHAR*>(v->vary_string), desc->dsc_length - 2, length))
+					return false;
+				v->vary_length = (USHORT) length;
+				return true;
+			}
+
+		case dtype_cstring:
+			if (!reader.getBytes(p, desc->dsc_length - 1, length))
+				return false;
+			p[length] = 0;
+			return true;
+
+		case dtype_short:
+			return reader.getSigned(reinterpret_cast<SSHORT*>(p));
+
+		case dtype_sql_time:
+		case dtype_sql_date:
+		case dtype_long:
+			return reader.getSigned(reinterpret_cast<SLONG*>(p));
+
+		case dtype_sql_time_tz:
+			return reader.getSigned(reinterpret_cast<SLONG*>(p)) &&
+				reader.getSigned(reinterpret_cast<SSHORT*>(p + sizeof(SLONG)));
+
+		case dtype_ex_time_tz:
+			return reader.getSigned(reinterpret_cast<SLONG*>(p)) &&
+				reader.getSigned(reinterpret_cast<SSHORT*>(p + sizeof(SLONG))) &&
+				reader.getSigned(reinterpret_cast<SSHORT*>(p + sizeof(SLONG) + sizeof(SSHORT)));
+
+		case dtype_timestamp:
+			return reader.getSigned(&reinterpret_cast<SLONG*>(p)[0]) &&
+				reader.getSigned(&reinterpret_cast<SLONG*>(p)[1]);
+
+		case dtype_timestamp_tz:
+			return reader.getSigned(&reinterpret_cast<SLONG*>(p)[0]) &&
+				reader.getSigned(&reinterpret_cast<SLONG*>(p)[1]) &&
+				reader.getSigned(reinterpret_cast<SSHORT*>(p + 2 * sizeof(SLONG)));
+
+		case dtype_ex_timestamp_tz:
+			return reader.getSigned(&reinterpret_cast<SLONG*>(p)[0]) &&
+				reader.getSigned(&reinterpret_cast<SLONG*>(p)[1]) &&
+				reader.getSigned(reinterpret_cast<SSHORT*>(p + 2 * sizeof(SLONG))) &&
+				reader.getSigned(reinterpret_cast<SSHORT*>(p + 2 * sizeof(SLONG) + sizeof(SSHORT)));
+
+		case dtype_int64:
+			return reader.getSigned(reinterpret_cast<SINT64*>(p));
+
+		case dtype_real:
+			{
+				if (!reader.getFixed(bits, sizeof(ULONG)))
+					return false;
+				const ULONG word = (ULONG) bits;
+				memcpy(p, &word, sizeof(word));
+				return true;
+			}
+
+		case dtype_double:
+			{
+				if (!reader.getFixed(bits, sizeof(ULONG)) || !reader.getFixed(bits2, sizeof(ULONG)))
+					return false;
+				ULONG words[2];
+				words[FB_LONG_DOUBLE_FIRST] = (ULONG) bits;
+				words[FB_LONG_DOUBLE_SECOND] = (ULONG) bits2;
+				memcpy(p, words, sizeof(words));
+				return true;
+			}
+
+		case dtype_dec64:
+			if (!reader.getFixed(bits, sizeof(FB_UINT64)))
+				return false;
+			memcpy(p, &bits, sizeof(bits));
+			return true;
+
+		case dtype_dec128:
+		case dtype_int128:
+			if (!reader.getFixed(bits, sizeof(FB_UINT64)) || !reader.getFixed(bits2, sizeof(FB_UINT64)))
+				return false;
+			memcpy(p + HIGH_HALF, &bits, sizeof(FB_UINT64));
+			memcpy(p + LOW_HALF, &bits2, sizeof(FB_UINT64));
+			return true;
+
+		case dtype_array:
+		case dtype_quad:
+		case dtype_blob:
+			{
+				if (!reader.getFixed(bits, sizeof(ULONG)) || !reader.getFixed(bits2, sizeof(ULONG)))
+					return false;
+				SQUAD* const quad = reinterpret_cast<SQUAD*>(p);
+				quad->gds_quad_high = (SLONG) (ULONG) bits;
+				quad->gds_quad_low = (ULONG) bits2;
+				return true;
+			}
+
+		default:
+			fb_assert(false);
+			return false;
+		}
+	}
+}
+
+
+bool REMOTE_pack_row(const rem_fmt* format, const UCHAR* message, Firebird::UCharBuffer& rows)
+{
+/**************************************
+ *
+ *	R E M O T E _ p a c k _ r o w
+ *
+ **************************************
+ *
+ * Functional description
+ *	Append a row of SQL message to the rows of op_fetch_response
+ *	(PROTOCOL_FETCH_BATCH).  Row is the bitmap of NULL flags
+ *	followed by non-NULL values.  Integers are sent as zigzag
+ *	varints, text and its length (varint) without padding,
+ *	other values most significant byte first.  There's no
+ *	alignment.
+ *
+ **************************************/
+
+	fb_assert(format->fmt_desc.getCount() % 2 == 0);
+
+	const FB_SIZE_T count = format->fmt_desc.getCount() / 2;
+	const FB_SIZE_T flagBytes = (count + 7) / 8;
+
+	// Enough for any row: varints take up to 10 bytes
+
+	const FB_SIZE_T used = rows.getCount();
+	UCHAR* const start = rows.getBuffer(used + flagBytes + format->fmt_length + 10 * count) + used;
+
+	UCHAR* const nulls = start;
+	memset(nulls, 0, flagBytes);
+	UCHAR* ptr = start + flagBytes;
+
+	const dsc* const begin = format->fmt_desc.begin();
+
+	for (FB_SIZE_T i = 0; i < count; i++)
+	{
+		const dsc* const desc = begin + i * 2;
+		const dsc* const flag = desc + 1;
+
+		fb_assert(flag->dsc_dtype == dtype_short);
+
+		if (*reinterpret_cast<const SSHORT*>(message + (IPTR) flag->dsc_address))
+			nulls[i >> 3] |= (1 << (i & 7));
+		else if (!(ptr = packDatum(ptr, desc, message)))
+		{
+			rows.shrink(used);
+			return false;
+		}
+	}
+
+	rows.shrink(ptr - rows.begin());
+	return true;
+}
+
+
+bool REMOTE_unpack_row(const rem_fmt* format, const UCHAR*& rows, const UCHAR* end, UCHAR* message)
+{
+/**************************************
+ *
+ *	R E M O T E _ u n p a c k _ r o w
+ *
+ **************************************
+ *
+ * Functional description
+ *	Move a row packed by REMOTE_pack_row into the message
+ *	and advance the rows pointer past it.  Return false if
+ *	the row is damaged.
+ *
+ **************************************/
+
+	fb_assert(format->fmt_desc.getCount() % 2 == 0);
+
+	const FB_SIZE_T count = format->fmt_desc.getCount() / 2;
+	const FB_SIZE_T flagBytes = (count + 7) / 8;
+
+	if ((FB_SIZE_T) (end - rows) < flagBytes)
+		return false;
+
+	const UCHAR* const nulls = rows;
+	RowReader reader(rows + flagBytes, end);
+
+	memset(message, 0, format->fmt_length);
+
+	const dsc* const begin = format->fmt_desc.begin();
+
+	for (FB_SIZE_T i = 0; i < count; i++)
+	{
+		const dsc* const desc = begin + i * 2;
+		const dsc* const flag = desc + 1;
+
+		if (nulls[i >> 3] & (1 << (i & 7)))
+			*reinterpret_cast<SSHORT*>(message + (IPTR) flag->dsc_address) = -1;
+		else if (!unpackDatum(reader, desc, message))
+			return false;
+	}
+
+	rows = reader.getPosition();
+	return true;
+}
+
 Rrq* REMOTE_find_request(Rrq* request, USHORT level)
 {
 /**************************************
@@ -567,6 +1078,8 @@ void REMOTE_reset_statement( Rsr* statement)
 	statement->rsr_msgs_waiting = 0;
 	statement->rsr_reorder_level = 0;
 	statement->rsr_batch_count = 0;
+	statement->rsr_fetch_time = 0;
+	statement->rsr_fetch_stalled = false;
 
 	// only one entry
 
@@ -100,6 +100,11 @@ const ULONG MAX_ROWS_PER_BATCH = 1000;
 
 const ULONG MAX_BATCH_CACHE_SIZE = 1024 * 1024; // 1 MB
 
+// Adaptive fetch constants (ClientAdaptiveFetch)
+
+const USHORT MAX_FETCH_BATCHES = 4;		// batches asked in advance
+const ULONG MIN_ADAPTIVE_FETCH_RTT = 1;	// ms, faster links don't need adapting
+
 // fwd. decl.
 namespace Firebird {
 	class Exception;
@@ -482,6 +487,11 @@ struct Rsr : public Firebird::GlobalStorage, public TypedHandle<rem_type_rsr>
 	USHORT			rsr_msgs_waiting; 	// count of full rsr_messages
 	USHORT			rsr_reorder_level; 	// Trigger pipelining at this level
 	USHORT			rsr_batch_count; 	// Count of batches in pipeline
+	USHORT			rsr_fetch_rows;		// Rows asked by op_fetch in adaptive mode
+	USHORT			rsr_fetch_depth;	// Batches kept in pipeline in adaptive mode, zero if not adaptive
+	SINT64			rsr_fetch_time;		// When op_fetch was sent into empty pipeline
+	ULONG			rsr_fetch_rtt;		// Last round trip time measured, ms
+	bool			rsr_fetch_stalled;	// Fetch had to wait for rows on the way
 
 	Firebird::string rsr_cursor_name;	// Name for cursor to be set on open
 	bool			rsr_delayed_format;	// Out format was delayed on execute, set it on fetch
@@ -543,6 +553,7 @@ public:
 		rsr_format(0), rsr_message(0), rsr_buffer(0), rsr_status(0),
 		rsr_id(0), rsr_fmt_length(0),
 		rsr_rows_pending(0), rsr_msgs_waiting(0), rsr_reorder_level(0), rsr_batch_count(0),
+		rsr_fetch_rows(0), rsr_fetch_depth(0), rsr_fetch_time(0), rsr_fetch_rtt(0), rsr_fetch_stalled(false),
 		rsr_cursor_name(getPool()), rsr_delayed_format(false), rsr_timeout(0), rsr_self(NULL)
 	{ }
 
@@ -662,6 +673,7 @@ inline void Rsr::releaseException()
 // fwd. decl.
 struct p_cnct;
 struct rmtque;
+struct server_req_t;	// defined in server.cpp
 struct xcc; // defined in xnet.h
 
 // Queue of deferred packets
@@ -1047,6 +1059,7 @@ struct rem_port : public Firebird::GlobalStorage, public Firebird::RefCounted
 	SLONG			port_dummy_timeout;	// time remaining until keepalive packet
 	SOCKET			port_handle;		// handle for INET socket
 	SOCKET			port_channel;		// handle for connection (from by OS)
+	SOCKET			port_armed;			// handle waited for by INET dispatcher's epoll set
 	struct linger	port_linger;		// linger value as defined by SO_LINGER
 	Rdb*			port_context;
 	Thread::Handle	port_events_thread;	// handle of thread, handling incoming events
@@ -1075,6 +1088,8 @@ struct rem_port : public Firebird::GlobalStorage, public Firebird::RefCounted
 	Rsr*			port_statement;			// Statement for execute immediate
 	rmtque*			port_receive_rmtque;	// for client, responses waiting
 	Firebird::AtomicCounter	port_requests_queued;	// requests currently queued
+	server_req_t*	port_server_request;	// first request queued or processed by server
+	ULONG			port_worker;			// id of server worker which processed last request
 	xcc*			port_xcc;				// interprocess structure
 	PacketQueue*	port_deferred_packets;	// queue of deferred packets
 	OBJCT			port_last_object_id;	// cached last id
@@ -1122,7 +1137,8 @@ public:
 		port_parent(0), port_async(0), port_async_receive(0),
 		port_server(0), port_server_flags(0), port_protocol(0), port_buff_size(rpt / 2),
 		port_flags(0), port_connect_timeout(0), port_dummy_packet_interval(0),
-		port_dummy_timeout(0), port_handle(INVALID_SOCKET), port_channel(INVALID_SOCKET), port_context(0),
+		port_dummy_timeout(0), port_handle(INVALID_SOCKET), port_channel(INVALID_SOCKET),
+		port_armed(INVALID_SOCKET), port_context(0),
 		port_events_thread(0), port_events_threadId(0), port_thread_guard(0),
 #ifdef WIN_NT
 		port_pipe(INVALID_HANDLE_VALUE), port_event(INVALID_HANDLE_VALUE),
@@ -1135,7 +1151,8 @@ public:
 		port_user_name(getPool()), port_peer_name(getPool()),
 		port_protocol_id(getPool()), port_address(getPool()),
 		port_rpr(0), port_statement(0), port_receive_rmtque(0),
-		port_requests_queued(0), port_xcc(0), port_deferred_packets(0), port_last_object_id(0),
+		port_requests_queued(0), port_server_request(NULL), port_worker(0),
+		port_xcc(0), port_deferred_packets(0), port_last_object_id(0),
 		port_queue(getPool()), port_qoffset(0),
 		port_srv_auth(NULL), port_srv_auth_block(NULL),
 		port_crypt_keys(getPool()), port_crypt_complete(false), port_crypt_level(WIRECRYPT_REQUIRED),
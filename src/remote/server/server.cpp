@@ -90,6 +90,75 @@ public:
 	server_req_t() : req_next(0), req_chain(0) { }
 };
 
+// Requests waiting for a worker thread, linked by req_next
+
+class RequestQueue
+{
+public:
+	RequestQueue() : m_head(NULL), m_tail(NULL) { }
+
+	bool isEmpty() const
+	{
+		return !m_head;
+	}
+
+	void put(server_req_t* request)
+	{
+		request->req_next = NULL;
+
+		if (m_tail)
+			m_tail->req_next = request;
+		else
+			m_head = request;
+
+		m_tail = request;
+	}
+
+	server_req_t* get()
+	{
+		server_req_t* const request = m_head;
+
+		if (request)
+		{
+			m_head = request->req_next;
+			if (!m_head)
+				m_tail = NULL;
+
+			request->req_next = NULL;
+		}
+
+		return request;
+	}
+
+	// move all requests of other queue to the end of this one
+	void putAll(RequestQueue& other)
+	{
+		if (!other.m_head)
+			return;
+
+		if (m_tail)
+			m_tail->req_next = other.m_head;
+		else
+			m_head = other.m_head;
+
+		m_tail = other.m_tail;
+		other.m_head = other.m_tail = NULL;
+	}
+
+	int getCount() const
+	{
+		int count = 0;
+		for (const server_req_t* request = m_head; request; request = request->req_next)
+			count++;
+
+		return count;
+	}
+
+private:
+	server_req_t* m_head;
+	server_req_t* m_tail;
+};
+
 struct srvr : public GlobalStorage
 {
 	srvr* const srvr_next;
@@ -1174,7 +1243,7 @@ static bool		link_request(rem_port*, server_req_t*);
 static bool		accept_connection(rem_port*, P_CNCT*, PACKET*);
 static ISC_STATUS	allocate_statement(rem_port*, /*P_RLSE*,*/ PACKET*);
 static void		append_request_chain(server_req_t*, server_req_t**);
-static void		append_request_next(server_req_t*, server_req_t**);
+static bool		append_request_next(server_req_t*);
 static void		attach_database(rem_port*, P_OP, P_ATCH*, PACKET*);
 static void		attach_service(rem_port*, P_ATCH*, PACKET*);
 static bool		continue_authentication(rem_port*, PACKET*, PACKET*);
@@ -1232,8 +1301,9 @@ class Worker
 public:
 	static const int MAX_THREADS = MAX_SLONG;
 	static const int IDLE_TIMEOUT = 60;
+	static const int OWN_RUN_LIMIT = 16;	// own requests taken before looking at request_que
 
-	Worker();
+	explicit Worker(USHORT flags);
 	~Worker();
 
 	bool wait(int timeout = IDLE_TIMEOUT);	// true is success, false if timeout
@@ -1248,12 +1318,33 @@ public:
 
 	static void shutdown();
 
+	// Port is bound to the worker which processed its last request, next
+	// requests of the port wait in the queue of that worker, so consecutive
+	// packets of the port tend to be handled by the same thread. Requests of
+	// not bound ports wait in request_que. Worker takes requests from its own
+	// queue first, then from request_que, then steals them from other workers.
+	// After OWN_RUN_LIMIT own requests in a row request_que is served first, so
+	// busy bound ports can't starve the not bound ones.
+	// Both functions are called with request_que_mutex locked.
+
+	static bool putRequest(server_req_t* request);	// true if bound worker was woken up
+	server_req_t* getRequest();
+
+	static ULONG generate(const Worker* item)
+	{
+		return item->m_id;
+	}
+
 private:
 	Worker* m_next;
 	Worker* m_prev;
 	Semaphore m_sem;
 	bool	m_active;
 	bool	m_going;		// thread was timedout and going to be deleted
+	ULONG	m_id;
+	USHORT	m_flags;		// passed to start() of replacement thread
+	int		m_ownRun;		// own requests taken in a row
+	RequestQueue m_requests;	// requests of ports bound to this worker
 #ifdef DEV_BUILD
 	ThreadId	m_tid;
 #endif
@@ -1261,31 +1352,37 @@ private:
 	void remove();
 	void insert(const bool active);
 	static void wakeUpAll();
+	static Worker* find(ULONG id);
+
+	typedef SortedArray<Worker*, EmptyStorage<Worker*>, ULONG, Worker> WorkerArray;
 
 	static Worker* m_activeWorkers;
 	static Worker* m_idleWorkers;
+	static GlobalPtr<WorkerArray> m_workers;	// all workers ordered by id
 	static GlobalPtr<Mutex> m_mutex;
 	static int m_cntAll;
 	static int m_cntIdle;
 	static int m_cntGoing;
+	static ULONG m_lastId;
 	static bool shutting_down;
 };
 
 Worker* Worker::m_activeWorkers = NULL;
 Worker* Worker::m_idleWorkers = NULL;
+GlobalPtr<Worker::WorkerArray> Worker::m_workers;
 GlobalPtr<Mutex> Worker::m_mutex;
 int Worker::m_cntAll = 0;
 int Worker::m_cntIdle = 0;
 int Worker::m_cntGoing = 0;
+ULONG Worker::m_lastId = 0;
 bool Worker::shutting_down = false;
 
 
 static GlobalPtr<Mutex> request_que_mutex;
-static server_req_t* request_que		= NULL;
+static RequestQueue request_que;				// requests of ports not bound to worker
 static server_req_t* free_requests		= NULL;
-static server_req_t* active_requests	= NULL;
-static int ports_active					= 0;	// length of active_requests
-static int ports_pending				= 0;	// length of request_que
+static int ports_active					= 0;	// requests being processed
+static int ports_pending				= 0;	// requests in request_que and workers queues
 
 static GlobalPtr<Mutex> servers_mutex;
 static srvr* servers = NULL;
@@ -1528,50 +1625,39 @@ static bool link_request(rem_port* port, server_req_t* request)
  **************************************
  *
  * Functional description
- *	Search for a port in a queue,
- *	if found - append new request to it.
+ *	If port has a request queued or processed,
+ *	append new request to it, else queue it.
+ *	Return false if a worker should be woken
+ *	up to handle the request.
  *
  **************************************/
 	const P_OP operation = request->req_receive.p_operation;
-	server_req_t* queue;
 
 	MutexLockGuard queGuard(request_que_mutex, FB_FUNCTION);
 
-	bool active = true;
-	queue = active_requests;
+	server_req_t* const queue = port->port_server_request;
+	bool woken = false;
 
-	while (true)
+	if (queue)
 	{
-		for (; queue; queue = queue->req_next)
+		// Don't queue a dummy keepalive packet if there is a request on this port
+		if (operation == op_dummy)
 		{
-			if (queue->req_port == port)
-			{
-				// Don't queue a dummy keepalive packet if there is a request on this port
-				if (operation == op_dummy)
-				{
-					free_request(request);
-					return true;
-				}
+			free_request(request);
+			return true;
+		}
 
-				append_request_chain(request, &queue->req_chain);
+		append_request_chain(request, &queue->req_chain);
 #ifdef DEBUG_REMOTE_MEMORY
-				printf("link_request %s request_queued %d\n",
-					active ? "ACTIVE" : "PENDING", port->port_requests_queued.value());
-				fflush(stdout);
+		printf("link_request request_queued %d\n", port->port_requests_queued.value());
+		fflush(stdout);
 #endif
-				break;
-			}
-		}
-
-		if (queue || !active)
-			break;
-
-		queue = request_que;
-		active = false;
 	}
-
-	if (!queue)
-		append_request_next(request, &request_que);
+	else
+	{
+		port->port_server_request = request;
+		woken = append_request_next(request);
+	}
 
 	++port->port_requests_queued;
 
@@ -1582,7 +1668,7 @@ static bool link_request(rem_port* port, server_req_t* request)
 		return true;
 	}
 
-	return false;
+	return woken;
 }
 
 
@@ -1930,7 +2016,7 @@ static bool accept_connection(rem_port* port, P_CNCT* connect, PACKET* send)
 	{
 		if ((protocol->p_cnct_version == PROTOCOL_VERSION10 ||
 			 (protocol->p_cnct_version >= PROTOCOL_VERSION11 &&
-			  protocol->p_cnct_version <= PROTOCOL_VERSION16)) &&
+			  protocol->p_cnct_version <= PROTOCOL_VERSION17)) &&
 			 (protocol->p_cnct_architecture == arch_generic ||
 			  protocol->p_cnct_architecture == ARCHITECTURE) &&
 			protocol->p_cnct_weight >= weight)
@@ -2268,7 +2354,7 @@ static void append_request_chain(server_req_t* request, server_req_t** que_inst)
 }
 
 
-static void append_request_next(server_req_t* request, server_req_t** que_inst)
+static bool append_request_next(server_req_t* request)
 {
 /**************************************
  *
@@ -2277,18 +2363,16 @@ static void append_request_next(server_req_t* request, server_req_t** que_inst)
  **************************************
  *
  * Functional description
- *	Traverse using req_next ptr and append
- *	a request at the end of a que.
- *	Return count of pending requests.
+ *	Append a request at the end of a queue
+ *	of worker bound to its port or of common
+ *	queue. Return true if bound worker was
+ *	woken up to handle it.
  *
  **************************************/
 	MutexLockGuard queGuard(request_que_mutex, FB_FUNCTION);
 
-	while (*que_inst)
-		que_inst = &(*que_inst)->req_next;
-
-	*que_inst = request;
 	ports_pending++;
+	return Worker::putRequest(request);
 }
 
 
@@ -3963,6 +4047,12 @@ ISC_STATUS rem_port::fetch(P_SQLDATA * sqldata, PACKET* sendL)
 	response->p_sqldata_messages = 1;
 	RMessage* message = NULL;
 
+	// Since PROTOCOL_FETCH_BATCH rows are collected and sent together
+
+	const bool packed = this->port_protocol >= PROTOCOL_FETCH_BATCH;
+	UCharBuffer rows;
+	USHORT row_count = 0;
+
 	// Check to see if any messages are already sitting around
 
 	const FB_UINT64 org_packets = this->port_snd_packets;
@@ -3981,8 +4071,12 @@ ISC_STATUS rem_port::fetch(P_SQLDATA * sqldata, PACKET* sendL)
 		}
 
 		// Have we exhausted the cache & have a pending error?
+		// Rows collected go first, error is returned by the next fetch.
 		if (statement->rsr_flags.test(Rsr::STREAM_ERR) && !statement->rsr_msgs_waiting)
 		{
+			if (row_count)
+				break;
+
 			fb_assert(statement->rsr_status);
 			statement->rsr_flags.clear(Rsr::STREAM_ERR);
 			return this->send_response(sendL, 0, 0, statement->rsr_status->value(), false);
@@ -4006,7 +4100,15 @@ ISC_STATUS rem_port::fetch(P_SQLDATA * sqldata, PACKET* sendL)
 			statement->rsr_flags.set(Rsr::FETCHED);
 
 			if (status_vector.getState() & Firebird::IStatus::STATE_ERRORS)
-				return this->send_response(sendL, 0, 0, &status_vector, false);
+			{
+				if (!row_count)
+					return this->send_response(sendL, 0, 0, &status_vector, false);
+
+				statement->rsr_flags.set(Rsr::STREAM_ERR);
+				statement->saveException(&status_vector, true);
+				rc = true;
+				break;
+			}
 
 			if (!rc)
 				break;
@@ -4022,21 +4124,35 @@ ISC_STATUS rem_port::fetch(P_SQLDATA * sqldata, PACKET* sendL)
 
 		// There's a buffer waiting -- send it
 
-		if (!this->send_partial(sendL))
+		if (packed)
+		{
+			// Advance the buffer as xdr_sql_message() does
+
+			statement->rsr_buffer = message->msg_next;
+
+			if (!REMOTE_pack_row(statement->rsr_format, message->msg_address, rows))
+				return FALSE;
+
+			row_count++;
+		}
+		else if (!this->send_partial(sendL))
 			return FALSE;
 
 		message->msg_address = NULL;
 
 		// If we've hit maximum prefetch size, break out of loop
 
-		const USHORT packets = this->port_snd_packets - org_packets;
+		const ULONG packets = packed ? rows.getCount() / this->port_buff_size :
+			this->port_snd_packets - org_packets;
 
 		if (packets >= MAX_PACKETS_PER_BATCH && count >= MIN_ROWS_PER_BATCH)
 			break;
 	}
 
 	response->p_sqldata_status = rc ? 0 : 100;
-	response->p_sqldata_messages = 0;
+	response->p_sqldata_messages = row_count;
+	response->p_sqldata_rows.cstr_length = rows.getCount();
+	response->p_sqldata_rows.cstr_address = rows.begin();
 
 	// hvlad: message->msg_address not used in xdr_protocol because of
 	// response->p_sqldata_messages set to zero above.
@@ -4051,6 +4167,9 @@ ISC_STATUS rem_port::fetch(P_SQLDATA * sqldata, PACKET* sendL)
 
 	this->send(sendL);
 
+	response->p_sqldata_rows.cstr_length = 0;
+	response->p_sqldata_rows.cstr_address = NULL;
+
 	// Since we have a little time on our hands while this packet is sent
 	// and processed, get the next batch of records.  Start by finding the
 	// next free buffer.
@@ -4061,7 +4180,8 @@ ISC_STATUS rem_port::fetch(P_SQLDATA * sqldata, PACKET* sendL)
 	while (message->msg_address && message->msg_next != statement->rsr_buffer)
 		message = message->msg_next;
 
-	USHORT prefetch_count = (rc && !statement->rsr_flags.test(Rsr::NO_BATCH)) ? count : 0;
+	USHORT prefetch_count =
+		(rc && !statement->rsr_flags.test(Rsr::NO_BATCH | Rsr::STREAM_ERR)) ? count : 0;
 
 	for (; prefetch_count; --prefetch_count)
 	{
@@ -5306,7 +5426,7 @@ ISC_STATUS rem_port::receive_after_start(P_DATA* data, PACKET* sendL, IStatus* s
 
 	data->p_data_message_number = msg_number;
 	data->p_data_messages = REMOTE_compute_batch_size(this,
-		(USHORT) xdr_protocol_overhead(op_response_piggyback), op_send, format);
+		(USHORT) xdr_protocol_overhead(op_response_piggyback, port_protocol), op_send, format);
 
 	return this->receive_msg(data, sendL);
 }
@@ -6413,7 +6533,7 @@ ISC_STATUS rem_port::start_transaction(P_OP operation, P_STTR * stuff, PACKET* s
 }
 
 
-static THREAD_ENTRY_DECLARE loopThread(THREAD_ENTRY_PARAM)
+static THREAD_ENTRY_DECLARE loopThread(THREAD_ENTRY_PARAM arg)
 {
 /**************************************
  *
@@ -6430,20 +6550,18 @@ static THREAD_ENTRY_DECLARE loopThread(THREAD_ENTRY_PARAM)
 
 	FpeControl::maskAll();
 
-	Worker worker;
+	Worker worker((USHORT)(IPTR) arg);
 
 	while (!Worker::isShuttingDown())
 	{
 		MutexEnsureUnlock reqQueGuard(request_que_mutex, FB_FUNCTION);
 		reqQueGuard.enter();
-		server_req_t* request = request_que;
+		server_req_t* request = worker.getRequest();
 		if (request)
 		{
 			worker.setState(true);
 
-			REMOTE_TRACE(("Dequeue request %p", request_que));
-			request_que = request->req_next;
-			ports_pending--;
+			REMOTE_TRACE(("Dequeue request %p", request));
 			reqQueGuard.leave();
 
 			while (request)
@@ -6455,19 +6573,21 @@ static THREAD_ENTRY_DECLARE loopThread(THREAD_ENTRY_PARAM)
 				if (request->req_port->port_server_flags & SRVR_thread_per_port)
 				{
 					port = request->req_port;
+					{ // scope
+						MutexLockGuard queGuard(request_que_mutex, FB_FUNCTION);
+						port->port_server_request = NULL;
+					}
 					free_request(request);
 
 					SRVR_main(port, port->port_server_flags);
 					request = 0;
 					continue;
 				}
-				// Splice request into list of active requests, execute request,
-				// and unsplice
+				// Request stays port_server_request of its port while executed, so
+				// requests arriving meanwhile are chained to it
 
 				{ // scope
 					MutexLockGuard queGuard(request_que_mutex, FB_FUNCTION);
-					request->req_next = active_requests;
-					active_requests = request;
 					ports_active++;
 				}
 
@@ -6533,18 +6653,7 @@ static THREAD_ENTRY_DECLARE loopThread(THREAD_ENTRY_PARAM)
 				{ // request_que_mutex scope
 					MutexLockGuard queGuard(request_que_mutex, FB_FUNCTION);
 
-					// Take request out of list of active requests
-
-					for (server_req_t** req_ptr = &active_requests; *req_ptr;
-						req_ptr = &(*req_ptr)->req_next)
-					{
-						if (*req_ptr == request)
-						{
-							*req_ptr = request->req_next;
-							ports_active--;
-							break;
-						}
-					}
+					ports_active--;
 
 					// If this is a explicit or implicit disconnect, get rid of
 					// any chained requests
@@ -6557,6 +6666,8 @@ static THREAD_ENTRY_DECLARE loopThread(THREAD_ENTRY_PARAM)
 							request->req_chain = next->req_chain;
 							free_request(next);
 						}
+						request->req_port->port_server_request = NULL;
+
 						if (request->req_send.p_operation == op_void &&
 							request->req_receive.p_operation == op_void)
 						{
@@ -6578,18 +6689,18 @@ static THREAD_ENTRY_DECLARE loopThread(THREAD_ENTRY_PARAM)
 					if (request)
 					{
 						server_req_t* next = request->req_chain;
+						request->req_port->port_server_request = next;
 						free_request(request);
 						//request = next;
 
 						// Try to be fair - put new request at the end of waiting
 						// requests queue and take request to work on from the
-						// head of the queue
+						// head of the queue. Port is bound to this worker now,
+						// so its request is put into our own queue.
 						if (next)
 						{
-							append_request_next(next, &request_que);
-							request = request_que;
-							request_que = request->req_next;
-							ports_pending--;
+							append_request_next(next);
+							request = worker.getRequest();
 						}
 						else {
 							request = NULL;
@@ -6778,8 +6889,10 @@ static void zap_packet(PACKET* packet, bool new_packet)
 
 
 
-Worker::Worker()
+Worker::Worker(USHORT flags)
 {
+	m_flags = flags;
+	m_ownRun = 0;
 	m_active = false;
 	m_going = false;
 	m_next = m_prev = NULL;
@@ -6788,16 +6901,43 @@ Worker::Worker()
 #endif
 
 	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+	m_id = ++m_lastId;
+	m_workers->add(this);
 	insert(m_active);
 }
 
 Worker::~Worker()
 {
-	MutexLockGuard guard(m_mutex, FB_FUNCTION);
-	remove();
-	--m_cntAll;
-	if (m_going)
-		--m_cntGoing;
+	bool moved;
+	{	// request_que_mutex scope
+		// Don't lose requests of bound ports if thread is exiting due to error
+		MutexLockGuard reqQueGuard(request_que_mutex, FB_FUNCTION);
+		moved = !m_requests.isEmpty();
+		request_que.putAll(m_requests);
+
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+		FB_SIZE_T pos;
+		if (m_workers->find(m_id, pos))
+			m_workers->remove(pos);
+
+		remove();
+		--m_cntAll;
+		if (m_going)
+			--m_cntGoing;
+	}
+
+	// Nobody was woken up for the requests moved to request_que
+	if (moved)
+	{
+		try
+		{
+			start(m_flags);
+		}
+		catch (const Exception& ex)
+		{
+			iscLogException("Error while starting worker thread", ex);
+		}
+	}
 }
 
 
@@ -6834,24 +6974,18 @@ void Worker::setState(const bool active)
 bool Worker::wakeUp()
 {
 	MutexLockGuard reqQueGuard(request_que_mutex, FB_FUNCTION);
+	MutexLockGuard guard(m_mutex, FB_FUNCTION);
 
 #ifdef _DEBUG
-	int cnt = 0;
-	for (server_req_t* req = request_que; req; req = req->req_next)
-		cnt++;
+	int cnt = request_que.getCount();
+	for (Worker** worker = m_workers->begin(); worker < m_workers->end(); worker++)
+		cnt += (*worker)->m_requests.getCount();
 	fb_assert(cnt == ports_pending);
-
-	cnt = 0;
-	for (server_req_t* req = active_requests; req; req = req->req_next)
-		cnt++;
-	fb_assert(cnt == ports_active);
 #endif
 
 	if (!ports_pending)
 		return true;
 
-	MutexLockGuard guard(m_mutex, FB_FUNCTION);
-
 	if (m_idleWorkers)
 	{
 		Worker* idle = m_idleWorkers;
@@ -6866,6 +7000,75 @@ bool Worker::wakeUp()
 	return (m_cntAll - m_cntGoing >= MAX_THREADS);
 }
 
+bool Worker::putRequest(server_req_t* request)
+{
+	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+	Worker* const worker = find(request->req_port->port_worker);
+	if (!worker)
+	{
+		request_que.put(request);
+		return false;
+	}
+
+	worker->m_requests.put(request);
+
+	// If bound worker is busy, let an idle one steal the request
+	if (worker->m_active)
+		return false;
+
+	worker->setState(true);
+	worker->m_sem.release();
+	return true;
+}
+
+server_req_t* Worker::getRequest()
+{
+	server_req_t* request = NULL;
+
+	if (m_ownRun < OWN_RUN_LIMIT)
+		request = m_requests.get();
+
+	if (request)
+		m_ownRun++;
+	else
+	{
+		m_ownRun = 0;
+		request = request_que.get();
+
+		if (!request)
+			request = m_requests.get();
+	}
+
+	if (!request)
+	{
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+		for (Worker** worker = m_workers->begin(); !request && worker < m_workers->end(); worker++)
+			request = (*worker)->m_requests.get();
+	}
+
+	if (request)
+	{
+		ports_pending--;
+		request->req_port->port_worker = m_id;
+	}
+
+	return request;
+}
+
+Worker* Worker::find(ULONG id)
+{
+	WorkerArray& workers = m_workers;
+
+	FB_SIZE_T pos;
+	if (!id || !workers.find(id, pos))
+		return NULL;
+
+	Worker* const worker = workers[pos];
+	return worker->m_going ? NULL : worker;
+}
+
 void Worker::wakeUpAll()
 {
 	MutexLockGuard guard(m_mutex, FB_FUNCTION);
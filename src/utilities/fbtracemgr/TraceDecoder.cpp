@@ -0,0 +1,420 @@
+/*
+ *	PROGRAM:		Firebird utilities
+ *	MODULE:			TraceDecoder.cpp
+ *	DESCRIPTION:	Decoder of binary trace log
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird Project.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ *
+ */
+
+#include "firebird.h"
+#include "../../utilities/fbtracemgr/TraceDecoder.h"
+#include "../../common/classes/array.h"
+#include "../../common/classes/auto.h"
+#include "../../common/classes/timestamp.h"
+#include "../../common/StatusArg.h"
+#include "../../common/os/os_utils.h"
+#include "iberror.h"
+
+#ifdef WIN_NT
+#define NEWLINE "\r\n"
+#else
+#define NEWLINE "\n"
+#endif
+
+using namespace TraceBinary;
+
+namespace
+{
+	const char* const TABLE_COUNTER_NAMES[TABLE_COUNTERS] =
+		{"natural", "index", "update", "insert", "delete", "backout", "purge", "expunge"};
+
+	void damaged(const char* fileName, FB_UINT64 offset)
+	{
+		Firebird::string message;
+		message.printf("binary trace log \"%s\" is damaged at offset %" UQUADFORMAT, fileName, offset);
+
+		(Firebird::Arg::Gds(isc_random) << message).raise();
+	}
+}
+
+namespace Firebird {
+
+TraceDecoder::TraceDecoder(MemoryPool& pool, bool json)
+	: m_json(json),
+	  m_strings(pool),
+	  m_output(pool)
+{
+}
+
+void TraceDecoder::decode(const char* fileName)
+{
+	AutoPtr<FILE> file(os_utils::fopen(fileName, "rb"));
+
+	if (!file)
+	{
+		(Arg::Gds(isc_io_error) << Arg::Str("fopen") << Arg::Str(fileName) <<
+			Arg::Gds(isc_io_open_err) << Arg::OsError()).raise();
+	}
+
+	HalfStaticArray<UCHAR, 4096> body;
+	FB_UINT64 offset = 0;
+	Header header;
+
+	while (fread(&header, sizeof(header), 1, file) == 1)
+	{
+		if (header.version != VERSION_1)
+		{
+			if (header.version == ((VERSION_1 & 0xFF) << 8))
+			{
+				string message;
+				message.printf("binary trace log \"%s\" was written on platform with different byte order",
+					fileName);
+
+				(Arg::Gds(isc_random) << message).raise();
+			}
+
+			damaged(fileName, offset);
+		}
+
+		if (header.length < sizeof(header) || header.length % ALIGNMENT)
+			damaged(fileName, offset);
+
+		const ULONG length = header.length - sizeof(header);
+
+		if (length && fread(body.getBuffer(length), length, 1, file) != 1)
+			damaged(fileName, offset);
+
+		switch (header.type)
+		{
+		case TYPE_STRING:
+			putString(header, body.begin(), length);
+			break;
+
+		case TYPE_EVENT:
+			putEvent(header, body.begin(), length);
+			break;
+
+		default:
+			// Records of unknown types are skipped
+			break;
+		}
+
+		if (m_output.hasData())
+		{
+			fwrite(m_output.c_str(), m_output.length(), 1, stdout);
+			m_output.erase();
+		}
+
+		offset += header.length;
+	}
+
+	if (!feof(file))
+		damaged(fileName, offset);
+
+	fflush(stdout);
+}
+
+void TraceDecoder::putString(const Header& header, const UCHAR* body, ULONG length)
+{
+	String str;
+
+	if (length < sizeof(str))
+		return;
+
+	memcpy(&str, body, sizeof(str));
+
+	if (str.length > length - sizeof(str))
+		return;
+
+	StringKey key;
+	key.processId = header.processId;
+	key.source = header.source;
+	key.id = str.id;
+
+	m_strings.put(key, string(reinterpret_cast<const char*>(body + sizeof(str)), str.length));
+}
+
+const string* TraceDecoder::getString(const Header& header, ULONG id) const
+{
+	if (!id)
+		return NULL;
+
+	StringKey key;
+	key.processId = header.processId;
+	key.source = header.source;
+	key.id = id;
+
+	return m_strings.get(key);
+}
+
+void TraceDecoder::putEvent(const Header& header, const UCHAR* body, ULONG length)
+{
+	Event event;
+
+	if (length < sizeof(event))
+		return;
+
+	memcpy(&event, body, sizeof(event));
+
+	const ULONG tablesLength = event.tableCount * sizeof(TableCounts);
+
+	if (event.tableCount > length / sizeof(TableCounts) ||
+		sizeof(event) + tablesLength + event.textLength > length)
+	{
+		return;
+	}
+
+	HalfStaticArray<TableCounts, 16> tables;
+	memcpy(tables.getBuffer(event.tableCount), body + sizeof(event), tablesLength);
+
+	const string text(reinterpret_cast<const char*>(body + sizeof(event) + tablesLength), event.textLength);
+
+	if (m_json)
+		printJson(header, event, tables.begin(), text.c_str());
+	else
+		printText(header, event, tables.begin(), text.c_str());
+}
+
+void TraceDecoder::printText(const Header& header, const Event& event,
+	const TableCounts* tables, const char* text)
+{
+	// Layout is the same as trace plugin produces in text mode
+
+	struct tm times;
+	const TimeStamp stamp(header.timestamp);
+	stamp.decode(&times);
+
+	const string* const action = getString(header, event.action);
+
+	string temp;
+	temp.printf("%04d-%02d-%02dT%02d:%02d:%02d.%04d (%d:%p) %s" NEWLINE,
+		times.tm_year + 1900, times.tm_mon + 1, times.tm_mday, times.tm_hour,
+		times.tm_min, times.tm_sec, (int) (header.timestamp.timestamp_time % ISC_TIME_SECONDS_PRECISION),
+		(int) header.processId, (void*) (IPTR) header.source, action ? action->c_str() : "<unknown event>");
+	m_output += temp;
+
+	const ULONG descriptions[] = {event.connection, event.transaction, event.object};
+
+	for (FB_SIZE_T i = 0; i < FB_NELEM(descriptions); i++)
+	{
+		if (descriptions[i])
+		{
+			const string* const description = getString(header, descriptions[i]);
+
+			if (description)
+				m_output += *description;
+			else
+			{
+				temp.printf("\t<unknown text %u>" NEWLINE, descriptions[i]);
+				m_output += temp;
+			}
+		}
+	}
+
+	m_output += text;
+
+	if (event.flags & FLAG_PERF)
+	{
+		const char* const pageNames[PAGE_COUNTERS] = {"read(s)", "write(s)", "fetch(es)", "mark(s)"};
+
+		temp.printf("%7" QUADFORMAT"d ms", event.time);
+		m_output += temp;
+
+		for (int i = 0; i < PAGE_COUNTERS; i++)
+		{
+			if (event.pages[i])
+			{
+				temp.printf(", %" QUADFORMAT"d %s", event.pages[i], pageNames[i]);
+				m_output += temp;
+			}
+		}
+
+		m_output += NEWLINE;
+	}
+
+	if (event.tableCount)
+	{
+		const TableCounts* const end = tables + event.tableCount;
+
+		FB_SIZE_T maxLength = 32;
+
+		for (const TableCounts* table = tables; table < end; table++)
+		{
+			const string* const name = getString(header, table->relation);
+
+			if (name && name->length() > maxLength)
+				maxLength = name->length();
+		}
+
+		m_output += NEWLINE "Table";
+		m_output.append(maxLength - 5, ' ');
+		m_output += "   Natural     Index    Update    Insert    Delete   Backout     Purge   Expunge" NEWLINE;
+		m_output.append(maxLength + 80, '*');
+		m_output += NEWLINE;
+
+		for (const TableCounts* table = tables; table < end; table++)
+		{
+			const string* const name = getString(header, table->relation);
+			const char* const relation = name ? name->c_str() : "<unknown>";
+
+			m_output += relation;
+			m_output.append(maxLength - fb_strlen(relation), ' ');
+
+			for (int j = 0; j < TABLE_COUNTERS; j++)
+			{
+				if (table->counters[j] == 0)
+					m_output.append(10, ' ');
+				else
+				{
+					temp.printf("%10" QUADFORMAT"d", table->counters[j]);
+					m_output += temp;
+				}
+			}
+
+			m_output += NEWLINE;
+		}
+	}
+
+	m_output += NEWLINE;
+}
+
+void TraceDecoder::printJson(const Header& header, const Event& event,
+	const TableCounts* tables, const char* text)
+{
+	struct tm times;
+	const TimeStamp stamp(header.timestamp);
+	stamp.decode(&times);
+
+	string temp;
+	temp.printf("{\"timestamp\":\"%04d-%02d-%02dT%02d:%02d:%02d.%04d\",\"process\":%u,\"source\":\"%p\"",
+		times.tm_year + 1900, times.tm_mon + 1, times.tm_mday, times.tm_hour,
+		times.tm_min, times.tm_sec, (int) (header.timestamp.timestamp_time % ISC_TIME_SECONDS_PRECISION),
+		header.processId, (void*) (IPTR) header.source);
+	m_output += temp;
+
+	const char* const names[] = {"event", "connection", "transaction", "object"};
+	const ULONG ids[] = {event.action, event.connection, event.transaction, event.object};
+
+	for (FB_SIZE_T i = 0; i < FB_NELEM(ids); i++)
+	{
+		const string* const str = getString(header, ids[i]);
+
+		if (str)
+			printJsonString(names[i], str->c_str(), str->length());
+		else if (ids[i])
+		{
+			temp.printf(",\"%s\":null", names[i]);
+			m_output += temp;
+		}
+	}
+
+	printJsonString("text", text, fb_strlen(text));
+
+	if (event.flags & FLAG_PERF)
+	{
+		temp.printf(",\"time\":%" QUADFORMAT"d,\"reads\":%" QUADFORMAT"d,\"writes\":%" QUADFORMAT"d,"
+			"\"fetches\":%" QUADFORMAT"d,\"marks\":%" QUADFORMAT"d",
+			event.time, event.pages[0], event.pages[1], event.pages[2], event.pages[3]);
+		m_output += temp;
+	}
+
+	if (event.tableCount)
+	{
+		m_output += ",\"tables\":[";
+
+		for (ULONG i = 0; i < event.tableCount; i++)
+		{
+			const string* const name = getString(header, tables[i].relation);
+
+			m_output += i ? ",{" : "{";
+
+			if (name)
+				printJsonString(NULL, name->c_str(), name->length());
+			else
+				m_output += "\"name\":null";
+
+			for (int j = 0; j < TABLE_COUNTERS; j++)
+			{
+				temp.printf(",\"%s\":%" QUADFORMAT"d", TABLE_COUNTER_NAMES[j], tables[i].counters[j]);
+				m_output += temp;
+			}
+
+			m_output += "}";
+		}
+
+		m_output += "]";
+	}
+
+	m_output += "}\n";
+}
+
+void TraceDecoder::printJsonString(const char* name, const char* str, FB_SIZE_T length)
+{
+	// Name is omitted for the name of relation which starts the object
+
+	if (name)
+	{
+		m_output += ",\"";
+		m_output += name;
+		m_output += "\":\"";
+	}
+	else
+		m_output += "\"name\":\"";
+
+	for (const char* const end = str + length; str < end; str++)
+	{
+		const UCHAR c = *str;
+
+		switch (c)
+		{
+		case '"':
+			m_output += "\\\"";
+			break;
+
+		case '\\':
+			m_output += "\\\\";
+			break;
+
+		case '\n':
+			m_output += "\\n";
+			break;
+
+		case '\r':
+			m_output += "\\r";
+			break;
+
+		case '\t':
+			m_output += "\\t";
+			break;
+
+		default:
+			if (c < 0x20)
+			{
+				string temp;
+				temp.printf("\\u%04x", c);
+				m_output += temp;
+			}
+			else
+				m_output += c;
+		}
+	}
+
+	m_output += "\"";
+}
+
+} // namespace Firebird
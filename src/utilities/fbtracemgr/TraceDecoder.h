@@ -0,0 +1,83 @@
+/*
+ *	PROGRAM:		Firebird utilities
+ *	MODULE:			TraceDecoder.h
+ *	DESCRIPTION:	Decoder of binary trace log
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird Project.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ *
+ */
+
+#ifndef UTILITIES_TRACE_DECODER_H
+#define UTILITIES_TRACE_DECODER_H
+
+#include "../../common/classes/alloc.h"
+#include "../../common/classes/fb_string.h"
+#include "../../common/classes/GenericMap.h"
+#include "../ntrace/TraceBinary.h"
+
+namespace Firebird {
+
+// Converts binary trace log (see TraceBinary.h) into the text the trace plugin
+// writes in text mode, or into JSON, one object per event and line
+
+class TraceDecoder
+{
+public:
+	TraceDecoder(MemoryPool& pool, bool json);
+
+	void decode(const char* fileName);
+
+private:
+	struct StringKey
+	{
+		ULONG processId;
+		FB_UINT64 source;
+		ULONG id;
+
+		bool operator>(const StringKey& other) const
+		{
+			if (processId != other.processId)
+				return processId > other.processId;
+
+			if (source != other.source)
+				return source > other.source;
+
+			return id > other.id;
+		}
+	};
+
+	typedef GenericMap<Pair<Right<StringKey, string> > > Strings;
+
+	void putString(const TraceBinary::Header& header, const UCHAR* body, ULONG length);
+	void putEvent(const TraceBinary::Header& header, const UCHAR* body, ULONG length);
+
+	const string* getString(const TraceBinary::Header& header, ULONG id) const;
+
+	void printText(const TraceBinary::Header& header, const TraceBinary::Event& event,
+		const TraceBinary::TableCounts* tables, const char* text);
+	void printJson(const TraceBinary::Header& header, const TraceBinary::Event& event,
+		const TraceBinary::TableCounts* tables, const char* text);
+	void printJsonString(const char* name, const char* str, FB_SIZE_T length);
+
+	const bool m_json;
+	Strings m_strings;
+	string m_output;
+};
+
+} // namespace Firebird
+
+#endif // UTILITIES_TRACE_DECODER_H
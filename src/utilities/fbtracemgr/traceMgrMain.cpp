@@ -34,6 +34,7 @@
 #include "../../common/utils_proto.h"
 #include "../../common/os/os_utils.h"
 #include "../../jrd/trace/TraceService.h"
+#include "../../utilities/fbtracemgr/TraceDecoder.h"
 #include "../ibase.h"
 
 #ifdef HAVE_LOCALE_H
@@ -60,6 +61,7 @@ public:
 	virtual void stopSession(ULONG id);
 	virtual void setActive(ULONG id, bool active);
 	virtual void listSessions();
+	virtual void decodeLog(const PathName& fileName, bool json);
 
 private:
 	void runService(size_t spbSize, const UCHAR* spb);
@@ -200,6 +202,12 @@ void TraceSvcUtil::listSessions()
 	runService(spb.getBufferLength(), spb.getBuffer());
 }
 
+void TraceSvcUtil::decodeLog(const PathName& fileName, bool json)
+{
+	TraceDecoder decoder(*getDefaultMemoryPool(), json);
+	decoder.decode(fileName.c_str());
+}
+
 void TraceSvcUtil::runService(size_t spbSize, const UCHAR* spb)
 {
 	os_utils::CtrlCHandler ctrlCHandler;
@@ -51,9 +51,14 @@
 #include "../common/classes/Switches.h"
 #include "../utilities/nbackup/nbkswi.h"
 #include "../common/isc_f_proto.h"
+#include "../common/isc_proto.h"
 #include "../common/StatusArg.h"
 #include "../common/classes/objects_array.h"
+#include "../common/classes/condition.h"
+#include "../common/classes/zip.h"
 #include "../common/os/os_utils.h"
+#include "../common/status.h"
+#include "../common/ThreadStart.h"
 
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
@@ -270,16 +275,110 @@ struct inc_header
 	ULONG prev_scn;			// SCN of previous level backup
 };
 
+// Backup file compressed by nbackup itself starts with zip_header followed
+// by chunks of data compressed independently, to let them be processed in
+// parallel. Each chunk is zip_chunk followed by its data, chunk of zero
+// length ends the file. Restore recognizes such files by signature.
+
+const char zip_signature[4] = {'N','B','K','Z'};
+const SSHORT ZIP_VERSION = 1;
+const ULONG ZIP_CHUNK_SIZE = 256 * 1024;
+const ULONG MAX_ZIP_CHUNK_SIZE = 16 * 1024 * 1024;
+
+struct zip_header
+{
+	char signature[4];		// 'NBKZ'
+	SSHORT version;			// Compressed file format version
+	SSHORT reserved;
+	ULONG chunk_size;		// Maximum length of uncompressed chunk
+};
+
+struct zip_chunk
+{
+	ULONG length;			// Length of uncompressed data
+	ULONG zip_length;		// Length of compressed data, equal to length for data stored as is
+};
+
+class NBackup;
+
+// Pipeline of threads compressing backup file being written or decompressing
+// backup file being read. Chunks of data pass through the ring of slots: file
+// IO is done by one thread at a time in chunks order, while (de)compression of
+// different chunks runs in parallel. Reads of database pages thus overlap with
+// compression and writes of backup file, and decompression overlaps with reads
+// of backup file and writes of restored pages.
+
+class ZipStream
+{
+public:
+	ZipStream(NBackup* nbk, bool writing, unsigned threads, ULONG chunkSize);
+	~ZipStream();
+
+	void put(const void* buffer, FB_SIZE_T length);
+	FB_SIZE_T get(void* buffer, FB_SIZE_T length);
+
+	// Write the rest of data and end of file mark
+	void finish();
+
+private:
+	enum SlotState { SLOT_FREE, SLOT_RAW, SLOT_ZIPPED, SLOT_BUSY };
+
+	struct Slot
+	{
+		SlotState state;
+		ULONG length;		// raw data length, position of consumer when reading
+		ULONG zipLength;
+		UCHAR* raw;
+		UCHAR* zip;
+	};
+
+	NBackup* const m_nbk;
+	const bool m_writing;
+	const ULONG m_chunkSize;
+
+	HalfStaticArray<Slot, 16> m_slots;
+	HalfStaticArray<Thread::Handle, 8> m_threads;
+	Array<UCHAR> m_buffers;
+
+	Mutex m_mutex;
+	Condition m_changed;
+
+	FB_UINT64 m_user;		// chunk filled (writing) or consumed (reading) by the caller
+	FB_UINT64 m_work;		// next chunk to (de)compress
+	FB_UINT64 m_io;			// next chunk to write or read
+	bool m_ioBusy;
+	bool m_eof;
+	bool m_shutdown;
+	bool m_failed;
+	FbLocalStatus m_status;
+
+	Slot& slot(FB_UINT64 number)
+	{
+		return m_slots[number % m_slots.getCount()];
+	}
+
+	void check();
+	void compress(Slot& slot);
+	void decompress(Slot& slot);
+	void readChunk(Slot& slot);
+	void writeChunk(Slot& slot);
+	void worker();
+
+	static THREAD_ENTRY_DECLARE workerThread(THREAD_ENTRY_PARAM arg);
+};
+
 class NBackup
 {
 public:
 	NBackup(UtilSvc* _uSvc, const PathName& _database, const string& _username, const string& _role,
-			const string& _password, bool _run_db_triggers, bool _direct_io, const string& _deco)
+			const string& _password, bool _run_db_triggers, bool _direct_io, const string& _deco,
+			bool _compress, unsigned _parallel)
 	  : uSvc(_uSvc), newdb(0), trans(0), database(_database),
 		username(_username), role(_role), password(_password),
 		run_db_triggers(_run_db_triggers), direct_io(_direct_io),
 		dbase(0), backup(0), decompress(_deco), childId(0), db_size_pages(0),
-		m_odsNumber(0), m_silent(false), m_printed(false)
+		m_odsNumber(0), m_silent(false), m_printed(false),
+		m_compress(_compress), m_parallel(_parallel), m_aheadLength(0), m_aheadPos(0)
 	{
 		// Recognition of local prefix allows to work with
 		// database using TCP/IP loopback while reading file locally.
@@ -346,11 +445,22 @@ private:
 	bool m_silent;		// are we already handling an exception?
 	bool m_printed;		// pr_error() was called to print status vector
 
+	bool m_compress;	// compress backup file ourselves
+	unsigned m_parallel;	// number of compression threads
+	AutoPtr<ZipStream> m_zip;
+	UCHAR m_ahead[sizeof(zip_header)];	// read ahead when looking for zip_header
+	FB_SIZE_T m_aheadLength, m_aheadPos;
+
 	// IO functions
 	FB_SIZE_T read_file(FILE_HANDLE &file, void *buffer, FB_SIZE_T bufsize);
 	void write_file(FILE_HANDLE &file, void *buffer, FB_SIZE_T bufsize);
 	void seek_file(FILE_HANDLE &file, SINT64 pos);
 
+	// Backup file IO, (de)compressed when necessary
+	FB_SIZE_T read_backup(void *buffer, FB_SIZE_T bufsize);
+	void write_backup(void *buffer, FB_SIZE_T bufsize);
+	void prefetch_changed_pages(const Ods::scns_page* scns, ULONG pageSize, ULONG pagesPerSCN, ULONG prev_scn);
+
 	void pr_error(const ISC_STATUS* status, const char* operation);
 	void print_child_stderr();
 
@@ -364,7 +474,7 @@ private:
 
 	// Create/open database and backup
 	void open_database_write(bool exclusive = false);
-	void open_database_scan();
+	void open_database_scan(bool sparse = false);
 	void create_database();
 	void close_database();
 
@@ -372,6 +482,8 @@ private:
 	void open_backup_decompress();
 	void create_backup();
 	void close_backup();
+
+	friend class ZipStream;
 };
 
 
@@ -467,6 +579,406 @@ void NBackup::seek_file(FILE_HANDLE &file, SINT64 pos)
 		Arg::OsError());
 }
 
+FB_SIZE_T NBackup::read_backup(void *buffer, FB_SIZE_T bufsize)
+{
+	if (m_zip)
+		return m_zip->get(buffer, bufsize);
+
+	// Return data read ahead by open_backup_scan() first
+	const FB_SIZE_T ahead = MIN(bufsize, m_aheadLength - m_aheadPos);
+	if (ahead)
+	{
+		memcpy(buffer, m_ahead + m_aheadPos, ahead);
+		m_aheadPos += ahead;
+	}
+
+	return ahead + read_file(backup, static_cast<UCHAR*>(buffer) + ahead, bufsize - ahead);
+}
+
+void NBackup::write_backup(void *buffer, FB_SIZE_T bufsize)
+{
+	if (m_zip)
+		m_zip->put(buffer, bufsize);
+	else
+		write_file(backup, buffer, bufsize);
+}
+
+
+#ifdef HAVE_ZLIB_H
+static InitInstance<ZLib> zlib;
+#endif
+
+ZipStream::ZipStream(NBackup* nbk, bool writing, unsigned threads, ULONG chunkSize)
+	: m_nbk(nbk), m_writing(writing), m_chunkSize(chunkSize),
+	  m_slots(*getDefaultMemoryPool()), m_threads(*getDefaultMemoryPool()),
+	  m_buffers(*getDefaultMemoryPool()),
+	  m_user(0), m_work(0), m_io(0), m_ioBusy(false), m_eof(false),
+	  m_shutdown(false), m_failed(false)
+{
+#ifdef HAVE_ZLIB_H
+	if (!zlib())
+	{
+		(Arg::Gds(isc_nbackup_zip_not_loaded) << Arg::StatusVector(zlib().status)).raise();
+	}
+#else
+	Arg::Gds(isc_nbackup_zip_not_supported).raise();
+#endif
+
+	if (!threads)
+		threads = 1;
+
+	// Let every thread have a chunk to work on while the caller and IO have theirs
+	const unsigned count = threads * 2 + 2;
+	UCHAR* buffer = m_buffers.getBuffer(count * 2 * (FB_SIZE_T) chunkSize);
+
+	m_slots.grow(count);
+	for (unsigned i = 0; i < count; i++)
+	{
+		Slot& s = m_slots[i];
+		s.state = SLOT_FREE;
+		s.length = s.zipLength = 0;
+		s.raw = buffer;
+		s.zip = buffer + chunkSize;
+		buffer += 2 * chunkSize;
+	}
+
+	for (unsigned i = 0; i < threads; i++)
+	{
+		Thread::Handle handle;
+
+		try
+		{
+			Thread::start(workerThread, this, THREAD_medium, &handle);
+		}
+		catch (const Exception&)
+		{
+			// Work with the threads we have
+			if (i)
+				break;
+
+			throw;
+		}
+
+		m_threads.add(handle);
+	}
+}
+
+ZipStream::~ZipStream()
+{
+	{	// scope
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+		m_shutdown = true;
+		m_changed.notifyAll();
+	}
+
+	for (FB_SIZE_T i = 0; i < m_threads.getCount(); i++)
+		Thread::waitForCompletion(m_threads[i]);
+}
+
+void ZipStream::check()
+{
+	// Caller holds m_mutex
+
+	if (m_failed)
+		m_status.check();
+
+	checkCtrlC(m_nbk->uSvc);
+}
+
+void ZipStream::put(const void* buffer, FB_SIZE_T length)
+{
+	fb_assert(m_writing);
+
+	const UCHAR* data = static_cast<const UCHAR*>(buffer);
+	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+	while (length)
+	{
+		Slot& s = slot(m_user);
+
+		while (s.state != SLOT_FREE)
+		{
+			check();
+			m_changed.wait(m_mutex);
+		}
+
+		check();
+
+		// Slot is ours until it's passed to the workers
+		const FB_SIZE_T step = MIN(length, m_chunkSize - s.length);
+		memcpy(s.raw + s.length, data, step);
+		s.length += step;
+		data += step;
+		length -= step;
+
+		if (s.length == m_chunkSize)
+		{
+			s.state = SLOT_RAW;
+			m_user++;
+			m_changed.notifyAll();
+		}
+	}
+}
+
+void ZipStream::finish()
+{
+	fb_assert(m_writing);
+
+	{	// scope
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+		Slot& s = slot(m_user);
+		if (s.state == SLOT_FREE && s.length)
+		{
+			s.state = SLOT_RAW;
+			m_user++;
+			m_changed.notifyAll();
+		}
+
+		while (m_io < m_user)
+		{
+			check();
+			m_changed.wait(m_mutex);
+		}
+
+		check();
+	}
+
+	// All chunks are written, workers are idle now
+	zip_chunk chunk;
+	chunk.length = chunk.zip_length = 0;
+	m_nbk->write_file(m_nbk->backup, &chunk, sizeof(chunk));
+}
+
+FB_SIZE_T ZipStream::get(void* buffer, FB_SIZE_T length)
+{
+	fb_assert(!m_writing);
+
+	UCHAR* data = static_cast<UCHAR*>(buffer);
+	FB_SIZE_T done = 0;
+	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+	while (done < length)
+	{
+		Slot& s = slot(m_user);
+
+		while (!(m_user < m_work && s.state == SLOT_RAW))
+		{
+			check();
+
+			if (m_eof && m_user == m_io)
+				return done;
+
+			m_changed.wait(m_mutex);
+		}
+
+		// Slot is ours until it's released, zipLength is our position in it
+		const FB_SIZE_T step = MIN(length - done, s.length - s.zipLength);
+		memcpy(data + done, s.raw + s.zipLength, step);
+		s.zipLength += step;
+		done += step;
+
+		if (s.zipLength == s.length)
+		{
+			s.state = SLOT_FREE;
+			m_user++;
+			m_changed.notifyAll();
+		}
+	}
+
+	return done;
+}
+
+void ZipStream::compress(Slot& s)
+{
+#ifdef HAVE_ZLIB_H
+	z_stream strm;
+	memset(&strm, 0, sizeof(strm));
+	strm.zalloc = ZLib::allocFunc;
+	strm.zfree = ZLib::freeFunc;
+
+	// Favor speed, pages compress well anyway
+	int ret = zlib().deflateInit(&strm, Z_BEST_SPEED);
+	if (ret != Z_OK)
+		(Arg::Gds(isc_nbackup_zip_call_err) << "deflateInit" << Arg::Num(ret)).raise();
+
+	strm.next_in = s.raw;
+	strm.avail_in = s.length;
+	strm.next_out = s.zip;
+	strm.avail_out = s.length;
+
+	ret = zlib().deflate(&strm, Z_FINISH);
+	zlib().deflateEnd(&strm);
+
+	// Data not compressible is stored as is
+	if (ret == Z_STREAM_END && strm.total_out < s.length)
+		s.zipLength = static_cast<ULONG>(strm.total_out);
+	else if (ret == Z_STREAM_END || ret == Z_OK || ret == Z_BUF_ERROR)
+		s.zipLength = s.length;
+	else
+		(Arg::Gds(isc_nbackup_zip_call_err) << "deflate" << Arg::Num(ret)).raise();
+#endif
+}
+
+void ZipStream::decompress(Slot& s)
+{
+	if (s.zipLength == s.length)
+	{
+		memcpy(s.raw, s.zip, s.length);
+		return;
+	}
+
+#ifdef HAVE_ZLIB_H
+	z_stream strm;
+	memset(&strm, 0, sizeof(strm));
+	strm.zalloc = ZLib::allocFunc;
+	strm.zfree = ZLib::freeFunc;
+
+	int ret = zlib().inflateInit(&strm);
+	if (ret != Z_OK)
+		(Arg::Gds(isc_nbackup_zip_call_err) << "inflateInit" << Arg::Num(ret)).raise();
+
+	strm.next_in = s.zip;
+	strm.avail_in = s.zipLength;
+	strm.next_out = s.raw;
+	strm.avail_out = s.length;
+
+	ret = zlib().inflate(&strm, Z_FINISH);
+	zlib().inflateEnd(&strm);
+
+	if (ret != Z_STREAM_END || strm.total_out != s.length)
+		status_exception::raise(Arg::Gds(isc_nbackup_err_eofbk) << m_nbk->bakname.c_str());
+#endif
+}
+
+void ZipStream::readChunk(Slot& s)
+{
+	zip_chunk chunk;
+	const FB_SIZE_T bytesDone = m_nbk->read_file(m_nbk->backup, &chunk, sizeof(chunk));
+
+	if (bytesDone != sizeof(chunk) || chunk.length > m_chunkSize || chunk.zip_length > chunk.length)
+		status_exception::raise(Arg::Gds(isc_nbackup_err_eofbk) << m_nbk->bakname.c_str());
+
+	s.length = chunk.length;
+	s.zipLength = chunk.zip_length;
+
+	if (m_nbk->read_file(m_nbk->backup, s.zip, s.zipLength) != s.zipLength)
+		status_exception::raise(Arg::Gds(isc_nbackup_err_eofbk) << m_nbk->bakname.c_str());
+}
+
+void ZipStream::writeChunk(Slot& s)
+{
+	zip_chunk chunk;
+	chunk.length = s.length;
+	chunk.zip_length = s.zipLength;
+
+	m_nbk->write_file(m_nbk->backup, &chunk, sizeof(chunk));
+	m_nbk->write_file(m_nbk->backup, s.zipLength < s.length ? s.zip : s.raw, s.zipLength);
+}
+
+void ZipStream::worker()
+{
+	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+	while (!m_shutdown && !m_failed)
+	{
+		try
+		{
+			// Sequential IO of the backup file goes first, to not let the pipeline stall
+
+			Slot& ioSlot = slot(m_io);
+
+			if (!m_ioBusy && (m_writing ?
+					m_io < m_work && ioSlot.state == SLOT_ZIPPED :
+					!m_eof && ioSlot.state == SLOT_FREE))
+			{
+				m_ioBusy = true;
+
+				{	// scope
+					MutexUnlockGuard unguard(m_mutex, FB_FUNCTION);
+
+					if (m_writing)
+						writeChunk(ioSlot);
+					else
+						readChunk(ioSlot);
+				}
+
+				m_ioBusy = false;
+
+				if (m_writing)
+				{
+					ioSlot.state = SLOT_FREE;
+					ioSlot.length = 0;
+					m_io++;
+				}
+				else if (ioSlot.length)
+				{
+					ioSlot.state = SLOT_ZIPPED;
+					m_io++;
+				}
+				else
+					m_eof = true;
+
+				m_changed.notifyAll();
+				continue;
+			}
+
+			Slot& workSlot = slot(m_work);
+
+			if (m_writing ? m_work < m_user : m_work < m_io)
+			{
+				fb_assert(workSlot.state == (m_writing ? SLOT_RAW : SLOT_ZIPPED));
+
+				workSlot.state = SLOT_BUSY;
+				m_work++;
+
+				{	// scope
+					MutexUnlockGuard unguard(m_mutex, FB_FUNCTION);
+
+					if (m_writing)
+						compress(workSlot);
+					else
+						decompress(workSlot);
+				}
+
+				if (m_writing)
+					workSlot.state = SLOT_ZIPPED;
+				else
+				{
+					workSlot.state = SLOT_RAW;
+					workSlot.zipLength = 0;		// position of the reader
+				}
+
+				m_changed.notifyAll();
+				continue;
+			}
+		}
+		catch (const Exception& ex)
+		{
+			ex.stuffException(&m_status);
+			m_failed = true;
+			m_changed.notifyAll();
+			break;
+		}
+
+		m_changed.wait(m_mutex);
+	}
+}
+
+THREAD_ENTRY_DECLARE ZipStream::workerThread(THREAD_ENTRY_PARAM arg)
+{
+	try
+	{
+		static_cast<ZipStream*>(arg)->worker();
+	}
+	catch (const Exception& ex)
+	{
+		iscLogException("nbackup compression thread", ex);
+	}
+
+	return 0;
+}
+
 void NBackup::open_database_write(bool exclusive)
 {
 #ifdef WIN_NT
@@ -491,8 +1003,12 @@ void NBackup::open_database_write(bool exclusive)
 	status_exception::raise(Arg::Gds(isc_nbackup_err_opendb) << dbname.c_str() << Arg::OsError());
 }
 
-void NBackup::open_database_scan()
+void NBackup::open_database_scan(bool sparse)
 {
+	// Sparse scan reads only pages changed since previous backup level, as
+	// listed at SCN pages. OS read-ahead would read the skipped pages too, so
+	// it's replaced by explicit prefetch of the changed pages.
+
 #ifdef WIN_NT
 
 	// On Windows we use unbuffered IO to work around bug in Windows Server 2003
@@ -504,7 +1020,8 @@ void NBackup::open_database_scan()
 	// system cache when reading large files.
 	dbase = CreateFile(dbname.c_str(),
 		GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING,
-		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN | (direct_io ? FILE_FLAG_NO_BUFFERING : 0),
+		FILE_ATTRIBUTE_NORMAL | (sparse ? FILE_FLAG_RANDOM_ACCESS : FILE_FLAG_SEQUENTIAL_SCAN) |
+			(direct_io ? FILE_FLAG_NO_BUFFERING : 0),
 		NULL);
 	if (dbase == INVALID_HANDLE_VALUE)
 		status_exception::raise(Arg::Gds(isc_nbackup_err_opendb) << dbname.c_str() << Arg::OsError());
@@ -535,11 +1052,11 @@ void NBackup::open_database_scan()
 	}
 
 #ifdef POSIX_FADV_SEQUENTIAL
-	int rc = fb_fadvise(dbase, 0, 0, POSIX_FADV_SEQUENTIAL);
+	int rc = fb_fadvise(dbase, 0, 0, sparse ? POSIX_FADV_RANDOM : POSIX_FADV_SEQUENTIAL);
 	if (rc)
 	{
 		status_exception::raise(Arg::Gds(isc_nbackup_err_fadvice) <<
-								"SEQUENTIAL" << dbname.c_str() << Arg::Unix(rc));
+								(sparse ? "RANDOM" : "SEQUENTIAL") << dbname.c_str() << Arg::Unix(rc));
 	}
 #endif // POSIX_FADV_SEQUENTIAL
 
@@ -595,24 +1112,49 @@ string NBackup::to_system(const PathName& from)
 void NBackup::open_backup_scan()
 {
 	if (decompress.hasData())
-	{
 		open_backup_decompress();
-		return;
-	}
-
-	string nm = to_system(bakname);
+	else
+	{
+		string nm = to_system(bakname);
 #ifdef WIN_NT
-	backup = CreateFile(nm.c_str(), GENERIC_READ, 0,
-		NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
-	if (backup != INVALID_HANDLE_VALUE)
-		return;
+		backup = CreateFile(nm.c_str(), GENERIC_READ, 0,
+			NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		if (backup == INVALID_HANDLE_VALUE)
 #else
-	backup = os_utils::open(nm.c_str(), O_RDONLY | O_LARGEFILE);
-	if (backup >= 0)
-		return;
+		backup = os_utils::open(nm.c_str(), O_RDONLY | O_LARGEFILE);
+		if (backup < 0)
 #endif
+		{
+			status_exception::raise(Arg::Gds(isc_nbackup_err_openbk) << bakname.c_str() <<
+				Arg::OsError());
+		}
+	}
+
+	// Check if backup file was compressed by us. If not, data read here
+	// is returned by read_backup() before the rest of file.
+	m_aheadPos = 0;
+	m_aheadLength = read_file(backup, m_ahead, sizeof(m_ahead));
+
+	zip_header header;
+	if (m_aheadLength == sizeof(header))
+	{
+		memcpy(&header, m_ahead, sizeof(header));
+
+		if (memcmp(header.signature, zip_signature, sizeof(zip_signature)) == 0)
+		{
+			if (header.version != ZIP_VERSION)
+			{
+				status_exception::raise(Arg::Gds(isc_nbackup_unsupvers_incbk) <<
+					Arg::Num(header.version) << bakname.c_str());
+			}
+
+			if (!header.chunk_size || header.chunk_size > MAX_ZIP_CHUNK_SIZE)
+				status_exception::raise(Arg::Gds(isc_nbackup_err_eofbk) << bakname.c_str());
 
-	status_exception::raise(Arg::Gds(isc_nbackup_err_openbk) << bakname.c_str() << Arg::OsError());
+			m_aheadLength = 0;
+			m_zip = FB_NEW ZipStream(this, false, m_parallel, header.chunk_size);
+		}
+	}
 }
 
 void NBackup::open_backup_decompress()
@@ -791,6 +1333,9 @@ void NBackup::create_backup()
 
 void NBackup::close_backup()
 {
+	m_zip.reset();
+	m_aheadLength = m_aheadPos = 0;
+
 	if (bakname == "stdout")
 		return;
 #ifdef WIN_NT
@@ -842,6 +1387,40 @@ void NBackup::fixup_database(bool set_readonly)
 }
 
 
+void NBackup::prefetch_changed_pages(const Ods::scns_page* scns, ULONG pageSize, ULONG pagesPerSCN,
+	ULONG prev_scn)
+{
+	// Ask OS to read pages changed since previous backup level in background,
+	// adjacent pages are requested together. There is no page cache to fill
+	// with direct IO.
+#if !defined(WIN_NT) && defined(POSIX_FADV_WILLNEED)
+	if (direct_io)
+		return;
+
+	const FB_UINT64 base = (FB_UINT64) scns->scn_sequence * pagesPerSCN;
+	ULONG slot = 0;
+
+	while (slot < pagesPerSCN)
+	{
+		if (scns->scn_pages[slot] <= prev_scn)
+		{
+			slot++;
+			continue;
+		}
+
+		const ULONG first = slot;
+
+		while (slot < pagesPerSCN && scns->scn_pages[slot] > prev_scn)
+			slot++;
+
+		// It's just a hint, failure is not an error
+		fb_fadvise(dbase, (base + first) * pageSize, (FB_UINT64) (slot - first) * pageSize,
+			POSIX_FADV_WILLNEED);
+	}
+#endif
+}
+
+
 // Print the status, the SQLCODE, and exit.
 // Also, indicate which operation the error occurred on.
 void NBackup::pr_error(const ISC_STATUS* status, const char* operation)
@@ -1244,7 +1823,19 @@ void NBackup::backup_database(int level, Guid& guid, const PathName& fname)
 		create_backup();
 		delete_backup = true;
 
-		open_database_scan();
+		if (m_compress)
+		{
+			zip_header zh;
+			memset(&zh, 0, sizeof(zh));
+			memcpy(zh.signature, zip_signature, sizeof(zip_signature));
+			zh.version = ZIP_VERSION;
+			zh.chunk_size = ZIP_CHUNK_SIZE;
+			write_file(backup, &zh, sizeof(zh));
+
+			m_zip = FB_NEW ZipStream(this, true, m_parallel, ZIP_CHUNK_SIZE);
+		}
+
+		open_database_scan(level != 0);
 
 		// Read database header
 		char unaligned_header_buffer[SECTOR_ALIGNMENT * 2];
@@ -1324,7 +1915,7 @@ void NBackup::backup_database(int level, Guid& guid, const PathName& fname)
 
 			memset(page_buff, 0, header->hdr_page_size);
 			memcpy(page_buff, &bh, sizeof(bh));
-			write_file(backup, page_buff, header->hdr_page_size);
+			write_backup(page_buff, header->hdr_page_size);
 			page_writes++;
 
 			seek_file(dbase, 0);
@@ -1356,7 +1947,7 @@ void NBackup::backup_database(int level, Guid& guid, const PathName& fname)
 
 			if (!level || page_buff->pag_scn > prev_scn)
 			{
-				write_file(backup, page_buff, header->hdr_page_size);
+				write_backup(page_buff, header->hdr_page_size);
 				page_writes++;
 			}
 
@@ -1416,6 +2007,8 @@ void NBackup::backup_database(int level, Guid& guid, const PathName& fname)
 				// pick up next SCN's page
 				memcpy(scns_buf, page_buff, header->hdr_page_size);
 				scns = scns_buf;
+
+				prefetch_changed_pages(scns, header->hdr_page_size, pagesPerSCN, prev_scn);
 			}
 
 
@@ -1444,6 +2037,9 @@ void NBackup::backup_database(int level, Guid& guid, const PathName& fname)
 				}
 			}
 		}
+		if (m_zip)
+			m_zip->finish();
+
 		close_database();
 		close_backup();
 
@@ -1522,6 +2118,7 @@ void NBackup::backup_database(int level, Guid& guid, const PathName& fname)
 	catch (const Exception&)
 	{
 		m_silent = true;
+		m_zip.reset();
 		if (delete_backup)
 			remove(bakname.c_str());
 		if (trans)
@@ -1636,7 +2233,7 @@ void NBackup::restore_database(const BackupFiles& files, bool inc_rest)
 			if (curLevel)
 			{
 				inc_header bakheader;
-				if (read_file(backup, &bakheader, sizeof(bakheader)) != sizeof(bakheader))
+				if (read_backup(&bakheader, sizeof(bakheader)) != sizeof(bakheader))
 					status_exception::raise(Arg::Gds(isc_nbackup_err_eofhdrbk) << bakname.c_str());
 				if (memcmp(bakheader.signature, backup_signature, sizeof(backup_signature)) != 0)
 					status_exception::raise(Arg::Gds(isc_nbackup_invalid_incbk) << bakname.c_str());
@@ -1661,7 +2258,7 @@ void NBackup::restore_database(const BackupFiles& files, bool inc_rest)
 				{
 					char char_buf[1024];
 					FB_SIZE_T step = left > sizeof(char_buf) ? sizeof(char_buf) : left;
-					if (read_file(backup, &char_buf, step) != step)
+					if (read_backup(&char_buf, step) != step)
 						status_exception::raise(Arg::Gds(isc_nbackup_err_eofhdrbk) << bakname.c_str());
 					left -= step;
 				}
@@ -1671,7 +2268,7 @@ void NBackup::restore_database(const BackupFiles& files, bool inc_rest)
 				prev_guid = bakheader.backup_guid;
 				while (true)
 				{
-					const FB_SIZE_T bytesDone = read_file(backup, page_buffer, bakheader.page_size);
+					const FB_SIZE_T bytesDone = read_backup(page_buffer, bakheader.page_size);
 					if (bytesDone == 0)
 						break;
 					if (bytesDone != bakheader.page_size) {
@@ -1692,7 +2289,7 @@ void NBackup::restore_database(const BackupFiles& files, bool inc_rest)
 					char buffer[65536];
 					while (true)
 					{
-						const FB_SIZE_T bytesRead = read_file(backup, buffer, sizeof(buffer));
+						const FB_SIZE_T bytesRead = read_backup(buffer, sizeof(buffer));
 						if (bytesRead == 0)
 							break;
 						write_file(dbase, buffer, bytesRead);
@@ -1812,6 +2409,8 @@ void nbackup(UtilSvc* uSvc)
 	int level = -1;
 	Guid guid;
 	bool print_size = false, version = false, inc_rest = false;
+	bool compress = false;
+	unsigned parallel = os_utils::getProcessorCount();
 	string onOff;
 
 	const Switches switches(nbackup_action_in_sw_table, FB_NELEM(nbackup_action_in_sw_table),
@@ -1992,6 +2591,19 @@ void nbackup(UtilSvc* uSvc)
 			inc_rest = true;
 			break;
 
+		case IN_SW_NBK_ZIP:
+			compress = true;
+			break;
+
+		case IN_SW_NBK_PARALLEL:
+			if (++itr >= argc)
+				missingParameterForSwitch(uSvc, argv[itr - 1]);
+
+			parallel = atoi(argv[itr]);
+			if (!parallel)
+				usage(uSvc, isc_nbackup_unknown_param, argv[itr]);
+			break;
+
 		default:
 			usage(uSvc, isc_nbackup_unknown_switch, argv[itr]);
 			break;
@@ -2017,7 +2629,8 @@ void nbackup(UtilSvc* uSvc)
 		usage(uSvc, isc_nbackup_size_with_lock);
 	}
 
-	NBackup nbk(uSvc, database, username, role, password, run_db_triggers, direct_io, decompress);
+	NBackup nbk(uSvc, database, username, role, password, run_db_triggers, direct_io, decompress,
+		compress, parallel);
 	try
 	{
 		switch (op)
@@ -26,8 +26,11 @@
 */
 
 #include "PluginLogWriter.h"
+#include "os/platform.h"
 #include "../common/classes/init.h"
+#include "../common/classes/GenericMap.h"
 #include "../common/os/os_utils.h"
+#include "../common/isc_proto.h"
 
 #ifndef S_IREAD
 #define S_IREAD S_IRUSR
@@ -36,8 +39,26 @@
 #define S_IWRITE S_IWUSR
 #endif
 
+#ifdef WIN_NT
+#define NEWLINE "\r\n"
+#else
+#define NEWLINE "\n"
+#endif
+
 using namespace Firebird;
 
+namespace
+{
+	// Asynchronous log buffers by log file name
+	typedef GenericMap<Pair<Left<PathName, PluginLogBuffer*> > > LogBuffers;
+
+	GlobalPtr<LogBuffers> logBuffers;
+	GlobalPtr<Mutex> logBuffersMutex;
+
+	const ULONG MIN_BUFFER_SIZE = 64 * 1024;
+	const int FLUSH_PERIOD = 100;	// milliseconds
+}
+
 // seems to only be Solaris 9 that doesn't have strerror_r,
 // maybe we can remove this in the future
 #ifndef HAVE_STRERROR_R
@@ -49,13 +70,21 @@ void strerror_r(int err, char* buf, size_t bufSize)
 }
 #endif
 
-PluginLogWriter::PluginLogWriter(const char* fileName, size_t maxSize) :
+PluginLogWriter::PluginLogWriter(const char* fileName, size_t maxSize, ULONG bufferSize) :
 	m_fileName(*getDefaultMemoryPool()),
 	m_fileHandle(-1),
 	m_maxSize(maxSize)
 {
 	m_fileName = fileName;
 
+	// Asynchronous writer leaves the file to the flusher of the shared buffer
+
+	if (bufferSize)
+	{
+		m_buffer.assignRefNoIncr(PluginLogBuffer::attach(m_fileName, maxSize, bufferSize));
+		return;
+	}
+
 #ifdef WIN_NT
 	PathName mutexName("fb_mutex_");
 	mutexName.append(m_fileName);
@@ -69,6 +98,9 @@ PluginLogWriter::PluginLogWriter(const char* fileName, size_t maxSize) :
 
 PluginLogWriter::~PluginLogWriter()
 {
+	if (m_buffer)
+		return;
+
 	{
 		Guard guard(this);
 
@@ -120,6 +152,12 @@ void PluginLogWriter::reopen()
 
 FB_SIZE_T PluginLogWriter::write(const void* buf, FB_SIZE_T size)
 {
+	if (m_buffer)
+	{
+		m_buffer->put(buf, size);
+		return size;
+	}
+
 	Guard guard(this);
 
 	setupIdleTimer(true);
@@ -280,3 +318,197 @@ void PluginLogWriter::onIdleTimer(TimerImpl*)
 	::close(m_fileHandle);
 	m_fileHandle = -1;
 }
+
+
+PluginLogBuffer::PluginLogBuffer(const PathName& fileName, size_t maxSize, ULONG bufferSize) :
+	m_fileName(getPool(), fileName),
+	m_file(FB_NEW PluginLogWriter(fileName.c_str(), maxSize)),
+	m_data(NULL),
+	m_capacity(FB_ALIGN(MAX(bufferSize, MIN_BUFFER_SIZE), HEADER_SIZE)),
+	m_head(0),
+	m_tail(0),
+	m_dropped(0),
+	m_output(getPool()),
+	m_thread(0),
+	m_shutdown(false)
+{
+	m_data = FB_NEW_POOL(getPool()) UCHAR[m_capacity];
+	memset(m_data, 0, m_capacity);
+
+	Thread::start(flusherThread, this, THREAD_medium, &m_thread);
+}
+
+PluginLogBuffer::~PluginLogBuffer()
+{
+	// Flusher writes all records left in the buffer before exit
+
+	m_shutdown = true;
+	m_wakeup.release();
+	Thread::waitForCompletion(m_thread);
+
+	logBuffers->remove(m_fileName);
+
+	delete[] m_data;
+}
+
+PluginLogBuffer* PluginLogBuffer::attach(const PathName& fileName, size_t maxSize, ULONG bufferSize)
+{
+	MutexLockGuard guard(logBuffersMutex, FB_FUNCTION);
+
+	// Buffer of the file is shared, the first writer of the file sets its size
+
+	PluginLogBuffer* buffer = NULL;
+
+	if (!logBuffers->get(fileName, buffer))
+	{
+		buffer = FB_NEW PluginLogBuffer(fileName, maxSize, bufferSize);
+		logBuffers->put(fileName, buffer);
+	}
+
+	buffer->addRef();
+	return buffer;
+}
+
+int PluginLogBuffer::release() const
+{
+	// Last release removes the buffer from the map, so it can't be found when dying
+
+	MutexLockGuard guard(logBuffersMutex, FB_FUNCTION);
+
+	return RefCounted::release();
+}
+
+void PluginLogBuffer::put(const void* buf, FB_SIZE_T length)
+{
+	const FB_UINT64 size = FB_ALIGN((FB_UINT64) HEADER_SIZE + length, HEADER_SIZE);
+	const FB_UINT64 half = m_capacity / 2;
+
+	// Reserve space for the record, drop it if the buffer is full
+
+	FB_UINT64 head = m_head.load(std::memory_order_relaxed);
+	FB_UINT64 used;
+
+	do
+	{
+		used = head - m_tail.load(std::memory_order_acquire);
+
+		if (used + size > m_capacity)
+		{
+			if (m_dropped++ == 0)
+				m_wakeup.release();
+
+			return;
+		}
+	} while (!m_head.compare_exchange_weak(head, head + size, std::memory_order_relaxed));
+
+	Header* const hdr = header(head);
+	hdr->length = length;
+	copy(head + HEADER_SIZE, static_cast<const UCHAR*>(buf), length);
+	hdr->size.store((ULONG) size, std::memory_order_release);
+
+	// Wake up flusher when the buffer gets half full, otherwise it wakes up by itself
+
+	if (used <= half && used + size > half)
+		m_wakeup.release();
+}
+
+void PluginLogBuffer::copy(FB_UINT64 position, const UCHAR* from, ULONG length)
+{
+	const ULONG offset = position % m_capacity;
+	const ULONG n = MIN(length, m_capacity - offset);
+
+	memcpy(m_data + offset, from, n);
+	memcpy(m_data, from + n, length - n);
+}
+
+bool PluginLogBuffer::flush()
+{
+	// Copy complete records out of the buffer and release their space at once,
+	// then write them into the file. Space is zeroed before release as any
+	// aligned position may become a header of the next records.
+
+	const FB_UINT64 start = m_tail.load(std::memory_order_relaxed);
+	FB_UINT64 tail = start;
+
+	m_output.clear();
+
+	while (true)
+	{
+		const Header* const hdr = header(tail);
+		const ULONG size = hdr->size.load(std::memory_order_acquire);
+
+		if (!size)
+			break;
+
+		const ULONG length = hdr->length;
+		const ULONG offset = (tail + HEADER_SIZE) % m_capacity;
+		const ULONG n = MIN(length, m_capacity - offset);
+
+		m_output.add(m_data + offset, n);
+		m_output.add(m_data, length - n);
+
+		tail += size;
+	}
+
+	if (tail != start)
+	{
+		const ULONG offset = start % m_capacity;
+		const ULONG length = (ULONG) (tail - start);
+		const ULONG n = MIN(length, m_capacity - offset);
+
+		memset(m_data + offset, 0, n);
+		memset(m_data, 0, length - n);
+
+		m_tail.store(tail, std::memory_order_release);
+	}
+
+	const FB_UINT64 dropped = m_dropped.exchange(0);
+
+	if (dropped)
+	{
+		const TimeStamp stamp(TimeStamp::getCurrentTimeStamp());
+		struct tm times;
+		stamp.decode(&times);
+
+		string message;
+		message.printf("%04d-%02d-%02dT%02d:%02d:%02d.%04d (%d) TRACE_OVERFLOW" NEWLINE
+			"\t%" UQUADFORMAT " record(s) dropped, log buffer is full" NEWLINE NEWLINE,
+			times.tm_year + 1900, times.tm_mon + 1, times.tm_mday, times.tm_hour,
+			times.tm_min, times.tm_sec, (int) (stamp.value().timestamp_time % ISC_TIME_SECONDS_PRECISION),
+			get_process_id(), dropped);
+
+		m_output.add(reinterpret_cast<const UCHAR*>(message.c_str()), message.length());
+	}
+
+	if (m_output.isEmpty())
+		return false;
+
+	try
+	{
+		m_file->write(m_output.begin(), m_output.getCount());
+	}
+	catch (const Exception& ex)
+	{
+		iscLogException("Trace log flusher", ex);
+	}
+
+	return true;
+}
+
+THREAD_ENTRY_DECLARE PluginLogBuffer::flusherThread(THREAD_ENTRY_PARAM arg)
+{
+	static_cast<PluginLogBuffer*>(arg)->flusher();
+	return 0;
+}
+
+void PluginLogBuffer::flusher()
+{
+	while (!m_shutdown)
+	{
+		m_wakeup.tryEnter(0, FLUSH_PERIOD);
+		flush();
+	}
+
+	while (flush())
+		;
+}
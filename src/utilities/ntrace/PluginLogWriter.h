@@ -36,6 +36,10 @@
 #include "../../common/os/path_utils.h"
 #include "../../common/classes/ImplementHelper.h"
 #include "../../common/classes/TimerImpl.h"
+#include "../../common/classes/RefCounted.h"
+#include "../../common/classes/semaphore.h"
+#include "../../common/ThreadStart.h"
+#include <atomic>
 
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
@@ -48,11 +52,14 @@
 #include <sys/stat.h>
 
 
+class PluginLogBuffer;
+
 class PluginLogWriter FB_FINAL :
 	public Firebird::RefCntIface<Firebird::ITraceLogWriterImpl<PluginLogWriter, Firebird::CheckStatusWrapper> >
 {
 public:
-	PluginLogWriter(const char* fileName, size_t maxSize);
+	// Non-zero bufferSize makes writes asynchronous, see PluginLogBuffer
+	PluginLogWriter(const char* fileName, size_t maxSize, ULONG bufferSize = 0);
 	~PluginLogWriter();
 
 	// TraceLogWriter implementation
@@ -124,6 +131,64 @@ private:
 
 	typedef Firebird::TimerImpl IdleTimer;
 	Firebird::RefPtr<IdleTimer> m_idleTimer;
+
+	Firebird::RefPtr<PluginLogBuffer> m_buffer;
+};
+
+
+// Lock-free ring buffer of log records shared by all asynchronous writers of
+// the same log file. Threads producing trace events just copy records into the
+// buffer, background flusher thread writes them into the file. Record which
+// doesn't fit into the buffer is dropped, number of dropped records is reported
+// in the log by the flusher.
+
+class PluginLogBuffer FB_FINAL : public Firebird::RefCounted, public Firebird::GlobalStorage
+{
+public:
+	static PluginLogBuffer* attach(const Firebird::PathName& fileName, size_t maxSize, ULONG bufferSize);
+
+	virtual int release() const;
+
+	void put(const void* buf, FB_SIZE_T size);
+
+private:
+	PluginLogBuffer(const Firebird::PathName& fileName, size_t maxSize, ULONG bufferSize);
+	~PluginLogBuffer();
+
+	// Every record starts with header, records are aligned at header size.
+	// Size is set when the record is complete.
+	struct Header
+	{
+		std::atomic<ULONG> size;	// aligned size of whole record
+		ULONG length;				// length of data
+	};
+
+	static const ULONG HEADER_SIZE = sizeof(Header);
+
+	Header* header(FB_UINT64 position) const
+	{
+		return reinterpret_cast<Header*>(m_data + position % m_capacity);
+	}
+
+	void copy(FB_UINT64 position, const UCHAR* from, ULONG length);
+	bool flush();
+
+	static THREAD_ENTRY_DECLARE flusherThread(THREAD_ENTRY_PARAM arg);
+	void flusher();
+
+	const Firebird::PathName m_fileName;
+	Firebird::RefPtr<PluginLogWriter> m_file;
+
+	UCHAR* m_data;
+	const ULONG m_capacity;
+	std::atomic<FB_UINT64> m_head;		// end of space reserved by writers
+	std::atomic<FB_UINT64> m_tail;		// start of space not yet flushed
+	std::atomic<FB_UINT64> m_dropped;	// records dropped since last flush
+
+	Firebird::Array<UCHAR> m_output;	// flusher's copy of records
+	Firebird::Semaphore m_wakeup;
+	Thread::Handle m_thread;
+	std::atomic<bool> m_shutdown;
 };
 
 #endif // PLUGINLOGWRITER_H
@@ -0,0 +1,104 @@
+/*
+ *	PROGRAM:	SQL Trace plugin
+ *	MODULE:		TraceBinary.h
+ *	DESCRIPTION:	Binary trace log format
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird Project.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ *
+*/
+
+#ifndef TRACE_BINARY_H
+#define TRACE_BINARY_H
+
+#include "firebird.h"
+
+// Binary trace log (log_format = binary) is a sequence of records, every record
+// starts with Header. Texts repeated in many events (event names, descriptions
+// of connections, transactions, statements with their SQL and plan, relation
+// names) are written once as String records and referred to by their ids.
+// Ids are unique within the plugin instance (Header::source) of the process
+// (Header::processId) which wrote the record. Numbers use the byte order of
+// the writer, VERSION_1 read as a different value means other byte order.
+// fbtracemgr -DECODE converts binary log into text or JSON.
+
+namespace TraceBinary
+{
+	const USHORT VERSION_1 = 1;
+
+	const USHORT TYPE_STRING = 1;
+	const USHORT TYPE_EVENT = 2;
+
+	const ULONG ALIGNMENT = 8;			// records and parts of event are aligned
+
+	struct Header
+	{
+		ULONG length;				// length of record including header
+		USHORT type;
+		USHORT version;
+		ISC_TIMESTAMP timestamp;	// local time
+		ULONG processId;
+		ULONG reserved;
+		FB_UINT64 source;			// plugin instance which wrote the record
+	};
+
+	static_assert(sizeof(Header) == 32, "struct Header size mismatch");
+
+	// String record is Header, String and text aligned. Record can define
+	// the id already used, the new text replaces the old one.
+
+	struct String
+	{
+		ULONG id;
+		ULONG length;
+	};
+
+	static_assert(sizeof(String) == 8, "struct String size mismatch");
+
+	const ULONG FLAG_PERF = 1;			// time and page counters are set
+
+	const int PAGE_COUNTERS = 4;		// reads, writes, fetches, marks
+	const int TABLE_COUNTERS = 8;		// natural, index, update, insert, delete, backout, purge, expunge
+
+	// Event record is Header, Event, TableCounts and event text aligned
+
+	struct Event
+	{
+		ULONG action;				// id of event name
+		ULONG connection;			// id of connection description, zero if none
+		ULONG transaction;			// id of transaction description, zero if none
+		ULONG object;				// id of statement, routine or service description, zero if none
+		ULONG textLength;			// length of event details text
+		ULONG tableCount;			// number of TableCounts
+		ULONG flags;
+		ULONG reserved;
+		SINT64 time;				// milliseconds
+		SINT64 pages[PAGE_COUNTERS];
+	};
+
+	static_assert(sizeof(Event) == 72, "struct Event size mismatch");
+
+	struct TableCounts
+	{
+		ULONG relation;				// id of relation name
+		ULONG reserved;
+		SINT64 counters[TABLE_COUNTERS];
+	};
+
+	static_assert(sizeof(TableCounts) == 72, "struct TableCounts size mismatch");
+}
+
+#endif // TRACE_BINARY_H
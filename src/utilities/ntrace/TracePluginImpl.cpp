@@ -53,6 +53,9 @@ using namespace Jrd;
 
 static const char* const DEFAULT_LOG_NAME = "default_trace.log";
 
+// Number of texts remembered as already written into binary log
+static const FB_SIZE_T MAX_BINARY_STRINGS = 4096;
+
 #ifdef WIN_NT
 #define NEWLINE "\r\n"
 #else
@@ -95,6 +98,11 @@ TracePluginImpl::TracePluginImpl(IPluginBase* plugin,
 	logWriter(initInfo->getLogWriter()),
 	config(configuration),
 	record(*getDefaultMemoryPool()),
+	binary_log(false),
+	binary_tables(*getDefaultMemoryPool()),
+	binary_record(*getDefaultMemoryPool()),
+	binary_strings(*getDefaultMemoryPool()),
+	binary_string_id(0),
 	connections(getDefaultMemoryPool()),
 	transactions(getDefaultMemoryPool()),
 	statements(getDefaultMemoryPool()),
@@ -105,8 +113,20 @@ TracePluginImpl::TracePluginImpl(IPluginBase* plugin,
 	const char* ses_name = initInfo->getTraceSessionName();
 	session_name = ses_name && *ses_name ? ses_name : " ";
 
+	memset(&binary_event, 0, sizeof(binary_event));
+
+	if (!config.log_format.equalsNoCase("text") && !config.log_format.equalsNoCase("binary"))
+	{
+		fatal_exception::raiseFmt("invalid value \"%s\" of log_format parameter",
+			config.log_format.c_str());
+	}
+
 	if (!logWriter)
 	{
+		// Binary format is supported by log files only, interactive sessions print text
+
+		binary_log = config.log_format.equalsNoCase("binary");
+
 		PathName logname(configuration.log_filename);
 		if (logname.empty()) {
 			logname = DEFAULT_LOG_NAME;
@@ -119,7 +139,8 @@ TracePluginImpl::TracePluginImpl(IPluginBase* plugin,
 			logname.insert(0, root);
 		}
 
-		logWriter = FB_NEW PluginLogWriter(logname.c_str(), config.max_log_size * 1024 * 1024);
+		logWriter = FB_NEW PluginLogWriter(logname.c_str(), config.max_log_size * 1024 * 1024,
+			config.log_buffer_size * 1024);
 		logWriter->addRef();
 	}
 
@@ -218,6 +239,12 @@ TracePluginImpl::~TracePluginImpl()
 
 void TracePluginImpl::logRecord(const char* action)
 {
+	if (binary_log)
+	{
+		logBinaryRecord(action);
+		return;
+	}
+
 	// We use atomic file appends for logging. Do not try to break logging
 	// to multiple separate file operations
 	const Firebird::TimeStamp stamp(Firebird::TimeStamp::getCurrentTimeStamp());
@@ -235,16 +262,123 @@ void TracePluginImpl::logRecord(const char* action)
 	// TODO: implement adjusting of line breaks
 	// line.adjustLineBreaks();
 
+	writeLog(record.c_str(), record.length());
+
+	record = "";
+}
+
+void TracePluginImpl::writeLog(const void* data, FB_SIZE_T length)
+{
 	LocalStatus ls;
 	CheckStatusWrapper status(&ls);
 
-	logWriter->write_s(&status, record.c_str(), record.length());
+	logWriter->write_s(&status, data, length);
 
 	if (ls.getState() & IStatus::STATE_ERRORS && ls.getErrors()[1] == isc_interface_version_too_old)
-		logWriter->write(record.c_str(), record.length());
+		logWriter->write(data, length);
 	else
 		check(&status);
+}
 
+void TracePluginImpl::dropRecord()
+{
+	// Texts put into binary log are remembered as written, so write them anyway
+
+	if (binary_record.hasData())
+	{
+		writeLog(binary_record.begin(), binary_record.getCount());
+		binary_record.clear();
+	}
+
+	binary_tables.clear();
+	memset(&binary_event, 0, sizeof(binary_event));
+	record = "";
+}
+
+void TracePluginImpl::insertDescription(ULONG& binary_id, const string& description)
+{
+	// Text log gets description in front of the record, binary log refers to it
+
+	if (binary_log)
+		binary_id = binaryString(description);
+	else
+		record.insert(0, description);
+}
+
+ULONG TracePluginImpl::binaryString(const string& text)
+{
+	ULONG id;
+
+	if (binary_strings.get(text, id))
+		return id;
+
+	// Forget texts written before when there are too many of them, they are
+	// written again when needed under new ids
+
+	if (binary_strings.count() >= MAX_BINARY_STRINGS)
+		binary_strings.clear();
+
+	id = ++binary_string_id;
+
+	if (!id)	// wrapped around, zero means no text
+		id = ++binary_string_id;
+
+	binary_strings.put(text, id);
+
+	TraceBinary::String str;
+	str.id = id;
+	str.length = text.length();
+
+	putBinary(TraceBinary::TYPE_STRING, &str, sizeof(str), text.c_str(), text.length());
+
+	return id;
+}
+
+void TracePluginImpl::putBinary(USHORT type, const void* data, FB_SIZE_T length,
+	const void* tail, FB_SIZE_T tail_length)
+{
+	// Records are collected and written at once, see logBinaryRecord
+
+	const FB_SIZE_T aligned = FB_ALIGN(tail_length, TraceBinary::ALIGNMENT);
+
+	TraceBinary::Header header;
+	header.length = sizeof(header) + length + aligned;
+	header.type = type;
+	header.version = TraceBinary::VERSION_1;
+	header.timestamp = TimeStamp::getCurrentTimeStamp().value();
+	header.processId = get_process_id();
+	header.reserved = 0;
+	header.source = (FB_UINT64) (IPTR) this;
+
+	binary_record.add(reinterpret_cast<const UCHAR*>(&header), sizeof(header));
+	binary_record.add(static_cast<const UCHAR*>(data), length);
+
+	if (tail_length)
+		binary_record.add(static_cast<const UCHAR*>(tail), tail_length);
+
+	binary_record.grow(binary_record.getCount() + aligned - tail_length);
+}
+
+void TracePluginImpl::logBinaryRecord(const char* action)
+{
+	binary_event.action = binaryString(action);
+	binary_event.textLength = record.length();
+	binary_event.tableCount = binary_tables.getCount();
+
+	HalfStaticArray<UCHAR, sizeof(TraceBinary::Event) + 16 * sizeof(TraceBinary::TableCounts)> event;
+	event.add(reinterpret_cast<const UCHAR*>(&binary_event), sizeof(binary_event));
+	event.add(reinterpret_cast<const UCHAR*>(binary_tables.begin()),
+		binary_tables.getCount() * sizeof(TraceBinary::TableCounts));
+
+	putBinary(TraceBinary::TYPE_EVENT, event.begin(), event.getCount(), record.c_str(), record.length());
+
+	// Texts and the event are written at once, as text log does
+
+	writeLog(binary_record.begin(), binary_record.getCount());
+
+	binary_record.clear();
+	binary_tables.clear();
+	memset(&binary_event, 0, sizeof(binary_event));
 	record = "";
 }
 
@@ -261,7 +395,7 @@ void TracePluginImpl::logRecordConn(const char* action, ITraceDatabaseConnection
 			ConnectionsTree::Accessor accessor(&connections);
 			if (accessor.locate(conn_id))
 			{
-				record.insert(0, *accessor.current().description);
+				insertDescription(binary_event.connection, *accessor.current().description);
 				break;
 			}
 		}
@@ -271,7 +405,7 @@ void TracePluginImpl::logRecordConn(const char* action, ITraceDatabaseConnection
 			string temp;
 			temp.printf("\t%s (ATT_%" SQUADFORMAT", <unknown, bug?>)" NEWLINE,
 				config.db_filename.c_str(), conn_id);
-			record.insert(0, temp);
+			insertDescription(binary_event.connection, temp);
 			break;
 		}
 
@@ -310,7 +444,7 @@ void TracePluginImpl::logRecordTrans(const char* action, ITraceDatabaseConnectio
 			TransactionsTree::Accessor accessor(&transactions);
 			if (accessor.locate(tra_id))
 			{
-				record.insert(0, *accessor.current().description);
+				insertDescription(binary_event.transaction, *accessor.current().description);
 				break;
 			}
 		}
@@ -319,7 +453,7 @@ void TracePluginImpl::logRecordTrans(const char* action, ITraceDatabaseConnectio
 		{
 			string temp;
 			temp.printf("\t\t(TRA_%" SQUADFORMAT", <unknown, bug?>)" NEWLINE, tra_id);
-			record.insert(0, temp);
+			insertDescription(binary_event.transaction, temp);
 			break;
 		}
 
@@ -335,7 +469,7 @@ void TracePluginImpl::logRecordProcFunc(const char* action, ITraceDatabaseConnec
 {
 	string temp;
 	temp.printf(NEWLINE "%s %s:" NEWLINE, obj_type, obj_name);
-	record.insert(0, temp);
+	insertDescription(binary_event.object, temp);
 
 	if (!transaction) {
 		logRecordConn(action, connection);
@@ -366,7 +500,7 @@ void TracePluginImpl::logRecordStmt(const char* action, ITraceDatabaseConnection
 				log = (description != NULL);
 				// Do not say anything about statements which do not fall under filter criteria
 				if (log) {
-					record.insert(0, *description);
+					insertDescription(binary_event.object, *description);
 				}
 				break;
 			}
@@ -376,7 +510,7 @@ void TracePluginImpl::logRecordStmt(const char* action, ITraceDatabaseConnection
 		{
 			string temp;
 			temp.printf(NEWLINE "Statement %" SQUADFORMAT", <unknown, bug?>:" NEWLINE, stmt_id);
-			record.insert(0, temp);
+			insertDescription(binary_event.object, temp);
 			break;
 		}
 
@@ -403,7 +537,7 @@ void TracePluginImpl::logRecordStmt(const char* action, ITraceDatabaseConnection
 
 	if (!log)
 	{
-		record = "";
+		dropRecord();
 		return;
 	}
 
@@ -429,7 +563,7 @@ void TracePluginImpl::logRecordServ(const char* action, ITraceServiceConnection*
 			ServicesTree::Accessor accessor(&services);
 			if (accessor.locate(svc_id))
 			{
-				record.insert(0, *accessor.current().description);
+				insertDescription(binary_event.object, *accessor.current().description);
 				break;
 			}
 		}
@@ -438,7 +572,7 @@ void TracePluginImpl::logRecordServ(const char* action, ITraceServiceConnection*
 		{
 			string temp;
 			temp.printf("\tService %p, <unknown, bug?>" NEWLINE, svc_id);
-			record.insert(0, temp);
+			insertDescription(binary_event.object, temp);
 			break;
 		}
 
@@ -478,6 +612,17 @@ void TracePluginImpl::logRecordError(const char* action, ITraceConnection* conne
 
 void TracePluginImpl::appendGlobalCounts(const PerformanceInfo* info)
 {
+	if (binary_log)
+	{
+		binary_event.flags |= TraceBinary::FLAG_PERF;
+		binary_event.time = info->pin_time;
+		binary_event.pages[0] = info->pin_counters[RuntimeStatistics::PAGE_READS];
+		binary_event.pages[1] = info->pin_counters[RuntimeStatistics::PAGE_WRITES];
+		binary_event.pages[2] = info->pin_counters[RuntimeStatistics::PAGE_FETCHES];
+		binary_event.pages[3] = info->pin_counters[RuntimeStatistics::PAGE_MARKS];
+		return;
+	}
+
 	string temp;
 
 	temp.printf("%7" QUADFORMAT"d ms", info->pin_time);
@@ -520,6 +665,21 @@ void TracePluginImpl::appendTableCounts(const PerformanceInfo *info)
 	const TraceCounts* trc = info->pin_tables;
 	const TraceCounts* trc_end = trc + info->pin_count;
 
+	if (binary_log)
+	{
+		static_assert(TraceBinary::TABLE_COUNTERS == DBB_max_rel_count, "Wrong number of table counters");
+
+		for (; trc < trc_end; trc++)
+		{
+			TraceBinary::TableCounts& counts = binary_tables.add();
+			counts.relation = binaryString(trc->trc_relation_name);
+			counts.reserved = 0;
+			memcpy(counts.counters, trc->trc_counters, sizeof(counts.counters));
+		}
+
+		return;
+	}
+
 	FB_SIZE_T max_len = 0;
 	for (; trc < trc_end; trc++)
 	{
@@ -32,6 +32,7 @@
 #include "firebird.h"
 #include "../../jrd/ntrace.h"
 #include "TracePluginConfig.h"
+#include "TraceBinary.h"
 #include "../../common/SimilarToRegex.h"
 #include "../../common/classes/rwlock.h"
 #include "../../common/classes/GenericMap.h"
@@ -148,6 +149,16 @@ private:
 	TracePluginConfig config;	// Immutable, thus thread-safe
 	Firebird::string record;
 
+	// Binary log: event being built, pending records and texts already written
+	typedef Firebird::GenericMap<Firebird::Pair<Firebird::Left<Firebird::string, ULONG> > > BinaryStrings;
+
+	bool binary_log;
+	TraceBinary::Event binary_event;
+	Firebird::Array<TraceBinary::TableCounts> binary_tables;
+	Firebird::Array<UCHAR> binary_record;
+	BinaryStrings binary_strings;
+	ULONG binary_string_id;
+
 	// Data for currently active connections, transactions, statements
 	Firebird::RWLock connectionsLock;
 	ConnectionsTree connections;
@@ -189,7 +200,15 @@ private:
 
 	bool checkServiceFilter(Firebird::ITraceServiceConnection* service, bool started);
 
-	// Write message to text log file
+	// Write message to log file
+	void writeLog(const void* data, FB_SIZE_T length);
+	void insertDescription(ULONG& binary_id, const Firebird::string& description);
+	ULONG binaryString(const Firebird::string& text);
+	void putBinary(USHORT type, const void* data, FB_SIZE_T length,
+		const void* tail = NULL, FB_SIZE_T tail_length = 0);
+	void logBinaryRecord(const char* action);
+	void dropRecord();
+
 	void logRecord(const char* action);
 	void logRecordConn(const char* action, Firebird::ITraceDatabaseConnection* connection);
 	void logRecordTrans(const char* action, Firebird::ITraceDatabaseConnection* connection,
@@ -42,6 +42,8 @@ STR_PARAMETER(exclude_gds_codes, "")
 BOOL_PARAMETER(log_initfini, true)
 BOOL_PARAMETER(enabled, false)
 UINT_PARAMETER(max_log_size, 0)
+UINT_PARAMETER(log_buffer_size, 1024)
+STR_PARAMETER(log_format, "text")
 
 #ifdef DATABASE_PARAMS
 BOOL_PARAMETER(log_connections, false)